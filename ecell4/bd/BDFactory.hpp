@@ -27,7 +27,8 @@ public:
 public:
 
     BDFactory(const Integer3& matrix_sizes = default_matrix_sizes(), Real bd_dt_factor = default_bd_dt_factor())
-        : base_type(), rng_(), matrix_sizes_(matrix_sizes), bd_dt_factor_(bd_dt_factor)
+        : base_type(), rng_(), matrix_sizes_(matrix_sizes), bd_dt_factor_(bd_dt_factor),
+        parallel_(false), num_threads_(0), skin_(0)
     {
         ; // do nothing
     }
@@ -58,31 +59,75 @@ public:
         return &(this->rng(rng));  //XXX: == this
     }
 
-protected:
+    bool has_rng() const
+    {
+        return static_cast<bool>(rng_);
+    }
 
-    virtual world_type* create_world(const Real3& edge_lengths) const
+    /**
+     * let worlds cache neighbors of each particle within the skin across
+     * steps. See NeighborList.
+     */
+    this_type& neighbor_list(const Real skin)
     {
-        if (rng_)
+        if (skin < 0)
         {
-            return new world_type(edge_lengths, matrix_sizes_, rng_);
+            throw IllegalArgument("The skin must not be negative.");
         }
-        else
+        skin_ = skin;
+        return (*this);
+    }
+
+    inline this_type* neighbor_list_ptr(const Real skin)
+    {
+        return &(this->neighbor_list(skin));  //XXX: == this
+    }
+
+    /**
+     * let simulators move particles on num_threads threads.
+     * See BDSimulator::set_parallel.
+     */
+    this_type& parallel(const Integer num_threads = 0)
+    {
+        if (num_threads < 0)
         {
-            return new world_type(edge_lengths, matrix_sizes_);
+            throw IllegalArgument("The number of threads must not be negative.");
         }
+        parallel_ = true;
+        num_threads_ = num_threads;
+        return (*this);
     }
 
-    virtual simulator_type* create_simulator(
-        const boost::shared_ptr<world_type>& w, const boost::shared_ptr<Model>& m) const
+    inline this_type* parallel_ptr(const Integer num_threads = 0)
+    {
+        return &(this->parallel(num_threads));  //XXX: == this
+    }
+
+protected:
+
+    virtual world_type* create_world(const Real3& edge_lengths) const
     {
-        if (bd_dt_factor_ > 0)
+        world_type* w(
+            rng_ ? new world_type(edge_lengths, matrix_sizes_, rng_)
+                : new world_type(edge_lengths, matrix_sizes_));
+        if (skin_ > 0)
         {
-            return new simulator_type(w, m, bd_dt_factor_);
+            w->set_neighbor_list_skin(skin_);
         }
-        else
+        return w;
+    }
+
+    virtual simulator_type* create_simulator(
+        const boost::shared_ptr<world_type>& w, const boost::shared_ptr<Model>& m) const
+    {
+        simulator_type* sim(
+            bd_dt_factor_ > 0 ? new simulator_type(w, m, bd_dt_factor_)
+                : new simulator_type(w, m));
+        if (parallel_)
         {
-            return new simulator_type(w, m);
+            sim->set_parallel(true, num_threads_);
         }
+        return sim;
     }
 
 protected:
@@ -90,6 +135,9 @@ protected:
     boost::shared_ptr<RandomNumberGenerator> rng_;
     Integer3 matrix_sizes_;
     Real bd_dt_factor_;
+    bool parallel_;
+    Integer num_threads_;
+    Real skin_;
 };
 
 } // bd
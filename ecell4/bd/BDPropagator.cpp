@@ -2,6 +2,7 @@
 
 #include <ecell4/core/exceptions.hpp>
 #include <ecell4/core/Species.hpp>
+#include <ecell4/core/functions.hpp>
 
 #include "BDPropagator.hpp"
 
@@ -12,6 +13,57 @@ namespace ecell4
 namespace bd
 {
 
+void BDPropagator::queue_all_particles()
+{
+    typedef BDWorld::particle_space_type particle_space_type;
+
+    // The columns are in the order of particles(), and so is the queue.
+    const particle_space_type& space(world_.particle_space());
+    queue_ = world_.list_particles();
+    const std::size_t num_particles(queue_.size());
+
+    particle_space_type::real_column_type coordinates[3];
+    for (Real3::size_type dim(0); dim < 3; ++dim)
+    {
+        coordinates[dim].resize(num_particles);
+    }
+    random_displacements_3d(
+        rng_, dt_, num_particles, space.Ds().data(), coordinates[0].data(),
+        coordinates[1].data(), coordinates[2].data());
+
+    const Real3& edge_lengths(world_.edge_lengths());
+    for (Real3::size_type dim(0); dim < 3; ++dim)
+    {
+        const Real* x(space.coordinates(dim).data());
+        Real* newx(coordinates[dim].data());
+        for (std::size_t i(0); i < num_particles; ++i)
+        {
+            newx[i] += x[i];
+        }
+        fold_periodic(newx, num_particles, edge_lengths[dim]);
+    }
+
+    // shuffle the queue and the destinations together
+    std::vector<std::size_t> order(num_particles);
+    for (std::size_t i(0); i < num_particles; ++i)
+    {
+        order[i] = i;
+    }
+    shuffle(rng_, order);
+
+    BDWorld::particle_container_type particles;
+    particles.swap(queue_);
+    queue_.reserve(num_particles);
+    destinations_.reserve(num_particles);
+    for (std::size_t i(0); i < num_particles; ++i)
+    {
+        const std::size_t j(order[i]);
+        queue_.push_back(particles[j]);
+        destinations_.push_back(
+            Real3(coordinates[0][j], coordinates[1][j], coordinates[2][j]));
+    }
+}
+
 bool BDPropagator::operator()()
 {
     if (queue_.empty())
@@ -19,19 +71,45 @@ bool BDPropagator::operator()()
         return false;
     }
 
-    const ParticleID pid(queue_.back().first);
+    const std::pair<ParticleID, Particle> queued(queue_.back());
     queue_.pop_back();
+    const ParticleID& pid(queued.first);
     Particle particle(world_.get_particle(pid).second);
 
-    if (attempt_reaction(pid, particle))
+    if (destinations_.empty())
+    {
+        if (!attempt_reaction(pid, particle))
+        {
+            diffuse(pid, particle);
+        }
+        return true;
+    }
+
+    const Real3 newpos(destinations_.back());
+    destinations_.pop_back();
+    if (attempt_reaction(pid, particle) || particle.D() == 0)
     {
         return true;
     }
+    else if (particle.D() != queued.second.D()
+        || particle.position() != queued.second.position())
+    {
+        // changed after the destination was drawn
+        diffuse(pid, particle);
+        return true;
+    }
+
+    attempt_move(pid, Particle(
+        particle.species(), newpos, particle.radius(), particle.D()));
+    return true;
+}
 
+void BDPropagator::diffuse(const ParticleID& pid, const Particle& particle)
+{
     const Real D(particle.D());
     if (D == 0)
     {
-        return true;
+        return;
     }
 
     const Real3 newpos(
@@ -41,180 +119,246 @@ bool BDPropagator::operator()()
         particle.species(), newpos, particle.radius(), particle.D());
     // Particle particle_to_update(
     //     particle.species_serial(), newpos, particle.radius(), particle.D());
+    attempt_move(pid, particle_to_update);
+}
+
+void BDPropagator::attempt_move(const ParticleID& pid, const Particle& particle_to_update)
+{
+    const Real3& newpos(particle_to_update.position());
+    if (world_.list_neighbors_within_radius(
+            pid, newpos, particle_to_update.radius(), neighbors_))
+    {
+        switch (neighbors_.size())
+        {
+        case 0:
+            world_.update_particle_without_checking(pid, particle_to_update);
+            return;
+        case 1:
+            attempt_reaction(
+                pid, particle_to_update, neighbors_[0].first,
+                world_.get_particle(neighbors_[0].first).second);
+            return;
+        default:
+            return;
+        }
+    }
+
     std::vector<std::pair<std::pair<ParticleID, Particle>, Real> >
         overlapped(world_.list_particles_within_radius(
-                       newpos, particle.radius(), pid));
+                       newpos, particle_to_update.radius(), pid));
 
     switch (overlapped.size())
     {
     case 0:
         world_.update_particle_without_checking(pid, particle_to_update);
-        return true;
+        return;
     case 1:
         {
             std::pair<ParticleID, Particle> closest(
                 (*(overlapped.begin())).first);
-            if (attempt_reaction(
-                    pid, particle_to_update, closest.first, closest.second))
-            {
-                return true;
-            }
+            attempt_reaction(
+                pid, particle_to_update, closest.first, closest.second);
         }
-        return true;
+        return;
     default:
-        return true;
+        return;
     }
 }
 
 bool BDPropagator::attempt_reaction(
     const ParticleID& pid, const Particle& particle)
 {
-    std::vector<ReactionRule> reaction_rules(
+    if (compiled_ != NULL)
+    {
+        return attempt_reaction(
+            pid, particle, compiled_->query_reaction_rules(particle.species()));
+    }
+
+    const std::vector<ReactionRule> reaction_rules(
         model_.query_reaction_rules(particle.species()));
-    if (reaction_rules.size() == 0)
+    return attempt_reaction(pid, particle, as_range(reaction_rules));
+}
+
+bool BDPropagator::attempt_reaction(
+    const ParticleID& pid, const Particle& particle,
+    const ReactionRuleRange& reaction_rules)
+{
+    if (reaction_rules.empty())
     {
         return false;
     }
 
-    const Real rnd(rng().uniform(0, 1));
+    const ReactionRule* rr(
+        select_reaction(reaction_rules, dt(), rng().uniform(0, 1)));
+    return (rr != NULL && fire_reaction(pid, particle, *rr));
+}
+
+const ReactionRule* BDPropagator::select_reaction(
+    const ReactionRuleRange& reaction_rules, const Real dt, const Real rnd)
+{
     Real prob(0);
-    for (std::vector<ReactionRule>::const_iterator i(reaction_rules.begin());
+    for (ReactionRuleRange::const_iterator i(reaction_rules.begin());
          i != reaction_rules.end(); ++i)
     {
-        const ReactionRule& rr(*i);
-        prob += rr.k() * dt();
+        prob += (*i).k() * dt;
         if (prob > rnd)
         {
-            const ReactionRule::product_container_type& products(rr.products());
-            reaction_info_type ri(world_.t() + dt_, reaction_info_type::container_type(1, std::make_pair(pid, particle)), reaction_info_type::container_type());
+            return &(*i);
+        }
+    }
+    return NULL;
+}
+
+bool BDPropagator::fire_reaction(
+    const ParticleID& pid, const Particle& particle, const ReactionRule& rr)
+{
+    const ReactionRule::product_container_type& products(rr.products());
+    reaction_info_type ri(world_.t() + dt_, reaction_info_type::container_type(1, std::make_pair(pid, particle)), reaction_info_type::container_type());
+
+    switch (products.size())
+    {
+    case 0:
+        remove_particle(pid);
+        last_reactions_.push_back(std::make_pair(rr, ri));
+        break;
+    case 1:
+        {
+            const Species species_new(
+                model_.apply_species_attributes(*(products.begin())));
+            const BDWorld::molecule_info_type
+                info(world_.get_molecule_info(species_new));
+            const Real radius_new(info.radius);
+            const Real D_new(info.D);
+
+            std::vector<std::pair<std::pair<ParticleID, Particle>, Real> >
+                overlapped(world_.list_particles_within_radius(
+                               particle.position(), radius_new, pid));
+            if (overlapped.size() > 0)
+            {
+                // throw NoSpace("");
+                return false;
+            }
+
+            Particle particle_to_update(
+                species_new, particle.position(), radius_new, D_new);
+            world_.update_particle(pid, particle_to_update);
 
-            switch (products.size())
+            ri.add_product(std::make_pair(pid, particle_to_update));
+            last_reactions_.push_back(std::make_pair(rr, ri));
+        }
+        break;
+    case 2:
+        {
+            ReactionRule::product_container_type::const_iterator
+                it(products.begin());
+            const Species species_new1(
+                model_.apply_species_attributes(*it));
+            const Species species_new2(
+                model_.apply_species_attributes(*(++it)));
+
+            const BDWorld::molecule_info_type
+                info1(world_.get_molecule_info(species_new1)),
+                info2(world_.get_molecule_info(species_new2));
+            const Real radius1(info1.radius),
+                radius2(info2.radius);
+            const Real D1(info1.D), D2(info2.D);
+
+            const Real D12(D1 + D2);
+            const Real r12(radius1 + radius2);
+            Integer i(max_retry_count_);
+            while (true)
             {
-            case 0:
-                remove_particle(pid);
-                last_reactions_.push_back(std::make_pair(rr, ri));
-                break;
-            case 1:
+                if (--i < 0)
                 {
-                    const Species species_new(
-                        model_.apply_species_attributes(*(products.begin())));
-                    const BDWorld::molecule_info_type
-                        info(world_.get_molecule_info(species_new));
-                    const Real radius_new(info.radius);
-                    const Real D_new(info.D);
-
-                    std::vector<std::pair<std::pair<ParticleID, Particle>, Real> >
-                        overlapped(world_.list_particles_within_radius(
-                                       particle.position(), radius_new, pid));
-                    if (overlapped.size() > 0)
-                    {
-                        // throw NoSpace("");
-                        return false;
-                    }
-
-                    Particle particle_to_update(
-                        species_new, particle.position(), radius_new, D_new);
-                    world_.update_particle(pid, particle_to_update);
-
-                    ri.add_product(std::make_pair(pid, particle_to_update));
-                    last_reactions_.push_back(std::make_pair(rr, ri));
+                    // throw NoSpace("")
+                    return false;
                 }
-                break;
-            case 2:
+
+                const Real3 ipv(draw_ipv(r12, dt(), D12));
+
+                const Real3 newpos1(world_.apply_boundary(
+                    particle.position() + ipv * (D1 / D12)));
+                const Real3 newpos2(world_.apply_boundary(
+                    particle.position() - ipv * (D2 / D12)));
+                std::vector<
+                    std::pair<std::pair<ParticleID, Particle>, Real> >
+                    overlapped1(world_.list_particles_within_radius(
+                                    newpos1, radius1, pid));
+                std::vector<
+                    std::pair<std::pair<ParticleID, Particle>, Real> >
+                    overlapped2(world_.list_particles_within_radius(
+                                    newpos2, radius2, pid));
+                if (overlapped1.size() != 0 || overlapped2.size() != 0)
                 {
-                    ReactionRule::product_container_type::const_iterator
-                        it(products.begin());
-                    const Species species_new1(
-                        model_.apply_species_attributes(*it));
-                    const Species species_new2(
-                        model_.apply_species_attributes(*(++it)));
-
-                    const BDWorld::molecule_info_type
-                        info1(world_.get_molecule_info(species_new1)),
-                        info2(world_.get_molecule_info(species_new2));
-                    const Real radius1(info1.radius),
-                        radius2(info2.radius);
-                    const Real D1(info1.D), D2(info2.D);
-
-                    const Real D12(D1 + D2);
-                    const Real r12(radius1 + radius2);
-                    Real3 newpos1, newpos2;
-                    Integer i(max_retry_count_);
-                    while (true)
-                    {
-                        if (--i < 0)
-                        {
-                            // throw NoSpace("")
-                            return false;
-                        }
-
-                        const Real3 ipv(draw_ipv(r12, dt(), D12));
-
-                        newpos1 = world_.apply_boundary(
-                            particle.position() + ipv * (D1 / D12));
-                        newpos2 = world_.apply_boundary(
-                            particle.position() - ipv * (D2 / D12));
-                        std::vector<
-                            std::pair<std::pair<ParticleID, Particle>, Real> >
-                            overlapped1(world_.list_particles_within_radius(
-                                            newpos1, radius1, pid));
-                        std::vector<
-                            std::pair<std::pair<ParticleID, Particle>, Real> >
-                            overlapped2(world_.list_particles_within_radius(
-                                            newpos2, radius2, pid));
-                        if (overlapped1.size() == 0 && overlapped2.size() == 0)
-                        {
-                            break;
-                        }
-                    }
-
-                    Particle particle_to_update1(
-                        species_new1, newpos1, radius1, D1);
-                    Particle particle_to_update2(
-                        species_new2, newpos2, radius2, D2);
-                    world_.update_particle(pid, particle_to_update1);
-                    std::pair<std::pair<ParticleID, Particle>, bool> retval = world_.new_particle(particle_to_update2);
-
-                    ri.add_product(std::make_pair(pid, particle_to_update1));
-                    ri.add_product(retval.first);
-                    last_reactions_.push_back(std::make_pair(rr, ri));
+                    continue;
                 }
-                break;
-            default:
-                throw NotImplemented(
-                    "more than two products are not allowed");
+
+                Particle particle_to_update1(
+                    species_new1, newpos1, radius1, D1);
+                Particle particle_to_update2(
+                    species_new2, newpos2, radius2, D2);
+                world_.update_particle(pid, particle_to_update1);
+                std::pair<std::pair<ParticleID, Particle>, bool> retval = world_.new_particle(particle_to_update2);
+
+                ri.add_product(std::make_pair(pid, particle_to_update1));
+                ri.add_product(retval.first);
+                last_reactions_.push_back(std::make_pair(rr, ri));
                 break;
             }
-            return true;
         }
+        break;
+    default:
+        throw NotImplemented(
+            "more than two products are not allowed");
+        break;
     }
-
-    return false;
+    return true;
 }
 
 bool BDPropagator::attempt_reaction(
     const ParticleID& pid1, const Particle& particle1,
     const ParticleID& pid2, const Particle& particle2)
 {
-    std::vector<ReactionRule> reaction_rules(
-        model_.query_reaction_rules(
-            particle1.species(), particle2.species()));
-    if (reaction_rules.size() == 0)
+    if (compiled_ != NULL)
+    {
+        return attempt_reaction(
+            pid1, particle1, pid2, particle2,
+            compiled_->query_reaction_rules(particle1.species(), particle2.species()));
+    }
+
+    const std::vector<ReactionRule> reaction_rules(
+        model_.query_reaction_rules(particle1.species(), particle2.species()));
+    return attempt_reaction(pid1, particle1, pid2, particle2, as_range(reaction_rules));
+}
+
+bool BDPropagator::attempt_reaction(
+    const ParticleID& pid1, const Particle& particle1,
+    const ParticleID& pid2, const Particle& particle2,
+    const ReactionRuleRange& reaction_rules)
+{
+    if (reaction_rules.empty())
     {
         return false;
     }
 
+    const ReactionRule* rr(select_reaction(
+        reaction_rules, dt(), particle1, particle2, rng().uniform(0, 1)));
+    return (rr != NULL && fire_reaction(pid1, particle1, pid2, particle2, *rr));
+}
+
+const ReactionRule* BDPropagator::select_reaction(
+    const ReactionRuleRange& reaction_rules, const Real dt,
+    const Particle& particle1, const Particle& particle2, const Real rnd)
+{
     const Real D1(particle1.D()), D2(particle2.D());
     const Real r12(particle1.radius() + particle2.radius());
-    const Real rnd(rng().uniform(0, 1));
     Real prob(0);
 
-    for (std::vector<ReactionRule>::const_iterator i(reaction_rules.begin());
+    for (ReactionRuleRange::const_iterator i(reaction_rules.begin());
          i != reaction_rules.end(); ++i)
     {
-        const ReactionRule& rr(*i);
-        prob += rr.k() * dt() / (
-            (Igbd_3d(r12, dt(), D1) + Igbd_3d(r12, dt(), D2)) * 4 * M_PI);
+        prob += (*i).k() * dt / (
+            (Igbd_3d(r12, dt, D1) + Igbd_3d(r12, dt, D2)) * 4 * M_PI);
 
         if (prob >= 1)
         {
@@ -227,64 +371,71 @@ bool BDPropagator::attempt_reaction(
         }
         if (prob > rnd)
         {
-            const ReactionRule::product_container_type& products(rr.products());
-            reaction_info_type ri(world_.t() + dt_, reaction_info_type::container_type(1, std::make_pair(pid1, particle1)), reaction_info_type::container_type());
-            ri.add_reactant(std::make_pair(pid2, particle2));
+            return &(*i);
+        }
+    }
+    return NULL;
+}
 
-            switch (products.size())
-            {
-            case 0:
-                remove_particle(pid1);
-                remove_particle(pid2);
+bool BDPropagator::fire_reaction(
+    const ParticleID& pid1, const Particle& particle1,
+    const ParticleID& pid2, const Particle& particle2,
+    const ReactionRule& rr)
+{
+    const ReactionRule::product_container_type& products(rr.products());
+    reaction_info_type ri(world_.t() + dt_, reaction_info_type::container_type(1, std::make_pair(pid1, particle1)), reaction_info_type::container_type());
+    ri.add_reactant(std::make_pair(pid2, particle2));
 
-                last_reactions_.push_back(std::make_pair(rr, ri));
-                break;
-            case 1:
-                {
-                    const Species sp(*(products.begin()));
-                    const BDWorld::molecule_info_type
-                        info(world_.get_molecule_info(sp));
-                    const Real radius_new(info.radius);
-                    const Real D_new(info.D);
-
-                    const Real3 pos1(particle1.position());
-                    const Real3 pos2(
-                        world_.periodic_transpose(particle2.position(), pos1));
-                    const Real D1(particle1.D()), D2(particle2.D());
-                    const Real D12(D1 + D2);
-                    const Real3 newpos(
-                        world_.apply_boundary((pos1 * D2 + pos2 * D1) / D12));
-
-                    std::vector<std::pair<std::pair<ParticleID, Particle>, Real> >
-                        overlapped(world_.list_particles_within_radius(
-                                       newpos, radius_new, pid1, pid2));
-                    if (overlapped.size() > 0)
-                    {
-                        // throw NoSpace("");
-                        return false;
-                    }
-
-                    const Particle particle_to_update(
-                        sp, newpos, radius_new, D_new);
-                    remove_particle(pid2);
-                    // world_.update_particle(pid1, particle_to_update);
-                    remove_particle(pid1);
-                    std::pair<std::pair<ParticleID, Particle>, bool> retval = world_.new_particle(particle_to_update);
-
-                    ri.add_product(retval.first);
-                    last_reactions_.push_back(std::make_pair(rr, ri));
-                }
-                break;
-            default:
-                throw NotImplemented(
-                    "more than one product is not allowed");
-                break;
+    switch (products.size())
+    {
+    case 0:
+        remove_particle(pid1);
+        remove_particle(pid2);
+
+        last_reactions_.push_back(std::make_pair(rr, ri));
+        break;
+    case 1:
+        {
+            const Species sp(*(products.begin()));
+            const BDWorld::molecule_info_type
+                info(world_.get_molecule_info(sp));
+            const Real radius_new(info.radius);
+            const Real D_new(info.D);
+
+            const Real3 pos1(particle1.position());
+            const Real3 pos2(
+                world_.periodic_transpose(particle2.position(), pos1));
+            const Real D1(particle1.D()), D2(particle2.D());
+            const Real D12(D1 + D2);
+            const Real3 newpos(
+                world_.apply_boundary((pos1 * D2 + pos2 * D1) / D12));
+
+            std::vector<std::pair<std::pair<ParticleID, Particle>, Real> >
+                overlapped(world_.list_particles_within_radius(
+                               newpos, radius_new, pid1, pid2));
+            if (overlapped.size() > 0)
+            {
+                // throw NoSpace("");
+                return false;
             }
-            return true;
+
+            const Particle particle_to_update(
+                sp, newpos, radius_new, D_new);
+            remove_particle(pid2);
+            // world_.update_particle(pid1, particle_to_update);
+            remove_particle(pid1);
+            std::pair<std::pair<ParticleID, Particle>, bool> retval = world_.new_particle(particle_to_update);
+
+            ri.add_product(retval.first);
+            last_reactions_.push_back(std::make_pair(rr, ri));
         }
+        break;
+    default:
+        throw NotImplemented(
+            "more than one product is not allowed");
+        break;
     }
-
-    return false;
+    return true;
 }
 
 void BDPropagator::remove_particle(const ParticleID& pid)
@@ -295,6 +446,10 @@ void BDPropagator::remove_particle(const ParticleID& pid)
         i(std::find_if(queue_.begin(), queue_.end(), cmp));
     if (i != queue_.end())
     {
+        if (!destinations_.empty())
+        {
+            destinations_.erase(destinations_.begin() + (i - queue_.begin()));
+        }
         queue_.erase(i);
     }
 }
@@ -3,6 +3,7 @@
 
 #include <ecell4/core/RandomNumberGenerator.hpp>
 #include <ecell4/core/Model.hpp>
+#include <ecell4/core/CompiledNetworkModel.hpp>
 
 #include "functions3d.hpp"
 #include "BDWorld.hpp"
@@ -73,14 +74,36 @@ public:
 
 public:
 
+    /**
+     * rules are queried from compiled if given, or from model otherwise.
+     * All the particles are queued in a random order. Their destinations
+     * are drawn at once from the columns of the particle space.
+     */
     BDPropagator(
         Model& model, BDWorld& world, RandomNumberGenerator& rng, const Real& dt,
-        std::vector<std::pair<ReactionRule, reaction_info_type> >& last_reactions)
+        std::vector<std::pair<ReactionRule, reaction_info_type> >& last_reactions,
+        const CompiledNetworkModel* compiled = NULL)
         : model_(model), world_(world), rng_(rng), dt_(dt),
-        last_reactions_(last_reactions), max_retry_count_(1)
+        last_reactions_(last_reactions), max_retry_count_(1), compiled_(compiled)
     {
-        queue_ = world_.list_particles();
-        shuffle(rng_, queue_);
+        queue_all_particles();
+    }
+
+    /**
+     * a propagator for the given particles in the given order.
+     * Displacements are drawn one by one when the particles are popped.
+     * It can also be used only to fire reactions with an empty queue.
+     */
+    BDPropagator(
+        Model& model, BDWorld& world, RandomNumberGenerator& rng, const Real& dt,
+        std::vector<std::pair<ReactionRule, reaction_info_type> >& last_reactions,
+        const CompiledNetworkModel* compiled,
+        const BDWorld::particle_container_type& queue)
+        : model_(model), world_(world), rng_(rng), dt_(dt),
+        last_reactions_(last_reactions), max_retry_count_(1), compiled_(compiled),
+        queue_(queue)
+    {
+        ;
     }
 
     bool operator()();
@@ -100,6 +123,41 @@ public:
         const ParticleID& pid1, const Particle& particle1,
         const ParticleID& pid2, const Particle& particle2);
 
+    /**
+     * move the particle by a random displacement, and try a reaction
+     * with the particle overlapped if any.
+     */
+    void diffuse(const ParticleID& pid, const Particle& particle);
+
+    /**
+     * move the particle to the given position if no other particle is
+     * there, or try a reaction with the only one overlapped.
+     */
+    void attempt_move(const ParticleID& pid, const Particle& particle_to_update);
+
+    bool fire_reaction(
+        const ParticleID& pid, const Particle& particle, const ReactionRule& rr);
+    bool fire_reaction(
+        const ParticleID& pid1, const Particle& particle1,
+        const ParticleID& pid2, const Particle& particle2,
+        const ReactionRule& rr);
+
+    /**
+     * select a reaction to fire with a uniform random number in [0, 1).
+     * return NULL if nothing fires.
+     */
+    static const ReactionRule* select_reaction(
+        const ReactionRuleRange& reaction_rules, const Real dt, const Real rnd);
+    static const ReactionRule* select_reaction(
+        const ReactionRuleRange& reaction_rules, const Real dt,
+        const Particle& particle1, const Particle& particle2, const Real rnd);
+
+    static ReactionRuleRange as_range(const std::vector<ReactionRule>& rules)
+    {
+        return (rules.empty() ? ReactionRuleRange()
+            : ReactionRuleRange(&rules[0], &rules[0] + rules.size()));
+    }
+
     class particle_finder
         : public std::unary_function<std::pair<ParticleID, Particle>, bool>
     {
@@ -123,6 +181,20 @@ public:
 
     void remove_particle(const ParticleID& pid);
 
+protected:
+
+    void queue_all_particles();
+
+    bool attempt_reaction(
+        const ParticleID& pid, const Particle& particle,
+        const ReactionRuleRange& reaction_rules);
+    bool attempt_reaction(
+        const ParticleID& pid1, const Particle& particle1,
+        const ParticleID& pid2, const Particle& particle2,
+        const ReactionRuleRange& reaction_rules);
+
+public:
+
     inline Real3 draw_displacement(const Particle& particle)
     {
         return random_displacement_3d(rng(), dt(), particle.D());
@@ -141,8 +213,11 @@ protected:
     Real dt_;
     std::vector<std::pair<ReactionRule, reaction_info_type> >& last_reactions_;
     Integer max_retry_count_;
+    const CompiledNetworkModel* compiled_;
 
     BDWorld::particle_container_type queue_;
+    std::vector<Real3> destinations_;  // of queue_ if drawn in bulk, or empty
+    NeighborList::neighbor_container_type neighbors_;  // a buffer reused by moves
 };
 
 } // bd
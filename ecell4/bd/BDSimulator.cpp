@@ -55,10 +55,34 @@ void BDSimulator::attempt_synthetic_reaction(const ReactionRule& rr)
     last_reactions_.push_back(std::make_pair(rr, ri));
 }
 
+void BDSimulator::compile_model()
+{
+    compiled_revision_ = model_->revision();
+    if (model_->is_static())
+    {
+        compiled_model_.compile(*model_);
+        has_compiled_model_ = true;
+    }
+    else
+    {
+        has_compiled_model_ = false;
+    }
+}
+
+bool BDSimulator::is_compiled() const
+{
+    return (model_->revision() == compiled_revision_);
+}
+
 void BDSimulator::step()
 {
     last_reactions_.clear();
 
+    if (has_compiled_model_ && !is_compiled())
+    {
+        compile_model();  // the model was changed after initialize()
+    }
+
     for (Model::reaction_rule_container_type::const_iterator i((*model_).reaction_rules().begin());
         i != (*model_).reaction_rules().end(); ++i)
     {
@@ -68,8 +92,20 @@ void BDSimulator::step()
         }
     }
 
+    world_->update_neighbor_list();
+
+    if (parallel_)
+    {
+        ParallelBDPropagator propagator(
+            *model_, *world_, *rng(), dt(), last_reactions_, *pool_,
+            has_compiled_model_ ? &compiled_model_ : NULL);
+        propagator();
+    }
+    else
     {
-        BDPropagator propagator(*model_, *world_, *rng(), dt(), last_reactions_);
+        BDPropagator propagator(
+            *model_, *world_, *rng(), dt(), last_reactions_,
+            has_compiled_model_ ? &compiled_model_ : NULL);
         while (propagator())
         {
             ; // do nothing here
@@ -3,12 +3,15 @@
 
 #include <stdexcept>
 #include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include <ecell4/core/Model.hpp>
 #include <ecell4/core/SimulatorBase.hpp>
+#include <ecell4/core/CompiledNetworkModel.hpp>
 
 #include "BDWorld.hpp"
 #include "BDPropagator.hpp"
+#include "ParallelBDPropagator.hpp"
 
 
 namespace ecell4
@@ -30,13 +33,15 @@ public:
     BDSimulator(
         boost::shared_ptr<BDWorld> world, boost::shared_ptr<Model> model,
         Real bd_dt_factor = 1e-5)
-        : base_type(world, model), dt_(0), bd_dt_factor_(bd_dt_factor), dt_set_by_user_(false)
+        : base_type(world, model), dt_(0), bd_dt_factor_(bd_dt_factor), dt_set_by_user_(false),
+        has_compiled_model_(false), compiled_revision_(0), parallel_(false), num_threads_(0)
     {
         initialize();
     }
 
     BDSimulator(boost::shared_ptr<BDWorld> world, Real bd_dt_factor = 1e-5)
-        : base_type(world), dt_(0), bd_dt_factor_(bd_dt_factor), dt_set_by_user_(false)
+        : base_type(world), dt_(0), bd_dt_factor_(bd_dt_factor), dt_set_by_user_(false),
+        has_compiled_model_(false), compiled_revision_(0), parallel_(false), num_threads_(0)
     {
         initialize();
     }
@@ -46,6 +51,8 @@ public:
     void initialize()
     {
         last_reactions_.clear();
+        compile_model();
+
         if (!dt_set_by_user_)
         {
             dt_ = determine_dt();
@@ -127,6 +134,30 @@ public:
         dt_set_by_user_ = true;
     }
 
+    /**
+     * switch to ParallelBDPropagator, which moves particles cell by cell
+     * on num_threads threads (0 means the number of hardware threads).
+     * Its trajectory does not depend on num_threads, but differs from
+     * the serial one with the same seed. The threads are started here,
+     * and kept until the simulator is destroyed or switched back.
+     */
+    void set_parallel(const bool parallel, const std::size_t num_threads = 0)
+    {
+        parallel_ = parallel;
+        num_threads_ = num_threads;
+        pool_.reset(parallel ? new ThreadPool(num_threads) : NULL);
+    }
+
+    bool is_parallel() const
+    {
+        return parallel_;
+    }
+
+    std::size_t num_threads() const
+    {
+        return num_threads_;
+    }
+
     inline boost::shared_ptr<RandomNumberGenerator> rng()
     {
         return (*world_).rng();
@@ -136,6 +167,20 @@ protected:
 
     void attempt_synthetic_reaction(const ReactionRule& rr);
 
+    /**
+     * compile the reaction rules of a static model, and keep the revision
+     * of the model for is_compiled(). A model which is not static is queried
+     * directly.
+     */
+    void compile_model();
+
+    /**
+     * return if the model has not been changed since compiled, comparing
+     * only Model::revision. The rules are compiled again at the next step if
+     * not, e.g. after a rule is added to the model.
+     */
+    bool is_compiled() const;
+
 protected:
 
     /**
@@ -146,6 +191,13 @@ protected:
     const Real bd_dt_factor_;
     bool dt_set_by_user_;
     std::vector<std::pair<ReactionRule, reaction_info_type> > last_reactions_;
+
+    CompiledNetworkModel compiled_model_;  // valid only for a static model
+    bool has_compiled_model_;
+    Integer compiled_revision_;  // of the model when compiled
+    bool parallel_;
+    std::size_t num_threads_;
+    boost::scoped_ptr<ThreadPool> pool_;  // valid only if parallel_
 };
 
 } // bd
@@ -15,6 +15,8 @@
 #include <ecell4/core/Model.hpp>
 #include <ecell4/core/WorldInterface.hpp>
 
+#include "NeighborList.hpp"
+
 
 namespace ecell4
 {
@@ -82,6 +84,10 @@ public:
         if (list_particles_within_radius(p.position(), p.radius()).size() == 0)
         {
             (*ps_).update_particle(pid, p); //XXX: DONOT call this->update_particle
+            if (neighbors_)
+            {
+                neighbors_->update(particle_space(), pid, p);
+            }
             return std::make_pair(std::make_pair(pid, p), true);
         }
         else
@@ -202,7 +208,12 @@ public:
 
     bool update_particle_without_checking(const ParticleID& pid, const Particle& p)
     {
-        return (*ps_).update_particle(pid, p);
+        const bool retval((*ps_).update_particle(pid, p));
+        if (neighbors_)
+        {
+            neighbors_->update(particle_space(), pid, p);
+        }
+        return retval;
     }
 
     bool update_particle(const ParticleID& pid, const Particle& p)
@@ -210,7 +221,7 @@ public:
         if (list_particles_within_radius(p.position(), p.radius(), pid).size()
             == 0)
         {
-            return (*ps_).update_particle(pid, p);
+            return update_particle_without_checking(pid, p);
         }
         else
         {
@@ -227,6 +238,10 @@ public:
     void remove_particle(const ParticleID& pid)
     {
         (*ps_).remove_particle(pid);
+        if (neighbors_)
+        {
+            neighbors_->remove(pid);
+        }
     }
 
     std::vector<std::pair<std::pair<ParticleID, Particle>, Real> >
@@ -251,6 +266,74 @@ public:
         return (*ps_).list_particles_within_radius(pos, radius, ignore1, ignore2);
     }
 
+    /**
+     * list particles overlapping with the particle moved to the position
+     * through the neighbor list, without allocating memory.
+     * @return false if the neighbor list is disabled or cannot answer.
+     * Then, call list_particles_within_radius instead.
+     */
+    bool list_neighbors_within_radius(
+        const ParticleID& pid, const Real3& pos, const Real& radius,
+        NeighborList::neighbor_container_type& retval) const
+    {
+        return (neighbors_ && neighbors_->list_neighbors_within_radius(
+            particle_space(), pid, pos, radius, retval));
+    }
+
+    /**
+     * same as above, but answer only if the particle was in the given cell
+     * when its neighbors were listed.
+     */
+    bool list_neighbors_within_radius(
+        const ParticleID& pid, const Real3& pos, const Real& radius,
+        const particle_space_type::cell_index_type& cell,
+        NeighborList::neighbor_container_type& retval) const
+    {
+        return (neighbors_ && neighbors_->list_neighbors_within_radius(
+            particle_space(), pid, pos, radius, cell, retval));
+    }
+
+    /**
+     * enable the neighbor list with the given skin, or disable it with 0.
+     * 2.5 times the skin plus the diameter of the largest particle must be
+     * shorter than the cell size (see NeighborList::fits_in_cells).
+     * Particles added later are checked when listed.
+     */
+    void set_neighbor_list_skin(const Real skin)
+    {
+        if (skin <= 0)
+        {
+            neighbors_.reset();
+            return;
+        }
+
+        const particle_space_type::real_column_type& radii(particle_space().radii());
+        const Real max_radius(
+            radii.empty() ? 0.0 : *std::max_element(radii.begin(), radii.end()));
+        if (!NeighborList::fits_in_cells(skin, max_radius, particle_space().cell_sizes()))
+        {
+            throw IllegalArgument(
+                "The skin plus radii must be shorter than the cell size.");
+        }
+        neighbors_.reset(new NeighborList(skin));
+    }
+
+    Real neighbor_list_skin() const
+    {
+        return (neighbors_ ? neighbors_->skin() : 0.0);
+    }
+
+    /**
+     * rebuild the neighbor list if enabled and needed.
+     */
+    void update_neighbor_list()
+    {
+        if (neighbors_ && !neighbors_->is_valid())
+        {
+            neighbors_->rebuild(particle_space());
+        }
+    }
+
     inline Real3 periodic_transpose(
         const Real3& pos1, const Real3& pos2) const
     {
@@ -333,6 +416,14 @@ public:
         return (*ps_).particles();
     }
 
+    /**
+     * return the cell list of particles to traverse them cell by cell.
+     */
+    const particle_space_type& particle_space() const
+    {
+        return static_cast<const particle_space_type&>(*ps_);  // see constructors
+    }
+
     void save(const std::string& filename) const
     {
 #ifdef WITH_HDF5
@@ -375,6 +466,10 @@ public:
 
         const H5::Group group(fin->openGroup("ParticleSpace"));
         ps_->load_hdf5(group);
+        if (neighbors_)
+        {
+            neighbors_->invalidate();
+        }
         pidgen_.load(*fin);
         rng_->load(*fin);
 #else
@@ -407,6 +502,7 @@ protected:
     boost::scoped_ptr<ParticleSpace> ps_;
     boost::shared_ptr<RandomNumberGenerator> rng_;
     SerialIDGenerator<ParticleID> pidgen_;
+    boost::scoped_ptr<NeighborList> neighbors_;  // NULL if disabled
 
     boost::weak_ptr<Model> model_;
 };
@@ -0,0 +1,181 @@
+#include <algorithm>
+
+#include "NeighborList.hpp"
+
+#include <ecell4/core/comparators.hpp>
+
+
+namespace ecell4
+{
+
+namespace bd
+{
+
+void NeighborList::rebuild(const particle_space_type& space)
+{
+    const particle_space_type::particle_container_type& particles(space.particles());
+
+    entries_.resize(particles.size());  // the capacity of each list is kept
+    entries_map_.clear();
+    for (entry_container_type::size_type i(0); i < particles.size(); ++i)
+    {
+        const Particle& p(particles[i].second);
+        check_radius(space, p.radius());
+        entry_type& e(entries_[i]);
+        std::copy(p.position().begin(), p.position().end(), e.reference.begin());
+        e.radius = p.radius();
+        e.neighbors.clear();
+
+        const std::vector<std::pair<std::pair<ParticleID, Particle>, Real> >
+            overlapped(space.list_particles_within_radius(
+                p.position(), p.radius() + skin_, particles[i].first));
+        for (std::vector<std::pair<std::pair<ParticleID, Particle>, Real> >::const_iterator
+            j(overlapped.begin()); j != overlapped.end(); ++j)
+        {
+            e.neighbors.push_back((*j).first.first);
+        }
+
+        entries_map_[particles[i].first] = i;
+    }
+
+    max_displacement_ = 0;
+    valid_ = true;
+    ++num_rebuilds_;
+}
+
+void NeighborList::update(
+    const particle_space_type& space, const ParticleID& pid, const Particle& p)
+{
+    if (!valid_)
+    {
+        return;  // rebuilt later anyway
+    }
+
+    entry_map_type::const_iterator i(entries_map_.find(pid));
+    if (i == entries_map_.end() || p.radius() > entries_[(*i).second].radius)
+    {
+        insert(space, pid, p);
+        return;
+    }
+
+    const Real displacement(space.distance(entries_[(*i).second].reference, p.position()));
+    Real current(max_displacement_.load());
+    while (displacement > current
+        && !max_displacement_.compare_exchange_weak(current, displacement))
+    {
+        ; // retry with the updated current
+    }
+}
+
+void NeighborList::insert(
+    const particle_space_type& space, const ParticleID& pid, const Particle& p)
+{
+    check_radius(space, p.radius());
+
+    // Others may have moved up to max_displacement_ from their references,
+    // and thus the margin must be taken into account.
+    const std::vector<std::pair<std::pair<ParticleID, Particle>, Real> >
+        overlapped(space.list_particles_within_radius(
+            p.position(), p.radius() + skin_ + max_displacement_.load(), pid));
+
+    entry_container_type::size_type idx;
+    entry_map_type::const_iterator i(entries_map_.find(pid));
+    if (i != entries_map_.end())
+    {
+        idx = (*i).second;
+    }
+    else
+    {
+        idx = entries_.size();
+        entries_.push_back(entry_type());
+        entries_map_[pid] = idx;
+    }
+
+    entry_type& e(entries_[idx]);
+    std::copy(p.position().begin(), p.position().end(), e.reference.begin());
+    e.radius = p.radius();
+    e.neighbors.clear();
+
+    for (std::vector<std::pair<std::pair<ParticleID, Particle>, Real> >::const_iterator
+        j(overlapped.begin()); j != overlapped.end(); ++j)
+    {
+        const ParticleID& neighbor((*j).first.first);
+        e.neighbors.push_back(neighbor);
+
+        entry_map_type::const_iterator k(entries_map_.find(neighbor));
+        if (k == entries_map_.end())
+        {
+            continue;
+        }
+
+        std::vector<ParticleID>& neighbors(entries_[(*k).second].neighbors);
+        if (std::find(neighbors.begin(), neighbors.end(), pid) == neighbors.end())
+        {
+            neighbors.push_back(pid);
+        }
+    }
+}
+
+void NeighborList::check_radius(
+    const particle_space_type& space, const Real radius)
+{
+    if (!fits_in_cells(skin_, radius, space.cell_sizes()))
+    {
+        valid_ = false;
+        throw IllegalArgument(
+            "The skin plus radii must be shorter than the cell size.");
+    }
+}
+
+bool NeighborList::list_neighbors_within_radius(
+    const particle_space_type& space, const ParticleID& pid,
+    const Real3& pos, const Real& radius,
+    const particle_space_type::cell_index_type* cell,
+    neighbor_container_type& retval) const
+{
+    if (!is_valid())
+    {
+        return false;
+    }
+
+    entry_map_type::const_iterator i(entries_map_.find(pid));
+    if (i == entries_map_.end())
+    {
+        return false;
+    }
+
+    const entry_type& e(entries_[(*i).second]);
+    if (radius > e.radius
+        || space.distance(e.reference, pos) + max_displacement_.load() > skin_
+        || (cell != NULL && space.cell_index(e.reference) != *cell))
+    {
+        return false;
+    }
+
+    retval.clear();
+    for (std::vector<ParticleID>::const_iterator j(e.neighbors.begin());
+        j != e.neighbors.end(); ++j)
+    {
+        const particle_space_type::particle_container_type::const_iterator
+            itr(space.find_particle(*j));
+        if (itr == space.particles().end())
+        {
+            continue;  // already removed
+        }
+
+        const Real dist(
+            space.distance(pos, (*itr).second.position()) - (*itr).second.radius());
+        if (dist < radius)
+        {
+            retval.push_back(std::make_pair(*j, dist));
+        }
+    }
+
+    std::sort(retval.begin(), retval.end(),
+        utils::pair_second_element_comparator<ParticleID, Real>());
+    return true;
+}
+
+} // bd
+
+} // ecell4
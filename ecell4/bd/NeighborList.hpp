@@ -0,0 +1,180 @@
+#ifndef ECELL4_BD_NEIGHBOR_LIST_HPP
+#define ECELL4_BD_NEIGHBOR_LIST_HPP
+
+#include <vector>
+#include <utility>
+#include <atomic>
+#include <algorithm>
+
+#include <ecell4/core/types.hpp>
+#include <ecell4/core/get_mapper_mf.hpp>
+#include <ecell4/core/Particle.hpp>
+#include <ecell4/core/ParticleSpaceCellListImpl.hpp>
+
+
+namespace ecell4
+{
+
+namespace bd
+{
+
+/**
+ * A Verlet list caching neighbors of each particle across steps.
+ * Each particle keeps particles within the sum of radii and the skin from
+ * its reference position, where it was at the last rebuild. The list answers
+ * an overlap query exactly as long as the querying particle and the farthest
+ * moved one together move less than the skin since the rebuild. Thus, it
+ * needs to be rebuilt only after some particle moves more than a half of
+ * the skin. Particles added later are inserted incrementally, and removed
+ * ones are skipped lazily.
+ *
+ * The skin together with radii must be shorter than the cell size of the
+ * cell list, which is used to build the lists. See fits_in_cells.
+ */
+class NeighborList
+{
+public:
+
+    typedef ParticleSpaceCellListImpl particle_space_type;
+    typedef std::vector<std::pair<ParticleID, Real> > neighbor_container_type;
+
+protected:
+
+    struct entry_type
+    {
+        Real3 reference;
+        Real radius;
+        std::vector<ParticleID> neighbors;
+    };
+
+    typedef std::vector<entry_type> entry_container_type;
+    typedef utils::get_mapper_mf<ParticleID, entry_container_type::size_type>::type
+        entry_map_type;
+
+public:
+
+    NeighborList(const Real skin)
+        : skin_(skin), valid_(false), max_displacement_(0), num_rebuilds_(0)
+    {
+        ;
+    }
+
+    Real skin() const
+    {
+        return skin_;
+    }
+
+    /**
+     * return if the list can answer queries without rebuilding.
+     */
+    bool is_valid() const
+    {
+        return (valid_ && max_displacement_.load() <= skin_ * 0.5);
+    }
+
+    void invalidate()
+    {
+        valid_ = false;
+    }
+
+    Integer num_rebuilds() const
+    {
+        return num_rebuilds_;
+    }
+
+    /**
+     * return if lists with the skin can hold particles of the radius.
+     * A neighbor is listed within the radii plus the skin and the margin
+     * (up to a half of the skin, see insert) from the reference, and moves
+     * less than the skin afterwards. It thus stays within the radii plus 2.5
+     * times the skin, which must be shorter than the cell size. Then, neither
+     * the cell list misses a neighbor beyond the adjacent cells, nor a cached
+     * neighbor of a particle reaches a cell two cells away, which
+     * ParallelBDPropagator may update concurrently.
+     */
+    static bool fits_in_cells(const Real skin, const Real radius, const Real3& cell_sizes)
+    {
+        return (2 * radius + 2.5 * skin
+            < std::min(cell_sizes[0], std::min(cell_sizes[1], cell_sizes[2])));
+    }
+
+    /**
+     * rebuild lists of all particles from scratch. Buffers are reused.
+     */
+    void rebuild(const particle_space_type& space);
+
+    /**
+     * record the new state of a particle after it was updated in the space.
+     * A move of an existing particle without changing its radius can be
+     * recorded concurrently for different particles.
+     */
+    void update(const particle_space_type& space,
+        const ParticleID& pid, const Particle& p);
+
+    void remove(const ParticleID& pid)
+    {
+        entries_map_.erase(pid);  // ignored in lists of others when queried
+    }
+
+    /**
+     * list particles overlapping with a sphere of the given particle moved to
+     * the position, in the same way as list_particles_within_radius ignoring
+     * the particle itself. Results are written into the given buffer, and no
+     * memory is allocated once the buffer has grown enough.
+     * @return false if the list cannot answer, e.g. the particle jumped out of
+     * its skin. Then, ask the space instead.
+     */
+    bool list_neighbors_within_radius(
+        const particle_space_type& space, const ParticleID& pid,
+        const Real3& pos, const Real& radius, neighbor_container_type& retval) const
+    {
+        return list_neighbors_within_radius(space, pid, pos, radius, NULL, retval);
+    }
+
+    /**
+     * same as above, but answer only if the reference position of the
+     * particle is in the given cell. Otherwise, its neighbors may have been
+     * collected from cells updated concurrently by others.
+     */
+    bool list_neighbors_within_radius(
+        const particle_space_type& space, const ParticleID& pid,
+        const Real3& pos, const Real& radius,
+        const particle_space_type::cell_index_type& cell,
+        neighbor_container_type& retval) const
+    {
+        return list_neighbors_within_radius(space, pid, pos, radius, &cell, retval);
+    }
+
+protected:
+
+    bool list_neighbors_within_radius(
+        const particle_space_type& space, const ParticleID& pid,
+        const Real3& pos, const Real& radius,
+        const particle_space_type::cell_index_type* cell,
+        neighbor_container_type& retval) const;
+
+    void insert(const particle_space_type& space,
+        const ParticleID& pid, const Particle& p);
+
+    /**
+     * invalidate the list and throw, if a particle of the radius may have
+     * neighbors beyond the adjacent cells, which the cell list cannot find.
+     */
+    void check_radius(const particle_space_type& space, const Real radius);
+
+protected:
+
+    Real skin_;
+    bool valid_;
+    std::atomic<Real> max_displacement_;  // since the last rebuild
+    Integer num_rebuilds_;
+
+    entry_container_type entries_;
+    entry_map_type entries_map_;
+};
+
+} // bd
+
+} // ecell4
+
+#endif /* ECELL4_BD_NEIGHBOR_LIST_HPP */
@@ -0,0 +1,281 @@
+#include "ParallelBDPropagator.hpp"
+
+#include <ecell4/core/functions.hpp>
+
+#include "functions3d.hpp"
+
+
+namespace ecell4
+{
+
+namespace bd
+{
+
+void ParallelBDPropagator::operator()()
+{
+    typedef particle_space_type::cell_index_type cell_index_type;
+
+    const particle_space_type& space(world_.particle_space());
+    const Integer3 matrix_sizes(space.matrix_sizes());
+    const std::size_t sizes[3] = {
+        static_cast<std::size_t>(matrix_sizes.col),
+        static_cast<std::size_t>(matrix_sizes.row),
+        static_cast<std::size_t>(matrix_sizes.layer)};
+    const std::size_t num_cells(sizes[0] * sizes[1] * sizes[2]);
+
+    seed_ = PhiloxRandomNumberGenerator::draw_key(rng_);
+
+    // group cells by colours
+    std::vector<std::vector<cell_index_type> > colours(27);
+    for (std::size_t i(0); i < sizes[0]; ++i)
+    {
+        for (std::size_t j(0); j < sizes[1]; ++j)
+        {
+            for (std::size_t k(0); k < sizes[2]; ++k)
+            {
+                const std::size_t c(
+                    colour(i, sizes[0])
+                    + 3 * (colour(j, sizes[1]) + 3 * colour(k, sizes[2])));
+                const cell_index_type idx = {{i, j, k}};
+                colours[c].push_back(idx);
+            }
+        }
+    }
+
+    std::vector<event_container_type> events(num_cells);
+    for (std::vector<std::vector<cell_index_type> >::const_iterator
+        i(colours.begin()); i != colours.end(); ++i)
+    {
+        const std::vector<cell_index_type>& cells(*i);
+        pool_.parallel_for(cells.size(),
+            [&](const std::size_t n)
+            {
+                const cell_index_type& idx(cells[n]);
+                const std::size_t stream(
+                    idx[0] + sizes[0] * (idx[1] + sizes[1] * idx[2]));
+                propagate_cell(idx, static_cast<Integer>(stream), events[stream]);
+            });
+    }
+
+    // fire deferred events in the order of cells
+    BDPropagator propagator(
+        model_, world_, rng_, dt_, last_reactions_, compiled_,
+        BDWorld::particle_container_type());
+    for (std::vector<event_container_type>::const_iterator i(events.begin());
+        i != events.end(); ++i)
+    {
+        for (event_container_type::const_iterator j((*i).begin());
+            j != (*i).end(); ++j)
+        {
+            fire_deferred(propagator, *j);
+        }
+    }
+}
+
+void ParallelBDPropagator::propagate_cell(
+    const particle_space_type::cell_index_type& idx, const Integer stream,
+    event_container_type& events) const
+{
+    const particle_space_type& space(world_.particle_space());
+    const particle_space_type::cell_type& cell(space.cell_at(idx));
+    PhiloxRandomNumberGenerator rng(seed_, stream);
+    std::vector<ReactionRule> buffer;
+
+    // No particle enters nor leaves the cell here, and thus indices are kept.
+    // First, select first-order reactions from the species column, and
+    // gather the positions and D of the rest to move from the columns.
+    const particle_space_type::real_column_type& Ds(space.Ds());
+    const particle_space_type::index_column_type& species_indices(space.species_indices());
+    std::vector<particle_space_type::cell_type::size_type> movers;
+    particle_space_type::real_column_type mover_Ds, coordinates[3];
+    for (particle_space_type::cell_type::size_type n(0); n < cell.size(); ++n)
+    {
+        const std::size_t k(cell[n]);
+        const ReactionRuleRange rules1(query_reaction_rules(
+            space.species_at(species_indices[k]), buffer));
+        if (!rules1.empty())
+        {
+            const ReactionRule* rr(
+                BDPropagator::select_reaction(rules1, dt(), rng.uniform(0, 1)));
+            if (rr != NULL)
+            {
+                const std::pair<ParticleID, Particle>& p(space.particles()[k]);
+                const deferred_event event = {
+                    deferred_event::FIRST_ORDER_REACTION, p.first, p.second,
+                    ParticleID(), Species(), *rr};
+                events.push_back(event);
+                continue;
+            }
+        }
+
+        if (Ds[k] != 0)
+        {
+            movers.push_back(n);
+            mover_Ds.push_back(Ds[k]);
+            for (Real3::size_type dim(0); dim < 3; ++dim)
+            {
+                coordinates[dim].push_back(space.coordinates(dim)[k]);
+            }
+        }
+    }
+
+    // Then, move them all at once.
+    const std::size_t num_movers(movers.size());
+    particle_space_type::real_column_type displacements[3];
+    for (Real3::size_type dim(0); dim < 3; ++dim)
+    {
+        displacements[dim].resize(num_movers);
+    }
+    random_displacements_3d(
+        rng, dt(), num_movers, mover_Ds.data(), displacements[0].data(),
+        displacements[1].data(), displacements[2].data());
+
+    const Real3& edge_lengths(world_.edge_lengths());
+    for (Real3::size_type dim(0); dim < 3; ++dim)
+    {
+        Real* x(coordinates[dim].data());
+        const Real* dx(displacements[dim].data());
+        for (std::size_t i(0); i < num_movers; ++i)
+        {
+            x[i] += dx[i];
+        }
+        fold_periodic(x, num_movers, edge_lengths[dim]);
+    }
+
+    // Finally, check overlaps one by one.
+    NeighborList::neighbor_container_type neighbors;
+    for (std::size_t i(0); i < num_movers; ++i)
+    {
+        const ParticleID pid(space.particles()[cell[movers[i]]].first);
+        const Particle particle(space.particles()[cell[movers[i]]].second);
+        const Real3 newpos(coordinates[0][i], coordinates[1][i], coordinates[2][i]);
+        const Particle particle_to_update(
+            particle.species(), newpos, particle.radius(), particle.D());
+
+        if (space.cell_index(newpos) != idx)
+        {
+            const deferred_event event = {
+                deferred_event::MOVE, pid, particle_to_update,
+                ParticleID(), Species(), ReactionRule()};
+            events.push_back(event);
+            continue;
+        }
+
+        std::size_t num_overlapped;
+        std::pair<ParticleID, Particle> closest;
+        if (world_.list_neighbors_within_radius(
+                pid, newpos, particle.radius(), idx, neighbors))
+        {
+            num_overlapped = neighbors.size();
+            if (num_overlapped == 1)
+            {
+                closest = world_.get_particle(neighbors[0].first);
+            }
+        }
+        else
+        {
+            const std::vector<std::pair<std::pair<ParticleID, Particle>, Real> >
+                overlapped(world_.list_particles_within_radius(
+                               newpos, particle.radius(), pid));
+            num_overlapped = overlapped.size();
+            if (num_overlapped == 1)
+            {
+                closest = overlapped[0].first;
+            }
+        }
+
+        switch (num_overlapped)
+        {
+        case 0:
+            world_.update_particle_without_checking(pid, particle_to_update);
+            break;
+        case 1:
+            {
+                const ReactionRuleRange rules2(query_reaction_rules(
+                    particle.species(), closest.second.species(), buffer));
+                if (rules2.empty())
+                {
+                    break;
+                }
+
+                const ReactionRule* rr(BDPropagator::select_reaction(
+                    rules2, dt(), particle_to_update, closest.second, rng.uniform(0, 1)));
+                if (rr != NULL)
+                {
+                    const deferred_event event = {
+                        deferred_event::SECOND_ORDER_REACTION, pid, particle_to_update,
+                        closest.first, closest.second.species(), *rr};
+                    events.push_back(event);
+                }
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void ParallelBDPropagator::fire_deferred(
+    BDPropagator& propagator, const deferred_event& event)
+{
+    if (!world_.has_particle(event.pid1))
+    {
+        return;  // consumed by another reaction
+    }
+
+    const Particle particle(world_.get_particle(event.pid1).second);
+    if (particle.species() != event.particle1.species())
+    {
+        return;  // changed by another reaction
+    }
+
+    switch (event.kind)
+    {
+    case deferred_event::FIRST_ORDER_REACTION:
+        if (!propagator.fire_reaction(event.pid1, particle, event.rr))
+        {
+            propagator.diffuse(event.pid1, particle);
+        }
+        break;
+    case deferred_event::MOVE:
+        propagator.attempt_move(event.pid1, event.particle1);
+        break;
+    case deferred_event::SECOND_ORDER_REACTION:
+        if (world_.has_particle(event.pid2))
+        {
+            const Particle particle2(world_.get_particle(event.pid2).second);
+            if (particle2.species() == event.species2)
+            {
+                propagator.fire_reaction(
+                    event.pid1, event.particle1, event.pid2, particle2, event.rr);
+            }
+        }
+        break;
+    }
+}
+
+ReactionRuleRange ParallelBDPropagator::query_reaction_rules(
+    const Species& sp, std::vector<ReactionRule>& buffer) const
+{
+    if (compiled_ != NULL)
+    {
+        return compiled_->query_reaction_rules(sp);
+    }
+    buffer = model_.query_reaction_rules(sp);
+    return BDPropagator::as_range(buffer);
+}
+
+ReactionRuleRange ParallelBDPropagator::query_reaction_rules(
+    const Species& sp1, const Species& sp2, std::vector<ReactionRule>& buffer) const
+{
+    if (compiled_ != NULL)
+    {
+        return compiled_->query_reaction_rules(sp1, sp2);
+    }
+    buffer = model_.query_reaction_rules(sp1, sp2);
+    return BDPropagator::as_range(buffer);
+}
+
+} // bd
+
+} // ecell4
@@ -0,0 +1,133 @@
+#ifndef ECELL4_BD_PARALLEL_BD_PROPAGATOR_HPP
+#define ECELL4_BD_PARALLEL_BD_PROPAGATOR_HPP
+
+#include <vector>
+
+#include <ecell4/core/RandomNumberGenerator.hpp>
+#include <ecell4/core/Model.hpp>
+#include <ecell4/core/CompiledNetworkModel.hpp>
+#include <ecell4/core/parallel_for.hpp>
+
+#include "BDWorld.hpp"
+#include "BDPropagator.hpp"
+
+
+namespace ecell4
+{
+
+namespace bd
+{
+
+/**
+ * A propagator moving particles cell by cell on multiple threads.
+ *
+ * Cells of ParticleSpaceCellListImpl are coloured like a checkerboard, so
+ * that no two cells in the same colour are adjacent even across the periodic
+ * boundary (2 colours along an axis with an even number of cells, and 3 with
+ * an odd number). Cells in a colour are processed concurrently, and colours
+ * one after another. A thread only moves particles within its own cell and
+ * reads particles in the neighbouring cells, which are never written in the
+ * same colour.
+ *
+ * Everything which may change the other cells is deferred to a serial pass
+ * after all the colours, i.e. a reaction, or a move into another cell.
+ * Reactions are selected in the parallel phase, and fired in the serial
+ * pass if reactants still exist. Within a cell, species, D and positions
+ * are read from the columns of the space, and particles not reacting are
+ * displaced all at once with random_displacements_3d before overlaps are
+ * checked one by one. Each cell draws random numbers from its
+ * own stream of PhiloxRandomNumberGenerator keyed with 64 bits drawn from
+ * the world RNG once per step. Thus, the trajectory does not depend on the number of threads.
+ * The threads are taken from a ThreadPool owned by the simulator, which
+ * serves all the colours of all the steps.
+ */
+class ParallelBDPropagator
+{
+public:
+
+    typedef BDPropagator::reaction_info_type reaction_info_type;
+    typedef BDWorld::particle_space_type particle_space_type;
+
+protected:
+
+    struct deferred_event
+    {
+        enum kind_type
+        {
+            FIRST_ORDER_REACTION,
+            SECOND_ORDER_REACTION,
+            MOVE
+        };
+
+        kind_type kind;
+        ParticleID pid1;
+        Particle particle1;  // the particle after the move if any
+        ParticleID pid2;
+        Species species2;
+        ReactionRule rr;
+    };
+
+    typedef std::vector<deferred_event> event_container_type;
+
+public:
+
+    ParallelBDPropagator(
+        Model& model, BDWorld& world, RandomNumberGenerator& rng, const Real& dt,
+        std::vector<std::pair<ReactionRule, reaction_info_type> >& last_reactions,
+        ThreadPool& pool, const CompiledNetworkModel* compiled = NULL)
+        : model_(model), world_(world), rng_(rng), dt_(dt),
+        last_reactions_(last_reactions), pool_(pool), compiled_(compiled), seed_(0)
+    {
+        ;
+    }
+
+    /**
+     * propagate all the particles by one step.
+     */
+    void operator()();
+
+    inline Real dt() const
+    {
+        return dt_;
+    }
+
+protected:
+
+    void propagate_cell(
+        const particle_space_type::cell_index_type& idx, const Integer stream,
+        event_container_type& events) const;
+    void fire_deferred(BDPropagator& propagator, const deferred_event& event);
+
+    ReactionRuleRange query_reaction_rules(
+        const Species& sp, std::vector<ReactionRule>& buffer) const;
+    ReactionRuleRange query_reaction_rules(
+        const Species& sp1, const Species& sp2, std::vector<ReactionRule>& buffer) const;
+
+    static std::size_t num_colours(const std::size_t size)
+    {
+        return (size <= 1 ? 1 : (size % 2 == 0 ? 2 : 3));
+    }
+
+    static std::size_t colour(const std::size_t i, const std::size_t size)
+    {
+        return (size > 1 && size % 2 != 0 && i + 1 == size ? 2 : i % 2);
+    }
+
+protected:
+
+    Model& model_;
+    BDWorld& world_;
+    RandomNumberGenerator& rng_;
+    Real dt_;
+    std::vector<std::pair<ReactionRule, reaction_info_type> >& last_reactions_;
+    ThreadPool& pool_;
+    const CompiledNetworkModel* compiled_;
+
+    Integer seed_;
+};
+
+} // bd
+
+} // ecell4
+
+#endif /* ECELL4_BD_PARALLEL_BD_PROPAGATOR_HPP */
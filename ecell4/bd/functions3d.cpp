@@ -29,8 +29,27 @@ Real3 random_displacement_3d(
     RandomNumberGenerator& rng, const Real& t, const Real& D)
 {
     const Real sigma(std::sqrt(2 * D * t));
-    return Real3(
-        rng.gaussian(sigma), rng.gaussian(sigma), rng.gaussian(sigma));
+    Real displacement[3];
+    rng.fill_gaussian(displacement, 3, sigma);
+    return Real3(displacement[0], displacement[1], displacement[2]);
+}
+
+void random_displacements_3d(
+    RandomNumberGenerator& rng, const Real& t, const std::size_t n,
+    const Real* D, Real* dx, Real* dy, Real* dz)
+{
+    rng.fill_gaussian(dx, n);
+    rng.fill_gaussian(dy, n);
+    rng.fill_gaussian(dz, n);
+
+    const Real t2(2 * t);
+    for (std::size_t i(0); i < n; ++i)
+    {
+        const Real sigma(std::sqrt(t2 * D[i]));
+        dx[i] *= sigma;
+        dy[i] *= sigma;
+        dz[i] *= sigma;
+    }
 }
 
 Real Igbd_3d(const Real& sigma, const Real& t, const Real& D)
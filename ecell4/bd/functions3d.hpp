@@ -39,6 +39,17 @@ Real3 random_spherical_uniform(RandomNumberGenerator& rng, const Real& r);
 Real3 random_displacement_3d(
     RandomNumberGenerator& rng, const Real& t, const Real& D);
 
+/**
+ * draw displacements of n particles at once into dx, dy and dz.
+ * Gaussian variates are drawn in bulk, and scaled in a loop without
+ * branches, which compilers can vectorize.
+ * @param t a step interval, $\Delta t$.
+ * @param D an array of diffusion coefficients of particles.
+ */
+void random_displacements_3d(
+    RandomNumberGenerator& rng, const Real& t, const std::size_t n,
+    const Real* D, Real* dx, Real* dy, Real* dz);
+
 Real3 random_ipv_3d(
     RandomNumberGenerator& rng, const Real& sigma, const Real& t, const Real& D);
 
@@ -7,6 +7,8 @@
 #   include <boost/test/included/unit_test.hpp>
 #endif
 
+#include <algorithm>
+
 #include <ecell4/core/NetworkModel.hpp>
 #include "../BDSimulator.hpp"
 
@@ -59,3 +61,150 @@ BOOST_AUTO_TEST_CASE(BDSimulator_test_step2)
     BDSimulator target(world, model);
     target.step();
 }
+
+BOOST_AUTO_TEST_CASE(BDSimulator_test_model_changed)
+{
+    const Real L(1e-6);
+    const Real3 edge_lengths(L, L, L);
+    const Integer3 matrix_sizes(3, 3, 3);
+    boost::shared_ptr<RandomNumberGenerator> rng(new GSLRandomNumberGenerator(0));
+
+    boost::shared_ptr<NetworkModel> model(new NetworkModel());
+    Species sp1("A", 2.5e-9, 1e-12), sp2("B", 2.5e-9, 1e-12);
+    model->add_species_attribute(sp1);
+    model->add_species_attribute(sp2);
+
+    boost::shared_ptr<BDWorld> world(new BDWorld(edge_lengths, matrix_sizes, rng));
+    world->add_molecules(sp1, 10);
+
+    BDSimulator target(world, model);
+    target.step();
+    BOOST_CHECK_EQUAL(world->num_molecules_exact(sp1), 10);
+
+    // a rule added after initialize() is compiled at the next step
+    model->add_reaction_rule(create_unimolecular_reaction_rule(sp1, sp2, 1e+12));
+    target.step();
+    BOOST_CHECK_EQUAL(world->num_molecules_exact(sp1), 0);
+    BOOST_CHECK_EQUAL(world->num_molecules_exact(sp2), 10);
+}
+
+bool less_pid(
+    const std::pair<ParticleID, Particle>& lhs, const std::pair<ParticleID, Particle>& rhs)
+{
+    return lhs.first < rhs.first;
+}
+
+std::vector<std::pair<ParticleID, Particle> > run_parallel(const std::size_t num_threads)
+{
+    const Real L(1e-6);
+    const Real3 edge_lengths(L, L, L);
+    const Integer3 matrix_sizes(4, 4, 4);
+    boost::shared_ptr<RandomNumberGenerator> rng(new GSLRandomNumberGenerator(0));
+
+    boost::shared_ptr<NetworkModel> model(new NetworkModel());
+    Species sp1("A", 2.5e-9, 1e-12), sp2("B", 2.5e-9, 1e-12), sp3("C", 2.5e-9, 1e-12);
+    model->add_species_attribute(sp1);
+    model->add_species_attribute(sp2);
+    model->add_species_attribute(sp3);
+    model->add_reaction_rule(create_binding_reaction_rule(sp1, sp2, sp3, 1e-18));
+    model->add_reaction_rule(create_unbinding_reaction_rule(sp3, sp1, sp2, 1e+3));
+
+    boost::shared_ptr<BDWorld> world(new BDWorld(edge_lengths, matrix_sizes, rng));
+    world->add_molecules(sp1, 100);
+    world->add_molecules(sp2, 100);
+
+    BDSimulator target(world, model);
+    target.set_parallel(true, num_threads);
+    BOOST_CHECK(target.is_parallel());
+    for (unsigned int i(0); i < 10; ++i)
+    {
+        target.step();
+    }
+
+    std::vector<std::pair<ParticleID, Particle> > particles(world->list_particles());
+    std::sort(particles.begin(), particles.end(), less_pid);
+    return particles;
+}
+
+BOOST_AUTO_TEST_CASE(BDSimulator_test_parallel)
+{
+    const std::vector<std::pair<ParticleID, Particle> > expected(run_parallel(1));
+    const std::vector<std::pair<ParticleID, Particle> > particles(run_parallel(4));
+
+    BOOST_CHECK_EQUAL(particles.size(), expected.size());
+    for (std::size_t i(0); i < std::min(particles.size(), expected.size()); ++i)
+    {
+        BOOST_CHECK_EQUAL(particles[i].first, expected[i].first);
+        BOOST_CHECK_EQUAL(particles[i].second.species().serial(), expected[i].second.species().serial());
+        BOOST_CHECK_EQUAL(particles[i].second.position(), expected[i].second.position());
+    }
+}
+
+std::vector<std::pair<ParticleID, Particle> > run_serial(const Real skin)
+{
+    const Real L(1e-6);
+    const Real3 edge_lengths(L, L, L);
+    const Integer3 matrix_sizes(4, 4, 4);
+    boost::shared_ptr<RandomNumberGenerator> rng(new GSLRandomNumberGenerator(0));
+
+    boost::shared_ptr<NetworkModel> model(new NetworkModel());
+    Species sp1("A", 2.5e-9, 1e-12), sp2("B", 2.5e-9, 1e-12), sp3("C", 5e-9, 1e-12);
+    model->add_species_attribute(sp1);
+    model->add_species_attribute(sp2);
+    model->add_species_attribute(sp3);
+    model->add_reaction_rule(create_binding_reaction_rule(sp1, sp2, sp3, 1e-18));
+    model->add_reaction_rule(create_unbinding_reaction_rule(sp3, sp1, sp2, 1e+3));
+
+    boost::shared_ptr<BDWorld> world(new BDWorld(edge_lengths, matrix_sizes, rng));
+    world->set_neighbor_list_skin(skin);
+    BOOST_CHECK_EQUAL(world->neighbor_list_skin(), skin);
+    world->add_molecules(sp1, 300);
+    world->add_molecules(sp2, 300);
+
+    BDSimulator target(world, model);
+    for (unsigned int i(0); i < 30; ++i)
+    {
+        target.step();
+    }
+
+    std::vector<std::pair<ParticleID, Particle> > particles(world->list_particles());
+    std::sort(particles.begin(), particles.end(), less_pid);
+    return particles;
+}
+
+BOOST_AUTO_TEST_CASE(BDSimulator_test_neighbor_list)
+{
+    const std::vector<std::pair<ParticleID, Particle> > expected(run_serial(0));
+    const std::vector<std::pair<ParticleID, Particle> > particles(run_serial(2e-8));
+
+    BOOST_CHECK_EQUAL(particles.size(), expected.size());
+    for (std::size_t i(0); i < std::min(particles.size(), expected.size()); ++i)
+    {
+        BOOST_CHECK_EQUAL(particles[i].first, expected[i].first);
+        BOOST_CHECK_EQUAL(particles[i].second.species().serial(), expected[i].second.species().serial());
+        BOOST_CHECK_EQUAL(particles[i].second.position(), expected[i].second.position());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(BDSimulator_test_neighbor_list_skin)
+{
+    const Real L(1e-6);
+    const Real3 edge_lengths(L, L, L);
+    const Integer3 matrix_sizes(4, 4, 4);  // the cell size is 2.5e-7
+    boost::shared_ptr<RandomNumberGenerator> rng(new GSLRandomNumberGenerator(0));
+    const Species sp1("A", 2.5e-9, 1e-12), sp2("B", 1e-8, 1e-12);
+
+    BDWorld world(edge_lengths, matrix_sizes, rng);
+    world.new_particle(Particle(sp1, Real3(0.5, 0.5, 0.5) * L, 2.5e-9, 1e-12));
+    BOOST_CHECK_THROW(world.set_neighbor_list_skin(9.9e-8), IllegalArgument);
+    world.set_neighbor_list_skin(9.7e-8);
+    world.update_neighbor_list();
+
+    // a larger particle is rejected when it enters the list
+    BOOST_CHECK_THROW(
+        world.new_particle(Particle(sp2, Real3(0.1, 0.1, 0.1) * L, 1e-8, 1e-12)),
+        IllegalArgument);
+    BOOST_CHECK_THROW(world.update_neighbor_list(), IllegalArgument);
+    world.set_neighbor_list_skin(0);
+    world.update_neighbor_list();
+}
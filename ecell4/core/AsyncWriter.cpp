@@ -0,0 +1,99 @@
+#include "AsyncWriter.hpp"
+#include "exceptions.hpp"
+
+
+namespace ecell4
+{
+
+AsyncWriter::AsyncWriter(const std::size_t capacity)
+    : capacity_(capacity), num_pending_(0), stopped_(false)
+{
+    if (capacity_ == 0)
+    {
+        throw IllegalArgument("A capacity must be positive.");
+    }
+
+    thread_ = std::thread(&AsyncWriter::run, this);
+}
+
+AsyncWriter::~AsyncWriter()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        popped_.wait(lock, [this]() { return num_pending_ == 0; });
+        stopped_ = true;
+    }
+    pushed_.notify_all();
+    thread_.join();
+}
+
+void AsyncWriter::push(const task_type& task)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        popped_.wait(lock, [this]() { return num_pending_ < capacity_ || error_; });
+        rethrow_if_failed();
+
+        tasks_.push_back(task);
+        ++num_pending_;
+    }
+    pushed_.notify_one();
+}
+
+void AsyncWriter::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    popped_.wait(lock, [this]() { return num_pending_ == 0; });
+    rethrow_if_failed();
+}
+
+void AsyncWriter::rethrow_if_failed()
+{
+    if (error_)
+    {
+        std::exception_ptr error(error_);
+        error_ = std::exception_ptr();
+        std::rethrow_exception(error);
+    }
+}
+
+void AsyncWriter::run()
+{
+    for (;;)
+    {
+        task_type task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            pushed_.wait(lock, [this]() { return stopped_ || !tasks_.empty(); });
+            if (tasks_.empty())
+            {
+                return;  // stopped
+            }
+            task = tasks_.front();
+            tasks_.pop_front();
+        }
+
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_)
+            {
+                error_ = std::current_exception();
+            }
+            num_pending_ -= tasks_.size();  // discard the rest
+            tasks_.clear();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --num_pending_;
+        }
+        popped_.notify_all();
+    }
+}
+
+} // ecell4
@@ -0,0 +1,73 @@
+#ifndef ECELL4_ASYNC_WRITER_HPP
+#define ECELL4_ASYNC_WRITER_HPP
+
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+
+namespace ecell4
+{
+
+/**
+ * A dedicated thread running tasks, e.g. writing snapshots of a world to
+ * files, in the order pushed, so that a simulation and disk I/O overlap.
+ *
+ * At most capacity tasks are pending including the running one, and push
+ * blocks until one of them is done (back-pressure). Thus, with capacity 2
+ * (a double buffer), no more than 3 snapshots are held at once including the
+ * one being pushed. The first exception thrown by a task is rethrown by the
+ * next push or wait, and the tasks left are discarded.
+ */
+class AsyncWriter
+{
+public:
+
+    typedef std::function<void()> task_type;
+
+public:
+
+    AsyncWriter(const std::size_t capacity = 2);
+
+    /**
+     * wait until all the tasks are done, but never throw.
+     */
+    ~AsyncWriter();
+
+    void push(const task_type& task);
+
+    /**
+     * block until all the tasks are done.
+     */
+    void wait();
+
+    std::size_t capacity() const
+    {
+        return capacity_;
+    }
+
+protected:
+
+    void run();
+    void rethrow_if_failed();  // call with mutex_ locked
+
+protected:
+
+    const std::size_t capacity_;
+
+    std::mutex mutex_;
+    std::condition_variable pushed_, popped_;
+    std::deque<task_type> tasks_;
+    std::size_t num_pending_;  // including the running task
+    bool stopped_;
+    std::exception_ptr error_;
+
+    std::thread thread_;
+};
+
+} // ecell4
+
+#endif /* ECELL4_ASYNC_WRITER_HPP */
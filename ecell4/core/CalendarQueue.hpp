@@ -0,0 +1,484 @@
+#ifndef ECELL4_CALENDAR_QUEUE_HPP
+#define ECELL4_CALENDAR_QUEUE_HPP
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <limits>
+#include <cmath>
+#include <stdexcept>
+
+#include "types.hpp"
+#include "DynamicPriorityQueue.hpp"
+
+
+namespace ecell4
+{
+
+/**
+   Calendar queue (R. Brown, 1988) for items of type Titem_ prioritized by
+   a Real key, Tkey_()(item), with the interface of DynamicPriorityQueue.
+
+   Items are hashed into buckets of the width, one "day", by their keys,
+   and the buckets are cycled as a "year". The next item is found by
+   scanning the buckets from the one holding the last top, so push, pop
+   and replace take O(1) time on average instead of O(log N) of a heap.
+   The number of buckets follows the number of items, and the width is
+   estimated from the gaps between the earliest keys when resized. Items
+   with an infinite key are kept apart and come after all the others.
+   Items with the same key come out in the order pushed.
+*/
+
+template<typename Titem_, typename Tkey_, class Tpolicy_ = persistent_id_policy<> >
+class CalendarQueue: private Tpolicy_
+{
+public:
+    typedef Tpolicy_ policy_type;
+    typedef typename policy_type::identifier_type identifier_type;
+    typedef typename policy_type::index_type index_type;
+    typedef Titem_ element_type;
+    typedef std::pair<identifier_type, element_type> value_type;
+    typedef Tkey_ key_function_type;
+
+protected:
+    typedef std::vector<value_type> value_vector;
+    typedef std::vector<index_type> bucket_type;
+
+    struct location_type
+    {
+        index_type bucket, pos;
+    };
+
+public:
+    typedef typename value_vector::size_type size_type;
+    typedef typename value_vector::const_iterator iterator;
+    typedef typename value_vector::const_iterator const_iterator;
+
+public:
+
+    CalendarQueue()
+        : buckets_(MIN_BUCKETS + 1), width_(1.0), lower_bound_(0.0),
+          top_valid_(false), stale_width_(false)
+    {
+        ;
+    }
+
+    bool empty() const
+    {
+        return items_.empty();
+    }
+
+    size_type size() const
+    {
+        return items_.size();
+    }
+
+    void clear()
+    {
+        items_.clear();
+        keys_.clear();
+        locations_.clear();
+        buckets_.clear();
+        buckets_.resize(MIN_BUCKETS + 1);
+        width_ = 1.0;
+        lower_bound_ = 0.0;
+        top_valid_ = false;
+        stale_width_ = false;
+        policy_type::clear();
+    }
+
+    value_type const& top() const
+    {
+        return items_[top_index()];
+    }
+
+    value_type const& second() const
+    {
+        return items_[second_index()];
+    }
+
+    element_type const& get(identifier_type id) const
+    {
+        return items_[policy_type::index(id)].second;
+    }
+
+    void pop()
+    {
+        pop_by_index(top_index());
+    }
+
+    void pop(identifier_type id)
+    {
+        pop_by_index(policy_type::index(id));
+    }
+
+    void replace(value_type const& value)
+    {
+        const index_type index(policy_type::index(value.first));
+        items_[index].second = value.second;
+        unlink(index);
+        keys_[index] = key_(value.second);
+        link(index);
+
+        if (top_valid_ && top_ == index)
+        {
+            top_valid_ = false;
+        }
+        else
+        {
+            update_top(index);
+        }
+    }
+
+    identifier_type push(element_type const& item)
+    {
+        const index_type index(items_.size());
+        const identifier_type id(policy_type::push(index));
+        items_.push_back(value_type(id, item));
+        keys_.push_back(key_(item));
+        locations_.push_back(location_type());
+        link(index);
+        update_top(index);
+
+        if (items_.size() > 2 * num_buckets())
+        {
+            resize(2 * num_buckets());
+        }
+        else if (stale_width_)
+        {
+            resize(num_buckets());
+        }
+        return id;
+    }
+
+    element_type const& operator[](identifier_type id) const
+    {
+        return get(id);
+    }
+
+    const_iterator begin() const
+    {
+        return items_.begin();
+    }
+
+    const_iterator end() const
+    {
+        return items_.end();
+    }
+
+    Real width() const
+    {
+        return width_;
+    }
+
+    size_type num_buckets() const
+    {
+        return buckets_.size() - 1;
+    }
+
+    // self-diagnostic methods
+    bool check() const
+    {
+        bool result(items_.size() == keys_.size() && items_.size() == locations_.size());
+        size_type num_items(0);
+        for (index_type b(0); b < buckets_.size(); ++b)
+        {
+            num_items += buckets_[b].size();
+            for (index_type pos(0); pos < buckets_[b].size(); ++pos)
+            {
+                const index_type index(buckets_[b][pos]);
+                result = result && index < size();
+                result = result && locations_[index].bucket == b;
+                result = result && locations_[index].pos == pos;
+                result = result && bucket_of(keys_[index]) == b;
+            }
+        }
+        result = result && num_items == size();
+
+        if (!empty())
+        {
+            const index_type index(top_index());
+            for (index_type i(0); i < size(); ++i)
+            {
+                result = result && !less(i, index);
+                result = result && !(keys_[i] < lower_bound_);
+            }
+        }
+        return result;
+    }
+
+protected:
+
+    static const size_type MIN_BUCKETS = 16;
+
+    bool less(const index_type lhs, const index_type rhs) const
+    {
+        return (keys_[lhs] < keys_[rhs]
+                || (keys_[lhs] == keys_[rhs] && items_[lhs].first < items_[rhs].first));
+    }
+
+    /**
+     * the bucket of a key, or num_buckets() for infinite keys and those
+     * too far to be hashed.
+     */
+    index_type bucket_of(const Real key) const
+    {
+        const Real day(std::floor(key / width_));
+        if (!(std::abs(day) < 1e+18))
+        {
+            return num_buckets();
+        }
+
+        const long long n(static_cast<long long>(num_buckets()));
+        return static_cast<index_type>(((static_cast<long long>(day) % n) + n) % n);
+    }
+
+    void link(const index_type index)
+    {
+        const index_type b(bucket_of(keys_[index]));
+        locations_[index].bucket = b;
+        locations_[index].pos = buckets_[b].size();
+        buckets_[b].push_back(index);
+
+        if (keys_[index] < lower_bound_)
+        {
+            lower_bound_ = keys_[index];
+        }
+    }
+
+    void unlink(const index_type index)
+    {
+        const location_type& loc(locations_[index]);
+        bucket_type& bucket(buckets_[loc.bucket]);
+        const index_type moved(bucket.back());
+        bucket[loc.pos] = moved;
+        locations_[moved].pos = loc.pos;
+        bucket.pop_back();
+    }
+
+    void update_top(const index_type index)
+    {
+        if (top_valid_ && less(index, top_))
+        {
+            top_ = index;
+        }
+    }
+
+    index_type top_index() const
+    {
+        if (!top_valid_)
+        {
+            find_top();
+        }
+        return top_;
+    }
+
+    void find_top() const
+    {
+        if (empty())
+        {
+            throw std::out_of_range("CalendarQueue::top_index(): empty.");
+        }
+
+        // look for the earliest item in this year bucket by bucket
+        const size_type n(num_buckets());
+        const Real first_day(std::floor(lower_bound_ / width_));
+        if (std::abs(first_day) < 1e+18)
+        {
+            index_type b(bucket_of(lower_bound_));
+            Real day(first_day);
+            for (size_type i(0); i < n; ++i)
+            {
+                bool found(false);
+                const bucket_type& bucket(buckets_[b]);
+                for (typename bucket_type::const_iterator j(bucket.begin());
+                     j != bucket.end(); ++j)
+                {
+                    // compare days as bucket_of does, not to miss one by rounding
+                    if (std::floor(keys_[*j] / width_) <= day && (!found || less(*j, top_)))
+                    {
+                        top_ = *j;
+                        found = true;
+                    }
+                }
+
+                if (found)
+                {
+                    top_valid_ = true;
+                    lower_bound_ = keys_[top_];
+                    return;
+                }
+
+                b = (b + 1 == n ? 0 : b + 1);
+                day += 1.0;
+            }
+        }
+
+        // sparse in this year, or all far; search directly, and estimate
+        // the width again at the next push or pop
+        top_ = 0;
+        for (index_type i(1); i < size(); ++i)
+        {
+            if (less(i, top_))
+            {
+                top_ = i;
+            }
+        }
+        top_valid_ = true;
+        lower_bound_ = keys_[top_];
+        stale_width_ = (size() > MIN_BUCKETS);
+    }
+
+    /**
+     * the earliest item but the top. The buckets are scanned from that of
+     * the top as find_top does, which takes O(1) time on average, but all
+     * the items are compared when none is found within a year, e.g. when
+     * the rest are infinite, in O(N) time. The result is not cached.
+     */
+    index_type second_index() const
+    {
+        if (size() <= 1)
+        {
+            throw std::out_of_range("CalendarQueue::second_index():"
+                                     " item count less than 2.");
+        }
+
+        const index_type first(top_index());
+        const Real first_day(std::floor(keys_[first] / width_));
+        if (std::abs(first_day) < 1e+18)
+        {
+            const size_type n(num_buckets());
+            index_type b(bucket_of(keys_[first]));
+            Real day(first_day);
+            for (size_type i(0); i < n; ++i)
+            {
+                bool found(false);
+                index_type retval(first);
+                const bucket_type& bucket(buckets_[b]);
+                for (typename bucket_type::const_iterator j(bucket.begin());
+                     j != bucket.end(); ++j)
+                {
+                    if (*j != first && std::floor(keys_[*j] / width_) <= day
+                        && (!found || less(*j, retval)))
+                    {
+                        retval = *j;
+                        found = true;
+                    }
+                }
+
+                if (found)
+                {
+                    return retval;
+                }
+
+                b = (b + 1 == n ? 0 : b + 1);
+                day += 1.0;
+            }
+        }
+
+        index_type retval(first == 0 ? 1 : 0);
+        for (index_type i(0); i < size(); ++i)
+        {
+            if (i != first && less(i, retval))
+            {
+                retval = i;
+            }
+        }
+        return retval;
+    }
+
+    void pop_by_index(const index_type index)
+    {
+        if (top_valid_ && top_ == index)
+        {
+            top_valid_ = false;
+        }
+
+        unlink(index);
+
+        // move the last item to the index
+        const index_type last(items_.size() - 1);
+        policy_type::pop(index, items_[index].first, items_[last].first);
+        if (index != last)
+        {
+            blit_swap(items_[index], items_[last]);
+            keys_[index] = keys_[last];
+            locations_[index] = locations_[last];
+            buckets_[locations_[index].bucket][locations_[index].pos] = index;
+            if (top_valid_ && top_ == last)
+            {
+                top_ = index;
+            }
+        }
+        items_.pop_back();
+        keys_.pop_back();
+        locations_.pop_back();
+
+        if (num_buckets() > MIN_BUCKETS && 2 * items_.size() < num_buckets())
+        {
+            resize(num_buckets() / 2);
+        }
+        else if (stale_width_)
+        {
+            resize(num_buckets());
+        }
+    }
+
+    /**
+     * rehash all the items into num_buckets buckets with the width of
+     * three times the mean gap between the earliest keys.
+     */
+    void resize(const size_type num_buckets)
+    {
+        const size_type num_samples(std::min<size_type>(size(), 25));
+        std::vector<Real> samples;
+        samples.reserve(size());
+        for (index_type i(0); i < size(); ++i)
+        {
+            if (std::abs(keys_[i]) < std::numeric_limits<Real>::infinity())
+            {
+                samples.push_back(keys_[i]);
+            }
+        }
+
+        if (samples.size() >= 2)
+        {
+            const size_type m(std::min(num_samples, samples.size()));
+            std::partial_sort(samples.begin(), samples.begin() + m, samples.end());
+            const Real gap((samples[m - 1] - samples[0]) / (m - 1));
+            if (gap > 0.0)
+            {
+                width_ = 3.0 * gap;
+            }
+        }
+
+        buckets_.clear();
+        buckets_.resize(num_buckets + 1);
+        for (index_type i(0); i < size(); ++i)
+        {
+            link(i);
+        }
+        stale_width_ = false;
+    }
+
+private:
+    value_vector items_;
+    std::vector<Real> keys_;
+    std::vector<location_type> locations_;
+    std::vector<bucket_type> buckets_;  // the last one for far items
+    Real width_;
+    key_function_type key_;
+
+    mutable Real lower_bound_;  // no key is less than this
+    mutable index_type top_;
+    mutable bool top_valid_;
+    mutable bool stale_width_;
+};
+
+template<typename Titem_, typename Tkey_, class Tpolicy_>
+const typename CalendarQueue<Titem_, Tkey_, Tpolicy_>::size_type
+CalendarQueue<Titem_, Tkey_, Tpolicy_>::MIN_BUCKETS;
+
+} // ecell4
+
+#endif /* ECELL4_CALENDAR_QUEUE_HPP */
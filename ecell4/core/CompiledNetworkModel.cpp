@@ -0,0 +1,64 @@
+#include "CompiledNetworkModel.hpp"
+
+
+namespace ecell4
+{
+
+void CompiledNetworkModel::compile(const Model& model)
+{
+    if (!model.is_static())
+    {
+        throw NotSupported("Only a static model can be compiled.");
+    }
+
+    first_order_indices_.clear();
+    first_order_offsets_.assign(1, 0);
+    first_order_reaction_rules_.clear();
+    second_order_offsets_.clear();
+    second_order_reaction_rules_.clear();
+
+    std::vector<std::pair<Species, Species> > pairs;
+    const Model::reaction_rule_container_type& rules(model.reaction_rules());
+    for (Model::reaction_rule_container_type::const_iterator i(rules.begin());
+        i != rules.end(); ++i)
+    {
+        const ReactionRule::reactant_container_type& rs((*i).reactants());
+        if (rs.size() == 1)
+        {
+            if (!first_order_indices_.insert(
+                    std::make_pair(rs[0].intern(), first_order_offsets_.size() - 1)).second)
+            {
+                continue;
+            }
+
+            const std::vector<ReactionRule> retval(model.query_reaction_rules(rs[0]));
+            first_order_reaction_rules_.insert(
+                first_order_reaction_rules_.end(), retval.begin(), retval.end());
+            first_order_offsets_.push_back(first_order_reaction_rules_.size());
+        }
+        else if (rs.size() == 2)
+        {
+            pairs.push_back(std::make_pair(rs[0], rs[1]));
+        }
+    }
+
+    for (std::vector<std::pair<Species, Species> >::const_iterator i(pairs.begin());
+        i != pairs.end(); ++i)
+    {
+        const second_order_key_type key(intern_second_order_key((*i).first, (*i).second));
+        if (second_order_offsets_.find(key) != second_order_offsets_.end())
+        {
+            continue;
+        }
+
+        const std::vector<ReactionRule>
+            retval(model.query_reaction_rules((*i).first, (*i).second));
+        const std::size_t first(second_order_reaction_rules_.size());
+        second_order_reaction_rules_.insert(
+            second_order_reaction_rules_.end(), retval.begin(), retval.end());
+        second_order_offsets_.insert(
+            std::make_pair(key, std::make_pair(first, second_order_reaction_rules_.size())));
+    }
+}
+
+} // ecell4
@@ -0,0 +1,178 @@
+#ifndef ECELL4_COMPILED_NETWORK_MODEL_HPP
+#define ECELL4_COMPILED_NETWORK_MODEL_HPP
+
+#include <vector>
+#include <utility>
+
+#include "types.hpp"
+#include "get_mapper_mf.hpp"
+#include "Species.hpp"
+#include "SpeciesIDMap.hpp"
+#include "ReactionRule.hpp"
+#include "Model.hpp"
+
+
+namespace ecell4
+{
+
+/**
+ * A read-only view of a contiguous range of ReactionRules.
+ * It is valid as long as CompiledNetworkModel, which owns rules, is alive.
+ */
+class ReactionRuleRange
+{
+public:
+
+    typedef const ReactionRule* const_iterator;
+    typedef std::size_t size_type;
+
+public:
+
+    ReactionRuleRange()
+        : first_(NULL), last_(NULL)
+    {
+        ;
+    }
+
+    ReactionRuleRange(const ReactionRule* first, const ReactionRule* last)
+        : first_(first), last_(last)
+    {
+        ;
+    }
+
+    const_iterator begin() const
+    {
+        return first_;
+    }
+
+    const_iterator end() const
+    {
+        return last_;
+    }
+
+    size_type size() const
+    {
+        return static_cast<size_type>(last_ - first_);
+    }
+
+    bool empty() const
+    {
+        return (first_ == last_);
+    }
+
+    const ReactionRule& operator[](const size_type i) const
+    {
+        return first_[i];
+    }
+
+protected:
+
+    const ReactionRule* first_;
+    const ReactionRule* last_;
+};
+
+/**
+ * A frozen snapshot of reaction rules in a static model.
+ * Rules are queried in the same way as Model::query_reaction_rules at
+ * construction, and laid out contiguously for each reactant and each pair
+ * of reactants. Interned ids of reactants are mapped to dense indices local
+ * to the snapshot. Thus, a query returns a range into the table without any
+ * allocation or copy, and the table is as large as the model.
+ *
+ * The view does not follow any later change of the model. Compile the model
+ * again in initialize() of simulators.
+ */
+class CompiledNetworkModel
+{
+public:
+
+    typedef ReactionRuleRange range_type;
+
+protected:
+
+    typedef std::vector<ReactionRule> reaction_rule_container_type;
+    typedef utils::get_mapper_mf<Species::id_type, std::size_t>::type
+        first_order_index_map_type;
+    typedef std::pair<std::size_t, std::size_t> offset_pair_type;
+    typedef utils::get_mapper_mf<second_order_key_type, offset_pair_type>::type
+        second_order_offset_map_type;
+
+public:
+
+    CompiledNetworkModel()
+        : first_order_indices_(), first_order_offsets_(1, 0), first_order_reaction_rules_(),
+        second_order_offsets_(), second_order_reaction_rules_()
+    {
+        ;
+    }
+
+    /**
+     * compile the given model. The model must be static.
+     */
+    CompiledNetworkModel(const Model& model)
+        : first_order_indices_(), first_order_offsets_(1, 0), first_order_reaction_rules_(),
+        second_order_offsets_(), second_order_reaction_rules_()
+    {
+        compile(model);
+    }
+
+    void compile(const Model& model);
+
+    range_type query_reaction_rules(const Species& sp) const
+    {
+        first_order_index_map_type::const_iterator
+            i(first_order_indices_.find(sp.id()));
+        if (i == first_order_indices_.end())
+        {
+            return range_type();
+        }
+        return range(first_order_reaction_rules_,
+            first_order_offsets_[(*i).second], first_order_offsets_[(*i).second + 1]);
+    }
+
+    range_type query_reaction_rules(const Species& sp1, const Species& sp2) const
+    {
+        second_order_offset_map_type::const_iterator
+            i(second_order_offsets_.find(second_order_key(sp1, sp2)));
+        if (i == second_order_offsets_.end())
+        {
+            return range_type();
+        }
+        return range(second_order_reaction_rules_, (*i).second.first, (*i).second.second);
+    }
+
+    std::size_t num_first_order_reaction_rules() const
+    {
+        return first_order_reaction_rules_.size();
+    }
+
+    std::size_t num_second_order_reaction_rules() const
+    {
+        return second_order_reaction_rules_.size();
+    }
+
+protected:
+
+    static range_type range(
+        const reaction_rule_container_type& rules,
+        const std::size_t first, const std::size_t last)
+    {
+        if (first == last)
+        {
+            return range_type();
+        }
+        return range_type(&rules[first], &rules[0] + last);
+    }
+
+protected:
+
+    first_order_index_map_type first_order_indices_;  // from an id to a local index
+    std::vector<std::size_t> first_order_offsets_;  // in CSR, by local indices
+    reaction_rule_container_type first_order_reaction_rules_;
+    second_order_offset_map_type second_order_offsets_;  // [first, last) for a pair
+    reaction_rule_container_type second_order_reaction_rules_;
+};
+
+} // ecell4
+
+#endif /* ECELL4_COMPILED_NETWORK_MODEL_HPP */
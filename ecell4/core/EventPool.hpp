@@ -0,0 +1,200 @@
+#ifndef ECELL4_EVENT_POOL_HPP
+#define ECELL4_EVENT_POOL_HPP
+
+#include <vector>
+#include <new>
+#include <utility>
+#include <boost/intrusive_ptr.hpp>
+
+#include "types.hpp"
+
+
+namespace ecell4
+{
+
+/**
+   Free lists of fixed-size blocks carved out of larger chunks. A block
+   released is kept for the next allocation of the same size class, so
+   events created and dropped at every step cost no call to malloc and
+   free once the number of events alive levels off. Blocks larger than
+   MAX_BLOCK_SIZE are left to the global operator new.
+
+   Not thread-safe. An arena belongs to one simulator.
+*/
+class EventArena
+{
+public:
+
+    typedef std::size_t size_type;
+
+    static const size_type ALIGNMENT = 16;
+    static const size_type MAX_BLOCK_SIZE = 512;
+    static const size_type BLOCKS_PER_CHUNK = 64;
+
+protected:
+
+    struct node_type
+    {
+        node_type* next;
+    };
+
+public:
+
+    EventArena()
+        : free_lists_(MAX_BLOCK_SIZE / ALIGNMENT, NULL), num_in_use_(0)
+    {
+        ;
+    }
+
+    ~EventArena()
+    {
+        for (std::vector<void*>::iterator i(chunks_.begin()); i != chunks_.end(); ++i)
+        {
+            ::operator delete(*i);
+        }
+    }
+
+    void* allocate(const size_type size)
+    {
+        if (size > MAX_BLOCK_SIZE || size == 0)
+        {
+            return ::operator new(size);
+        }
+
+        const size_type c(size_class(size));
+        if (free_lists_[c] == NULL)
+        {
+            grow(c);
+        }
+
+        node_type* block(free_lists_[c]);
+        free_lists_[c] = block->next;
+        ++num_in_use_;
+        return block;
+    }
+
+    void deallocate(void* ptr, const size_type size)
+    {
+        if (size > MAX_BLOCK_SIZE || size == 0)
+        {
+            ::operator delete(ptr);
+            return;
+        }
+
+        const size_type c(size_class(size));
+        node_type* block(static_cast<node_type*>(ptr));
+        block->next = free_lists_[c];
+        free_lists_[c] = block;
+        --num_in_use_;
+    }
+
+    /**
+     * the number of pooled blocks in use.
+     */
+    size_type num_in_use() const
+    {
+        return num_in_use_;
+    }
+
+    size_type num_chunks() const
+    {
+        return chunks_.size();
+    }
+
+protected:
+
+    static size_type size_class(const size_type size)
+    {
+        return (size - 1) / ALIGNMENT;
+    }
+
+    void grow(const size_type c)
+    {
+        const size_type block_size((c + 1) * ALIGNMENT);
+        char* chunk(static_cast<char*>(::operator new(block_size * BLOCKS_PER_CHUNK)));
+        chunks_.push_back(chunk);
+
+        // thread the blocks in order, the first one at the head
+        for (size_type i(BLOCKS_PER_CHUNK); i > 0; --i)
+        {
+            node_type* block(reinterpret_cast<node_type*>(chunk + (i - 1) * block_size));
+            block->next = free_lists_[c];
+            free_lists_[c] = block;
+        }
+    }
+
+private:
+
+    EventArena(const EventArena&);
+    EventArena& operator=(const EventArena&);
+
+protected:
+
+    std::vector<node_type*> free_lists_;
+    std::vector<void*> chunks_;
+    size_type num_in_use_;
+};
+
+/**
+   Create events in an arena of a simulator. create() places an Event in
+   a pooled block, and holds it by boost::intrusive_ptr for
+   IntrusiveEventScheduler, with the reference count in the event itself.
+   Events are not exposed to Python, and those of a simulator are dropped
+   with its scheduler before its EventPool. The pool owns the arena, so
+   all the events must be released before it is destroyed.
+
+   An event is owned by intrusive_ptr alone: an event of the pool never
+   goes to boost::shared_ptr, which would delete it out of the arena.
+*/
+class EventPool
+{
+public:
+
+    typedef EventArena::size_type size_type;
+
+public:
+
+    EventPool()
+    {
+        ;
+    }
+
+    /**
+     * T must derive from Event (see intrusive_ptr_release).
+     */
+    template <typename T, typename... Args>
+    boost::intrusive_ptr<T> create(Args&&... args) const
+    {
+        void* const block(arena_.allocate(sizeof(T)));
+        T* event;
+        try
+        {
+            event = new (block) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            arena_.deallocate(block, sizeof(T));
+            throw;
+        }
+        event->attach_(&arena_, block, sizeof(T));
+        return boost::intrusive_ptr<T>(event);
+    }
+
+    size_type num_in_use() const
+    {
+        return arena_.num_in_use();
+    }
+
+    size_type num_chunks() const
+    {
+        return arena_.num_chunks();
+    }
+
+protected:
+
+    mutable EventArena arena_;
+};
+
+} // ecell4
+
+#endif /* ECELL4_EVENT_POOL_HPP */
@@ -3,20 +3,47 @@
 
 #include <boost/range/iterator_range.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/intrusive_ptr.hpp>
 #include <stdexcept>
 
 #include "types.hpp"
 #include "DynamicPriorityQueue.hpp"
+#include "CalendarQueue.hpp"
+#include "EventPool.hpp"
 
 
 namespace ecell4
 {
 
+/**
+ * Events are held by boost::shared_ptr, or by boost::intrusive_ptr with
+ * the reference count in the event itself. The count is not atomic, i.e.
+ * an event held by intrusive_ptr must not be shared across threads.
+ */
 struct Event
 {
 public:
 
-    Event(Real const& time) : time_(time) {}
+    Event(Real const& time)
+        : time_(time), ref_count_(0), arena_(NULL), block_(NULL), block_size_(0)
+    {
+        ;
+    }
+
+    // the reference count and the block are never copied
+    Event(Event const& rhs)
+        : time_(rhs.time_), dt_(rhs.dt_),
+          ref_count_(0), arena_(NULL), block_(NULL), block_size_(0)
+    {
+        ;
+    }
+
+    Event& operator=(Event const& rhs)
+    {
+        time_ = rhs.time_;
+        dt_ = rhs.dt_;
+        return *this;
+    }
 
     virtual ~Event() {}
 
@@ -40,31 +67,99 @@ protected:
     Real time_;
     //XXX: deprecate me
     Real dt_;
+
+private:
+
+    friend class EventPool;
+    friend void intrusive_ptr_add_ref(const Event* event);
+    friend void intrusive_ptr_release(const Event* event);
+
+    void attach_(EventArena* arena, void* block, const std::size_t block_size)
+    {
+        arena_ = arena;
+        block_ = block;
+        block_size_ = block_size;
+    }
+
+private:
+
+    mutable std::size_t ref_count_;  // see intrusive_ptr_release
+    EventArena* arena_;  // NULL unless created by EventPool::create
+    void* block_;
+    std::size_t block_size_;
 };
 
+inline void intrusive_ptr_add_ref(const Event* event)
+{
+    ++event->ref_count_;
+}
+
+/**
+ * destroy the event with the last reference, and give its block back to
+ * the arena if it was created by EventPool::create.
+ */
+inline void intrusive_ptr_release(const Event* event)
+{
+    if (--event->ref_count_ > 0)
+    {
+        return;
+    }
 
-template <class EventType>
-class EventSchedulerBase
+    EventArena* const arena(event->arena_);
+    if (arena == NULL)
+    {
+        delete event;
+        return;
+    }
+
+    void* const block(event->block_);
+    const std::size_t block_size(event->block_size_);
+    event->~Event();
+    arena->deallocate(block, block_size);
+}
+
+
+template <class EventType, class Tpointer_ = boost::shared_ptr<EventType> >
+struct event_comparator
 {
-protected:
+    bool operator()(Tpointer_ const& lhs, Tpointer_ const& rhs) const
+    {
+        return lhs->time() <= rhs->time();
+    }
+};
 
-    struct event_comparator
+template <class EventType, class Tpointer_ = boost::shared_ptr<EventType> >
+struct event_time
+{
+    Real operator()(Tpointer_ const& event) const
     {
-        bool operator()(boost::shared_ptr<EventType> const& lhs,
-                boost::shared_ptr<EventType> const& rhs) const
-        {
-            return lhs->time() <= rhs->time();
-        }
-    };
+        return event->time();
+    }
+};
+
+/**
+ * Events are kept in a binary heap, DynamicPriorityQueue, by default. Give
+ * CalendarQueue as Tqueue_, or use CalendarEventSchedulerBase, for many
+ * events scheduled at once. eGFRD and Spatiocyte use the latter when built
+ * with WITH_CALENDAR_QUEUE. Events are held by the pointer type of the
+ * queue, boost::shared_ptr by default, or boost::intrusive_ptr with
+ * IntrusiveEventSchedulerBase and IntrusiveCalendarEventSchedulerBase.
+ */
+template <class EventType,
+          class Tqueue_ = DynamicPriorityQueue<
+              boost::shared_ptr<EventType>, event_comparator<EventType> > >
+class EventSchedulerBase
+{
+protected:
 
-    typedef DynamicPriorityQueue<boost::shared_ptr<EventType>, event_comparator>
-        EventPriorityQueue;
+    typedef Tqueue_ EventPriorityQueue;
 
 public:
 
     typedef typename EventPriorityQueue::size_type size_type;
     typedef typename EventPriorityQueue::identifier_type identifier_type;
     typedef typename EventPriorityQueue::value_type value_type;
+    typedef typename EventPriorityQueue::element_type event_pointer_type;
     typedef boost::iterator_range<typename EventPriorityQueue::const_iterator>
         events_range;
 
@@ -106,7 +201,7 @@ public:
         return eventPriorityQueue_.second();
     }
 
-    boost::shared_ptr<EventType> get(identifier_type const& id) const
+    event_pointer_type get(identifier_type const& id) const
     {
         return eventPriorityQueue_.get(id);
     }
@@ -117,7 +212,7 @@ public:
         eventPriorityQueue_.clear();
     }
 
-    identifier_type add(boost::shared_ptr<EventType> const& event)
+    identifier_type add(event_pointer_type const& event)
     {
         return eventPriorityQueue_.push(event);
     }
@@ -161,7 +256,24 @@ protected:
     Real time_;
 };
 
+template <class EventType>
+using CalendarEventSchedulerBase = EventSchedulerBase<EventType,
+      CalendarQueue<boost::shared_ptr<EventType>, event_time<EventType> > >;
+
+template <class EventType>
+using IntrusiveEventSchedulerBase = EventSchedulerBase<EventType,
+      DynamicPriorityQueue<boost::intrusive_ptr<EventType>,
+          event_comparator<EventType, boost::intrusive_ptr<EventType> > > >;
+
+template <class EventType>
+using IntrusiveCalendarEventSchedulerBase = EventSchedulerBase<EventType,
+      CalendarQueue<boost::intrusive_ptr<EventType>,
+          event_time<EventType, boost::intrusive_ptr<EventType> > > >;
+
 typedef EventSchedulerBase<Event> EventScheduler;
+typedef CalendarEventSchedulerBase<Event> CalendarEventScheduler;
+typedef IntrusiveEventSchedulerBase<Event> IntrusiveEventScheduler;
+typedef IntrusiveCalendarEventSchedulerBase<Event> IntrusiveCalendarEventScheduler;
 
 } // ecell4
 
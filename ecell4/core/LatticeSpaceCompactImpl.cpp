@@ -0,0 +1,188 @@
+#include <limits>
+
+#include "Context.hpp"
+#include "MoleculePool.hpp"
+#include "VacantType.hpp"
+#include "StructureType.hpp"
+#include "LatticeSpaceCompactImpl.hpp"
+
+namespace ecell4 {
+
+typedef LatticeSpaceCompactImpl::coordinate_type coordinate_type;
+
+const LatticeSpaceCompactImpl::pool_index_type LatticeSpaceCompactImpl::vacant_index;
+const LatticeSpaceCompactImpl::pool_index_type LatticeSpaceCompactImpl::border_index;
+const LatticeSpaceCompactImpl::pool_index_type LatticeSpaceCompactImpl::periodic_index;
+
+LatticeSpaceCompactImpl::LatticeSpaceCompactImpl(
+    const Real3& edge_lengths, const Real& voxel_radius,
+    const bool is_periodic) :
+    base_type(edge_lengths, voxel_radius, is_periodic)
+{
+    border_ = boost::shared_ptr<VoxelPool>(
+            new StructureType(Species("Border", voxel_radius_, 0), vacant_));
+    periodic_ = boost::shared_ptr<VoxelPool>(
+            new StructureType(Species("Periodic", voxel_radius, 0), vacant_));
+
+    initialize_voxels(is_periodic_);
+}
+
+LatticeSpaceCompactImpl::~LatticeSpaceCompactImpl() {}
+
+void LatticeSpaceCompactImpl::initialize_voxels(const bool is_periodic)
+{
+    const coordinate_type voxel_size(col_size_ * row_size_ * layer_size_);
+
+    voxel_pools_.clear();
+    molecule_pools_.clear();
+
+    pools_.clear();
+    pool_indices_.clear();
+    index_of(vacant_);    // vacant_index
+    index_of(border_);    // border_index
+    index_of(periodic_);  // periodic_index
+
+    voxels_.clear();
+    voxels_.reserve(voxel_size);
+    for (coordinate_type coord(0); coord < voxel_size; ++coord)
+    {
+        if (!is_inside(coord))
+        {
+            if (is_periodic)
+            {
+                voxels_.push_back(periodic_index);
+                periodic_->add_voxel(coordinate_id_pair_type(ParticleID(), coord));
+            }
+            else
+            {
+                voxels_.push_back(border_index);
+                border_->add_voxel(coordinate_id_pair_type(ParticleID(), coord));
+            }
+        }
+        else
+        {
+            voxels_.push_back(vacant_index);
+            vacant_->add_voxel(coordinate_id_pair_type(ParticleID(), coord));
+        }
+    }
+}
+
+LatticeSpaceCompactImpl::pool_index_type
+LatticeSpaceCompactImpl::index_of(const boost::shared_ptr<VoxelPool>& vp)
+{
+    pool_index_map_type::const_iterator itr(pool_indices_.find(vp.get()));
+    if (itr != pool_indices_.end())
+    {
+        return (*itr).second;
+    }
+
+    if (pools_.size() > std::numeric_limits<pool_index_type>::max())
+    {
+        throw IllegalState("Too many pools are placed on LatticeSpaceCompactImpl.");
+    }
+
+    const pool_index_type index(static_cast<pool_index_type>(pools_.size()));
+    pools_.push_back(vp);
+    pool_indices_.insert(pool_index_map_type::value_type(vp.get(), index));
+    return index;
+}
+
+void LatticeSpaceCompactImpl::push_untracked_voxels(
+    std::vector<std::pair<ParticleID, ParticleVoxel> >& voxels,
+    const boost::shared_ptr<VoxelPool>& vp, const Species& sp) const
+{
+    pool_index_map_type::const_iterator j(pool_indices_.find(vp.get()));
+    if (j == pool_indices_.end())
+    {
+        return;  // never placed
+    }
+
+    const pool_index_type index((*j).second);
+    const std::string loc(get_location_serial(vp));
+    for (voxel_container::const_iterator i(voxels_.begin()); i != voxels_.end(); ++i)
+    {
+        if (*i != index)
+        {
+            continue;
+        }
+
+        const coordinate_type coord(std::distance(voxels_.begin(), i));
+        voxels.push_back(std::make_pair(
+            ParticleID(),
+            ParticleVoxel(sp, coord, vp->radius(), vp->D(), loc)));
+    }
+}
+
+bool
+LatticeSpaceCompactImpl::move(
+        const coordinate_type& src,
+        const coordinate_type& dest,
+        const std::size_t candidate)
+{
+    return move_(src, dest, candidate).second;
+}
+
+bool LatticeSpaceCompactImpl::can_move(
+    const coordinate_type& src, const coordinate_type& dest) const
+{
+    if (src == dest)
+        return false;
+
+    const VoxelPool* src_vp(pools_[voxels_.at(src)].get());
+    if (src_vp->is_vacant())
+        return false;
+
+    pool_index_type dest_index(voxels_.at(dest));
+
+    if (dest_index == border_index)
+        return false;
+
+    if (dest_index == periodic_index)
+        dest_index = voxels_.at(apply_boundary_(dest));
+
+    return (pools_[dest_index].get() == src_vp->location().get());
+}
+
+std::pair<coordinate_type, bool>
+LatticeSpaceCompactImpl::move_(
+        coordinate_type from,
+        coordinate_type to,
+        const std::size_t candidate)
+{
+    if (from == to)
+    {
+        return std::pair<coordinate_type, bool>(from, false);
+    }
+
+    VoxelPool* from_vp(pools_[voxels_.at(from)].get());
+    if (from_vp->is_vacant())
+    {
+        return std::pair<coordinate_type, bool>(from, true);
+    }
+
+    pool_index_type to_index(voxels_.at(to));
+
+    if (to_index == border_index)
+    {
+        return std::pair<coordinate_type, bool>(from, false);
+    }
+    else if (to_index == periodic_index)
+    {
+        to = apply_boundary_(to);
+        to_index = voxels_.at(to);
+    }
+
+    VoxelPool* to_vp(pools_[to_index].get());
+    if (to_vp != from_vp->location().get())
+    {
+        return std::pair<coordinate_type, bool>(to, false);
+    }
+
+    from_vp->replace_voxel(from, to, candidate);
+    to_vp->replace_voxel(to, from);
+    std::swap(voxels_[from], voxels_[to]);
+
+    return std::pair<coordinate_type, bool>(to, true);
+}
+
+} // ecell4
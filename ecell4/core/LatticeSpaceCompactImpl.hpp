@@ -0,0 +1,138 @@
+#ifndef ECELL4_LATTICE_SPACE_COMPACT_IMPL_HPP
+#define ECELL4_LATTICE_SPACE_COMPACT_IMPL_HPP
+
+#include "get_mapper_mf.hpp"
+#include "LatticeSpaceImplBase.hpp"
+
+namespace ecell4 {
+
+/**
+ * A LatticeSpace storing a 16-bit index of the pool for each voxel, instead
+ * of a shared pointer as LatticeSpaceVectorImpl does. A lattice takes 2
+ * bytes per voxel, 1/8 of LatticeSpaceVectorImpl, and a move just swaps two
+ * indices without touching reference counts.
+ *
+ * Pools are kept in a table, where a pool is registered when it is placed
+ * on the lattice for the first time, and is found there when placed again.
+ * Entries are neither reused nor removed until reset, as the space never
+ * drops a pool before reset either. Thus, the table holds at most one
+ * entry for each species besides the vacant and halo ones, and placing
+ * the 65534th species throws IllegalState. Unlike LatticeSpaceVectorImpl,
+ * the border and periodic halo are structures which only count their
+ * voxels.
+ */
+class LatticeSpaceCompactImpl
+    : public LatticeSpaceImplBase
+{
+public:
+
+    typedef LatticeSpaceImplBase base_type;
+    typedef uint16_t pool_index_type;
+    typedef std::vector<pool_index_type> voxel_container;
+    typedef std::vector<boost::shared_ptr<VoxelPool> > pool_container_type;
+
+protected:
+
+    typedef utils::get_mapper_mf<const VoxelPool*, pool_index_type>::type
+        pool_index_map_type;
+
+    static const pool_index_type vacant_index = 0;
+    static const pool_index_type border_index = 1;
+    static const pool_index_type periodic_index = 2;
+
+public:
+
+    LatticeSpaceCompactImpl(const Real3& edge_lengths,
+                            const Real& voxel_radius,
+                            const bool is_periodic = true);
+    ~LatticeSpaceCompactImpl();
+
+    boost::shared_ptr<VoxelPool> get_voxel_pool_at(const coordinate_type& coord) const
+    {
+        return pools_[voxels_.at(coord)];
+    }
+
+    /**
+     * return the pool at the coordinate without sharing its ownership.
+     */
+    const VoxelPool* get_voxel_pool_ptr_at(const coordinate_type& coord) const
+    {
+        return pools_[voxels_[coord]].get();
+    }
+
+    bool move(const coordinate_type& src,
+              const coordinate_type& dest,
+              const std::size_t candidate=0);
+    bool can_move(const coordinate_type& src, const coordinate_type& dest) const;
+
+    coordinate_type
+    get_neighbor(const coordinate_type& coord, const Integer& nrand) const
+    {
+        coordinate_type const dest = get_neighbor_(coord, nrand);
+
+        if (voxels_.at(dest) != periodic_index)
+        {
+            return dest;
+        }
+        else
+        {
+            return periodic_transpose(dest);
+        }
+    }
+
+    /**
+     * return the number of pools registered in the table.
+     */
+    std::size_t num_pools() const
+    {
+        return pools_.size();
+    }
+
+#ifdef WITH_HDF5
+    /*
+     * HDF5 Save
+     */
+    void save_hdf5(H5::Group* root) const
+    {
+        save_lattice_space(*this, root, "LatticeSpaceCompactImpl");
+    }
+
+    void load_hdf5(const H5::Group& root)
+    {
+        load_lattice_space(root, this);
+    }
+#endif
+
+protected:
+
+    void initialize_voxels(const bool is_periodic);
+
+    /**
+     * return the index of the pool, which is registered if not yet.
+     */
+    pool_index_type index_of(const boost::shared_ptr<VoxelPool>& vp);
+
+    void set_voxel_pool_at(const coordinate_type& coord, const boost::shared_ptr<VoxelPool>& vp)
+    {
+        voxels_.at(coord) = index_of(vp);
+    }
+
+    void push_untracked_voxels(
+        std::vector<std::pair<ParticleID, ParticleVoxel> >& voxels,
+        const boost::shared_ptr<VoxelPool>& vp, const Species& sp) const;
+
+    std::pair<coordinate_type, bool>
+    move_(coordinate_type from,
+          coordinate_type to,
+          const std::size_t candidate=0);
+
+protected:
+
+    voxel_container voxels_;
+    pool_container_type pools_;
+    pool_index_map_type pool_indices_;
+};
+
+} // ecell4
+
+#endif /* ECELL4_LATTICE_SPACE_COMPACT_IMPL_HPP */
@@ -0,0 +1,115 @@
+#ifndef ECELL4_LATTICE_SPACE_IMPL_BASE_HPP
+#define ECELL4_LATTICE_SPACE_IMPL_BASE_HPP
+
+#include "HCPLatticeSpace.hpp"
+
+namespace ecell4 {
+
+/**
+ * A base of LatticeSpaceVectorImpl and LatticeSpaceCompactImpl, which only
+ * differ in how a voxel refers to its pool. The methods placing, removing
+ * and listing voxels are implemented here in terms of get_voxel_pool_at and
+ * set_voxel_pool_at. Moves and neighbors are left to the derived classes
+ * so that they can be resolved without virtual calls in the step loop.
+ */
+class LatticeSpaceImplBase
+    : public HCPLatticeSpace
+{
+public:
+
+    typedef HCPLatticeSpace base_type;
+
+public:
+
+    LatticeSpaceImplBase(const Real3& edge_lengths,
+                         const Real& voxel_radius,
+                         const bool is_periodic)
+        : base_type(edge_lengths, voxel_radius, is_periodic), is_periodic_(is_periodic)
+    {
+        ;
+    }
+
+    virtual ~LatticeSpaceImplBase() {}
+
+    /*
+     * Space APIs
+     *
+     * using ParticleID, Species and Posision3
+     */
+
+    Integer num_species() const;
+
+    bool remove_voxel(const ParticleID& pid);
+    bool remove_voxel(const coordinate_type& coord);
+
+    bool update_structure(const Particle& p);
+
+    /*
+     * for Simulator
+     *
+     * using Species and coordinate_type
+     */
+    std::vector<std::pair<ParticleID, ParticleVoxel> > list_voxels() const;
+    std::vector<std::pair<ParticleID, ParticleVoxel> > list_voxels(const Species& sp) const;
+    std::vector<std::pair<ParticleID, ParticleVoxel> > list_voxels_exact(const Species& sp) const;
+
+    std::pair<ParticleID, ParticleVoxel> get_voxel_at(const coordinate_type& coord) const;
+
+    bool update_voxel(const ParticleID& pid, ParticleVoxel v);
+    bool add_voxel(const Species& species, const ParticleID& pid, const coordinate_type& coord);
+
+    bool add_voxels(const Species& species,
+                    std::vector<std::pair<ParticleID, coordinate_type> > voxels);
+
+    const Species& find_species(std::string name) const;
+    std::vector<coordinate_type> list_coords(const Species& sp) const;
+    std::vector<coordinate_type> list_coords_exact(const Species& sp) const;
+
+    bool is_periodic() const
+    {
+        return is_periodic_;
+    }
+
+    void reset(const Real3& edge_lengths, const Real& voxel_radius, const bool is_periodic)
+    {
+        base_type::reset(edge_lengths, voxel_radius, is_periodic);
+
+        is_periodic_ = is_periodic;
+        initialize_voxels(is_periodic_);
+    }
+
+    const Particle particle_at(const coordinate_type& coord) const;
+
+protected:
+
+    coordinate_type apply_boundary_(const coordinate_type& coord) const
+    {
+        return periodic_transpose(coord);
+    }
+
+    virtual void initialize_voxels(const bool is_periodic) = 0;
+
+    virtual void set_voxel_pool_at(
+        const coordinate_type& coord, const boost::shared_ptr<VoxelPool>& vp) = 0;
+
+    /**
+     * append voxels of a pool, which does not track its voxels, by scanning
+     * the lattice. The species of the voxels is given as sp.
+     */
+    virtual void push_untracked_voxels(
+        std::vector<std::pair<ParticleID, ParticleVoxel> >& voxels,
+        const boost::shared_ptr<VoxelPool>& vp, const Species& sp) const = 0;
+
+    coordinate_type get_coord(const ParticleID& pid) const;
+
+protected:
+
+    bool is_periodic_;
+
+    boost::shared_ptr<VoxelPool> border_;
+    boost::shared_ptr<VoxelPool> periodic_;
+};
+
+} // ecell4
+
+#endif /* ECELL4_LATTICE_SPACE_IMPL_BASE_HPP */
@@ -1,16 +1,16 @@
 #ifndef ECELL4_LATTICE_SPACE_VECTOR_IMPL_HPP
 #define ECELL4_LATTICE_SPACE_VECTOR_IMPL_HPP
 
-#include "HCPLatticeSpace.hpp"
+#include "LatticeSpaceImplBase.hpp"
 
 namespace ecell4 {
 
 class LatticeSpaceVectorImpl
-    : public HCPLatticeSpace
+    : public LatticeSpaceImplBase
 {
 public:
 
-    typedef HCPLatticeSpace base_type;
+    typedef LatticeSpaceImplBase base_type;
     typedef std::vector<boost::shared_ptr<VoxelPool> > voxel_container;
 
 public:
@@ -20,45 +20,21 @@ public:
                            const bool is_periodic = true);
     ~LatticeSpaceVectorImpl();
 
-    /*
-     * Space APIs
-     *
-     * using ParticleID, Species and Posision3
-     */
-
-    Integer num_species() const;
-
-    bool remove_voxel(const ParticleID& pid);
-    bool remove_voxel(const coordinate_type& coord);
-
-    bool update_structure(const Particle& p);
-
-    /*
-     * for Simulator
-     *
-     * using Species and coordinate_type
-     */
-    std::vector<std::pair<ParticleID, ParticleVoxel> > list_voxels() const;
-    std::vector<std::pair<ParticleID, ParticleVoxel> > list_voxels(const Species& sp) const;
-    std::vector<std::pair<ParticleID, ParticleVoxel> > list_voxels_exact(const Species& sp) const;
-
-    std::pair<ParticleID, ParticleVoxel> get_voxel_at(const coordinate_type& coord) const;
-
-    bool update_voxel(const ParticleID& pid, ParticleVoxel v);
-    bool add_voxel(const Species& species, const ParticleID& pid, const coordinate_type& coord);
-
-    bool add_voxels(const Species& species,
-                    std::vector<std::pair<ParticleID, coordinate_type> > voxels);
-
-    const Species& find_species(std::string name) const;
-    std::vector<coordinate_type> list_coords(const Species& sp) const;
-    std::vector<coordinate_type> list_coords_exact(const Species& sp) const;
-
     boost::shared_ptr<VoxelPool> get_voxel_pool_at(const coordinate_type& coord) const
     {
         return voxels_.at(coord);
     }
 
+    /**
+     * return the pool at the coordinate without sharing its ownership.
+     * Unlike get_voxel_pool_at, it is cheap enough for a tight loop on
+     * multiple threads.
+     */
+    const VoxelPool* get_voxel_pool_ptr_at(const coordinate_type& coord) const
+    {
+        return voxels_[coord].get();
+    }
+
     bool move(const coordinate_type& src,
               const coordinate_type& dest,
               const std::size_t candidate=0);
@@ -79,11 +55,6 @@ public:
         }
     }
 
-    bool is_periodic() const
-    {
-        return is_periodic_;
-    }
-
 #ifdef WITH_HDF5
     /*
      * HDF5 Save
@@ -99,24 +70,18 @@ public:
     }
 #endif
 
-    void reset(const Real3& edge_lengths, const Real& voxel_radius, const bool is_periodic)
-    {
-        base_type::reset(edge_lengths, voxel_radius, is_periodic);
-
-        is_periodic_ = is_periodic;
-        initialize_voxels(is_periodic_);
-    }
-
-    const Particle particle_at(const coordinate_type& coord) const;
-
 protected:
 
-    coordinate_type apply_boundary_(const coordinate_type& coord) const
+    void initialize_voxels(const bool is_periodic);
+
+    void set_voxel_pool_at(const coordinate_type& coord, const boost::shared_ptr<VoxelPool>& vp)
     {
-        return periodic_transpose(coord);
+        voxels_.at(coord) = vp;
     }
 
-    void initialize_voxels(const bool is_periodic);
+    void push_untracked_voxels(
+        std::vector<std::pair<ParticleID, ParticleVoxel> >& voxels,
+        const boost::shared_ptr<VoxelPool>& vp, const Species& sp) const;
 
     std::pair<coordinate_type, bool>
     move_(coordinate_type from,
@@ -127,16 +92,9 @@ protected:
     move_(coordinate_id_pair_type& info,
           coordinate_type to);
 
-    coordinate_type get_coord(const ParticleID& pid) const;
-
 protected:
 
-    bool is_periodic_;
-
     voxel_container voxels_;
-
-    boost::shared_ptr<VoxelPool> border_;
-    boost::shared_ptr<VoxelPool> periodic_;
 };
 
 } // ecell4
@@ -19,11 +19,29 @@ public:
 
 public:
 
+    Model()
+        : revision_(0)
+    {
+        ;
+    }
+
     virtual ~Model()
     {
         ;
     }
 
+    /**
+     * return the number of changes made to the species attributes or the
+     * reaction rules, including their rate constants, so far. Simulators
+     * keep it to know if what they derived from the model is still valid,
+     * without comparing the rules.
+     * @return the revision of the model
+     */
+    Integer revision() const
+    {
+        return revision_;
+    }
+
     // ModelTraits
 
     /**
@@ -158,7 +176,8 @@ public:
 
     virtual boost::shared_ptr<Model> expand(
         const std::vector<Species>& sp, const Integer max_itr,
-        const std::map<Species, Integer>& max_stoich) const = 0;
+        const std::map<Species, Integer>& max_stoich,
+        const std::size_t num_threads = 0) const = 0;
     virtual boost::shared_ptr<Model> expand(
         const std::vector<Species>& sp, const Integer max_itr) const = 0;
     virtual boost::shared_ptr<Model> expand(
@@ -208,6 +227,10 @@ public:
             add_reaction_rule(*i);
         }
     }
+
+protected:
+
+    Integer revision_;  // see revision()
 };
 
 } // ecell4
@@ -1,6 +1,10 @@
 #include <algorithm>
+#include <mutex>
+#include <unordered_set>
+#include <boost/array.hpp>
 
 #include "exceptions.hpp"
+#include "parallel_for.hpp"
 #include "NetfreeModel.hpp"
 
 
@@ -29,6 +33,7 @@ bool NetfreeModel::update_species_attribute(const Species& sp)
     //     (*i).set_attribute((*j).first, (*j).second);
     // }
     (*i).overwrite_attributes(sp);
+    ++revision_;
     return false;
 }
 
@@ -39,6 +44,7 @@ void NetfreeModel::add_species_attribute(const Species& sp)
         throw AlreadyExists("species already exists");
     }
     species_attributes_.push_back(sp);
+    ++revision_;
 }
 
 void NetfreeModel::remove_species_attribute(const Species& sp)
@@ -51,6 +57,7 @@ void NetfreeModel::remove_species_attribute(const Species& sp)
         throw NotFound(message.str()); // use boost::format if it's allowed
     }
     species_attributes_.erase(i, species_attributes_.end());
+    ++revision_;
 }
 
 bool NetfreeModel::has_species_attribute(const Species& sp) const
@@ -210,6 +217,7 @@ std::vector<ReactionRule> NetfreeModel::apply(
 void NetfreeModel::add_reaction_rule(const ReactionRule& rr)
 {
     reaction_rules_.push_back(rr);
+    ++revision_;
 }
 
 void NetfreeModel::remove_reaction_rule(const ReactionRule& rr)
@@ -220,6 +228,7 @@ void NetfreeModel::remove_reaction_rule(const ReactionRule& rr)
         throw NotFound("The given reaction rule was not found.");
     }
     reaction_rules_.erase(i, reaction_rules_.end());
+    ++revision_;
 }
 
 bool NetfreeModel::has_reaction_rule(const ReactionRule& rr) const
@@ -231,10 +240,10 @@ bool NetfreeModel::has_reaction_rule(const ReactionRule& rr) const
 
 boost::shared_ptr<Model> NetfreeModel::expand(
     const std::vector<Species>& sp, const Integer max_itr,
-    const std::map<Species, Integer>& max_stoich) const
+    const std::map<Species, Integer>& max_stoich, const std::size_t num_threads) const
 {
     return extras::generate_network_from_netfree_model(
-        *this, sp, max_itr, max_stoich).first;
+        *this, sp, max_itr, max_stoich, num_threads).first;
 }
 
 
@@ -292,17 +301,142 @@ bool check_stoichiometry(const ReactionRule& rr,
     return true;
 }
 
+/**
+ * memoized results shared through a network generation. All the maps are
+ * keyed by serials, not to intern species which may never be registered.
+ */
+class __generation_cache
+{
+public:
+
+    typedef std::vector<unsigned char> match_flags_type;
+
+public:
+
+    __generation_cache(
+        const NetfreeModel& nfm, const std::map<Species, Integer>& max_stoich)
+        : nfm_(nfm), max_stoich_(max_stoich)
+    {
+        ;
+    }
+
+    /**
+     * return the canonical form of the given species. Each serial is
+     * formatted only once. This is thread-safe.
+     */
+    Species format(const Species& sp)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const utils::get_mapper_mf<Species::serial_type, Species>::type::const_iterator
+                i(formatted_.find(sp.serial()));
+            if (i != formatted_.end())
+            {
+                return (*i).second;
+            }
+        }
+
+        const Species retval(format_species(sp));
+        std::lock_guard<std::mutex> lock(mutex_);
+        formatted_.insert(std::make_pair(sp.serial(), retval));
+        formatted_.insert(std::make_pair(retval.serial(), retval));  // already canonical
+        return retval;
+    }
+
+    /**
+     * return flags whether the species matches each reactant of rules.
+     * the k-th bit of the i-th element is for the k-th reactant of
+     * the i-th rule in the model.
+     */
+    match_flags_type compute_match_flags(const Species& sp) const
+    {
+        const NetfreeModel::reaction_rule_container_type& rules(nfm_.reaction_rules());
+        match_flags_type retval(rules.size(), 0);
+        for (std::size_t i(0); i < rules.size(); ++i)
+        {
+            const ReactionRule::reactant_container_type& reactants(rules[i].reactants());
+            for (std::size_t k(0); k < reactants.size() && k < 8; ++k)
+            {
+                if (SpeciesExpressionMatcher(reactants[k]).match(sp))
+                {
+                    retval[i] |= (1 << k);
+                }
+            }
+        }
+        return retval;
+    }
+
+    void set_match_flags(const Species& sp, const match_flags_type& flags)
+    {
+        match_flags_[sp.serial()] = flags;
+    }
+
+    const match_flags_type& match_flags(const Species& sp) const
+    {
+        return (*match_flags_.find(sp.serial())).second;
+    }
+
+    bool check_stoichiometry(const Species& sp)
+    {
+        if (max_stoich_.empty())
+        {
+            return true;
+        }
+
+        const utils::get_mapper_mf<Species::serial_type, bool>::type::const_iterator
+            i(stoichiometry_.find(sp.serial()));
+        if (i != stoichiometry_.end())
+        {
+            return (*i).second;
+        }
+        const bool retval(extras::check_stoichiometry(sp, max_stoich_));
+        stoichiometry_.insert(std::make_pair(sp.serial(), retval));
+        return retval;
+    }
+
+    bool check_stoichiometry(const ReactionRule& rr)
+    {
+        for (ReactionRule::product_container_type::const_iterator
+            i(rr.products().begin()); i != rr.products().end(); ++i)
+        {
+            if (!check_stoichiometry(*i))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * mark the species as known, and return true if it was not yet.
+     */
+    bool mark(const Species& sp)
+    {
+        return known_.insert(sp.serial()).second;
+    }
+
+protected:
+
+    const NetfreeModel& nfm_;
+    const std::map<Species, Integer>& max_stoich_;
+
+    std::mutex mutex_;  // only for formatted_
+    utils::get_mapper_mf<Species::serial_type, Species>::type formatted_;
+    utils::get_mapper_mf<Species::serial_type, match_flags_type>::type match_flags_;
+    utils::get_mapper_mf<Species::serial_type, bool>::type stoichiometry_;
+    std::unordered_set<Species::serial_type> known_;
+};
+
 void __add_reaction_rules(
     const std::vector<ReactionRule>& reaction_rules,
     std::vector<ReactionRule>& reactions, std::vector<Species>& newseeds,
-    const std::vector<Species>& seeds,
-    const std::map<Species, Integer>& max_stoich)
+    __generation_cache& cache)
 {
     for (std::vector<ReactionRule>::const_iterator i(reaction_rules.begin());
         i != reaction_rules.end(); ++i)
     {
         const ReactionRule& rr(*i);
-        if (!check_stoichiometry(rr, max_stoich))
+        if (!cache.check_stoichiometry(rr))
         {
             continue;
         }
@@ -312,11 +446,8 @@ void __add_reaction_rules(
         for (ReactionRule::product_container_type::const_iterator
             j(rr.products().begin()); j != rr.products().end(); ++j)
         {
-            const Species sp(format_species(*j));
-            if (std::find(newseeds.begin(), newseeds.end(), sp)
-                == newseeds.end()
-                && std::find(seeds.begin(), seeds.end(), sp)
-                == seeds.end())
+            const Species sp(cache.format(*j));
+            if (cache.mark(sp))
             {
                 newseeds.push_back(sp);
             }
@@ -324,47 +455,70 @@ void __add_reaction_rules(
     }
 }
 
+/**
+ * expand the network by one generation. seeds1 is the frontier, which
+ * is replaced with new species, and seeds2 is all the known species.
+ *
+ * Matching is done on num_threads threads for each pair of a rule and
+ * reactants, while the results are merged in the same order as the serial
+ * expansion. Thus, the output never depends on the number of threads.
+ */
 void __generate_recurse(
     const NetfreeModel& nfm, std::vector<ReactionRule>& reactions,
     std::vector<Species>& seeds1, std::vector<Species>& seeds2,
-    const std::map<Species, Integer>& max_stoich)
+    __generation_cache& cache, const std::size_t num_threads)
 {
-    std::vector<Species> newseeds;
+    typedef boost::array<std::size_t, 3> task_type;  // (rule, seed1, seed2)
+
     seeds2.insert(seeds2.begin(), seeds1.begin(), seeds1.end());
 
-    for (NetfreeModel::reaction_rule_container_type::const_iterator
-        i(nfm.reaction_rules().begin()); i != nfm.reaction_rules().end(); ++i)
     {
-        const ReactionRule& rr(*i);
+        std::vector<__generation_cache::match_flags_type> flags(seeds1.size());
+        parallel_for(seeds1.size(), num_threads,
+            [&](const std::size_t i) { flags[i] = cache.compute_match_flags(seeds1[i]); });
+        for (std::size_t i(0); i < seeds1.size(); ++i)
+        {
+            cache.set_match_flags(seeds1[i], flags[i]);
+        }
+    }
+
+    const NetfreeModel::reaction_rule_container_type& rules(nfm.reaction_rules());
+    std::vector<task_type> tasks;
+    for (std::size_t i(0); i < rules.size(); ++i)
+    {
+        const ReactionRule& rr(rules[i]);
 
         switch (rr.reactants().size())
         {
         case 0:
             continue;
         case 1:
-            for (std::vector<Species>::const_iterator j(seeds1.begin());
-                j != seeds1.end(); ++j)
+            for (std::size_t j(0); j < seeds1.size(); ++j)
             {
-                ReactionRule::reactant_container_type reactants(1);
-                reactants[0] = *j;
-                __add_reaction_rules(
-                    rr.generate(reactants), reactions, newseeds, seeds2, max_stoich);
+                if (cache.match_flags(seeds1[j])[i] & 1)
+                {
+                    const task_type task = {{i, j, j}};
+                    tasks.push_back(task);
+                }
             }
             break;
         case 2:
-            for (std::vector<Species>::const_iterator j(seeds1.begin());
-                j != seeds1.end(); ++j)
+            for (std::size_t j(0); j < seeds1.size(); ++j)
             {
-                const std::vector<Species>::const_iterator start(
-                    seeds2.begin()
-                    + std::distance<std::vector<Species>::const_iterator>(
-                        seeds1.begin(), j));
-                for (std::vector<Species>::const_iterator
-                    k(start); k != seeds2.end(); ++k)
+                const unsigned char flag1(cache.match_flags(seeds1[j])[i]);
+                if (flag1 == 0)
+                {
+                    continue;
+                }
+
+                for (std::size_t k(j); k < seeds2.size(); ++k)
                 {
-                    __add_reaction_rules(
-                        generate_reaction_rules(rr, *j, *k),
-                        reactions, newseeds, seeds2, max_stoich);
+                    const unsigned char flag2(cache.match_flags(seeds2[k])[i]);
+                    if (((flag1 & 1) && (flag2 & 2)) || ((flag1 & 2) && (flag2 & 1)))
+                    {
+                        const task_type task = {{i, j, k}};
+                        tasks.push_back(task);
+                    }
                 }
             }
             break;
@@ -374,23 +528,58 @@ void __generate_recurse(
         }
     }
 
+    std::vector<std::vector<ReactionRule> > generated(tasks.size());
+    parallel_for(tasks.size(), num_threads,
+        [&](const std::size_t n)
+        {
+            const ReactionRule& rr(rules[tasks[n][0]]);
+            if (rr.reactants().size() == 1)
+            {
+                generated[n] = rr.generate(
+                    ReactionRule::reactant_container_type(1, seeds1[tasks[n][1]]));
+            }
+            else
+            {
+                generated[n] = generate_reaction_rules(
+                    rr, seeds1[tasks[n][1]], seeds2[tasks[n][2]]);
+            }
+
+            for (std::vector<ReactionRule>::const_iterator i(generated[n].begin());
+                i != generated[n].end(); ++i)
+            {
+                for (ReactionRule::product_container_type::const_iterator
+                    j((*i).products().begin()); j != (*i).products().end(); ++j)
+                {
+                    cache.format(*j);  // warm up the cache in parallel
+                }
+            }
+        });
+
+    std::vector<Species> newseeds;
+    for (std::size_t n(0); n < tasks.size(); ++n)
+    {
+        __add_reaction_rules(generated[n], reactions, newseeds, cache);
+    }
+
     seeds1.swap(newseeds);
 }
 
 std::pair<boost::shared_ptr<NetworkModel>, bool> generate_network_from_netfree_model(
     const NetfreeModel& nfm, const std::vector<Species>& seeds, const Integer max_itr,
-    const std::map<Species, Integer>& max_stoich)
+    const std::map<Species, Integer>& max_stoich, std::size_t num_threads)
 {
     std::vector<ReactionRule> reactions;
     std::vector<Species> seeds1;
     std::vector<Species> seeds2;
+    __generation_cache cache(nfm, max_stoich);
+
+    num_threads = resolve_num_threads(num_threads);
 
     for (std::vector<Species>::const_iterator i(seeds.begin());
         i != seeds.end(); ++i)
     {
-        const Species sp(format_species(*i));
-        if (std::find(seeds1.begin(), seeds1.end(), sp)
-            == seeds1.end())
+        const Species sp(cache.format(*i));
+        if (cache.mark(sp))
         {
             seeds1.push_back(sp);
         }
@@ -406,9 +595,8 @@ std::pair<boost::shared_ptr<NetworkModel>, bool> generate_network_from_netfree_m
             for (ReactionRule::product_container_type::const_iterator
                 j(rr.products().begin()); j != rr.products().end(); ++j)
             {
-                const Species sp(format_species(*j));
-                if (std::find(seeds1.begin(), seeds1.end(), sp)
-                    == seeds1.end())
+                const Species sp(cache.format(*j));
+                if (cache.mark(sp))
                 {
                     seeds1.push_back(sp);
                 }
@@ -419,7 +607,7 @@ std::pair<boost::shared_ptr<NetworkModel>, bool> generate_network_from_netfree_m
     Integer cnt(0);
     while (seeds1.size() > 0 && cnt < max_itr)
     {
-        __generate_recurse(nfm, reactions, seeds1, seeds2, max_stoich);
+        __generate_recurse(nfm, reactions, seeds1, seeds2, cache, num_threads);
         cnt += 1;
     }
 
@@ -91,7 +91,8 @@ public:
 
     boost::shared_ptr<Model> expand(
         const std::vector<Species>& sp, const Integer max_itr,
-        const std::map<Species, Integer>& max_stoich) const;
+        const std::map<Species, Integer>& max_stoich,
+        const std::size_t num_threads = 0) const;
     boost::shared_ptr<Model> expand(
         const std::vector<Species>& sp, const Integer max_itr) const;
     boost::shared_ptr<Model> expand(const std::vector<Species>& sp) const;
@@ -117,9 +118,16 @@ protected:
 namespace extras
 {
 
+/**
+ * generate a network from seeds by applying rules in the model repeatedly.
+ * Species are matched and rules are generated on num_threads threads, but
+ * the result is the same with any number of threads.
+ * num_threads = 0 means the number of hardware threads.
+ * return the network and whether the expansion finished within max_itr.
+ */
 std::pair<boost::shared_ptr<NetworkModel>, bool> generate_network_from_netfree_model(
     const NetfreeModel& nfm, const std::vector<Species>& seeds, const Integer max_itr,
-    const std::map<Species, Integer>& max_stoich);
+    const std::map<Species, Integer>& max_stoich, std::size_t num_threads = 0);
 
 inline std::pair<boost::shared_ptr<NetworkModel>, bool> generate_network_from_netfree_model(
     const NetfreeModel& nfm, const std::vector<Species>& seeds, const Integer max_itr)
@@ -29,6 +29,7 @@ bool NetworkModel::update_species_attribute(const Species& sp)
     //     (*i).set_attribute((*j).first, (*j).second);
     // }
     (*i).overwrite_attributes(sp);
+    ++revision_;
     return false;
 }
 
@@ -39,6 +40,8 @@ void NetworkModel::add_species_attribute(const Species& sp)
         throw AlreadyExists("species already exists");
     }
     species_attributes_.push_back(sp);
+    species_attributes_.back().intern();
+    ++revision_;
 }
 
 void NetworkModel::remove_species_attribute(const Species& sp)
@@ -51,6 +54,7 @@ void NetworkModel::remove_species_attribute(const Species& sp)
         throw NotFound(message.str()); // use boost::format if it's allowed
     }
     species_attributes_.erase(i, species_attributes_.end());
+    ++revision_;
 }
 
 bool NetworkModel::has_species_attribute(const Species& sp) const
@@ -83,10 +87,9 @@ Integer NetworkModel::apply(const Species& pttrn, const Species& sp) const
 std::vector<ReactionRule> NetworkModel::query_reaction_rules(
     const Species& sp) const
 {
-    first_order_reaction_rules_map_type::const_iterator
-        i(first_order_reaction_rules_map_.find(sp.serial()));
-
     std::vector<ReactionRule> retval;
+    first_order_reaction_rules_map_type::const_iterator
+        i(first_order_reaction_rules_map_.find(sp.id()));
     if (i != first_order_reaction_rules_map_.end())
     {
         retval.reserve((*i).second.size());
@@ -103,13 +106,8 @@ std::vector<ReactionRule> NetworkModel::query_reaction_rules(
     const Species& sp1, const Species& sp2) const
 {
     std::vector<ReactionRule> retval;
-    const std::pair<Species::serial_type, Species::serial_type>
-        key(sp1.serial() < sp2.serial()?
-            std::make_pair(sp1.serial(), sp2.serial()):
-            std::make_pair(sp2.serial(), sp1.serial()));
-
     second_order_reaction_rules_map_type::const_iterator
-        i(second_order_reaction_rules_map_.find(key));
+        i(second_order_reaction_rules_map_.find(second_order_key(sp1, sp2)));
     if (i != second_order_reaction_rules_map_.end())
     {
         retval.reserve((*i).second.size());
@@ -142,11 +140,28 @@ std::vector<ReactionRule> NetworkModel::apply(
     return std::vector<ReactionRule>(1, rr);
 }
 
+void NetworkModel::intern_species(const ReactionRule& rr)
+{
+    for (ReactionRule::reactant_container_type::const_iterator
+        i(rr.reactants().begin()); i != rr.reactants().end(); ++i)
+    {
+        (*i).intern();
+    }
+    for (ReactionRule::product_container_type::const_iterator
+        i(rr.products().begin()); i != rr.products().end(); ++i)
+    {
+        (*i).intern();
+    }
+}
+
 void NetworkModel::add_reaction_rule(const ReactionRule& rr)
 {
+    ++revision_;
+
     if (rr.has_descriptor())
     {
         reaction_rules_.push_back(rr);
+        intern_species(reaction_rules_.back());
         return;
     }
 
@@ -162,22 +177,17 @@ void NetworkModel::add_reaction_rule(const ReactionRule& rr)
 
     const reaction_rule_container_type::size_type idx(reaction_rules_.size());
     reaction_rules_.push_back(rr);
+    intern_species(reaction_rules_.back());
 
-    if (rr.reactants().size() == 1)
+    const ReactionRule::reactant_container_type& reactants(reaction_rules_.back().reactants());
+    if (reactants.size() == 1)
     {
-        const Species::serial_type key = rr.reactants()[0].serial();
-        first_order_reaction_rules_map_[key].push_back(idx);
+        first_order_reaction_rules_map_[reactants[0].id()].push_back(idx);
     }
-    else if (rr.reactants().size() == 2)
+    else if (reactants.size() == 2)
     {
-        const Species::serial_type
-            serial1(rr.reactants()[0].serial()),
-            serial2(rr.reactants()[1].serial());
-        const std::pair<Species::serial_type, Species::serial_type>
-            key(serial1 < serial2?
-                std::make_pair(serial1, serial2):
-                std::make_pair(serial2, serial1));
-        second_order_reaction_rules_map_[key].push_back(idx);
+        second_order_reaction_rules_map_[second_order_key(
+            reactants[0], reactants[1])].push_back(idx);
     }
     else
     {
@@ -209,6 +219,7 @@ void NetworkModel::remove_reaction_rule(const ReactionRule& rr)
 void NetworkModel::remove_reaction_rule(const NetworkModel::reaction_rule_container_type::iterator i)
 {
     assert(reaction_rules_.size() > 0);
+    ++revision_;
     const reaction_rule_container_type::size_type idx = i - reaction_rules_.begin();
     assert(idx < reaction_rules_.size());
     const reaction_rule_container_type::size_type last_idx(reaction_rules_.size() - 1);
@@ -222,21 +233,21 @@ void NetworkModel::remove_reaction_rule(const NetworkModel::reaction_rule_contai
         }
         else if (rr.reactants().size() == 1)
         {
-            first_order_reaction_rules_map_type::iterator
-                j(first_order_reaction_rules_map_.find(rr.reactants()[0].serial()));
-            assert(j != first_order_reaction_rules_map_.end());
+            assert(first_order_reaction_rules_map_.count(rr.reactants()[0].id()) == 1);
+            first_order_reaction_rules_map_type::mapped_type&
+                indices(first_order_reaction_rules_map_[rr.reactants()[0].id()]);
 
             first_order_reaction_rules_map_type::mapped_type::iterator
-                k(std::remove((*j).second.begin(), (*j).second.end(), idx));
-            assert(k != (*j).second.end());
+                k(std::remove(indices.begin(), indices.end(), idx));
+            assert(k != indices.end());
 
-            (*j).second.erase(k, (*j).second.end());
+            indices.erase(k, indices.end());
         }
         else if (rr.reactants().size() == 2)
         {
             second_order_reaction_rules_map_type::iterator
-                j(second_order_reaction_rules_map_.find(std::make_pair(
-                    rr.reactants()[0].serial(), rr.reactants()[1].serial())));
+                j(second_order_reaction_rules_map_.find(second_order_key(
+                    rr.reactants()[0], rr.reactants()[1])));
             assert(j != second_order_reaction_rules_map_.end());
 
             second_order_reaction_rules_map_type::mapped_type::iterator
@@ -259,24 +270,22 @@ void NetworkModel::remove_reaction_rule(const NetworkModel::reaction_rule_contai
         }
         else if (rrlast.reactants().size() == 1)
         {
-            first_order_reaction_rules_map_type::iterator
-                j(first_order_reaction_rules_map_.find(
-                    rrlast.reactants()[0].serial()));
-            assert(j != first_order_reaction_rules_map_.end());
+            assert(first_order_reaction_rules_map_.count(rrlast.reactants()[0].id()) == 1);
+            first_order_reaction_rules_map_type::mapped_type&
+                indices(first_order_reaction_rules_map_[rrlast.reactants()[0].id()]);
 
             first_order_reaction_rules_map_type::mapped_type::iterator
-                k(std::remove((*j).second.begin(), (*j).second.end(), last_idx));
-            assert(k != (*j).second.end());
+                k(std::remove(indices.begin(), indices.end(), last_idx));
+            assert(k != indices.end());
 
-            (*j).second.erase(k, (*j).second.end());
-            (*j).second.push_back(idx);
+            indices.erase(k, indices.end());
+            indices.push_back(idx);
         }
         else if (rrlast.reactants().size() == 2)
         {
             second_order_reaction_rules_map_type::iterator
-                j(second_order_reaction_rules_map_.find(std::make_pair(
-                    rrlast.reactants()[0].serial(),
-                    rrlast.reactants()[1].serial())));
+                j(second_order_reaction_rules_map_.find(second_order_key(
+                    rrlast.reactants()[0], rrlast.reactants()[1])));
             assert(j != second_order_reaction_rules_map_.end());
 
             second_order_reaction_rules_map_type::mapped_type::iterator
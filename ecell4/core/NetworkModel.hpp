@@ -1,8 +1,6 @@
 #ifndef ECELL4_NETWORK_MODEL_HPP
 #define ECELL4_NETWORK_MODEL_HPP
 
-// #include "get_mapper_mf.hpp"
-
 #include <map>
 #include <set>
 #include <algorithm>
@@ -10,7 +8,9 @@
 #include <boost/shared_ptr.hpp>
 
 #include "types.hpp"
+#include "get_mapper_mf.hpp"
 #include "Species.hpp"
+#include "SpeciesIDMap.hpp"
 #include "ReactionRule.hpp"
 #include "Model.hpp"
 
@@ -31,11 +31,16 @@ public:
 
 protected:
 
-    typedef std::map<Species::serial_type,
-                     std::vector<reaction_rule_container_type::size_type> >
+    /**
+     * rules are indexed by the interned ids of reactants. The first order
+     * table is hashed with the id, and the second order one with a pair of
+     * ids (see second_order_key). Reactants are interned when added.
+     */
+    typedef utils::get_mapper_mf<Species::id_type,
+                     std::vector<reaction_rule_container_type::size_type> >::type
         first_order_reaction_rules_map_type;
-    typedef std::map<std::pair<Species::serial_type, Species::serial_type>,
-                     std::vector<reaction_rule_container_type::size_type> >
+    typedef utils::get_mapper_mf<second_order_key_type,
+                     std::vector<reaction_rule_container_type::size_type> >::type
         second_order_reaction_rules_map_type;
 
 public:
@@ -65,9 +70,14 @@ public:
 
     Species apply_species_attributes(const Species& sp) const;
 
+    /**
+     * a NetworkModel is already expanded, and is just copied.
+     * the stoichiometry limits and the number of threads are ignored.
+     */
     boost::shared_ptr<Model> expand(
         const std::vector<Species>& sp, const Integer max_itr,
-        const std::map<Species, Integer>& max_stoich) const
+        const std::map<Species, Integer>& /* max_stoich */,
+        const std::size_t /* num_threads */ = 0) const
     {
         return boost::shared_ptr<Model>(new NetworkModel(*this));
     }
@@ -115,6 +125,11 @@ protected:
 
     void remove_reaction_rule(const reaction_rule_container_type::iterator i);
 
+    /**
+     * intern the reactants and products of a rule being registered.
+     */
+    static void intern_species(const ReactionRule& rr);
+
 protected:
 
     species_container_type species_attributes_;
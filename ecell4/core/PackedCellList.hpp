@@ -0,0 +1,277 @@
+#ifndef ECELL4_PACKED_CELL_LIST_HPP
+#define ECELL4_PACKED_CELL_LIST_HPP
+
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+#include "exceptions.hpp"
+
+
+namespace ecell4
+{
+
+/**
+   Indices of values, 0 to size() - 1, sorted into cells and packed into a
+   single array. Each cell owns a contiguous range of the array, and the
+   indices in a cell are read as one span without a pointer per cell.
+
+   The ranges are laid out by a counting sort with some room left at the
+   end of each cell. A value moved to another cell is taken out of its
+   range by swapping it with the last one there, and appended to the new
+   range, both in O(1) time. The whole array is laid out again only when
+   a cell runs out of room, which leaves the cells sorted by index again.
+
+   The owner keeps the values in a vector and removes one by moving the
+   last value into its place, as erase() expects.
+*/
+class PackedCellList
+{
+public:
+
+    typedef std::size_t size_type;
+    typedef std::vector<size_type> index_container_type;
+
+    /**
+     * indices of values in a cell, with the interface of a const vector.
+     */
+    class cell_type
+    {
+    public:
+
+        typedef PackedCellList::size_type size_type;
+        typedef PackedCellList::size_type value_type;
+        typedef const size_type* const_iterator;
+        typedef const size_type* iterator;
+
+    public:
+
+        cell_type(const size_type* first, const size_type* last)
+            : first_(first), last_(last)
+        {
+            ;
+        }
+
+        const_iterator begin() const
+        {
+            return first_;
+        }
+
+        const_iterator end() const
+        {
+            return last_;
+        }
+
+        size_type size() const
+        {
+            return last_ - first_;
+        }
+
+        bool empty() const
+        {
+            return first_ == last_;
+        }
+
+        const size_type& operator[](const size_type i) const
+        {
+            return first_[i];
+        }
+
+    protected:
+
+        const size_type* first_;
+        const size_type* last_;
+    };
+
+public:
+
+    PackedCellList(const size_type num_cells)
+        : offsets_(num_cells + 1, 0), counts_(num_cells, 0), num_rebuilds_(0)
+    {
+        ;
+    }
+
+    size_type num_cells() const
+    {
+        return counts_.size();
+    }
+
+    /**
+     * the number of values.
+     */
+    size_type size() const
+    {
+        return cells_.size();
+    }
+
+    cell_type cell(const size_type c) const
+    {
+        const size_type* first(entries_.empty() ? NULL : &entries_[0] + offsets_[c]);
+        return cell_type(first, first + counts_[c]);
+    }
+
+    size_type cell_of(const size_type value) const
+    {
+        return cells_[value];
+    }
+
+    /**
+     * the number of times the cells were laid out.
+     */
+    size_type num_rebuilds() const
+    {
+        return num_rebuilds_;
+    }
+
+    /**
+     * add a new value, size(), to the cell c.
+     */
+    void push_back(const size_type c)
+    {
+        const size_type value(cells_.size());
+        cells_.push_back(c);
+        slots_.push_back(0);
+        append(value, c);
+    }
+
+    /**
+     * move the value to the cell c.
+     */
+    void move(const size_type value, const size_type c)
+    {
+        if (cells_[value] == c)
+        {
+            return;
+        }
+
+        take(value);
+        cells_[value] = c;
+        append(value, c);
+    }
+
+    /**
+     * remove the value, and then rename the last value, size() - 1, to it.
+     */
+    void erase(const size_type value)
+    {
+        if (value >= cells_.size())
+        {
+            throw IllegalState("The value is out of range.");
+        }
+
+        take(value);
+
+        const size_type last(cells_.size() - 1);
+        if (value != last)
+        {
+            entries_[slots_[last]] = value;
+            slots_[value] = slots_[last];
+            cells_[value] = cells_[last];
+        }
+        cells_.pop_back();
+        slots_.pop_back();
+    }
+
+    void clear()
+    {
+        std::fill(offsets_.begin(), offsets_.end(), 0);
+        std::fill(counts_.begin(), counts_.end(), 0);
+        entries_.clear();
+        cells_.clear();
+        slots_.clear();
+    }
+
+    /**
+     * lay out all the cells again by a counting sort of the values.
+     */
+    void rebuild()
+    {
+        std::fill(counts_.begin(), counts_.end(), 0);
+        for (index_container_type::const_iterator i(cells_.begin()); i != cells_.end(); ++i)
+        {
+            ++counts_[*i];
+        }
+
+        offsets_[0] = 0;
+        for (size_type c(0); c < num_cells(); ++c)
+        {
+            offsets_[c + 1] = offsets_[c] + counts_[c] + room(counts_[c]);
+            counts_[c] = 0;
+        }
+
+        entries_.resize(offsets_.back());
+        for (size_type value(0); value < cells_.size(); ++value)
+        {
+            const size_type c(cells_[value]);
+            slots_[value] = offsets_[c] + counts_[c];
+            entries_[slots_[value]] = value;
+            ++counts_[c];
+        }
+        ++num_rebuilds_;
+    }
+
+    // self-diagnostic method
+    bool check() const
+    {
+        bool result(cells_.size() == slots_.size());
+        size_type num_values(0);
+        for (size_type c(0); c < num_cells(); ++c)
+        {
+            result = result && offsets_[c] + counts_[c] <= offsets_[c + 1];
+            const cell_type values(cell(c));
+            for (cell_type::const_iterator i(values.begin()); i != values.end(); ++i)
+            {
+                result = result && *i < size() && cells_[*i] == c;
+                result = result && entries_[slots_[*i]] == *i;
+            }
+            num_values += values.size();
+        }
+        return result && num_values == size();
+    }
+
+protected:
+
+    static size_type room(const size_type count)
+    {
+        return 2 + count / 4;
+    }
+
+    void append(const size_type value, const size_type c)
+    {
+        if (offsets_[c] + counts_[c] == offsets_[c + 1])
+        {
+            rebuild();  // including the value
+            return;
+        }
+
+        slots_[value] = offsets_[c] + counts_[c];
+        entries_[slots_[value]] = value;
+        ++counts_[c];
+    }
+
+    /**
+     * take the value out of its cell by swapping it with the last one.
+     */
+    void take(const size_type value)
+    {
+        const size_type c(cells_[value]);
+        const size_type last_slot(offsets_[c] + counts_[c] - 1);
+        const size_type moved(entries_[last_slot]);
+        entries_[slots_[value]] = moved;
+        slots_[moved] = slots_[value];
+        --counts_[c];
+    }
+
+protected:
+
+    index_container_type offsets_;  // the first slot of each cell
+    index_container_type counts_;  // the number of values in each cell
+    index_container_type entries_;  // values in slots
+    index_container_type cells_;  // the cell of each value
+    index_container_type slots_;  // the slot of each value
+    size_type num_rebuilds_;
+};
+
+} // ecell4
+
+#endif /* ECELL4_PACKED_CELL_LIST_HPP */
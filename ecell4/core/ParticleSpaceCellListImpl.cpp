@@ -12,17 +12,9 @@ void ParticleSpaceCellListImpl::reset(const Real3& edge_lengths)
     particles_.clear();
     rmap_.clear();
     particle_pool_.clear();
+    resize_columns(0);
 
-    for (matrix_type::size_type i(0); i < matrix_.shape()[0]; ++i)
-    {
-        for (matrix_type::size_type j(0); j < matrix_.shape()[1]; ++j)
-        {
-            for (matrix_type::size_type k(0); k < matrix_.shape()[2]; ++k)
-            {
-                matrix_[i][j][k].clear();
-            }
-        }
-    }
+    cells_.clear();
 
     for (Real3::size_type dim(0); dim < 3; ++dim)
     {
@@ -44,18 +36,18 @@ bool ParticleSpaceCellListImpl::update_particle(
     {
         if ((*i).second.species() != p.species())
         {
-            particle_pool_[(*i).second.species_serial()].erase((*i).first);
-            particle_pool_[p.species_serial()].insert(pid);
+            particle_pool_[(*i).second.species()].erase((*i).first);
+            particle_pool_[p.species()].insert(pid);
         }
         this->update(i, std::make_pair(pid, p));
         return false;
     }
 
+    // the species must be in the pool before its index is taken for columns
+    particle_pool_[p.species()].insert(pid);
     this->update(std::make_pair(pid, p));
     // const bool succeeded(this->update(std::make_pair(pid, p)).second);
     // BOOST_ASSERT(succeeded);
-
-    particle_pool_[p.species_serial()].insert(pid);
     return true;
 }
 
@@ -81,7 +73,7 @@ void ParticleSpaceCellListImpl::remove_particle(const ParticleID& pid)
     //XXX: this remove_particle throws an error when no corresponding
     //XXX: particle is found.
     std::pair<ParticleID, Particle> pp(get_particle(pid)); //XXX: may raise an error.
-    particle_pool_[pp.second.species_serial()].erase(pid);
+    particle_pool_[pp.second.species()].erase(pid);
     this->erase(pid);
 }
 
@@ -97,7 +89,7 @@ Integer ParticleSpaceCellListImpl::num_particles(const Species& sp) const
     for (per_species_particle_id_set::const_iterator i(particle_pool_.begin());
         i != particle_pool_.end(); ++i)
     {
-        const Species tgt((*i).first);
+        const Species& tgt((*i).first);
         if (sexp.match(tgt))
         {
             retval += (*i).second.size();
@@ -108,7 +100,7 @@ Integer ParticleSpaceCellListImpl::num_particles(const Species& sp) const
 
 Integer ParticleSpaceCellListImpl::num_particles_exact(const Species& sp) const
 {
-    per_species_particle_id_set::const_iterator i(particle_pool_.find(sp.serial()));
+    per_species_particle_id_set::const_iterator i(particle_pool_.find(sp));
     if (i == particle_pool_.end())
     {
         return 0;
@@ -123,7 +115,7 @@ Integer ParticleSpaceCellListImpl::num_molecules(const Species& sp) const
     for (per_species_particle_id_set::const_iterator i(particle_pool_.begin());
         i != particle_pool_.end(); ++i)
     {
-        const Species tgt((*i).first);
+        const Species& tgt((*i).first);
         retval += sexp.count(tgt) * (*i).second.size();
     }
     return retval;
@@ -163,7 +155,7 @@ std::vector<std::pair<ParticleID, Particle> >
     std::vector<std::pair<ParticleID, Particle> > retval;
 
     // per_species_particle_id_set::const_iterator
-    //     i(particle_pool_.find(sp.serial()));
+    //     i(particle_pool_.find(sp));
     // if (i == particle_pool_.end())
     // {
     //     //XXX: In the original, this raises an error,
@@ -207,23 +199,16 @@ std::vector<std::pair<std::pair<ParticleID, Particle>, Real> >
             {
                 cell_index_type newidx(idx);
                 const Real3 stride(this->offset_index_cyclic(newidx, off));
-                const cell_type& c(this->cell(newidx));
+                const cell_type c(this->cell(newidx));
                 for (cell_type::const_iterator i(c.begin()); i != c.end(); ++i)
                 {
                     // neighbor_filter::operator()
-                    particle_container_type::const_iterator
-                        itr(particles_.begin() + (*i));
-                    // particle_container_type::const_iterator itr = particles_.begin();
-                    // std::advance(itr, *i);
-
-                    const Real dist(
-                        length((*itr).second.position() + stride - pos)
-                        - (*itr).second.radius());
+                    const Real dist(this->distance_at(*i, pos, stride));
                     if (dist < radius)
                     {
                         // overlap_checker::operator()
                         retval.push_back(
-                            std::make_pair(*itr, dist));
+                            std::make_pair(particles_[*i], dist));
                     }
                 }
             }
@@ -260,23 +245,18 @@ std::vector<std::pair<std::pair<ParticleID, Particle>, Real> >
             {
                 cell_index_type newidx(idx);
                 const Real3 stride(this->offset_index_cyclic(newidx, off));
-                const cell_type& c(this->cell(newidx));
+                const cell_type c(this->cell(newidx));
                 for (cell_type::const_iterator i(c.begin()); i != c.end(); ++i)
                 {
                     // neighbor_filter::operator()
-                    particle_container_type::const_iterator
-                        itr(particles_.begin() + (*i));
-
-                    const Real dist(
-                        length((*itr).second.position() + stride - pos)
-                        - (*itr).second.radius());
+                    const Real dist(this->distance_at(*i, pos, stride));
                     if (dist < radius)
                     {
                         // overlap_checker::operator()
-                        if ((*itr).first != ignore)
+                        const std::pair<ParticleID, Particle>& p(particles_[*i]);
+                        if (p.first != ignore)
                         {
-                            retval.push_back(
-                                std::make_pair(*itr, dist));
+                            retval.push_back(std::make_pair(p, dist));
                         }
                     }
                 }
@@ -314,23 +294,18 @@ std::vector<std::pair<std::pair<ParticleID, Particle>, Real> >
             {
                 cell_index_type newidx(idx);
                 const Real3 stride(this->offset_index_cyclic(newidx, off));
-                const cell_type& c(this->cell(newidx));
+                const cell_type c(this->cell(newidx));
                 for (cell_type::const_iterator i(c.begin()); i != c.end(); ++i)
                 {
                     // neighbor_filter::operator()
-                    particle_container_type::const_iterator
-                        itr(particles_.begin() + (*i));
-
-                    const Real dist(
-                        length((*itr).second.position() + stride - pos)
-                        - (*itr).second.radius());
+                    const Real dist(this->distance_at(*i, pos, stride));
                     if (dist < radius)
                     {
                         // overlap_checker::operator()
-                        if ((*itr).first != ignore1 && (*itr).first != ignore2)
+                        const std::pair<ParticleID, Particle>& p(particles_[*i]);
+                        if (p.first != ignore1 && p.first != ignore2)
                         {
-                            retval.push_back(
-                                std::make_pair(*itr, dist));
+                            retval.push_back(std::make_pair(p, dist));
                         }
                     }
                 }
@@ -2,9 +2,13 @@
 #define ECELL4_PARTICLE_SPACE_CELL_LIST_IMPL_HPP
 
 #include <set>
-#include <boost/multi_array.hpp>
+#include <algorithm>
+#include <boost/array.hpp>
+#include <boost/align/aligned_allocator.hpp>
 
 #include "ParticleSpace.hpp"
+#include "SpeciesIDMap.hpp"
+#include "PackedCellList.hpp"
 
 #ifdef WITH_HDF5
 #include "ParticleSpaceHDF5Writer.hpp"
@@ -28,50 +32,60 @@ public:
         key_to_value_map_type;
 
     typedef std::set<ParticleID> particle_id_set;
-    typedef std::map<Species::serial_type, particle_id_set> per_species_particle_id_set;
+    typedef SpeciesIDMap<particle_id_set> per_species_particle_id_set;
 
-    typedef std::vector<particle_container_type::size_type> cell_type; // sorted
-    typedef boost::multi_array<cell_type, 3> matrix_type;
-    typedef boost::array<matrix_type::size_type, 3> cell_index_type;
-    typedef boost::array<matrix_type::difference_type, 3> cell_offset_type;
+    typedef PackedCellList::cell_type cell_type;
+    typedef boost::array<std::size_t, 3> cell_index_type;
+    typedef boost::array<std::ptrdiff_t, 3> cell_offset_type;
+
+    // columns start at cache lines for loops over them to be vectorized
+    typedef std::vector<Real, boost::alignment::aligned_allocator<Real, 64> >
+        real_column_type;
+    typedef std::vector<std::size_t, boost::alignment::aligned_allocator<std::size_t, 64> >
+        index_column_type;
 
 public:
 
     ParticleSpaceCellListImpl(const Real3& edge_lengths)
-        : base_type(), edge_lengths_(edge_lengths), matrix_(boost::extents[3][3][3])
+        : base_type(), edge_lengths_(edge_lengths), cells_(3 * 3 * 3)
     {
-        cell_sizes_[0] = edge_lengths_[0] / matrix_.shape()[0];
-        cell_sizes_[1] = edge_lengths_[1] / matrix_.shape()[1];
-        cell_sizes_[2] = edge_lengths_[2] / matrix_.shape()[2];
+        matrix_sizes_[0] = 3;
+        matrix_sizes_[1] = 3;
+        matrix_sizes_[2] = 3;
+        cell_sizes_[0] = edge_lengths_[0] / matrix_sizes_[0];
+        cell_sizes_[1] = edge_lengths_[1] / matrix_sizes_[1];
+        cell_sizes_[2] = edge_lengths_[2] / matrix_sizes_[2];
     }
 
     ParticleSpaceCellListImpl(
         const Real3& edge_lengths, const Integer3& matrix_sizes)
         : base_type(), edge_lengths_(edge_lengths),
-        matrix_(boost::extents[matrix_sizes.col][matrix_sizes.row][matrix_sizes.layer])
+        cells_(matrix_sizes.col * matrix_sizes.row * matrix_sizes.layer)
     {
-        cell_sizes_[0] = edge_lengths_[0] / matrix_.shape()[0];
-        cell_sizes_[1] = edge_lengths_[1] / matrix_.shape()[1];
-        cell_sizes_[2] = edge_lengths_[2] / matrix_.shape()[2];
+        matrix_sizes_[0] = matrix_sizes.col;
+        matrix_sizes_[1] = matrix_sizes.row;
+        matrix_sizes_[2] = matrix_sizes.layer;
+        cell_sizes_[0] = edge_lengths_[0] / matrix_sizes_[0];
+        cell_sizes_[1] = edge_lengths_[1] / matrix_sizes_[1];
+        cell_sizes_[2] = edge_lengths_[2] / matrix_sizes_[2];
     }
 
     void diagnosis() const
     {
-        for (matrix_type::size_type i(0); i < matrix_.shape()[0]; ++i)
+        if (cells_.size() != particles_.size() || !cells_.check())
+        {
+            throw IllegalState("out of bounds.");
+        }
+        for (particle_container_type::size_type i(0); i < particles_.size(); ++i)
         {
-            for (matrix_type::size_type j(0); j < matrix_.shape()[1]; ++j)
+            const Particle& p(particles_[i].second);
+            if (coordinates_[0][i] != p.position()[0]
+                || coordinates_[1][i] != p.position()[1]
+                || coordinates_[2][i] != p.position()[2]
+                || radii_[i] != p.radius() || Ds_[i] != p.D()
+                || particle_pool_.begin()[species_indices_[i]].first != p.species())
             {
-                for (matrix_type::size_type k(0); k < matrix_.shape()[2]; ++k)
-                {
-                    const cell_type& c = matrix_[i][j][k];
-                    for (cell_type::const_iterator it(c.begin()); it != c.end(); ++it)
-                    {
-                        if (*it >= particles_.size())
-                        {
-                            throw IllegalState("out of bounds.");
-                        }
-                    }
-                }
+                throw IllegalState("columns are out of sync.");
             }
         }
     }
@@ -84,7 +98,7 @@ public:
     }
     virtual bool has_species(const Species& sp) const
     {
-        return (particle_pool_.find(sp.serial()) != particle_pool_.end());
+        return (particle_pool_.find(sp) != particle_pool_.end());
     }
 
     virtual std::vector<Species> list_species() const
@@ -93,8 +107,9 @@ public:
         for (per_species_particle_id_set::const_iterator
             i(particle_pool_.begin()); i != particle_pool_.end(); ++i)
         {
-            retval.push_back(Species((*i).first));
+            retval.push_back(Species((*i).first.serial()));
         }
+        std::sort(retval.begin(), retval.end());  // in the order of serials
         return retval;
     }
 
@@ -112,7 +127,33 @@ public:
 
     const Integer3 matrix_sizes() const
     {
-        return Integer3(matrix_.shape()[0], matrix_.shape()[1], matrix_.shape()[2]);
+        return Integer3(matrix_sizes_[0], matrix_sizes_[1], matrix_sizes_[2]);
+    }
+
+    /**
+     * return the index of the cell containing the given position.
+     */
+    cell_index_type cell_index(const Real3& pos) const
+    {
+        return index(pos);
+    }
+
+    /**
+     * return indices of particles in the cell, which point to particles().
+     * This is valid until a particle enters or leaves any cell.
+     */
+    cell_type cell_at(const cell_index_type& i) const
+    {
+        return cell(i);
+    }
+
+    /**
+     * return an iterator to the particle in particles(), or particles().end()
+     * if not found. This neither copies nor throws.
+     */
+    particle_container_type::const_iterator find_particle(const ParticleID& pid) const
+    {
+        return find(pid);
     }
 
     void reset(const Real3& edge_lengths);
@@ -124,6 +165,40 @@ public:
         return particles_;
     }
 
+    /**
+     * The particles are also stored in a structure of arrays, which is kept in
+     * the order of particles(). Indices in cell_at() point to them as well.
+     * Columns are reallocated when a particle is added or removed.
+     */
+    const real_column_type& coordinates(const Real3::size_type dim) const
+    {
+        return coordinates_[dim];
+    }
+
+    const real_column_type& radii() const
+    {
+        return radii_;
+    }
+
+    const real_column_type& Ds() const
+    {
+        return Ds_;
+    }
+
+    /**
+     * return species of particles as indices, which are dense in this space
+     * and never reused until reset. species_at() gives the Species back.
+     */
+    const index_column_type& species_indices() const
+    {
+        return species_indices_;
+    }
+
+    const Species& species_at(const std::size_t species_index) const
+    {
+        return particle_pool_.begin()[species_index].first;
+    }
+
     std::pair<ParticleID, Particle> get_particle(const ParticleID& pid) const;
     bool has_particle(const ParticleID& pid) const;
     void remove_particle(const ParticleID& pid);
@@ -177,13 +252,13 @@ protected:
     inline cell_index_type index(const Real3& pos) const
     {
         cell_index_type retval = {{
-            static_cast<matrix_type::size_type>(
-                pos[0] / cell_sizes_[0]) % matrix_.shape()[0],
-            static_cast<matrix_type::size_type>(
-                pos[1] / cell_sizes_[1]) % matrix_.shape()[1],
-            static_cast<matrix_type::size_type>(
-                pos[2] / cell_sizes_[2]) % matrix_.shape()[2]
-            }}; // boost::array<matrix_type::size_type, 3>
+            static_cast<std::size_t>(
+                pos[0] / cell_sizes_[0]) % matrix_sizes_[0],
+            static_cast<std::size_t>(
+                pos[1] / cell_sizes_[1]) % matrix_sizes_[1],
+            static_cast<std::size_t>(
+                pos[2] / cell_sizes_[2]) % matrix_sizes_[2]
+            }}; // boost::array<std::size_t, 3>
         return retval;
     }
 
@@ -193,20 +268,20 @@ protected:
         Real3 retval;
 
         if (o[0] < 0 &&
-            static_cast<matrix_type::size_type>(-o[0]) > i[0])
+            static_cast<std::size_t>(-o[0]) > i[0])
         {
-            matrix_type::size_type t(
-                (i[0] + matrix_.shape()[0] - (-o[0] % matrix_.shape()[0]))
-                % matrix_.shape()[0]);
-            retval[0] = (o[0] - static_cast<matrix_type::difference_type>(t - i[0]))
+            std::size_t t(
+                (i[0] + matrix_sizes_[0] - (-o[0] % matrix_sizes_[0]))
+                % matrix_sizes_[0]);
+            retval[0] = (o[0] - static_cast<std::ptrdiff_t>(t - i[0]))
                 * cell_sizes_[0];
             i[0] = t;
         }
-        else if (matrix_.shape()[0] - o[0] <= i[0])
+        else if (matrix_sizes_[0] - o[0] <= i[0])
         {
-            matrix_type::size_type
-                t((i[0] + (o[0] % matrix_.shape()[0])) % matrix_.shape()[0]);
-            retval[0] = (o[0] - static_cast<matrix_type::difference_type>(t - i[0]))
+            std::size_t
+                t((i[0] + (o[0] % matrix_sizes_[0])) % matrix_sizes_[0]);
+            retval[0] = (o[0] - static_cast<std::ptrdiff_t>(t - i[0]))
                 * cell_sizes_[0];
             i[0] = t;
         }
@@ -216,20 +291,20 @@ protected:
         }
 
         if (o[1] < 0 &&
-            static_cast<matrix_type::size_type>(-o[1]) > i[1])
+            static_cast<std::size_t>(-o[1]) > i[1])
         {
-            matrix_type::size_type t(
-                (i[1] + matrix_.shape()[1] - (-o[1] % matrix_.shape()[1]))
-                % matrix_.shape()[1]);
-            retval[1] = (o[1] - static_cast<matrix_type::difference_type>(t - i[1]))
+            std::size_t t(
+                (i[1] + matrix_sizes_[1] - (-o[1] % matrix_sizes_[1]))
+                % matrix_sizes_[1]);
+            retval[1] = (o[1] - static_cast<std::ptrdiff_t>(t - i[1]))
                 * cell_sizes_[1];
             i[1] = t;
         }
-        else if (matrix_.shape()[1] - o[1] <= i[1])
+        else if (matrix_sizes_[1] - o[1] <= i[1])
         {
-            matrix_type::size_type
-                t((i[1] + (o[1] % matrix_.shape()[1])) % matrix_.shape()[1]);
-            retval[1] = (o[1] - static_cast<matrix_type::difference_type>(t - i[1]))
+            std::size_t
+                t((i[1] + (o[1] % matrix_sizes_[1])) % matrix_sizes_[1]);
+            retval[1] = (o[1] - static_cast<std::ptrdiff_t>(t - i[1]))
                 * cell_sizes_[1];
             i[1] = t;
         }
@@ -239,20 +314,20 @@ protected:
         }
 
         if (o[2] < 0 &&
-            static_cast<matrix_type::size_type>(-o[2]) > i[2])
+            static_cast<std::size_t>(-o[2]) > i[2])
         {
-            matrix_type::size_type
-                t((i[2] + matrix_.shape()[2] - (-o[2] % matrix_.shape()[2]))
-                % matrix_.shape()[2]);
-            retval[2] = (o[2] - static_cast<matrix_type::difference_type>(t - i[2]))
+            std::size_t
+                t((i[2] + matrix_sizes_[2] - (-o[2] % matrix_sizes_[2]))
+                % matrix_sizes_[2]);
+            retval[2] = (o[2] - static_cast<std::ptrdiff_t>(t - i[2]))
                 * cell_sizes_[2];
             i[2] = t;
         }
-        else if (matrix_.shape()[2] - o[2] <= i[2])
+        else if (matrix_sizes_[2] - o[2] <= i[2])
         {
-            matrix_type::size_type t(
-                (i[2] + (o[2] % matrix_.shape()[2])) % matrix_.shape()[2]);
-            retval[2] = (o[2] - static_cast<matrix_type::difference_type>(t - i[2]))
+            std::size_t t(
+                (i[2] + (o[2] % matrix_sizes_[2])) % matrix_sizes_[2]);
+            retval[2] = (o[2] - static_cast<std::ptrdiff_t>(t - i[2]))
                 * cell_sizes_[2];
             i[2] = t;
         }
@@ -264,14 +339,63 @@ protected:
         return retval;
     }
 
-    inline const cell_type& cell(const cell_index_type& i) const
+    /**
+     * return the distance between pos and the surface of the i-th particle
+     * shifted by stride, only with its columns.
+     */
+    inline Real distance_at(
+        const particle_container_type::size_type i, const Real3& pos,
+        const Real3& stride) const
+    {
+        return std::sqrt(
+            pow_2(coordinates_[0][i] + stride[0] - pos[0])
+            + pow_2(coordinates_[1][i] + stride[1] - pos[1])
+            + pow_2(coordinates_[2][i] + stride[2] - pos[2]))
+            - radii_[i];
+    }
+
+    inline void set_columns(
+        const particle_container_type::size_type i, const Particle& p)
+    {
+        const Real3& pos(p.position());
+        coordinates_[0][i] = pos[0];
+        coordinates_[1][i] = pos[1];
+        coordinates_[2][i] = pos[2];
+        radii_[i] = p.radius();
+        Ds_[i] = p.D();
+        species_indices_[i] = particle_pool_.find(p.species()) - particle_pool_.begin();
+    }
+
+    inline void resize_columns(const particle_container_type::size_type size)
+    {
+        coordinates_[0].resize(size);
+        coordinates_[1].resize(size);
+        coordinates_[2].resize(size);
+        radii_.resize(size);
+        Ds_.resize(size);
+        species_indices_.resize(size);
+    }
+
+    inline void copy_columns(
+        const particle_container_type::size_type dst,
+        const particle_container_type::size_type src)
     {
-        return matrix_[i[0]][i[1]][i[2]];
+        coordinates_[0][dst] = coordinates_[0][src];
+        coordinates_[1][dst] = coordinates_[1][src];
+        coordinates_[2][dst] = coordinates_[2][src];
+        radii_[dst] = radii_[src];
+        Ds_[dst] = Ds_[src];
+        species_indices_[dst] = species_indices_[src];
     }
 
-    inline cell_type& cell(const cell_index_type& i)
+    inline std::size_t cell_id(const cell_index_type& i) const
     {
-        return matrix_[i[0]][i[1]][i[2]];
+        return (i[0] * matrix_sizes_[1] + i[1]) * matrix_sizes_[2] + i[2];
+    }
+
+    inline cell_type cell(const cell_index_type& i) const
+    {
+        return cells_.cell(cell_id(i));
     }
 
     inline particle_container_type::iterator find(const ParticleID& k)
@@ -298,96 +422,33 @@ protected:
         particle_container_type::iterator const& old_value,
         const std::pair<ParticleID, Particle>& v)
     {
-        cell_type* new_cell(&cell(index(v.second.position())));
-        cell_type* old_cell(0);
-
-        if (old_value != particles_.end())
-        {
-            old_cell = &cell(index((*old_value).second.position()));
-        }
-
-        if (new_cell == old_cell)
+        if (old_value == particles_.end())
         {
-            // reinterpret_cast<nonconst_value_type&>(*old_value) = v;
-            *old_value = v;
-            return old_value;
+            return update(v).first;
         }
-        else
-        {
-            particle_container_type::size_type idx(0);
 
-            if (old_cell)
-            {
-                // reinterpret_cast<nonconst_value_type&>(*old_value) = v;
-                *old_value = v;
-
-                cell_type::iterator
-                    i(find_in_cell(old_cell, old_value - particles_.begin()));
-                idx = *i;
-                erase_from_cell(old_cell, i);
-                push_into_cell(new_cell, idx);
-            }
-            else
-            {
-                idx = particles_.size();
-                particles_.push_back(v);
-                push_into_cell(new_cell, idx);
-                rmap_[v.first] = idx;
-            }
-            return particles_.begin() + idx;
-        }
+        *old_value = v;
+        cells_.move(old_value - particles_.begin(), cell_id(index(v.second.position())));
+        set_columns(old_value - particles_.begin(), v.second);
+        return old_value;
     }
 
     inline std::pair<particle_container_type::iterator, bool> update(
         const std::pair<ParticleID, Particle>& v)
     {
-        cell_type* new_cell(&cell(index(v.second.position())));
-        particle_container_type::iterator old_value(particles_.end());
-        cell_type* old_cell(0);
-
-        {
-            key_to_value_map_type::const_iterator i(rmap_.find(v.first));
-            if (i != rmap_.end())
-            {
-                old_value = particles_.begin() + (*i).second;
-                old_cell = &cell(index(old_value->second.position()));
-            }
-        }
-
-        if (new_cell == old_cell)
+        key_to_value_map_type::const_iterator i(rmap_.find(v.first));
+        if (i != rmap_.end())
         {
-            // reinterpret_cast<nonconst_value_type&>(*old_value) = v;
-            *old_value = v;
-            // return std::pair<particle_container_type::iterator, bool>(old_value, false);
-            return std::make_pair(old_value, false);
+            return std::make_pair(update(particles_.begin() + (*i).second, v), false);
         }
-        else
-        {
-            particle_container_type::size_type idx(0);
 
-            if (old_cell)
-            {
-                // reinterpret_cast<nonconst_value_type&>(*old_value) = v;
-                *old_value = v;
-
-                cell_type::iterator
-                    i(find_in_cell(old_cell, old_value - particles_.begin()));
-                idx = *i;
-                erase_from_cell(old_cell, i);
-                push_into_cell(new_cell, idx);
-                return std::pair<particle_container_type::iterator, bool>(
-                    particles_.begin() + idx, false);
-            }
-            else
-            {
-                idx = particles_.size();
-                particles_.push_back(v);
-                push_into_cell(new_cell, idx);
-                rmap_[v.first] = idx;
-                return std::pair<particle_container_type::iterator, bool>(
-                    particles_.begin() + idx, true);
-            }
-        }
+        const particle_container_type::size_type idx(particles_.size());
+        particles_.push_back(v);
+        cells_.push_back(cell_id(index(v.second.position())));
+        resize_columns(idx + 1);
+        set_columns(idx, v.second);
+        rmap_[v.first] = idx;
+        return std::make_pair(particles_.begin() + idx, true);
     }
 
     inline bool erase(particle_container_type::iterator const& i)
@@ -397,34 +458,20 @@ protected:
             return false;
         }
 
-        particle_container_type::size_type old_idx(i - particles_.begin());
-        cell_type& old_cell(cell(index((*i).second.position())));
-        const bool succeeded(erase_from_cell(&old_cell, old_idx));
-        if (!succeeded)
-        {
-            throw IllegalState("never get here");
-        }
-        // BOOST_ASSERT(succeeded);
+        const particle_container_type::size_type old_idx(i - particles_.begin());
+        cells_.erase(old_idx);  // the last index is renamed to old_idx
         rmap_.erase((*i).first);
 
-        particle_container_type::size_type const last_idx(particles_.size() - 1);
-
+        const particle_container_type::size_type last_idx(particles_.size() - 1);
         if (old_idx < last_idx)
         {
             const std::pair<ParticleID, Particle>& last(particles_[last_idx]);
-            cell_type& last_cell(cell(index(last.second.position())));
-            const bool tmp(erase_from_cell(&last_cell, last_idx));
-            if (!tmp)
-            {
-                throw IllegalState("never get here");
-            }
-            // BOOST_ASSERT(tmp);
-            push_into_cell(&last_cell, old_idx);
             rmap_[last.first] = old_idx;
-            // reinterpret_cast<nonconst_value_type&>(*i) = last;
             (*i) = last;
+            copy_columns(old_idx, last_idx);
         }
         particles_.pop_back();
+        resize_columns(last_idx);
         return true;
     }
 
@@ -438,57 +485,6 @@ protected:
         return erase(particles_.begin() + (*p).second);
     }
 
-    inline void erase_from_cell(cell_type* c, const cell_type::iterator& i)
-    {
-        c->erase(i);
-    }
-
-    inline cell_type::size_type erase_from_cell(
-        cell_type* c, const particle_container_type::size_type& v)
-    {
-        cell_type::iterator e(c->end());
-        std::pair<cell_type::iterator, cell_type::iterator>
-            i(std::equal_range(c->begin(), e, v));
-        const cell_type::size_type retval(i.second - i.first);
-        c->erase(i.first, i.second);
-        return retval;
-    }
-
-    inline void push_into_cell(
-        cell_type* c, const particle_container_type::size_type& v)
-    {
-        cell_type::iterator i(std::upper_bound(c->begin(), c->end(), v));
-        c->insert(i, v);
-    }
-
-    inline cell_type::iterator find_in_cell(
-        cell_type* c, const particle_container_type::size_type& v)
-    {
-        cell_type::iterator i(std::lower_bound(c->begin(), c->end(), v));
-        if (i != c->end() && *i == v)
-        {
-            return i;
-        }
-        else
-        {
-            return c->end();
-        }
-    }
-
-    inline cell_type::const_iterator find_in_cell(
-        cell_type* c, const particle_container_type::size_type& v) const
-    {
-        cell_type::iterator i(std::lower_bound(c->begin(), c->end(), v));
-        if (i != c->end() && *i == v)
-        {
-            return i;
-        }
-        else
-        {
-            return c->end();
-        }
-    }
-
 protected:
 
     Real3 edge_lengths_;
@@ -497,7 +493,14 @@ protected:
     key_to_value_map_type rmap_;
     per_species_particle_id_set particle_pool_;
 
-    matrix_type matrix_;
+    // columns in the order of particles_
+    real_column_type coordinates_[3];
+    real_column_type radii_;
+    real_column_type Ds_;
+    index_column_type species_indices_;  // positions in particle_pool_
+
+    boost::array<std::size_t, 3> matrix_sizes_;
+    PackedCellList cells_;
     Real3 cell_sizes_;
 };
 
@@ -1,6 +1,8 @@
 #include <boost/scoped_ptr.hpp>
 #include <gsl/gsl_rng.h>
 #include <sstream>
+#include <cmath>
+#include <limits>
 
 #include "RandomNumberGenerator.hpp"
 
@@ -11,6 +13,55 @@
 namespace ecell4
 {
 
+Integer RandomNumberGenerator::poisson(Real mean)
+{
+    if (!(mean > 0.0))
+    {
+        return 0;
+    }
+
+    if (mean < 10.0)
+    {
+        // multiply uniform numbers until the product falls below exp(-mean)
+        const Real threshold(std::exp(-mean));
+        Integer k(0);
+        Real prod(uniform(0.0, 1.0));
+        while (prod > threshold)
+        {
+            ++k;
+            prod *= uniform(0.0, 1.0);
+        }
+        return k;
+    }
+
+    // the transformed rejection with squeeze (PTRS) by W. Hormann (1993)
+    const Real slam(std::sqrt(mean)), loglam(std::log(mean));
+    const Real b(0.931 + 2.53 * slam);
+    const Real a(-0.059 + 0.02483 * b);
+    const Real invalpha(1.1239 + 1.1328 / (b - 3.4));
+    const Real vr(0.9277 - 3.6224 / (b - 2.0));
+    while (true)
+    {
+        const Real u(uniform(0.0, 1.0) - 0.5);
+        const Real v(uniform(0.0, 1.0));
+        const Real us(0.5 - std::fabs(u));
+        const Real k(std::floor((2.0 * a / us + b) * u + mean + 0.43));
+        if (us >= 0.07 && v <= vr)
+        {
+            return static_cast<Integer>(k);
+        }
+        if (k < 0.0 || (us < 0.013 && v > us))
+        {
+            continue;
+        }
+        if (std::log(v) + std::log(invalpha) - std::log(a / (us * us) + b)
+            <= -mean + k * loglam - std::lgamma(k + 1.0))
+        {
+            return static_cast<Integer>(k);
+        }
+    }
+}
+
 #ifdef WITH_HDF5
 void GSLRandomNumberGenerator::save(H5::H5Location* root) const
 {
@@ -101,6 +152,33 @@ Integer GSLRandomNumberGenerator::binomial(Real p, Integer n)
     return gsl_ran_binomial(rng_.get(), p, n);
 }
 
+Integer GSLRandomNumberGenerator::poisson(Real mean)
+{
+    return gsl_ran_poisson(rng_.get(), mean);
+}
+
+void GSLRandomNumberGenerator::fill_uniform(
+    Real* data, const std::size_t size, Real min, Real max)
+{
+    // the same sequence as uniform(), but without a virtual call for each
+    gsl_rng* const rng(rng_.get());
+    for (std::size_t i(0); i < size; ++i)
+    {
+        data[i] = gsl_rng_uniform(rng) * (max - min) + min;
+    }
+}
+
+void GSLRandomNumberGenerator::fill_gaussian(
+    Real* data, const std::size_t size, Real sigma, Real mean)
+{
+    // the same sequence as gaussian(), but without a virtual call for each
+    gsl_rng* const rng(rng_.get());
+    for (std::size_t i(0); i < size; ++i)
+    {
+        data[i] = gsl_ran_gaussian(rng, sigma) + mean;
+    }
+}
+
 Real3 GSLRandomNumberGenerator::direction3d(Real length)
 {
     double x, y, z;
@@ -118,4 +196,316 @@ void GSLRandomNumberGenerator::seed()
     gsl_rng_set(rng_.get(), unsigned(std::time(0)));
 }
 
+#ifdef WITH_HDF5
+void PhiloxRandomNumberGenerator::save(H5::H5Location* root) const
+{
+    using namespace H5;
+
+    boost::scoped_ptr<DataType> optype(new DataType(H5T_OPAQUE, 1));
+    hsize_t bufsize(sizeof(state_type));
+    DataSpace dataspace(1, &bufsize);
+    optype->setTag("PhiloxRandomNumberGenerator state type");
+    boost::scoped_ptr<DataSet> dataset(
+        new DataSet(root->createDataSet("rng", *optype, dataspace)));
+    dataset->write((const unsigned char*)(&state_), *optype);
+}
+
+void PhiloxRandomNumberGenerator::load(const H5::H5Location& root)
+{
+    using namespace H5;
+
+    const DataSet dataset(DataSet(root.openDataSet("rng")));
+    if (dataset.getSpace().getSimpleExtentNpoints() != sizeof(state_type))
+    {
+        throw IllegalState("The state is not of PhiloxRandomNumberGenerator.");
+    }
+    boost::scoped_ptr<DataType> optype(new DataType(H5T_OPAQUE, 1));
+    optype->setTag("PhiloxRandomNumberGenerator state type");
+    dataset.read((unsigned char*)(&state_), *optype);
+}
+
+void PhiloxRandomNumberGenerator::save(const std::string& filename) const
+{
+    boost::scoped_ptr<H5::H5File>
+        fout(new H5::H5File(filename.c_str(), H5F_ACC_TRUNC));
+    this->save(fout.get());
+    extras::save_version_information(fout.get(), std::string("ecell4-philox_rng-") + std::string(VERSION_INFO));
+}
+
+void PhiloxRandomNumberGenerator::load(const std::string& filename)
+{
+    boost::scoped_ptr<H5::H5File>
+        fin(new H5::H5File(filename.c_str(), H5F_ACC_RDONLY));
+    this->load(*fin);
+}
+#endif
+
+void PhiloxRandomNumberGenerator::generate(
+    const uint32_t key[2], const uint32_t counter[4], uint32_t out[4])
+{
+    const uint32_t M0(0xD2511F53), M1(0xCD9E8D57);
+    const uint32_t W0(0x9E3779B9), W1(0xBB67AE85);
+
+    uint32_t k0(key[0]), k1(key[1]);
+    uint32_t c0(counter[0]), c1(counter[1]), c2(counter[2]), c3(counter[3]);
+    for (unsigned int round(0); round < 10; ++round)
+    {
+        const uint64_t p0(static_cast<uint64_t>(M0) * c0);
+        const uint64_t p1(static_cast<uint64_t>(M1) * c2);
+        const uint32_t hi0(static_cast<uint32_t>(p0 >> 32)), lo0(static_cast<uint32_t>(p0));
+        const uint32_t hi1(static_cast<uint32_t>(p1 >> 32)), lo1(static_cast<uint32_t>(p1));
+        c0 = hi1 ^ c1 ^ k0;
+        c1 = lo1;
+        c2 = hi0 ^ c3 ^ k1;
+        c3 = lo0;
+        k0 += W0;
+        k1 += W1;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+/**
+ * the error of the Stirling approximation of log(k!), used by BTRD.
+ */
+static Real stirling_correction(const Integer k)
+{
+    static const Real table[] = {
+        0.08106146679532726, 0.04134069595540929, 0.02767792568499834,
+        0.02079067210376509, 0.01664469118982119, 0.01387612882307075,
+        0.01189670994589177, 0.01041126526197209, 0.009255462182712733,
+        0.008330563433362871};
+
+    if (k < 10)
+    {
+        return table[k];
+    }
+    const Real x(1.0 / (k + 1)), xsq(x * x);
+    return (1.0 / 12 - (1.0 / 360 - xsq / 1260) * xsq) * x;
+}
+
+Real PhiloxRandomNumberGenerator::random()
+{
+    return next_real();
+}
+
+Real PhiloxRandomNumberGenerator::uniform(Real min, Real max)
+{
+    return next_real() * (max - min) + min;
+}
+
+Integer PhiloxRandomNumberGenerator::uniform_int(Integer min, Integer max)
+{
+    if (max < min)
+    {
+        throw std::invalid_argument(
+            "the max value must be larger than the min value.");
+    }
+
+    // rejection sampling for an unbiased integer in [0, n)
+    const uint64_t n(static_cast<uint64_t>(max) - static_cast<uint64_t>(min) + 1);
+    if (n == 0)
+    {
+        return static_cast<Integer>((static_cast<uint64_t>(next()) << 32) | next());
+    }
+    const uint64_t limit(std::numeric_limits<uint64_t>::max() - std::numeric_limits<uint64_t>::max() % n);
+    uint64_t k;
+    do
+    {
+        k = (static_cast<uint64_t>(next()) << 32) | next();
+    } while (k >= limit);
+    return static_cast<Integer>(static_cast<uint64_t>(min) + k % n);
+}
+
+Real PhiloxRandomNumberGenerator::gaussian(Real sigma, Real mean)
+{
+    // Box-Muller transform. 1 - u is in (0, 1].
+    const Real r(std::sqrt(-2.0 * std::log(1.0 - next_real())));
+    return r * std::cos(2.0 * M_PI * next_real()) * sigma + mean;
+}
+
+Integer PhiloxRandomNumberGenerator::binomial(Real p, Integer n)
+{
+    // Draws depend only on the stream, unlike std::binomial_distribution,
+    // whose algorithm is up to the standard library.
+    if (n <= 0 || !(p > 0.0))
+    {
+        return 0;
+    }
+    else if (p >= 1.0)
+    {
+        return n;
+    }
+    else if (p > 0.5)
+    {
+        return n - binomial(1.0 - p, n);
+    }
+
+    const Real q(1.0 - p);
+    const Real r(p / q), nr((n + 1) * r);
+
+    if (n * p < 10.0)
+    {
+        // the inversion from k = 0
+        while (true)
+        {
+            Real u(next_real());
+            Real f(std::pow(q, static_cast<Real>(n)));
+            Integer k(0);
+            while (u > f && k < n)
+            {
+                u -= f;
+                ++k;
+                f *= nr / k - r;
+            }
+            if (u <= f)
+            {
+                return k;
+            }
+        }
+    }
+
+    // the transformed rejection with decomposition (BTRD) by W. Hormann (1993)
+    const Real npq(n * p * q), spq(std::sqrt(npq));
+    const Integer m(static_cast<Integer>(std::floor((n + 1) * p)));
+    const Real b(1.15 + 2.53 * spq);
+    const Real a(-0.0873 + 0.0248 * b + 0.01 * p);
+    const Real c(n * p + 0.5);
+    const Real alpha((2.83 + 5.1 / b) * spq);
+    const Real vr(0.92 - 4.2 / b), urvr(0.86 * vr);
+
+    while (true)
+    {
+        Real u, v(next_real());
+        if (v <= urvr)
+        {
+            u = v / vr - 0.43;
+            return static_cast<Integer>(std::floor((2.0 * a / (0.5 - std::fabs(u)) + b) * u + c));
+        }
+        if (v >= vr)
+        {
+            u = next_real() - 0.5;
+        }
+        else
+        {
+            u = v / vr - 0.93;
+            u = (u < 0.0 ? -0.5 : 0.5) - u;
+            v = next_real() * vr;
+        }
+
+        const Real us(0.5 - std::fabs(u));
+        const Real kr(std::floor((2.0 * a / us + b) * u + c));
+        if (kr < 0.0 || kr > n)
+        {
+            continue;
+        }
+        const Integer k(static_cast<Integer>(kr));
+        v *= alpha / (a / (us * us) + b);
+        const Integer km(k > m ? k - m : m - k);
+        if (km <= 15)
+        {
+            // the recursive evaluation of f(k) / f(m)
+            Real f(1.0);
+            for (Integer i(m + 1); i <= k; ++i)
+            {
+                f *= nr / i - r;
+            }
+            for (Integer i(k + 1); i <= m; ++i)
+            {
+                v *= nr / i - r;
+            }
+            if (v <= f)
+            {
+                return k;
+            }
+            continue;
+        }
+
+        // the squeeze with the normal approximation
+        v = std::log(v);
+        const Real rho((km / npq) * (((km / 3.0 + 0.625) * km + 1.0 / 6) / npq + 0.5));
+        const Real t(-0.5 * km * km / npq);
+        if (v < t - rho)
+        {
+            return k;
+        }
+        if (v > t + rho)
+        {
+            continue;
+        }
+
+        const Real nm(n - m + 1), nk(n - k + 1);
+        const Real h((m + 0.5) * std::log((m + 1) / (r * nm))
+            + stirling_correction(m) + stirling_correction(n - m));
+        if (v <= h + (n + 1) * std::log(nm / nk) + (k + 0.5) * std::log(nk * r / (k + 1))
+            - stirling_correction(k) - stirling_correction(n - k))
+        {
+            return k;
+        }
+    }
+}
+
+Integer PhiloxRandomNumberGenerator::poisson(Real mean)
+{
+    // the portable default built on uniform()
+    return RandomNumberGenerator::poisson(mean);
+}
+
+Real3 PhiloxRandomNumberGenerator::direction3d(Real length)
+{
+    const Real z(2.0 * next_real() - 1.0);
+    const Real phi(2.0 * M_PI * next_real());
+    const Real r(std::sqrt(1.0 - z * z) * length);
+    return Real3(r * std::cos(phi), r * std::sin(phi), z * length);
+}
+
+void PhiloxRandomNumberGenerator::fill_uniform(
+    Real* data, const std::size_t size, Real min, Real max)
+{
+    const Real width(max - min);
+    for (std::size_t i(0); i < size; ++i)
+    {
+        data[i] = next_real() * width + min;
+    }
+}
+
+void PhiloxRandomNumberGenerator::fill_gaussian(
+    Real* data, const std::size_t size, Real sigma, Real mean)
+{
+    // Box-Muller transform giving a pair at once
+    std::size_t i(0);
+    for (; i + 1 < size; i += 2)
+    {
+        const Real r(std::sqrt(-2.0 * std::log(1.0 - next_real())) * sigma);
+        const Real theta(2.0 * M_PI * next_real());
+        data[i] = r * std::cos(theta) + mean;
+        data[i + 1] = r * std::sin(theta) + mean;
+    }
+    if (i < size)
+    {
+        data[i] = gaussian(sigma, mean);
+    }
+}
+
+void PhiloxRandomNumberGenerator::seed(Integer val)
+{
+    state_.key[0] = static_cast<uint32_t>(val);
+    state_.key[1] = static_cast<uint32_t>(static_cast<uint64_t>(val) >> 32);
+    rewind();
+}
+
+Integer PhiloxRandomNumberGenerator::draw_key(RandomNumberGenerator& rng)
+{
+    const uint64_t high(static_cast<uint64_t>(rng.uniform_int(0, 0xffffffff)));
+    const uint64_t low(static_cast<uint64_t>(rng.uniform_int(0, 0xffffffff)));
+    return static_cast<Integer>((high << 32) | low);
+}
+
+void PhiloxRandomNumberGenerator::seed()
+{
+    seed(static_cast<Integer>(std::time(0)));
+}
+
 } // ecell4
@@ -3,6 +3,7 @@
 
 #include <ctime>
 #include <vector>
+#include <stdint.h>
 #include <boost/shared_ptr.hpp>
 #include <gsl/gsl_rng.h>
 #include <gsl/gsl_randist.h>
@@ -33,8 +34,39 @@ public:
     virtual Integer uniform_int(Integer min, Integer max) = 0;
     virtual Real gaussian(Real sigma, Real mean = 0.0) = 0;
     virtual Integer binomial(Real p, Integer n) = 0;
+
+    /**
+     * draw from the Poisson distribution with the given mean.
+     * the default is built on uniform(); an implementation may override it.
+     */
+    virtual Integer poisson(Real mean);
+
     virtual Real3 direction3d(Real length = 1.0) = 0;
 
+    /**
+     * fill the given array with uniform random numbers in [min, max).
+     * an implementation may override this to draw in bulk.
+     */
+    virtual void fill_uniform(Real* data, const std::size_t size, Real min = 0.0, Real max = 1.0)
+    {
+        for (std::size_t i(0); i < size; ++i)
+        {
+            data[i] = uniform(min, max);
+        }
+    }
+
+    /**
+     * fill the given array with normal random numbers.
+     * an implementation may override this to draw in bulk.
+     */
+    virtual void fill_gaussian(Real* data, const std::size_t size, Real sigma = 1.0, Real mean = 0.0)
+    {
+        for (std::size_t i(0); i < size; ++i)
+        {
+            data[i] = gaussian(sigma, mean);
+        }
+    }
+
     virtual void seed(Integer val) = 0;
     virtual void seed() = 0;
 
@@ -86,10 +118,14 @@ public:
     Integer uniform_int(Integer min, Integer max);
     Real gaussian(Real sigma, Real mean = 0.0);
     Integer binomial(Real p, Integer n);
+    Integer poisson(Real mean);
     Real3 direction3d(Real length);
     void seed(Integer val);
     void seed();
 
+    void fill_uniform(Real* data, const std::size_t size, Real min = 0.0, Real max = 1.0);
+    void fill_gaussian(Real* data, const std::size_t size, Real sigma = 1.0, Real mean = 0.0);
+
 #ifdef WITH_HDF5
     void save(H5::H5Location* root) const;
     void load(const H5::H5Location& root);
@@ -132,6 +168,154 @@ protected:
     rng_handle rng_;
 };
 
+/**
+ * A counter-based random number generator, Philox4x32-10, in
+ *     J. K. Salmon, M. A. Moraes, R. O. Dror, and D. E. Shaw,
+ *     Proc. SC'11, 16:1-16:12 (2011).
+ * The n-th output is a pure function of the key (seed), the stream and n,
+ * so that generators with the same seed but different streams give
+ * independent sequences, e.g. one for each thread, reproducibly.
+ * The whole state is a few words, and can be saved into HDF5.
+ */
+class PhiloxRandomNumberGenerator
+    : public RandomNumberGenerator
+{
+public:
+
+    typedef uint32_t value_type;
+
+    struct state_type
+    {
+        uint32_t key[2];
+        uint32_t counter[4];  // counter[0:2] for the position, and counter[2:4] for the stream
+        uint32_t buffer[4];
+        uint32_t index;  // the next position in buffer
+    };
+
+public:
+
+    Real random();
+    Real uniform(Real min, Real max);
+    Integer uniform_int(Integer min, Integer max);
+    Real gaussian(Real sigma, Real mean = 0.0);
+    Integer binomial(Real p, Integer n);
+    Integer poisson(Real mean);
+    Real3 direction3d(Real length);
+    void fill_uniform(Real* data, const std::size_t size, Real min = 0.0, Real max = 1.0);
+    void fill_gaussian(Real* data, const std::size_t size, Real sigma = 1.0, Real mean = 0.0);
+    void seed(Integer val);
+    void seed();
+
+#ifdef WITH_HDF5
+    void save(H5::H5Location* root) const;
+    void load(const H5::H5Location& root);
+    void save(const std::string& filename) const;
+    void load(const std::string& filename);
+#endif
+
+    PhiloxRandomNumberGenerator()
+    {
+        set_stream(0);
+        seed(0);
+    }
+
+    PhiloxRandomNumberGenerator(const Integer myseed, const Integer stream = 0)
+    {
+        set_stream(stream);
+        seed(myseed);
+    }
+
+    PhiloxRandomNumberGenerator(const std::string& filename)
+    {
+        set_stream(0);
+        seed(0);
+        load(filename);
+    }
+
+    /**
+     * return the stream id.
+     */
+    Integer stream() const
+    {
+        return static_cast<Integer>(
+            (static_cast<uint64_t>(state_.counter[3]) << 32) | state_.counter[2]);
+    }
+
+    /**
+     * return a generator with the same seed, but for another stream.
+     * it starts from the beginning of the stream.
+     */
+    PhiloxRandomNumberGenerator substream(const Integer stream) const
+    {
+        PhiloxRandomNumberGenerator retval(*this);
+        retval.set_stream(stream);
+        retval.rewind();
+        return retval;
+    }
+
+    const state_type& state() const
+    {
+        return state_;
+    }
+
+    /**
+     * draw a key (seed) from all the 64 bits with another generator,
+     * which may give only 32 bits at a time. Keys drawn for every step
+     * must be this wide for no two steps to share a key in practice.
+     */
+    static Integer draw_key(RandomNumberGenerator& rng);
+
+    /**
+     * draw 32 random bits.
+     */
+    inline value_type next()
+    {
+        if (state_.index == 4)
+        {
+            generate(state_.key, state_.counter, state_.buffer);
+            if (++state_.counter[0] == 0)
+            {
+                ++state_.counter[1];
+            }
+            state_.index = 0;
+        }
+        return state_.buffer[state_.index++];
+    }
+
+    /**
+     * the Philox4x32-10 bijection from a counter to random bits.
+     */
+    static void generate(const uint32_t key[2], const uint32_t counter[4], uint32_t out[4]);
+
+protected:
+
+    void set_stream(const Integer stream)
+    {
+        state_.counter[2] = static_cast<uint32_t>(stream);
+        state_.counter[3] = static_cast<uint32_t>(static_cast<uint64_t>(stream) >> 32);
+    }
+
+    void rewind()
+    {
+        state_.counter[0] = 0;
+        state_.counter[1] = 0;
+        state_.index = 4;
+    }
+
+    /**
+     * a uniform random number in [0, 1) with 53 bits.
+     */
+    inline Real next_real()
+    {
+        const uint32_t a(next() >> 5), b(next() >> 6);
+        return (a * 67108864.0 + b) * (1.0 / 9007199254740992.0);
+    }
+
+protected:
+
+    state_type state_;
+};
+
 } // ecell4
 
 #endif /* ECELL4_RANDOM_NUMBER_GENERATOR_HPP */
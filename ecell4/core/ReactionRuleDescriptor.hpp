@@ -32,12 +32,14 @@ public:
 public:
 
     ReactionRuleDescriptor(const coefficient_container_type &reactant_coefficients, const coefficient_container_type &product_coefficients)
-        : reactant_coefficients_(reactant_coefficients), product_coefficients_(product_coefficients)
+        : reactant_coefficients_(reactant_coefficients), product_coefficients_(product_coefficients),
+        revision_(0)
     {
         ;
     }
 
     ReactionRuleDescriptor()
+        : revision_(0)
     {
         ;
     }
@@ -65,6 +67,16 @@ public:
         return 0;
     }
 
+    /**
+     * return the number of changes made to the coefficients or parameters
+     * so far. A descriptor held by a model may be changed in place, which
+     * Model::revision does not count.
+     */
+    Integer revision() const
+    {
+        return revision_;
+    }
+
     // Accessor of coefficients;
     const coefficient_container_type &reactant_coefficients(void) const
     {
@@ -79,11 +91,13 @@ public:
     void resize_reactants(const std::size_t size)
     {
         this->reactant_coefficients_.resize(size, 1.0);
+        ++revision_;
     }
 
     void resize_products(const std::size_t size)
     {
         this->product_coefficients_.resize(size, 1.0);
+        ++revision_;
     }
 
     void set_reactant_coefficient(const std::size_t num, const Real new_coeff)
@@ -93,6 +107,7 @@ public:
             this->resize_reactants(num + 1);
         }
         this->reactant_coefficients_[num] = new_coeff;
+        ++revision_;
     }
 
     void set_product_coefficient(const std::size_t num, const Real new_coeff)
@@ -102,6 +117,7 @@ public:
             this->resize_products(num + 1);
         }
         this->product_coefficients_[num] = new_coeff;
+        ++revision_;
     }
 
     void set_reactant_coefficients(const coefficient_container_type &new_reactant_coefficients)
@@ -111,6 +127,7 @@ public:
         {
             this->reactant_coefficients_.push_back(new_reactant_coefficients[i]);
         }
+        ++revision_;
     }
 
     void set_product_coefficients(const coefficient_container_type &new_product_coefficients)
@@ -120,6 +137,7 @@ public:
         {
             this->product_coefficients_.push_back(new_product_coefficients[i]);
         }
+        ++revision_;
     }
 
     bool has_coefficients(void) const
@@ -131,6 +149,10 @@ private:
 
     coefficient_container_type reactant_coefficients_;
     coefficient_container_type product_coefficients_;
+
+protected:
+
+    Integer revision_;  // see revision()
 };
 
 class ReactionRuleDescriptorMassAction
@@ -185,11 +207,13 @@ public:
     void set_k(const Real k)
     {
         k_ = Quantity<Real>(k);
+        ++revision_;
     }
 
     void set_k(const Quantity<Real>& k)
     {
         k_ = k;
+        ++revision_;
     }
 
     virtual Real propensity(const state_container_type& reactants, const state_container_type& products, Real volume, Real t) const
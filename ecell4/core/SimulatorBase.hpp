@@ -6,6 +6,7 @@
 #include "Model.hpp"
 #include "Simulator.hpp"
 #include "EventScheduler.hpp"
+#include "EventPool.hpp"
 #include "observers.hpp"
 
 
@@ -192,14 +193,13 @@ public:
             (*i)->initialize(world_, model_);
         }
 
-        EventScheduler scheduler;
+        IntrusiveEventScheduler scheduler;
         // for (std::vector<boost::shared_ptr<Observer> >::const_iterator
         //     i(offset); i != observers.end(); ++i)
         for (std::vector<boost::shared_ptr<Observer> >::const_iterator
             i(observers.begin()); i != observers.end(); ++i)
         {
-            scheduler.add(boost::shared_ptr<Event>(
-                new ObserverEvent(this, (*i).get(), t())));
+            scheduler.add(event_pool_.create<ObserverEvent>(this, (*i).get(), t()));
         }
 
         while (true)
@@ -227,7 +227,7 @@ public:
                 {
                     running = false;
                 }
-                EventScheduler::value_type top(scheduler.pop());
+                IntrusiveEventScheduler::value_type top(scheduler.pop());
                 top.second->fire();
                 running = (
                     running && static_cast<ObserverEvent*>(top.second.get())->running());
@@ -258,6 +258,8 @@ protected:
     boost::shared_ptr<world_type> world_;
     boost::shared_ptr<model_type> model_;
     Integer num_steps_;
+
+    EventPool event_pool_;  // for the events of the simulator and observers
 };
 
 }
@@ -57,6 +57,15 @@ public:
         return create_simulator(w, m);
     }
 
+    /**
+     * return if the factory was given a random number generator, which is
+     * shared by all the worlds it creates.
+     */
+    virtual bool has_rng() const
+    {
+        return false;
+    }
+
     simulator_type* simulator(const boost::shared_ptr<world_type>& w) const
     {
         if (boost::shared_ptr<Model> bound_model = w->lock_model())
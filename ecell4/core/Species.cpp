@@ -1,25 +1,145 @@
 #include "Species.hpp"
 
 #include <algorithm>
+#include <mutex>
 
 
 namespace ecell4
 {
 
+namespace
+{
+
+/**
+ * the global table to intern serials. An empty serial is reserved for 0.
+ * Serials are only appended, and size is published after each append.
+ */
+struct species_intern_table
+{
+    species_intern_table()
+        : ids(), serials(1, ""), size(1)
+    {
+        ids.insert(std::make_pair(std::string(""), 0));
+    }
+
+    std::mutex mutex;
+    utils::get_mapper_mf<Species::serial_type, Species::id_type>::type ids;
+    std::vector<Species::serial_type> serials;
+    std::atomic<Species::id_type> size;
+};
+
+species_intern_table& get_species_intern_table()
+{
+    static species_intern_table table;
+    return table;
+}
+
+/**
+ * a copy of the global table for each thread. It is caught up with the
+ * table only when the table has grown, so that a lookup takes no lock.
+ */
+struct species_intern_mirror
+{
+    species_intern_mirror()
+        : ids(), size(0)
+    {
+        ;
+    }
+
+    utils::get_mapper_mf<Species::serial_type, Species::id_type>::type ids;
+    Species::id_type size;
+};
+
+} // anonymous
+
+const Species::id_type Species::uninterned;
+
+Species::id_type Species::intern() const
+{
+    id_type retval(id_.load(std::memory_order_relaxed));
+    if (retval == uninterned)
+    {
+        retval = intern(serial_);
+        id_.store(retval, std::memory_order_relaxed);
+    }
+    return retval;
+}
+
+Species::id_type Species::intern(const serial_type& serial)
+{
+    if (serial.empty())
+    {
+        return 0;
+    }
+
+    species_intern_table& table(get_species_intern_table());
+    std::lock_guard<std::mutex> lock(table.mutex);
+    const std::pair<utils::get_mapper_mf<serial_type, id_type>::type::iterator, bool>
+        retval(table.ids.insert(std::make_pair(serial, table.serials.size())));
+    if (retval.second)
+    {
+        table.serials.push_back(serial);
+        table.size.store(table.serials.size(), std::memory_order_release);
+    }
+    return (*retval.first).second;
+}
+
+Species::id_type Species::find_interned(const serial_type& serial)
+{
+    if (serial.empty())
+    {
+        return 0;
+    }
+
+    species_intern_table& table(get_species_intern_table());
+    static thread_local species_intern_mirror mirror;
+    if (mirror.size != table.size.load(std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> lock(table.mutex);
+        for (; mirror.size < table.serials.size(); ++mirror.size)
+        {
+            mirror.ids.insert(std::make_pair(table.serials[mirror.size], mirror.size));
+        }
+    }
+
+    const utils::get_mapper_mf<serial_type, id_type>::type::const_iterator
+        i(mirror.ids.find(serial));
+    return (i == mirror.ids.end() ? uninterned : (*i).second);
+}
+
+Species::serial_type Species::interned_serial(const id_type id)
+{
+    species_intern_table& table(get_species_intern_table());
+    std::lock_guard<std::mutex> lock(table.mutex);
+    if (id >= table.serials.size())
+    {
+        std::ostringstream message;
+        message << "Species id [" << id << "] not found";
+        throw NotFound(message.str());
+    }
+    return table.serials[id];
+}
+
+Species::id_type Species::num_interned()
+{
+    return get_species_intern_table().size.load(std::memory_order_acquire);
+}
+
 Species::Species()
-    : serial_(""), attributes_()
+    : serial_(""), id_(0), attributes_()
 {
     ; // do nothing
 }
 
 Species::Species(const serial_type& name)
-    : serial_(name), attributes_()
+    : serial_(name), id_(uninterned), attributes_()
 {
     ;
 }
 
 Species::Species(const Species& another)
-    : serial_(another.serial()), attributes_(another.attributes_)
+    : serial_(another.serial_), id_(another.id_.load(std::memory_order_relaxed)),
+    attributes_(another.attributes_)
 {
     ;
 }
@@ -27,6 +147,7 @@ Species::Species(const Species& another)
 Species& Species::operator=(const Species& another)
 {
     serial_ = another.serial_;
+    id_.store(another.id_.load(std::memory_order_relaxed), std::memory_order_relaxed);
     attributes_ = another.attributes_;
     return *this;
 }
@@ -34,7 +155,7 @@ Species& Species::operator=(const Species& another)
 Species::Species(
     const serial_type& name, const Real& radius, const Real& D,
     const std::string location, const Integer& dimension)
-    : serial_(name), attributes_()
+    : serial_(name), id_(uninterned), attributes_()
 {
     set_attribute("radius", radius);
     set_attribute("D", D);
@@ -45,7 +166,7 @@ Species::Species(
 Species::Species(
     const serial_type& name, const Quantity<Real>& radius, const Quantity<Real>& D,
     const std::string location, const Integer& dimension)
-    : serial_(name), attributes_()
+    : serial_(name), id_(uninterned), attributes_()
 {
     set_attribute("radius", radius);
     set_attribute("D", D);
@@ -53,19 +174,26 @@ Species::Species(
     set_attribute("dimension", dimension);
 }
 
-const Species::serial_type Species::serial() const
+const Species::serial_type& Species::serial() const
 {
     return serial_;
 }
 
 bool Species::operator==(const Species& rhs) const
 {
-    return (serial() == rhs.serial());
+    // compare ids only when both are interned, not to intern temporaries
+    const id_type lhs_id(id_.load(std::memory_order_relaxed));
+    const id_type rhs_id(rhs.id_.load(std::memory_order_relaxed));
+    if (lhs_id != uninterned && rhs_id != uninterned)
+    {
+        return (lhs_id == rhs_id);
+    }
+    return (serial_ == rhs.serial_);
 }
 
 bool Species::operator!=(const Species& rhs) const
 {
-    return (serial() != rhs.serial());
+    return !(*this == rhs);
 }
 
 bool Species::operator<(const Species& rhs) const
@@ -114,6 +242,7 @@ void Species::add_unit(const UnitSpecies& usp)
     {
         serial_ = usp.serial();
     }
+    id_.store(uninterned, std::memory_order_relaxed);
 }
 
 std::vector<std::pair<std::string, Species::attribute_type> > Species::list_attributes() const
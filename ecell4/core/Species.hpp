@@ -6,6 +6,7 @@
 #include <map>
 #include <sstream>
 #include <algorithm>
+#include <atomic>
 #include <boost/algorithm/string.hpp>
 #include <boost/variant.hpp>
 #include <boost/container/flat_map.hpp>
@@ -32,6 +33,19 @@ public:
     typedef UnitSpecies::serial_type serial_type; //XXX: std::string
     typedef std::vector<UnitSpecies> container_type;
 
+    /**
+     * a dense integer interned from a serial. Species with the same serial
+     * share the same id in a process, and an empty serial is always 0.
+     * An id is assigned only by intern(), which models and worlds call when
+     * a species is registered. Ids are not persistent, and must not be saved.
+     */
+    typedef std::size_t id_type;
+
+    /**
+     * the id of a serial which is not registered anywhere yet.
+     */
+    static const id_type uninterned = static_cast<id_type>(-1);
+
     typedef boost::variant<std::string, Quantity<Real>, Quantity<Integer>, bool> attribute_type;
 
 protected:
@@ -57,7 +71,52 @@ public:
     Species(const serial_type& name, const Quantity<Real>& radius, const Quantity<Real>& D,
             const std::string location = "", const Integer& dimension = 0);
 
-    const serial_type serial() const;
+    const serial_type& serial() const;
+
+    /**
+     * return the id of the serial without assigning a new one. It is
+     * uninterned if the serial has not been registered yet, and then the
+     * species is not a key of any table. A found id is cached.
+     */
+    id_type id() const
+    {
+        id_type retval(id_.load(std::memory_order_relaxed));
+        if (retval == uninterned)
+        {
+            retval = find_interned(serial_);
+            id_.store(retval, std::memory_order_relaxed);
+        }
+        return retval;
+    }
+
+    /**
+     * assign an id to the serial if not yet, and return it. This is called
+     * at registration, not on hot paths.
+     */
+    id_type intern() const;
+
+    /**
+     * return the id of the given serial, and assign a new one if not yet.
+     * This is thread-safe.
+     */
+    static id_type intern(const serial_type& serial);
+
+    /**
+     * return the id of the given serial, or uninterned. This is thread-safe,
+     * and takes no lock unless an id was assigned since the last call in
+     * the same thread.
+     */
+    static id_type find_interned(const serial_type& serial);
+
+    /**
+     * return the serial for the given id.
+     */
+    static serial_type interned_serial(const id_type id);
+
+    /**
+     * return the number of ids assigned so far. All ids are less than this.
+     */
+    static id_type num_interned();
 
     void add_unit(const UnitSpecies& usp);
     const std::vector<UnitSpecies> units() const;
@@ -114,6 +173,7 @@ public:
 protected:
 
     serial_type serial_;
+    mutable std::atomic<id_type> id_;  // uninterned until found or interned
     attributes_container_type attributes_;
 };
 
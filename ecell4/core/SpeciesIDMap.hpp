@@ -0,0 +1,216 @@
+#ifndef ECELL4_SPECIES_ID_MAP_HPP
+#define ECELL4_SPECIES_ID_MAP_HPP
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "Species.hpp"
+#include "get_mapper_mf.hpp"
+
+
+namespace ecell4
+{
+
+/**
+ * A map from Species to T_ keyed by the interned id of Species.
+ * Values are stored densely in a vector together with the key, and a lookup
+ * indexes a vector by the id to find the position without any hashing or
+ * string comparison. Inserting a key interns it. As ids are assigned only
+ * to registered species, the index stays as small as the registered ones.
+ * The iteration order is the order of insertion, not of serials.
+ */
+template <typename T_>
+class SpeciesIDMap
+{
+public:
+
+    typedef Species key_type;
+    typedef T_ mapped_type;
+    typedef std::pair<Species, T_> value_type;
+    typedef std::vector<value_type> container_type;
+    typedef typename container_type::size_type size_type;
+    typedef typename container_type::iterator iterator;
+    typedef typename container_type::const_iterator const_iterator;
+
+protected:
+
+    typedef std::vector<size_type> index_container_type;
+
+    static const size_type npos = static_cast<size_type>(-1);
+
+public:
+
+    SpeciesIDMap()
+        : index_(), values_()
+    {
+        ;
+    }
+
+    size_type size() const
+    {
+        return values_.size();
+    }
+
+    bool empty() const
+    {
+        return values_.empty();
+    }
+
+    void clear()
+    {
+        index_.clear();
+        values_.clear();
+    }
+
+    iterator begin()
+    {
+        return values_.begin();
+    }
+
+    iterator end()
+    {
+        return values_.end();
+    }
+
+    const_iterator begin() const
+    {
+        return values_.begin();
+    }
+
+    const_iterator end() const
+    {
+        return values_.end();
+    }
+
+    iterator find(const Species& sp)
+    {
+        const size_type i(position(sp.id()));
+        return (i == npos ? values_.end() : values_.begin() + i);
+    }
+
+    const_iterator find(const Species& sp) const
+    {
+        const size_type i(position(sp.id()));
+        return (i == npos ? values_.end() : values_.begin() + i);
+    }
+
+    size_type count(const Species& sp) const
+    {
+        return (position(sp.id()) == npos ? 0 : 1);
+    }
+
+    std::pair<iterator, bool> insert(const value_type& val)
+    {
+        const Species::id_type id(val.first.intern());
+        const size_type i(position(id));
+        if (i != npos)
+        {
+            return std::make_pair(values_.begin() + i, false);
+        }
+
+        add_index(id);
+        values_.push_back(val);
+        return std::make_pair(values_.end() - 1, true);
+    }
+
+    T_& operator[](const Species& sp)
+    {
+        const Species::id_type id(sp.intern());
+        const size_type i(position(id));
+        if (i != npos)
+        {
+            return values_[i].second;
+        }
+
+        add_index(id);
+        values_.push_back(std::make_pair(sp, T_()));
+        return values_.back().second;
+    }
+
+protected:
+
+    size_type position(const Species::id_type id) const
+    {
+        return (id < index_.size() ? index_[id] : npos);
+    }
+
+    void add_index(const Species::id_type id)
+    {
+        if (id >= index_.size())
+        {
+            index_.resize(id + 1, npos);
+        }
+        index_[id] = values_.size();
+    }
+
+protected:
+
+    index_container_type index_;  // from an id to the position in values_, or npos
+    container_type values_;
+};
+
+template <typename T_>
+const typename SpeciesIDMap<T_>::size_type SpeciesIDMap<T_>::npos;
+
+/**
+ * the ids of an unordered pair of Species, the smaller first.
+ */
+struct second_order_key_type
+{
+    Species::id_type first, second;
+
+    bool operator==(const second_order_key_type& rhs) const
+    {
+        return (first == rhs.first && second == rhs.second);
+    }
+
+    bool operator<(const second_order_key_type& rhs) const
+    {
+        return (first < rhs.first || (first == rhs.first && second < rhs.second));
+    }
+};
+
+inline second_order_key_type second_order_key(
+    const Species::id_type id1, const Species::id_type id2)
+{
+    const second_order_key_type retval = {std::min(id1, id2), std::max(id1, id2)};
+    return retval;
+}
+
+/**
+ * make the key of an unordered pair of Species. A pair with an uninterned
+ * species is not a key of any table.
+ */
+inline second_order_key_type second_order_key(const Species& sp1, const Species& sp2)
+{
+    return second_order_key(sp1.id(), sp2.id());
+}
+
+/**
+ * the same as second_order_key, but interns both species for registration.
+ */
+inline second_order_key_type intern_second_order_key(
+    const Species& sp1, const Species& sp2)
+{
+    return second_order_key(sp1.intern(), sp2.intern());
+}
+
+} // ecell4
+
+ECELL4_DEFINE_HASH_BEGIN()
+
+template<>
+struct hash<ecell4::second_order_key_type>
+{
+    std::size_t operator()(const ecell4::second_order_key_type& val) const
+    {
+        const std::size_t h(hash<ecell4::Species::id_type>()(val.first));
+        return h ^ (hash<ecell4::Species::id_type>()(val.second)
+            + 0x9e3779b9 + (h << 6) + (h >> 2));
+    }
+};
+
+ECELL4_DEFINE_HASH_END()
+
+#endif /* ECELL4_SPECIES_ID_MAP_HPP */
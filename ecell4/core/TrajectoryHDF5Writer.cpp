@@ -0,0 +1,262 @@
+#include "TrajectoryHDF5Writer.hpp"
+
+#ifdef WITH_HDF5
+
+#include <boost/scoped_array.hpp>
+
+#include "exceptions.hpp"
+
+
+namespace ecell4
+{
+
+namespace
+{
+
+H5::DSetCreatPropList create_property(
+    const int rank, const hsize_t* chunk, const int compression, const bool shuffle)
+{
+    H5::DSetCreatPropList prop;
+    prop.setChunk(rank, chunk);
+    if (shuffle)
+    {
+        prop.setShuffle();
+    }
+    if (compression > 0)
+    {
+        prop.setDeflate(compression);
+    }
+    return prop;
+}
+
+template <typename Troot_>
+H5::DataSet* create_dataset(
+    Troot_& root, const std::string& name, const H5::DataType& type,
+    const hsize_t chunk_size, const int compression, const bool shuffle)
+{
+    const hsize_t dims[] = {0};
+    const hsize_t maxdims[] = {H5S_UNLIMITED};
+    const hsize_t chunk[] = {chunk_size};
+    return new H5::DataSet(root.createDataSet(
+        name, type, H5::DataSpace(1, dims, maxdims),
+        create_property(1, chunk, compression, shuffle)));
+}
+
+hsize_t get_size(const H5::DataSet& dataset)
+{
+    hsize_t dims[] = {0};
+    dataset.getSpace().getSimpleExtentDims(dims);
+    return dims[0];
+}
+
+void append(H5::DataSet& dataset, const H5::DataType& type, const void* buf, const hsize_t n)
+{
+    if (n == 0)
+    {
+        return;
+    }
+
+    const hsize_t offset[] = {get_size(dataset)};
+    const hsize_t dims[] = {offset[0] + n};
+    const hsize_t count[] = {n};
+    dataset.extend(dims);
+
+    H5::DataSpace filespace(dataset.getSpace());
+    filespace.selectHyperslab(H5S_SELECT_SET, count, offset);
+    dataset.write(buf, type, H5::DataSpace(1, count), filespace);
+}
+
+} // anonymous
+
+TrajectoryHDF5Writer::TrajectoryHDF5Writer(
+    const std::string& filename, const bool append,
+    const hsize_t chunk_size, const int compression, const bool shuffle)
+    : filename_(filename), species_ids_(), num_frames_(0), num_particles_(0)
+{
+    if (chunk_size == 0)
+    {
+        throw IllegalArgument("A chunk size must be positive.");
+    }
+    if (compression < 0 || compression > 9)
+    {
+        throw IllegalArgument("A compression level must be in [0, 9].");
+    }
+
+    if (append)
+    {
+        H5E_auto2_t func;
+        void* client_data;
+        H5::Exception::getAutoPrint(func, &client_data);
+        H5::Exception::dontPrint();
+        try
+        {
+            file_.reset(new H5::H5File(filename_.c_str(), H5F_ACC_RDWR));
+        }
+        catch (H5::FileIException& err)
+        {
+            ;  // not exist yet
+        }
+        H5::Exception::setAutoPrint(func, client_data);
+    }
+
+    if (file_)
+    {
+        open();
+    }
+    else
+    {
+        file_.reset(new H5::H5File(filename_.c_str(), H5F_ACC_TRUNC));
+        create(chunk_size, compression, shuffle);
+    }
+}
+
+void TrajectoryHDF5Writer::create(
+    const hsize_t chunk_size, const int compression, const bool shuffle)
+{
+    species_.reset(create_dataset(
+        *file_, "species", get_species_comp_type(), 64, 0, false));
+
+    H5::Group frames(file_->createGroup("frames"));
+    const hsize_t frame_chunk(std::min<hsize_t>(chunk_size, 1024));
+    t_.reset(create_dataset(
+        frames, "t", H5::PredType::IEEE_F64LE, frame_chunk, compression, shuffle));
+    offset_.reset(create_dataset(
+        frames, "offset", H5::PredType::STD_U64LE, frame_chunk, compression, shuffle));
+    size_.reset(create_dataset(
+        frames, "size", H5::PredType::STD_U64LE, frame_chunk, compression, shuffle));
+
+    {
+        const hsize_t dims[] = {0, 0};
+        const hsize_t maxdims[] = {H5S_UNLIMITED, H5S_UNLIMITED};
+        const hsize_t chunk[] = {frame_chunk, 16};
+        counts_.reset(new H5::DataSet(frames.createDataSet(
+            "counts", H5::PredType::STD_U64LE, H5::DataSpace(2, dims, maxdims),
+            create_property(2, chunk, compression, shuffle))));
+    }
+
+    particles_.reset(create_dataset(
+        *file_, "particles", traits_type::get_particle_comp_type(),
+        chunk_size, compression, shuffle));
+}
+
+void TrajectoryHDF5Writer::open()
+{
+    H5E_auto2_t func;
+    void* client_data;
+    H5::Exception::getAutoPrint(func, &client_data);
+    H5::Exception::dontPrint();
+    try
+    {
+        species_.reset(new H5::DataSet(file_->openDataSet("species")));
+        t_.reset(new H5::DataSet(file_->openDataSet("frames/t")));
+        offset_.reset(new H5::DataSet(file_->openDataSet("frames/offset")));
+        size_.reset(new H5::DataSet(file_->openDataSet("frames/size")));
+        counts_.reset(new H5::DataSet(file_->openDataSet("frames/counts")));
+        particles_.reset(new H5::DataSet(file_->openDataSet("particles")));
+        H5::Exception::setAutoPrint(func, client_data);
+    }
+    catch (H5::Exception& err)
+    {
+        H5::Exception::setAutoPrint(func, client_data);
+        throw IllegalState(
+            "The file [" + filename_ + "] is not a trajectory to append to.");
+    }
+
+    const hsize_t num_species(get_size(*species_));
+    if (num_species > 0)
+    {
+        const H5::CompType type(get_species_comp_type());
+        const hsize_t dims[] = {num_species};
+        const H5::DataSpace space(1, dims);
+        boost::scoped_array<h5_species_struct>
+            h5_species_table(new h5_species_struct[num_species]);
+        species_->read(h5_species_table.get(), type, space);
+        for (hsize_t i(0); i < num_species; ++i)
+        {
+            species_ids_.insert(std::make_pair(
+                std::string(h5_species_table[i].serial), h5_species_table[i].id));
+        }
+        H5::DataSet::vlenReclaim(
+            type, space, H5::DSetMemXferPropList::DEFAULT, h5_species_table.get());
+    }
+
+    num_frames_ = get_size(*t_);
+    num_particles_ = get_size(*particles_);
+}
+
+uint32_t TrajectoryHDF5Writer::get_species_id(const Species::serial_type& serial)
+{
+    species_id_map_type::const_iterator itr(species_ids_.find(serial));
+    if (itr != species_ids_.end())
+    {
+        return (*itr).second;
+    }
+
+    h5_species_struct h5_species;
+    h5_species.id = species_ids_.size() + 1;
+    h5_species.serial = const_cast<char*>(serial.c_str());
+    append(*species_, get_species_comp_type(), &h5_species, 1);
+
+    species_ids_.insert(std::make_pair(serial, h5_species.id));
+    return h5_species.id;
+}
+
+void TrajectoryHDF5Writer::write(const Real t, const particle_container_type& particles)
+{
+    const hsize_t num_particles(particles.size());
+    std::vector<uint64_t> counts(species_ids_.size(), 0);
+
+    boost::scoped_array<h5_particle_struct>
+        h5_particle_table(new h5_particle_struct[num_particles]);
+    for (hsize_t i(0); i < num_particles; ++i)
+    {
+        const uint32_t sid(get_species_id(particles[i].second.species_serial()));
+        if (sid > counts.size())
+        {
+            counts.resize(sid, 0);
+        }
+        ++counts[sid - 1];
+
+        h5_particle_table[i].lot = particles[i].first.lot();
+        h5_particle_table[i].serial = particles[i].first.serial();
+        h5_particle_table[i].sid = sid;
+        h5_particle_table[i].posx = particles[i].second.position()[0];
+        h5_particle_table[i].posy = particles[i].second.position()[1];
+        h5_particle_table[i].posz = particles[i].second.position()[2];
+        h5_particle_table[i].radius = particles[i].second.radius();
+        h5_particle_table[i].D = particles[i].second.D();
+    }
+
+    append(*particles_, traits_type::get_particle_comp_type(),
+           h5_particle_table.get(), num_particles);
+
+    const double time(t);
+    const uint64_t offset(num_particles_), size(num_particles);
+    append(*t_, H5::PredType::NATIVE_DOUBLE, &time, 1);
+    append(*offset_, H5::PredType::NATIVE_UINT64, &offset, 1);
+    append(*size_, H5::PredType::NATIVE_UINT64, &size, 1);
+
+    {
+        hsize_t dims[] = {0, 0};
+        counts_->getSpace().getSimpleExtentDims(dims);
+        const hsize_t new_dims[] = {num_frames_ + 1, std::max<hsize_t>(dims[1], counts.size())};
+        counts_->extend(new_dims);
+
+        if (counts.size() > 0)
+        {
+            const hsize_t offset[] = {num_frames_, 0};
+            const hsize_t count[] = {1, counts.size()};
+            H5::DataSpace filespace(counts_->getSpace());
+            filespace.selectHyperslab(H5S_SELECT_SET, count, offset);
+            counts_->write(&counts[0], H5::PredType::NATIVE_UINT64,
+                           H5::DataSpace(2, count), filespace);
+        }
+    }
+
+    num_particles_ += num_particles;
+    ++num_frames_;
+}
+
+} // ecell4
+
+#endif // WITH_HDF5
@@ -0,0 +1,119 @@
+#ifndef ECELL4_TRAJECTORY_HDF5_WRITER_HPP
+#define ECELL4_TRAJECTORY_HDF5_WRITER_HPP
+
+#include <ecell4/core/config.h>
+
+#ifdef WITH_HDF5
+
+#include <boost/scoped_ptr.hpp>
+
+#include <hdf5.h>
+#include <H5Cpp.h>
+
+#include "types.hpp"
+#include "get_mapper_mf.hpp"
+#include "Species.hpp"
+#include "Particle.hpp"
+#include "ParticleSpaceHDF5Writer.hpp"
+
+
+namespace ecell4
+{
+
+/**
+ * A writer appending frames of particles to extendible, chunked datasets
+ * in a single HDF5 file, instead of saving the whole world to a file per
+ * frame. The file consists of:
+ *
+ *   /species            (id, serial) of species, growing as they appear;
+ *                       serials are variable-length strings, never truncated
+ *   /frames/t           the time of each frame
+ *   /frames/offset      the index of the first particle of each frame
+ *   /frames/size        the number of particles in each frame
+ *   /frames/counts      the number of particles of each species (frames x species)
+ *   /particles          particles of all frames in the format of save_particle_space
+ *
+ * Species ids start from 1 as save_particle_space. Datasets are compressed
+ * with gzip at the given level (0 for none) after the shuffle filter if
+ * requested. When appending, frames are added to an existing file written
+ * by this class.
+ */
+class TrajectoryHDF5Writer
+{
+public:
+
+    typedef ParticleSpaceHDF5Traits traits_type;
+    typedef traits_type::h5_particle_struct h5_particle_struct;
+
+    typedef struct h5_species_struct {
+        uint32_t id;
+        char* serial;
+    } h5_species_struct;
+
+    typedef std::vector<std::pair<ParticleID, Particle> >
+        particle_container_type;
+    typedef utils::get_mapper_mf<Species::serial_type, uint32_t>::type
+        species_id_map_type;
+
+public:
+
+    TrajectoryHDF5Writer(
+        const std::string& filename, const bool append = false,
+        const hsize_t chunk_size = 4096, const int compression = 0,
+        const bool shuffle = false);
+
+    ~TrajectoryHDF5Writer()
+    {
+        flush();
+    }
+
+    void write(const Real t, const particle_container_type& particles);
+
+    void flush()
+    {
+        file_->flush(H5F_SCOPE_LOCAL);
+    }
+
+    hsize_t num_frames() const
+    {
+        return num_frames_;
+    }
+
+    std::size_t num_species() const
+    {
+        return species_ids_.size();
+    }
+
+    static H5::CompType get_species_comp_type()
+    {
+        H5::CompType h5_species_comp_type(sizeof(h5_species_struct));
+        h5_species_comp_type.insertMember(
+            "id", HOFFSET(h5_species_struct, id), H5::PredType::STD_U32LE);
+        h5_species_comp_type.insertMember(
+            "serial", HOFFSET(h5_species_struct, serial),
+            H5::StrType(H5::PredType::C_S1, H5T_VARIABLE));
+        return h5_species_comp_type;
+    }
+
+protected:
+
+    void create(const hsize_t chunk_size, const int compression, const bool shuffle);
+    void open();
+
+    uint32_t get_species_id(const Species::serial_type& serial);
+
+protected:
+
+    const std::string filename_;
+    boost::scoped_ptr<H5::H5File> file_;
+    boost::scoped_ptr<H5::DataSet> species_, t_, offset_, size_, counts_, particles_;
+
+    species_id_map_type species_ids_;
+    hsize_t num_frames_, num_particles_;
+};
+
+} // ecell4
+
+#endif // WITH_HDF5
+
+#endif /* ECELL4_TRAJECTORY_HDF5_WRITER_HPP */
@@ -11,6 +11,7 @@
 // #include "Space.hpp"
 #include "Integer3.hpp"
 #include "get_mapper_mf.hpp"
+#include "SpeciesIDMap.hpp"
 #include "Context.hpp"
 
 #ifdef WITH_HDF5
@@ -52,11 +53,8 @@ public:
 
 protected:
 
-    typedef utils::get_mapper_mf<Species, boost::shared_ptr<VoxelPool> >::type
-            voxel_pool_map_type;
-
-    typedef utils::get_mapper_mf<Species, boost::shared_ptr<MoleculePool> >::type
-            molecule_pool_map_type;
+    typedef SpeciesIDMap<boost::shared_ptr<VoxelPool> > voxel_pool_map_type;
+    typedef SpeciesIDMap<boost::shared_ptr<MoleculePool> > molecule_pool_map_type;
 
 public:
 
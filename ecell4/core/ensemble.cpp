@@ -0,0 +1,47 @@
+#include "ensemble.hpp"
+
+#include <cstdlib>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+
+namespace ecell4
+{
+
+TemporaryFile::TemporaryFile()
+{
+#ifdef _WIN32
+    char path[MAX_PATH + 1], name[MAX_PATH + 1];
+    if (GetTempPathA(MAX_PATH + 1, path) == 0
+        || GetTempFileNameA(path, "e4", 0, name) == 0)
+    {
+        throw IllegalState("Failed to create a temporary file.");
+    }
+    filename_ = name;
+#else
+    const char* tmpdir(std::getenv("TMPDIR"));
+    std::string pattern(tmpdir != NULL && tmpdir[0] != '\0' ? tmpdir : "/tmp");
+    pattern += "/ecell4-XXXXXX";
+    std::vector<char> name(pattern.begin(), pattern.end());
+    name.push_back('\0');
+    const int fd(mkstemp(&name[0]));
+    if (fd == -1)
+    {
+        throw IllegalState("Failed to create a temporary file.");
+    }
+    close(fd);
+    filename_ = &name[0];
+#endif
+}
+
+TemporaryFile::~TemporaryFile()
+{
+    std::remove(filename_.c_str());
+}
+
+} // ecell4
@@ -0,0 +1,158 @@
+#ifndef ECELL4_ENSEMBLE_HPP
+#define ECELL4_ENSEMBLE_HPP
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include <mutex>
+#include <boost/shared_ptr.hpp>
+
+#include "types.hpp"
+#include "Real3.hpp"
+#include "Species.hpp"
+#include "Model.hpp"
+#include "exceptions.hpp"
+#include "extras.hpp"
+#include "parallel_for.hpp"
+#include <ecell4/core/config.h>
+
+
+namespace ecell4
+{
+
+/**
+ * return the number of time points logged by run_ensemble,
+ * which are t0, t0 + dt, ..., and t0 + duration as FixedIntervalNumberObserver.
+ */
+inline std::size_t num_ensemble_times(const Real duration, const Real dt)
+{
+    if (!(dt > 0.0) || duration < 0.0)
+    {
+        throw IllegalArgument("The duration and interval must be positive.");
+    }
+    const std::size_t num_intervals(static_cast<std::size_t>(std::ceil(duration / dt - 1e-10)));
+    return num_intervals + 1;
+}
+
+/**
+ * a file with a unique name in the temporary directory, which is removed
+ * when this object is destroyed.
+ */
+class TemporaryFile
+{
+public:
+
+    TemporaryFile();
+    ~TemporaryFile();
+
+    const std::string& filename() const
+    {
+        return filename_;
+    }
+
+private:
+
+    TemporaryFile(const TemporaryFile&);
+    TemporaryFile& operator=(const TemporaryFile&);
+
+    std::string filename_;
+};
+
+/**
+ * run independent replicates of a stochastic simulation in parallel, and
+ * write the numbers of molecules at fixed intervals into the given array.
+ *
+ * The given world is saved once, and each replicate creates its own world
+ * with the factory, loads the saved state into it, binds it to the model,
+ * and reseeds its random number generator with seeds[i]. Thus, particles,
+ * structures and subvolumes are copied as they are, and the result does
+ * not depend on the number of threads. This requires HDF5, and the save
+ * and the loads hold extras::hdf5_mutex() against other threads calling
+ * HDF5, e.g. observers writing in the background. A factory given
+ * a random number generator, which would be shared by all the replicates,
+ * is rejected when more than one thread is used.
+ *
+ * data must be allocated for seeds.size() * num_ensemble_times(duration, dt)
+ * * (species.size() + 1) elements. data[i][k][0] is the k-th time, and
+ * data[i][k][j + 1] is the value of species[j] in the i-th replicate.
+ * num_threads = 0 means the number of hardware threads.
+ */
+template <typename Tfactory_>
+void run_ensemble(
+    const Tfactory_& factory, const boost::shared_ptr<Model>& model,
+    const boost::shared_ptr<typename Tfactory_::world_type>& world,
+    const std::vector<Integer>& seeds, const Real duration, const Real dt,
+    const std::vector<std::string>& species, Real* data,
+    std::size_t num_threads = 0)
+{
+#ifdef WITH_HDF5
+    typedef typename Tfactory_::world_type world_type;
+    typedef typename Tfactory_::simulator_type simulator_type;
+
+    const std::size_t num_times(num_ensemble_times(duration, dt));
+    const std::size_t num_columns(species.size() + 1);
+    const std::size_t num_replicates(seeds.size());
+
+    num_threads = std::min(resolve_num_threads(num_threads), num_replicates);
+    if (num_threads > 1 && factory.has_rng())
+    {
+        throw IllegalArgument(
+            "The factory must not be given a random number generator"
+            " to run replicates in parallel.");
+    }
+
+    const Real t0(world->t());
+    const Real3 edge_lengths(world->edge_lengths());
+
+    std::vector<Species> targets;
+    targets.reserve(species.size());
+    for (std::vector<std::string>::const_iterator i(species.begin());
+        i != species.end(); ++i)
+    {
+        targets.push_back(Species(*i));
+    }
+
+    const TemporaryFile initial;
+    {
+        std::lock_guard<std::mutex> lock(extras::hdf5_mutex());
+        world->save(initial.filename());
+    }
+
+    parallel_for(num_replicates, num_threads,
+        [&](const std::size_t i)
+        {
+            boost::shared_ptr<world_type> w(factory.world(edge_lengths));
+            {
+                std::lock_guard<std::mutex> lock(extras::hdf5_mutex());
+                w->load(initial.filename());
+            }
+            w->bind_to(model);
+            w->rng()->seed(seeds[i]);
+
+            boost::shared_ptr<simulator_type> sim(factory.simulator(w, model));
+
+            Real* row(data + i * num_times * num_columns);
+            for (std::size_t k(0); k < num_times; ++k, row += num_columns)
+            {
+                const Real tk(k + 1 == num_times ? t0 + duration : t0 + dt * k);
+                while (sim->step(tk))
+                {
+                    ; // do nothing
+                }
+
+                row[0] = w->t();
+                for (std::size_t j(0); j < targets.size(); ++j)
+                {
+                    row[j + 1] = w->get_value(targets[j]);
+                }
+            }
+        });
+#else
+    throw NotSupported("run_ensemble requires HDF5 to copy the world.");
+#endif
+}
+
+} // ecell4
+
+#endif /* ECELL4_ENSEMBLE_HPP */
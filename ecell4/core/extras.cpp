@@ -84,6 +84,12 @@ std::string load_version_information(const std::string& filename)
 #endif
 }
 
+std::mutex& hdf5_mutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
 template <typename T>
 T mystoi(const std::string& s)
 {
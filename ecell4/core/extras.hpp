@@ -1,6 +1,7 @@
 #ifndef ECELL4_EXTRAS_HPP
 #define ECELL4_EXTRAS_HPP
 
+#include <mutex>
 #include <boost/shared_ptr.hpp>
 #include <boost/scoped_ptr.hpp>
 
@@ -123,6 +124,13 @@ std::string load_version_information(const H5::H5Location& root);
 #endif
 std::string load_version_information(const std::string& filename);
 
+/**
+ * a lock for calls to HDF5 from more than one thread in the process, e.g.
+ * observers writing in the background or replicates loading a world.
+ * HDF5 is usually not built thread-safe.
+ */
+std::mutex& hdf5_mutex();
+
 std::vector<std::vector<Real> > get_stoichiometry(
     const std::vector<Species>& species_list, const std::vector<ReactionRule>& reaction_rules);
 
@@ -46,6 +46,28 @@ inline double modulo(const double& p1, const double& p2)
     return r;
 }
 
+/**
+ * fold n values into [0, L) in place under the periodic boundary.
+ * Values within one period from the range are folded in a loop without
+ * branches, which compilers can vectorize. The rest, e.g. after a gaussian
+ * step longer than L, are rare, and folded with modulo afterwards.
+ */
+inline void fold_periodic(Real* x, const std::size_t n, const Real L)
+{
+    for (std::size_t i(0); i < n; ++i)
+    {
+        const Real v(x[i]);
+        x[i] = v + (v < 0 ? L : 0) - (v >= L ? L : 0);
+    }
+    for (std::size_t i(0); i < n; ++i)
+    {
+        if (x[i] < 0 || x[i] >= L)
+        {
+            x[i] = modulo(x[i], L);
+        }
+    }
+}
+
 inline int64_t abs(const int64_t& x)
 {
     return (x > 0 ? x : -x);
@@ -0,0 +1,80 @@
+#ifndef ECELL4_CORE_HOLD_MODEL_HPP
+#define ECELL4_CORE_HOLD_MODEL_HPP
+
+#include <vector>
+#include <chrono>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/exponential_distribution.hpp>
+
+#include "EventScheduler.hpp"
+
+namespace ecell4
+{
+
+struct HoldEvent
+    : public Event
+{
+    HoldEvent(const Real time, const std::size_t slot)
+        : Event(time), slot(slot)
+    {
+        ;
+    }
+
+    void set_time(const Real time)
+    {
+        time_ = time;
+    }
+
+    std::size_t slot;
+};
+
+/**
+ * the classic hold model: pop the earliest event and schedule it again
+ * later, with some events rescheduled in between like domains in eGFRD.
+ * return the sum of the popped times, and the seconds taken by the steps
+ * in elapsed if given.
+ */
+template <typename Tscheduler_>
+Real hold(Tscheduler_& scheduler, const std::size_t num_events, const std::size_t num_steps,
+    double* elapsed = NULL)
+{
+    typedef typename Tscheduler_::identifier_type identifier_type;
+
+    boost::mt19937 rng(0);
+    boost::exponential_distribution<Real> dist(1.0);
+
+    std::vector<identifier_type> ids;
+    for (std::size_t i(0); i < num_events; ++i)
+    {
+        ids.push_back(scheduler.add(boost::shared_ptr<Event>(new HoldEvent(dist(rng), i))));
+    }
+
+    const std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+    Real sum(0.0);
+    for (std::size_t i(0); i < num_steps; ++i)
+    {
+        typename Tscheduler_::value_type top(scheduler.pop());
+        sum += top.second->time();
+        HoldEvent* const event(static_cast<HoldEvent*>(top.second.get()));
+        event->set_time(scheduler.time() + dist(rng));
+        ids[event->slot] = scheduler.add(top.second);
+
+        if (i % 4 == 0)
+        {
+            const identifier_type id(ids[rng() % num_events]);
+            boost::shared_ptr<Event> other(scheduler.get(id));
+            static_cast<HoldEvent*>(other.get())->set_time(scheduler.time() + dist(rng));
+            scheduler.update(std::make_pair(id, other));
+        }
+    }
+    if (elapsed != NULL)
+    {
+        *elapsed = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+    return sum;
+}
+
+} // ecell4
+
+#endif /* ECELL4_CORE_HOLD_MODEL_HPP */
@@ -1,4 +1,8 @@
 #include "observers.hpp"
+#include "TrajectoryHDF5Writer.hpp"
+#include "extras.hpp"
+
+#include <mutex>
 
 
 namespace ecell4
@@ -128,6 +132,18 @@ void NumberLogger::save(const std::string& filename) const
     ofs.close();
 }
 
+void NumberLogger::copy_data(Real* buffer) const
+{
+    const std::size_t num_cols(num_columns());
+    for (data_container_type::const_iterator i(data.begin());
+        i != data.end(); ++i, buffer += num_cols)
+    {
+        const std::size_t n(std::min((*i).size(), num_cols));
+        std::copy((*i).begin(), (*i).begin() + n, buffer);
+        std::fill(buffer + n, buffer + num_cols, 0.0);
+    }
+}
+
 void reserve_species_list(
     NumberLogger& logger, const boost::shared_ptr<WorldInterface>& world, const boost::shared_ptr<Model>& model)
 {
@@ -305,7 +321,10 @@ bool FixedIntervalHDF5Observer::fire(const Simulator* sim, const boost::shared_p
         throw NotFound("The output path does not exists.");
     }
 
-    world->save(filename());
+    {
+        std::lock_guard<std::mutex> lock(extras::hdf5_mutex());
+        world->save(filename());
+    }
 
     return base_type::fire(sim, world);
 }
@@ -324,10 +343,241 @@ const std::string FixedIntervalHDF5Observer::filename(const Integer idx) const
     }
 }
 
+namespace
+{
+
+boost::shared_ptr<AsyncWriter> create_async_writer(const Integer capacity)
+{
+    if (capacity <= 0)
+    {
+        return boost::shared_ptr<AsyncWriter>();
+    }
+    return boost::shared_ptr<AsyncWriter>(new AsyncWriter(capacity));
+}
+
+/**
+ * wait for all the frames written, and release the thread.
+ */
+void release_async_writer(boost::shared_ptr<AsyncWriter>& async)
+{
+    if (!async)
+    {
+        return;
+    }
+
+    const boost::shared_ptr<AsyncWriter> tmp(async);
+    async.reset();
+    tmp->wait();  // rethrow an error in writing if any
+}
+
+void save_positions(
+    const boost::shared_ptr<AsyncWriter>& async, PositionLogger& logger,
+    const std::string& filename, const boost::shared_ptr<WorldInterface>& world)
+{
+    if (!is_directory(filename))
+    {
+        throw NotFound("The output path does not exists.");
+    }
+
+    if (!async)
+    {
+        std::ofstream ofs(filename.c_str(), std::ios::out);
+        logger.save(ofs, world);
+        ofs.close();
+        return;
+    }
+
+    const boost::shared_ptr<const PositionLogger::frame_type>
+        frame(new PositionLogger::frame_type(logger.snapshot(world)));
+    PositionLogger* const ptr(&logger);
+    async->push([ptr, filename, frame]()
+        {
+            std::ofstream ofs(filename.c_str(), std::ios::out);
+            ptr->write(ofs, *frame);
+            ofs.close();
+        });
+}
+
+/**
+ * run a task calling HDF5 on the thread of async, or here without it.
+ */
+void run_hdf5_task(
+    const boost::shared_ptr<AsyncWriter>& async, const std::function<void()>& task)
+{
+    const std::function<void()> locked([task]()
+        {
+            std::lock_guard<std::mutex> lock(extras::hdf5_mutex());
+            task();
+        });
+
+    if (async)
+    {
+        async->push(locked);
+    }
+    else
+    {
+        locked();
+    }
+}
+
+} // anonymous
+
+void FixedIntervalHDF5TrajectoryObserver::initialize(const boost::shared_ptr<WorldInterface>& world, const boost::shared_ptr<Model>& model)
+{
+#ifdef WITH_HDF5
+    if (!is_directory(filename_))
+    {
+        throw NotFound("The output path does not exists.");
+    }
+
+    // append frames to the file written in the last run
+    const bool append(append_ || count() > 0);
+    base_type::initialize(world, model);
+
+    close();
+    async_ = create_async_writer(async_capacity_);
+
+    const boost::shared_ptr<writer_slot_type> writer(new writer_slot_type());
+    const std::string filename(filename_);
+    const Integer chunk_size(chunk_size_), compression(compression_);
+    const bool shuffle(shuffle_);
+    run_hdf5_task(async_, [writer, filename, append, chunk_size, compression, shuffle]()
+        {
+            writer->reset(new TrajectoryHDF5Writer(
+                filename, append, chunk_size, compression, shuffle));
+        });
+    writer_ = writer;
+#else
+    throw NotSupported(
+        "This method requires HDF5. The HDF5 support is turned off.");
+#endif
+}
+
+void FixedIntervalHDF5TrajectoryObserver::finalize(const boost::shared_ptr<WorldInterface>& world)
+{
+    close();
+    base_type::finalize(world);
+}
+
+void FixedIntervalHDF5TrajectoryObserver::close()
+{
+    if (writer_)
+    {
+        const boost::shared_ptr<writer_slot_type> writer(writer_);
+        writer_.reset();
+        run_hdf5_task(async_, [writer]() { writer->reset(); });  // flush and close
+    }
+    release_async_writer(async_);
+}
+
+bool FixedIntervalHDF5TrajectoryObserver::fire(const Simulator* sim, const boost::shared_ptr<WorldInterface>& world)
+{
+    log(world);
+    return base_type::fire(sim, world);
+}
+
+void FixedIntervalHDF5TrajectoryObserver::log(const boost::shared_ptr<WorldInterface>& world)
+{
+#ifdef WITH_HDF5
+    if (!writer_)
+    {
+        throw IllegalState("The observer is not initialized.");
+    }
+
+    const boost::shared_ptr<TrajectoryHDF5Writer::particle_container_type>
+        particles(new TrajectoryHDF5Writer::particle_container_type());
+    if (species_.size() == 0)
+    {
+        *particles = world->list_particles();
+    }
+    else
+    {
+        for (std::vector<std::string>::const_iterator i(species_.begin());
+            i != species_.end(); ++i)
+        {
+            const Species sp(*i);
+            TrajectoryHDF5Writer::particle_container_type tmp(world->list_particles(sp));
+            for (TrajectoryHDF5Writer::particle_container_type::iterator j(tmp.begin());
+                j != tmp.end(); ++j)
+            {
+                (*j).second.species() = sp;  // labeled with the given species as PositionLogger
+            }
+            particles->insert(particles->end(), tmp.begin(), tmp.end());
+        }
+    }
+
+    const boost::shared_ptr<writer_slot_type> writer(writer_);
+    const Real t(world->t());
+    const Integer flush_interval(flush_interval_);
+    run_hdf5_task(async_, [writer, t, particles, flush_interval]()
+        {
+            (*writer)->write(t, *particles);
+            if (flush_interval > 0 && (*writer)->num_frames() % flush_interval == 0)
+            {
+                (*writer)->flush();
+            }
+        });
+#endif
+}
+
+void FixedIntervalHDF5TrajectoryObserver::reset()
+{
+    close();
+    base_type::reset();
+}
+
+void FixedIntervalHDF5TrajectoryObserver::set_append(const bool append)
+{
+    append_ = append;
+}
+
+void FixedIntervalHDF5TrajectoryObserver::set_chunk_size(const Integer chunk_size)
+{
+    if (chunk_size <= 0)
+    {
+        throw std::invalid_argument("A chunk size must be positive.");
+    }
+    chunk_size_ = chunk_size;
+}
+
+void FixedIntervalHDF5TrajectoryObserver::set_compression(const Integer level)
+{
+    if (level < 0 || level > 9)
+    {
+        throw std::invalid_argument("A compression level must be in [0, 9].");
+    }
+    compression_ = level;
+}
+
+void FixedIntervalHDF5TrajectoryObserver::set_shuffle(const bool shuffle)
+{
+    shuffle_ = shuffle;
+}
+
+void FixedIntervalHDF5TrajectoryObserver::set_flush_interval(const Integer interval)
+{
+    if (interval < 0)
+    {
+        throw std::invalid_argument("A flush interval must not be negative.");
+    }
+    flush_interval_ = interval;
+}
+
+void FixedIntervalHDF5TrajectoryObserver::set_async(const Integer capacity)
+{
+    if (capacity < 0)
+    {
+        throw std::invalid_argument("A capacity must not be negative.");
+    }
+    async_capacity_ = capacity;
+}
+
 void FixedIntervalCSVObserver::initialize(const boost::shared_ptr<WorldInterface>& world, const boost::shared_ptr<Model>& model)
 {
     base_type::initialize(world, model);
+    release_async_writer(async_);
     logger_.initialize();
+    async_ = create_async_writer(async_capacity_);
 }
 
 bool FixedIntervalCSVObserver::fire(const Simulator* sim, const boost::shared_ptr<WorldInterface>& world)
@@ -336,16 +586,15 @@ bool FixedIntervalCSVObserver::fire(const Simulator* sim, const boost::shared_pt
     return base_type::fire(sim, world);
 }
 
-void FixedIntervalCSVObserver::log(const boost::shared_ptr<WorldInterface>& world)
+void FixedIntervalCSVObserver::finalize(const boost::shared_ptr<WorldInterface>& world)
 {
-    if (!is_directory(filename()))
-    {
-        throw NotFound("The output path does not exists.");
-    }
+    release_async_writer(async_);
+    base_type::finalize(world);
+}
 
-    std::ofstream ofs(filename().c_str(), std::ios::out);
-    logger_.save(ofs, world);
-    ofs.close();
+void FixedIntervalCSVObserver::log(const boost::shared_ptr<WorldInterface>& world)
+{
+    save_positions(async_, logger_, filename(), world);
 }
 
 const std::string FixedIntervalCSVObserver::filename() const
@@ -362,8 +611,36 @@ const std::string FixedIntervalCSVObserver::filename() const
     }
 }
 
+void FixedIntervalCSVObserver::set_header(const std::string& header)
+{
+    if (async_)
+    {
+        throw IllegalState("The header cannot be changed while writing asynchronously.");
+    }
+    logger_.header = header;
+}
+
+void FixedIntervalCSVObserver::set_formatter(const std::string& formatter)
+{
+    if (async_)
+    {
+        throw IllegalState("The formatter cannot be changed while writing asynchronously.");
+    }
+    logger_.formatter = formatter;
+}
+
+void FixedIntervalCSVObserver::set_async(const Integer capacity)
+{
+    if (capacity < 0)
+    {
+        throw std::invalid_argument("A capacity must not be negative.");
+    }
+    async_capacity_ = capacity;
+}
+
 void FixedIntervalCSVObserver::reset()
 {
+    release_async_writer(async_);
     logger_.reset();
     base_type::reset();
 }
@@ -371,7 +648,9 @@ void FixedIntervalCSVObserver::reset()
 void CSVObserver::initialize(const boost::shared_ptr<WorldInterface>& world, const boost::shared_ptr<Model>& model)
 {
     base_type::initialize(world, model);
+    release_async_writer(async_);
     logger_.initialize();
+    async_ = create_async_writer(async_capacity_);
     log(world);
 }
 
@@ -382,16 +661,15 @@ bool CSVObserver::fire(const Simulator* sim, const boost::shared_ptr<WorldInterf
     return retval;
 }
 
-void CSVObserver::log(const boost::shared_ptr<WorldInterface>& world)
+void CSVObserver::finalize(const boost::shared_ptr<WorldInterface>& world)
 {
-    if (!is_directory(filename()))
-    {
-        throw NotFound("The output path does not exists.");
-    }
+    release_async_writer(async_);
+    base_type::finalize(world);
+}
 
-    std::ofstream ofs(filename().c_str(), std::ios::out);
-    logger_.save(ofs, world);
-    ofs.close();
+void CSVObserver::log(const boost::shared_ptr<WorldInterface>& world)
+{
+    save_positions(async_, logger_, filename(), world);
 }
 
 const std::string CSVObserver::filename() const
@@ -408,8 +686,36 @@ const std::string CSVObserver::filename() const
     }
 }
 
+void CSVObserver::set_header(const std::string& header)
+{
+    if (async_)
+    {
+        throw IllegalState("The header cannot be changed while writing asynchronously.");
+    }
+    logger_.header = header;
+}
+
+void CSVObserver::set_formatter(const std::string& formatter)
+{
+    if (async_)
+    {
+        throw IllegalState("The formatter cannot be changed while writing asynchronously.");
+    }
+    logger_.formatter = formatter;
+}
+
+void CSVObserver::set_async(const Integer capacity)
+{
+    if (capacity < 0)
+    {
+        throw std::invalid_argument("A capacity must not be negative.");
+    }
+    async_capacity_ = capacity;
+}
+
 void CSVObserver::reset()
 {
+    release_async_writer(async_);
     logger_.reset();
     base_type::reset();
 }
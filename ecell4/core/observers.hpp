@@ -11,6 +11,7 @@
 #include "Model.hpp"
 #include "Simulator.hpp"
 #include "WorldInterface.hpp"
+#include "AsyncWriter.hpp"
 
 #include <fstream>
 #include <boost/format.hpp>
@@ -136,6 +137,20 @@ struct NumberLogger
     void log(const boost::shared_ptr<WorldInterface>& world);
     void save(const std::string& filename) const;
 
+    /**
+     * the time and the values of targets in a row.
+     */
+    std::size_t num_columns() const
+    {
+        return targets.size() + 1;
+    }
+
+    /**
+     * copy data into a row-major buffer of data.size() x num_columns(),
+     * e.g. a NumPy array, at once. Values not logged yet are filled with 0.
+     */
+    void copy_data(Real* buffer) const;
+
     data_container_type data;
     species_container_type targets;
     const bool all_species;
@@ -173,6 +188,11 @@ public:
     NumberLogger::data_container_type data() const;
     NumberLogger::species_container_type targets() const;
 
+    const NumberLogger& logger() const
+    {
+        return logger_;
+    }
+
     void save(const std::string& filename) const
     {
         logger_.save(filename);
@@ -216,6 +236,11 @@ public:
     NumberLogger::data_container_type data() const;
     NumberLogger::species_container_type targets() const;
 
+    const NumberLogger& logger() const
+    {
+        return logger_;
+    }
+
     void save(const std::string& filename) const
     {
         logger_.save(filename);
@@ -297,6 +322,11 @@ public:
     NumberLogger::data_container_type data() const;
     NumberLogger::species_container_type targets() const;
 
+    const NumberLogger& logger() const
+    {
+        return logger_;
+    }
+
     void save(const std::string& filename) const
     {
         logger_.save(filename);
@@ -347,6 +377,90 @@ protected:
     std::string prefix_;
 };
 
+class TrajectoryHDF5Writer;
+
+/**
+ * An observer appending particles to a single HDF5 file at a fixed interval
+ * with TrajectoryHDF5Writer, instead of saving the whole world to a file
+ * every time as FixedIntervalHDF5Observer does.
+ *
+ * The file is truncated at the first initialize unless set_append(true),
+ * and frames of later runs are appended to it. It is flushed every
+ * flush_interval frames (0 means only when closed at finalize).
+ */
+class FixedIntervalHDF5TrajectoryObserver
+    : public FixedIntervalObserver
+{
+public:
+
+    typedef FixedIntervalObserver base_type;
+
+public:
+
+    FixedIntervalHDF5TrajectoryObserver(
+        const Real& dt, const std::string& filename,
+        const std::vector<std::string>& species = std::vector<std::string>())
+        : base_type(dt), filename_(filename), species_(species),
+        append_(false), chunk_size_(4096), compression_(0), shuffle_(false),
+        flush_interval_(0), async_capacity_(0)
+    {
+        ;
+    }
+
+    virtual ~FixedIntervalHDF5TrajectoryObserver()
+    {
+        ;
+    }
+
+    virtual void initialize(const boost::shared_ptr<WorldInterface>& world, const boost::shared_ptr<Model>& model);
+    virtual void finalize(const boost::shared_ptr<WorldInterface>& world);
+    virtual bool fire(const Simulator* sim, const boost::shared_ptr<WorldInterface>& world);
+    virtual void reset();
+    void log(const boost::shared_ptr<WorldInterface>& world);
+
+    const std::string& filename() const
+    {
+        return filename_;
+    }
+
+    void set_append(const bool append);
+    void set_chunk_size(const Integer chunk_size);
+    void set_compression(const Integer level);
+    void set_shuffle(const bool shuffle);
+    void set_flush_interval(const Integer interval);
+
+    /**
+     * write frames on a background thread from the next run, with at most
+     * capacity frames pending (0 means writing synchronously). See AsyncWriter.
+     * The file is then opened, written and closed only on that thread, and
+     * observers in the process call HDF5 one at a time. Thus, HDF5 need not
+     * be built thread-safe, but must not be called elsewhere during a run.
+     */
+    void set_async(const Integer capacity);
+
+protected:
+
+    typedef boost::shared_ptr<TrajectoryHDF5Writer> writer_slot_type;
+
+    /**
+     * close the file, and wait for the frames left.
+     */
+    void close();
+
+    std::string filename_;
+    std::vector<std::string> species_;
+
+    bool append_;
+    Integer chunk_size_, compression_;
+    bool shuffle_;
+    Integer flush_interval_;
+
+    Integer async_capacity_;
+
+    boost::shared_ptr<writer_slot_type> writer_;  // filled and read only by tasks
+    boost::shared_ptr<AsyncWriter> async_;
+};
+
 struct PositionLogger
 {
     typedef std::vector<std::pair<ParticleID, Particle> >
@@ -412,7 +526,38 @@ struct PositionLogger
         }
     }
 
-    void save(std::ofstream& ofs, const boost::shared_ptr<WorldInterface>& world)
+    /**
+     * particles to be written, which are copied from a world so that they
+     * can be written later or on another thread.
+     */
+    struct frame_type
+    {
+        Real t;
+        std::vector<particle_container_type> particles;  // per species if given
+    };
+
+    frame_type snapshot(const boost::shared_ptr<WorldInterface>& world) const
+    {
+        frame_type frame;
+        frame.t = world->t();
+
+        if (species.size() == 0)
+        {
+            frame.particles.push_back(world->list_particles());
+        }
+        else
+        {
+            for (std::vector<std::string>::const_iterator i(species.begin());
+                i != species.end(); ++i)
+            {
+                const Species sp(*i);
+                frame.particles.push_back(world->list_particles(sp));
+            }
+        }
+        return frame;
+    }
+
+    void write(std::ofstream& ofs, const frame_type& frame)
     {
         ofs << std::setprecision(17);
 
@@ -423,21 +568,22 @@ struct PositionLogger
 
         if (species.size() == 0)
         {
-            const particle_container_type particles(world->list_particles());
-            write_particles(ofs, world->t(), particles);
+            write_particles(ofs, frame.t, frame.particles.at(0));
         }
         else
         {
-            for (std::vector<std::string>::const_iterator i(species.begin());
-                i != species.end(); ++i)
+            for (std::size_t i(0); i < species.size(); ++i)
             {
-                const Species sp(*i);
-                const particle_container_type particles(world->list_particles(sp));
-                write_particles(ofs, world->t(), particles, *i);
+                write_particles(ofs, frame.t, frame.particles.at(i), species[i]);
             }
         }
     }
 
+    void save(std::ofstream& ofs, const boost::shared_ptr<WorldInterface>& world)
+    {
+        write(ofs, snapshot(world));
+    }
+
     std::vector<std::string> species;
     std::string header, formatter;
     serial_map_type serials;
@@ -459,7 +605,7 @@ public:
 
     FixedIntervalCSVObserver(
         const Real& dt, const std::string& filename)
-        : base_type(dt), prefix_(filename), logger_()
+        : base_type(dt), prefix_(filename), logger_(), async_capacity_(0)
     {
         ;
     }
@@ -467,7 +613,7 @@ public:
     FixedIntervalCSVObserver(
         const Real& dt, const std::string& filename,
         const std::vector<std::string>& species)
-        : base_type(dt), prefix_(filename), logger_(species)
+        : base_type(dt), prefix_(filename), logger_(species), async_capacity_(0)
     {
         ;
     }
@@ -478,25 +624,32 @@ public:
     }
 
     virtual void initialize(const boost::shared_ptr<WorldInterface>& world, const boost::shared_ptr<Model>& model);
+    virtual void finalize(const boost::shared_ptr<WorldInterface>& world);
     virtual bool fire(const Simulator* sim, const boost::shared_ptr<WorldInterface>& world);
     void log(const boost::shared_ptr<WorldInterface>& world);
     const std::string filename() const;
     virtual void reset();
 
-    void set_header(const std::string& header)
-    {
-        logger_.header = header;
-    }
+    /**
+     * change the format. These throw IllegalState while files are written
+     * on a background thread, which reads the format.
+     */
+    void set_header(const std::string& header);
+    void set_formatter(const std::string& formatter);
 
-    void set_formatter(const std::string& formatter)
-    {
-        logger_.formatter = formatter;
-    }
+    /**
+     * write files on a background thread from the next run, with at most
+     * capacity frames pending (0 means writing synchronously). See AsyncWriter.
+     */
+    void set_async(const Integer capacity);
 
 protected:
 
     std::string prefix_;
     PositionLogger logger_;
+
+    Integer async_capacity_;
+    boost::shared_ptr<AsyncWriter> async_;
 };
 
 class CSVObserver
@@ -515,7 +668,7 @@ public:
 
     CSVObserver(
         const std::string& filename)
-        : base_type(true), prefix_(filename), logger_()
+        : base_type(true), prefix_(filename), logger_(), async_capacity_(0)
     {
         ;
     }
@@ -523,7 +676,7 @@ public:
     CSVObserver(
         const std::string& filename,
         const std::vector<std::string>& species)
-        : base_type(true), prefix_(filename), logger_(species)
+        : base_type(true), prefix_(filename), logger_(species), async_capacity_(0)
     {
         ;
     }
@@ -534,25 +687,32 @@ public:
     }
 
     virtual void initialize(const boost::shared_ptr<WorldInterface>& world, const boost::shared_ptr<Model>& model);
+    virtual void finalize(const boost::shared_ptr<WorldInterface>& world);
     virtual bool fire(const Simulator* sim, const boost::shared_ptr<WorldInterface>& world);
     void log(const boost::shared_ptr<WorldInterface>& world);
     const std::string filename() const;
     virtual void reset();
 
-    void set_header(const std::string& header)
-    {
-        logger_.header = header;
-    }
+    /**
+     * change the format. These throw IllegalState while files are written
+     * on a background thread, which reads the format.
+     */
+    void set_header(const std::string& header);
+    void set_formatter(const std::string& formatter);
 
-    void set_formatter(const std::string& formatter)
-    {
-        logger_.formatter = formatter;
-    }
+    /**
+     * write files on a background thread from the next run, with at most
+     * capacity frames pending (0 means writing synchronously). See AsyncWriter.
+     */
+    void set_async(const Integer capacity);
 
 protected:
 
     std::string prefix_;
     PositionLogger logger_;
+
+    Integer async_capacity_;
+    boost::shared_ptr<AsyncWriter> async_;
 };
 
 struct TimingEvent
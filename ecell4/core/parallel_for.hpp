@@ -0,0 +1,242 @@
+#ifndef ECELL4_PARALLEL_FOR_HPP
+#define ECELL4_PARALLEL_FOR_HPP
+
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+
+namespace ecell4
+{
+
+/**
+ * return the number of threads to be used. 0 means the number of hardware threads.
+ */
+inline std::size_t resolve_num_threads(const std::size_t num_threads)
+{
+    if (num_threads == 0)
+    {
+        return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    }
+    return num_threads;
+}
+
+/**
+ * call func(i) for each i in [0, n) on num_threads threads including the
+ * caller. Indices are handed out one by one, and thus func must not
+ * depend on the order of calls. The first exception thrown is rethrown
+ * after all the threads are joined, and no more index is handed out.
+ */
+template <typename Tfunc_>
+void parallel_for(const std::size_t n, std::size_t num_threads, Tfunc_ func)
+{
+    num_threads = std::min(resolve_num_threads(num_threads), n);
+    if (num_threads <= 1)
+    {
+        for (std::size_t i(0); i < n; ++i)
+        {
+            func(i);
+        }
+        return;
+    }
+
+    std::atomic<std::size_t> next(0);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    const auto worker = [&]()
+    {
+        for (std::size_t i(next++); i < n; i = next++)
+        {
+            try
+            {
+                func(i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
+                next = n;  // stop the others
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i(1); i < num_threads; ++i)
+    {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for (std::vector<std::thread>::iterator i(threads.begin());
+        i != threads.end(); ++i)
+    {
+        (*i).join();
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+/**
+ * A pool of threads kept alive across loops. parallel_for above spawns
+ * and joins threads at every call, which costs more than the loop itself
+ * when it is called for many short phases, e.g. colours of cells in a step.
+ * ThreadPool::parallel_for behaves the same, but wakes the threads of the
+ * pool instead. The caller takes part in the loop as one of num_threads
+ * threads. A pool runs one loop at a time, and must not be shared by
+ * simulators running concurrently.
+ */
+class ThreadPool
+{
+public:
+
+    explicit ThreadPool(const std::size_t num_threads = 0)
+        : num_threads_(resolve_num_threads(num_threads)), n_(0), next_(0),
+        num_running_(0), generation_(0), stopped_(false)
+    {
+        for (std::size_t i(1); i < num_threads_; ++i)
+        {
+            workers_.push_back(std::thread(&ThreadPool::work, this));
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopped_ = true;
+        }
+        wake_.notify_all();
+        for (std::vector<std::thread>::iterator i(workers_.begin());
+            i != workers_.end(); ++i)
+        {
+            (*i).join();
+        }
+    }
+
+    std::size_t num_threads() const
+    {
+        return num_threads_;
+    }
+
+    /**
+     * call func(i) for each i in [0, n) on the threads of the pool. See
+     * ecell4::parallel_for for the order of calls and exceptions.
+     */
+    template <typename Tfunc_>
+    void parallel_for(const std::size_t n, Tfunc_ func)
+    {
+        if (num_threads_ <= 1 || n <= 1)
+        {
+            for (std::size_t i(0); i < n; ++i)
+            {
+                func(i);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            func_ = func;
+            n_ = n;
+            next_ = 0;
+            num_running_ = workers_.size();
+            ++generation_;
+        }
+        wake_.notify_all();
+
+        run();
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this]() { return num_running_ == 0; });
+        func_ = nullptr;
+
+        if (error_)
+        {
+            std::exception_ptr error;
+            error.swap(error_);
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+
+    void run()
+    {
+        for (std::size_t i(next_++); i < n_; i = next_++)
+        {
+            try
+            {
+                func_(i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_)
+                {
+                    error_ = std::current_exception();
+                }
+                next_ = n_;  // stop the others
+            }
+        }
+    }
+
+    void work()
+    {
+        std::size_t generation(0);
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock,
+                    [&]() { return stopped_ || generation_ != generation; });
+                if (stopped_)
+                {
+                    return;
+                }
+                generation = generation_;
+            }
+
+            run();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --num_running_;
+            }
+            done_.notify_one();
+        }
+    }
+
+private:
+
+    const std::size_t num_threads_;
+    std::vector<std::thread> workers_;
+
+    std::function<void(std::size_t)> func_;
+    std::size_t n_;
+    std::atomic<std::size_t> next_;
+    std::exception_ptr error_;
+
+    std::size_t num_running_;
+    std::size_t generation_;
+    bool stopped_;
+    std::mutex mutex_;
+    std::condition_variable wake_, done_;
+};
+
+} // ecell4
+
+#endif /* ECELL4_PARALLEL_FOR_HPP */
@@ -0,0 +1,91 @@
+#define BOOST_TEST_MODULE "AsyncWriter_test"
+
+#ifdef UNITTEST_FRAMEWORK_LIBRARY_EXIST
+#   include <boost/test/unit_test.hpp>
+#else
+#   define BOOST_TEST_NO_LIB
+#   include <boost/test/included/unit_test.hpp>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <vector>
+
+#include <ecell4/core/AsyncWriter.hpp>
+#include <ecell4/core/exceptions.hpp>
+
+using namespace ecell4;
+
+BOOST_AUTO_TEST_CASE(AsyncWriter_test_order)
+{
+    std::vector<int> done;
+    {
+        AsyncWriter writer(3);
+        BOOST_CHECK_EQUAL(writer.capacity(), 3);
+        for (int i(0); i < 100; ++i)
+        {
+            writer.push([&done, i]() { done.push_back(i); });
+        }
+        writer.wait();
+        BOOST_CHECK_EQUAL(done.size(), 100);
+
+        writer.push([&done]() { done.push_back(100); });
+    }  // the destructor waits for the rest
+
+    BOOST_CHECK_EQUAL(done.size(), 101);
+    for (int i(0); i < 101; ++i)
+    {
+        BOOST_CHECK_EQUAL(done[i], i);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(AsyncWriter_test_back_pressure)
+{
+    std::atomic<int> num_pending(0), max_pending(0);
+    AsyncWriter writer(2);
+    for (int i(0); i < 20; ++i)
+    {
+        const int n(++num_pending);
+        if (n > max_pending)
+        {
+            max_pending = n;
+        }
+        writer.push([&num_pending]()
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                --num_pending;
+            });
+    }
+    writer.wait();
+
+    // a task counted before push blocks
+    BOOST_CHECK(max_pending <= 3);
+    BOOST_CHECK_EQUAL(num_pending, 0);
+}
+
+BOOST_AUTO_TEST_CASE(AsyncWriter_test_error)
+{
+    std::atomic<int> num_done(0);
+    AsyncWriter writer(2);
+
+    // the first task fails only after the second one is queued
+    std::promise<void> queued;
+    std::shared_future<void> latch(queued.get_future());
+    writer.push([latch]()
+        {
+            latch.wait();
+            throw NotFound("The output path does not exists.");
+        });
+    writer.push([&num_done]() { ++num_done; });
+    queued.set_value();
+    BOOST_CHECK_THROW(writer.wait(), NotFound);
+    BOOST_CHECK_EQUAL(num_done, 0);  // discarded
+
+    // the writer is available after the error is reported
+    writer.push([&num_done]() { ++num_done; });
+    writer.wait();
+    BOOST_CHECK_EQUAL(num_done, 1);
+
+    BOOST_CHECK_THROW(AsyncWriter(0), IllegalArgument);
+}
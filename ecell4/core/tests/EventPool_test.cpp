@@ -0,0 +1,130 @@
+#define BOOST_TEST_MODULE "EventPool_test"
+
+#ifdef UNITTEST_FRAMEWORK_LIBRARY_EXIST
+#   include <boost/test/unit_test.hpp>
+#else
+#   define BOOST_TEST_NO_LIB
+#   include <boost/test/included/unit_test.hpp>
+#endif
+
+#include <vector>
+
+#include <ecell4/core/EventPool.hpp>
+#include <ecell4/core/EventScheduler.hpp>
+
+using namespace ecell4;
+
+namespace
+{
+
+struct CountedEvent
+    : public Event
+{
+    CountedEvent(Real const& time, int& num_alive)
+        : Event(time), num_alive(num_alive)
+    {
+        ++num_alive;
+    }
+
+    virtual ~CountedEvent()
+    {
+        --num_alive;
+    }
+
+    int& num_alive;
+};
+
+struct LargeEvent
+    : public Event
+{
+    LargeEvent(Real const& time)
+        : Event(time)
+    {
+        ;
+    }
+
+    char data[EventArena::MAX_BLOCK_SIZE];
+};
+
+} // anonymous
+
+BOOST_AUTO_TEST_CASE(EventPool_test_reuse)
+{
+    EventPool pool;
+    int num_alive(0);
+
+    const void* address;
+    {
+        const boost::intrusive_ptr<Event> event(pool.create<CountedEvent>(1.0, num_alive));
+        BOOST_CHECK_EQUAL(event->time(), 1.0);
+        BOOST_CHECK_EQUAL(pool.num_in_use(), 1);
+        address = event.get();
+
+        // copies share the event
+        boost::intrusive_ptr<Event> copy(event);
+        BOOST_CHECK_EQUAL(num_alive, 1);
+    }
+    BOOST_CHECK_EQUAL(num_alive, 0);
+    BOOST_CHECK_EQUAL(pool.num_in_use(), 0);
+
+    // the block released last is given first
+    const boost::intrusive_ptr<Event> event(pool.create<CountedEvent>(2.0, num_alive));
+    BOOST_CHECK_EQUAL(event.get(), address);
+
+    // events not in a pool are deleted as usual
+    {
+        const boost::intrusive_ptr<Event> other(new CountedEvent(3.0, num_alive));
+        BOOST_CHECK_EQUAL(num_alive, 2);
+        BOOST_CHECK_EQUAL(pool.num_in_use(), 1);
+    }
+    BOOST_CHECK_EQUAL(num_alive, 1);
+
+    // too large to be pooled
+    const boost::intrusive_ptr<Event> large(pool.create<LargeEvent>(4.0));
+    BOOST_CHECK_EQUAL(large->time(), 4.0);
+    BOOST_CHECK_EQUAL(pool.num_in_use(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(EventPool_test_steady_state)
+{
+    EventPool pool;
+    IntrusiveEventScheduler scheduler;
+    int num_alive(0);
+
+    for (std::size_t i(0); i < 100; ++i)
+    {
+        scheduler.add(pool.create<CountedEvent>(i * 0.5, num_alive));
+    }
+    const std::size_t num_chunks(pool.num_chunks());
+
+    // replace the first event with a new one, as eGFRD reschedules a domain
+    for (std::size_t i(0); i < 10000; ++i)
+    {
+        const IntrusiveEventScheduler::value_type top(scheduler.pop());
+        scheduler.add(pool.create<CountedEvent>(top.second->time() + 50.0, num_alive));
+    }
+    BOOST_CHECK_EQUAL(scheduler.size(), 100);
+    BOOST_CHECK_EQUAL(pool.num_in_use(), 100);
+    BOOST_CHECK_EQUAL(pool.num_chunks(), num_chunks);
+    BOOST_CHECK_EQUAL(num_alive, 100);
+
+    scheduler.clear();
+    BOOST_CHECK_EQUAL(pool.num_in_use(), 0);
+    BOOST_CHECK_EQUAL(num_alive, 0);
+}
+
+BOOST_AUTO_TEST_CASE(EventPool_test_lifetime)
+{
+    int num_alive(0);
+    EventPool pool;
+    {
+        IntrusiveEventScheduler scheduler;
+        scheduler.add(pool.create<CountedEvent>(1.0, num_alive));
+        scheduler.add(pool.create<CountedEvent>(2.0, num_alive));
+        BOOST_CHECK_EQUAL(pool.num_in_use(), 2);
+    }
+
+    // events are released with the scheduler, before the pool
+    BOOST_CHECK_EQUAL(pool.num_in_use(), 0);
+    BOOST_CHECK_EQUAL(num_alive, 0);
+}
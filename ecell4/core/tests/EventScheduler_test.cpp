@@ -9,7 +9,11 @@
 
 #include <boost/test/floating_point_comparison.hpp>
 
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real.hpp>
+
 #include <ecell4/core/EventScheduler.hpp>
+#include <ecell4/core/hold_model.hpp>
 
 using namespace ecell4;
 
@@ -17,3 +21,104 @@ BOOST_AUTO_TEST_CASE(EventScheduler_test_constructor)
 {
     EventScheduler scheduler;
 }
+
+namespace
+{
+
+struct TestEvent
+    : public Event
+{
+    TestEvent(Real const& time)
+        : Event(time)
+    {
+        ;
+    }
+};
+
+} // anonymous
+
+BOOST_AUTO_TEST_CASE(EventScheduler_test_calendar_queue)
+{
+    boost::mt19937 rng(1);
+    boost::uniform_real<Real> dist(0.0, 10.0);
+
+    EventScheduler heap;
+    CalendarEventScheduler calendar;
+    std::vector<std::pair<EventScheduler::identifier_type,
+        CalendarEventScheduler::identifier_type> > ids;
+
+    for (int i(0); i < 1000; ++i)
+    {
+        const Real t(dist(rng));
+        ids.push_back(std::make_pair(
+            heap.add(boost::shared_ptr<Event>(new TestEvent(t))),
+            calendar.add(boost::shared_ptr<Event>(new TestEvent(t)))));
+    }
+
+    // far events and those rescheduled earlier
+    ids.push_back(std::make_pair(
+        heap.add(boost::shared_ptr<Event>(new TestEvent(inf))),
+        calendar.add(boost::shared_ptr<Event>(new TestEvent(inf)))));
+    for (int i(0); i < 1000; i += 7)
+    {
+        const Real t(dist(rng) * (i % 2 == 0 ? 1e+3 : 1e-3));
+        heap.update(std::make_pair(ids[i].first,
+            boost::shared_ptr<Event>(new TestEvent(t))));
+        calendar.update(std::make_pair(ids[i].second,
+            boost::shared_ptr<Event>(new TestEvent(t))));
+    }
+    for (int i(3); i < 1000; i += 11)
+    {
+        heap.remove(ids[i].first);
+        calendar.remove(ids[i].second);
+    }
+    BOOST_CHECK(calendar.check());
+    BOOST_CHECK_EQUAL(heap.size(), calendar.size());
+    BOOST_CHECK_EQUAL(heap.next_time(), calendar.next_time());
+    BOOST_CHECK_EQUAL(heap.second().second->time(), calendar.second().second->time());
+
+    while (heap.size() > 0)
+    {
+        if (heap.size() > 1)
+        {
+            BOOST_CHECK_EQUAL(heap.second().second->time(), calendar.second().second->time());
+        }
+        const Real t(heap.pop().second->time());
+        BOOST_CHECK_EQUAL(calendar.pop().second->time(), t);
+        BOOST_CHECK_EQUAL(calendar.time(), t);
+    }
+    BOOST_CHECK_EQUAL(calendar.size(), 0);
+    BOOST_CHECK_THROW(calendar.pop(), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(EventScheduler_test_calendar_queue_ties)
+{
+    CalendarEventScheduler scheduler;
+    std::vector<boost::shared_ptr<Event> > events;
+    for (int i(0); i < 100; ++i)
+    {
+        events.push_back(boost::shared_ptr<Event>(new TestEvent(i % 2 == 0 ? 1.0 : 2.0)));
+        scheduler.add(events.back());
+    }
+
+    // events at the same time come out in the order added
+    for (int i(0); i < 100; ++i)
+    {
+        BOOST_CHECK(scheduler.pop().second == events[(i < 50 ? 2 * i : 2 * (i - 50) + 1)]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(EventScheduler_test_hold)
+{
+    // a hold model with enough events for the calendar to be resized
+    const std::size_t num_events(10000), num_steps(50000);
+
+    EventScheduler heap;
+    const Real sum1(hold(heap, num_events, num_steps));
+    CalendarEventScheduler calendar;
+    const Real sum2(hold(calendar, num_events, num_steps));
+
+    BOOST_CHECK_CLOSE(sum1, sum2, 1e-8);
+    BOOST_CHECK(calendar.check());
+    BOOST_CHECK_EQUAL(heap.second().second->time(), calendar.second().second->time());
+}
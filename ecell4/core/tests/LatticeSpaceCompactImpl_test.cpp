@@ -0,0 +1,278 @@
+#define BOOST_TEST_MODULE "LatticeSpaceCompactImpl_test"
+
+#ifdef UNITTEST_FRAMEWORK_LIBRARY_EXIST
+#   include <boost/test/unit_test.hpp>
+#else
+#   define BOOST_TEST_NO_LIB
+#   include <boost/test/included/unit_test.hpp>
+#endif
+
+#include <ecell4/core/MoleculePool.hpp>
+#include <ecell4/core/VacantType.hpp>
+#include <ecell4/core/LatticeSpaceCompactImpl.hpp>
+#include <ecell4/core/LatticeSpaceVectorImpl.hpp>
+#include <ecell4/core/SerialIDGenerator.hpp>
+#include <ecell4/core/RandomNumberGenerator.hpp>
+
+using namespace ecell4;
+
+struct Fixture
+{
+    const Real3 edge_lengths;
+    const Real voxel_radius;
+    LatticeSpaceCompactImpl space;
+    SerialIDGenerator<ParticleID> sidgen;
+    const Real D, radius;
+    const Species sp;
+    Fixture() :
+        edge_lengths(2.5e-8, 2.5e-8, 2.5e-8),
+        voxel_radius(2.5e-9),
+        space(edge_lengths, voxel_radius, false),
+        sidgen(), D(1e-12), radius(2.5e-9),
+        sp("A", 2.5e-9, 1e-12)
+    {
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(suite, Fixture)
+
+BOOST_AUTO_TEST_CASE(LatticeSpaceCompactImpl_test_constructor)
+{
+    BOOST_CHECK_EQUAL(space.actual_size(), space.vacant()->size());
+    BOOST_CHECK_EQUAL(space.num_species(), 0);
+    BOOST_CHECK_EQUAL(space.num_pools(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(LatticeSpaceCompactImpl_test_get_voxel)
+{
+    const VoxelSpaceBase::coordinate_type
+        coord(space.position2coordinate(Real3(1.25e-8, 1.25e-8, 1.25e-8)));
+
+    {
+        std::pair<ParticleID, ParticleVoxel> voxel(space.get_voxel_at(coord));
+        BOOST_CHECK_EQUAL(voxel.first, ParticleID());
+        BOOST_CHECK_EQUAL(voxel.second.species, space.vacant()->species());
+    }
+
+    ParticleID pid(sidgen());
+    BOOST_CHECK(space.update_voxel(pid, ParticleVoxel(sp, coord, radius, D)));
+    BOOST_CHECK_EQUAL(space.num_pools(), 4);
+
+    {
+        std::pair<ParticleID, ParticleVoxel> voxel(space.get_voxel_at(coord));
+        BOOST_CHECK_EQUAL(voxel.first, pid);
+        BOOST_CHECK_EQUAL(voxel.second.species, sp);
+    }
+
+    BOOST_CHECK_EQUAL(space.list_voxels().size(), 1);
+    BOOST_CHECK_EQUAL(space.list_voxels_exact(sp).size(), 1);
+    BOOST_CHECK_EQUAL(space.num_particles(sp), 1);
+}
+
+BOOST_AUTO_TEST_CASE(LatticeSpaceCompactImpl_test_add_remove_molecule)
+{
+    const VoxelSpaceBase::coordinate_type coord(
+            space.global2coordinate(Integer3(3,4,5)));
+    ParticleID pid(sidgen());
+    BOOST_CHECK(space.update_voxel(pid, ParticleVoxel(sp, coord, radius, D)));
+    BOOST_CHECK_EQUAL(space.num_particles(sp), 1);
+    BOOST_CHECK(!space.get_voxel_pool_at(coord)->is_vacant());
+    const Integer num_vacant(space.vacant()->size());
+
+    BOOST_CHECK(space.remove_voxel(coord));
+    BOOST_CHECK(space.get_voxel_pool_at(coord)->is_vacant());
+    BOOST_CHECK_EQUAL(space.num_particles(sp), 0);
+    BOOST_CHECK_EQUAL(space.vacant()->size(), num_vacant + 1);
+    BOOST_CHECK(!space.remove_voxel(coord));
+
+    // placing the same species again finds its entry in the table
+    BOOST_CHECK(space.update_voxel(sidgen(), ParticleVoxel(sp, coord, radius, D)));
+    BOOST_CHECK_EQUAL(space.num_pools(), 4);
+}
+
+BOOST_AUTO_TEST_CASE(LatticeSpaceCompactImpl_test_move)
+{
+    const VoxelSpaceBase::coordinate_type
+        coord(space.global2coordinate(Integer3(2,3,4))),
+        to_coord(space.global2coordinate(Integer3(2,4,4)));
+
+    ParticleID pid(sidgen());
+    BOOST_CHECK(space.update_voxel(pid, ParticleVoxel(sp, coord, radius, D)));
+
+    BOOST_CHECK(space.can_move(coord, to_coord));
+    BOOST_CHECK(space.move(coord, to_coord));
+    BOOST_CHECK(space.get_voxel_pool_at(coord)->is_vacant());
+    BOOST_CHECK_EQUAL(space.get_voxel_at(to_coord).first, pid);
+    BOOST_CHECK_EQUAL(space.list_coords(sp).at(0), to_coord);
+
+    BOOST_CHECK(space.update_voxel(sidgen(), ParticleVoxel(sp, coord, radius, D)));
+    BOOST_CHECK(!space.can_move(coord, to_coord));
+    BOOST_CHECK(!space.move(coord, to_coord));
+}
+
+BOOST_AUTO_TEST_CASE(LatticeSpaceCompactImpl_test_border)
+{
+    const VoxelSpaceBase::coordinate_type
+        coord(space.global2coordinate(Integer3(0, 0, 0)));
+    BOOST_CHECK(space.update_voxel(sidgen(), ParticleVoxel(sp, coord, radius, D)));
+
+    for (Integer i(0); i < 12; ++i)
+    {
+        const VoxelSpaceBase::coordinate_type neighbor(space.get_neighbor(coord, i));
+        if (!space.is_inside(neighbor))
+        {
+            BOOST_CHECK(!space.can_move(coord, neighbor));
+            BOOST_CHECK(!space.move(coord, neighbor));
+        }
+    }
+    BOOST_CHECK_EQUAL(space.list_coords(sp).at(0), coord);
+}
+
+BOOST_AUTO_TEST_CASE(LatticeSpaceCompactImpl_test_same_as_vector_impl)
+{
+    LatticeSpaceVectorImpl reference(edge_lengths, voxel_radius, false);
+    GSLRandomNumberGenerator rng;
+    rng.seed(0);
+
+    for (Integer i(0); i < 100; ++i)
+    {
+        const VoxelSpaceBase::coordinate_type coord(space.global2coordinate(Integer3(
+            rng.uniform_int(0, space.col_size() - 1),
+            rng.uniform_int(0, space.row_size() - 1),
+            rng.uniform_int(0, space.layer_size() - 1))));
+        if (!space.get_voxel_pool_at(coord)->is_vacant())
+        {
+            continue;
+        }
+
+        const ParticleID pid(sidgen());
+        BOOST_CHECK(space.update_voxel(pid, ParticleVoxel(sp, coord, radius, D)));
+        BOOST_CHECK(reference.update_voxel(pid, ParticleVoxel(sp, coord, radius, D)));
+    }
+
+    for (Integer step(0); step < 100; ++step)
+    {
+        const std::vector<VoxelSpaceBase::coordinate_type> coords(space.list_coords(sp));
+        for (std::size_t i(0); i < coords.size(); ++i)
+        {
+            const Integer nrand(rng.uniform_int(0, 11));
+            const VoxelSpaceBase::coordinate_type
+                neighbor(space.get_neighbor(coords[i], nrand));
+            BOOST_CHECK_EQUAL(neighbor, reference.get_neighbor(coords[i], nrand));
+            BOOST_CHECK_EQUAL(space.move(coords[i], neighbor, i),
+                              reference.move(coords[i], neighbor, i));
+        }
+    }
+
+    for (Integer coord(0); coord < space.size(); ++coord)
+    {
+        BOOST_CHECK_EQUAL(space.get_voxel_at(coord).first,
+                          reference.get_voxel_at(coord).first);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+struct PeriodicFixture
+{
+    const Real3 edge_lengths;
+    const Real voxel_radius;
+    LatticeSpaceCompactImpl space;
+    SerialIDGenerator<ParticleID> sidgen;
+    const Real D, radius;
+    const Species sp;
+    PeriodicFixture() :
+        edge_lengths(2.5e-8, 2.5e-8, 2.5e-8),
+        voxel_radius(2.5e-9),
+        space(edge_lengths, voxel_radius, true),
+        sidgen(), D(1e-12), radius(2.5e-9),
+        sp(std::string("A"), 2.5e-9, 1e-12)
+    {
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(periodic_suite, PeriodicFixture)
+
+BOOST_AUTO_TEST_CASE(LatticeSpaceCompactImpl_test_periodic_col)
+{
+    const int col_size(space.col_size()),
+              row_size(space.row_size()),
+              layer_size(space.layer_size());
+    for (int i(0); i < row_size; ++i)
+        for (int j(0); j < layer_size; ++j)
+        {
+            const VoxelSpaceBase::coordinate_type
+                coord(space.global2coordinate(Integer3(0, i, j)));
+
+            BOOST_CHECK(space.update_voxel(sidgen(), ParticleVoxel(sp, coord, radius, D)));
+        }
+
+    // from 0 to col_size-1
+    for (int i(0); i < row_size; ++i)
+        for (int j(0); j < layer_size; ++j)
+        {
+            const VoxelSpaceBase::coordinate_type
+                coord(space.global2coordinate(Integer3(0, i, j)));
+
+            const Integer nrnd((j&1)==1?2:3);
+            const VoxelSpaceBase::coordinate_type
+                neighbor(space.get_neighbor(coord, nrnd));
+
+            BOOST_CHECK_EQUAL(space.coordinate2global(neighbor).col, col_size-1);
+            BOOST_CHECK(space.move(coord, neighbor));
+        }
+
+    BOOST_CHECK_EQUAL(space.num_particles(sp), row_size * layer_size);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+struct StructureFixture
+{
+    const Real3 edge_lengths;
+    const Real voxel_radius;
+    LatticeSpaceCompactImpl space;
+    SerialIDGenerator<ParticleID> sidgen;
+    const Real D, radius;
+    const Species structure, sp;
+    StructureFixture() :
+        edge_lengths(2.5e-8, 2.5e-8, 2.5e-8),
+        voxel_radius(2.5e-9),
+        space(edge_lengths, voxel_radius, false),
+        sidgen(), D(1e-12), radius(2.5e-9),
+        structure("Structure", 2.5e-9, 0),
+        sp("A", 2.5e-9, 1e-12, "Structure")
+    {
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(structure_suite, StructureFixture)
+
+BOOST_AUTO_TEST_CASE(LatticeSpaceCompactImpl_test_structure_move)
+{
+    const Real3 pos1(2.7e-9, 1.3e-8, 2.0e-8);
+    const Real3 pos2(1.2e-8, 1.5e-8, 1.8e-8);
+    BOOST_CHECK(space.update_structure(Particle(structure, pos1, radius, D)));
+    BOOST_CHECK(space.update_structure(Particle(structure, pos2, radius, D)));
+    BOOST_CHECK_EQUAL(space.list_particles().size(), 2);
+
+    ParticleID pid(sidgen());
+    BOOST_CHECK(space.update_voxel(
+        pid, ParticleVoxel(sp, space.position2coordinate(pos1), radius, D, structure.serial())));
+    BOOST_CHECK_EQUAL(space.list_particles(sp).size(), 1);
+    BOOST_CHECK_EQUAL(space.list_particles(structure).size(), 1);
+
+    const VoxelSpaceBase::coordinate_type
+        coord1(space.position2coordinate(pos1)),
+        coord2(space.position2coordinate(pos2));
+    BOOST_CHECK(space.move(coord1, coord2));
+    BOOST_CHECK_EQUAL(space.list_particles(sp).size(), 1);
+    BOOST_CHECK_EQUAL(space.list_particles(structure).size(), 1);
+    BOOST_CHECK_EQUAL(space.get_voxel_pool_at(coord1)->species(), structure);
+
+    BOOST_CHECK(space.remove_particle(pid));
+    BOOST_CHECK_EQUAL(space.list_particles(structure).size(), 2);
+    BOOST_CHECK_EQUAL(space.num_pools(), 5);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
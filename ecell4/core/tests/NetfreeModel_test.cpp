@@ -202,6 +202,7 @@ BOOST_AUTO_TEST_CASE(NetfreeModel_generation2)
     // }
 
     BOOST_CHECK_EQUAL((*nwm).reaction_rules().size(), 13);
+    BOOST_CHECK_EQUAL(nfm.expand(seeds, 10, max_stoich, 1)->reaction_rules().size(), 13);
 }
 
 // BOOST_AUTO_TEST_CASE(NetfreeModel_query_reaction_rules3)
@@ -292,3 +293,34 @@ BOOST_AUTO_TEST_CASE(NetfreeModel_generation3)
         BOOST_CHECK_EQUAL((*i).k(), 1.0);
     }
 }
+
+BOOST_AUTO_TEST_CASE(NetfreeModel_generation_threads)
+{
+    NetfreeModel nfm;
+    nfm.add_reaction_rule(
+        create_binding_reaction_rule(
+            Species("X(r)"), Species("X(l)"), Species("X(r^1).X(l^1)"), 1.0));
+    nfm.add_reaction_rule(
+        create_unbinding_reaction_rule(
+             Species("X(r^1).X(l^1)"),Species("X(r)"), Species("X(l)"), 1.0));
+    nfm.add_reaction_rule(
+        create_unimolecular_reaction_rule(Species("X(s=u)"), Species("X(s=p)"), 1.0));
+
+    std::vector<Species> seeds(1, Species("X(l,r,s=u)"));
+    std::map<Species, Integer> max_stoich;
+    max_stoich[Species("X")] = 2;
+
+    const boost::shared_ptr<NetworkModel> m1(
+        extras::generate_network_from_netfree_model(nfm, seeds, 10, max_stoich, 1).first);
+    const boost::shared_ptr<NetworkModel> m2(
+        extras::generate_network_from_netfree_model(nfm, seeds, 10, max_stoich, 4).first);
+
+    BOOST_CHECK(m1->reaction_rules().size() > 0);
+    BOOST_CHECK_EQUAL(m1->reaction_rules().size(), m2->reaction_rules().size());
+    for (std::size_t i(0); i < m1->reaction_rules().size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(
+            m1->reaction_rules()[i].as_string(), m2->reaction_rules()[i].as_string());
+    }
+    BOOST_CHECK(m1->species_attributes() == m2->species_attributes());
+}
@@ -10,6 +10,7 @@
 #include <ecell4/core/exceptions.hpp>
 #include <ecell4/core/types.hpp>
 #include <ecell4/core/NetworkModel.hpp>
+#include <ecell4/core/CompiledNetworkModel.hpp>
 
 using namespace ecell4;
 
@@ -88,10 +89,15 @@ BOOST_AUTO_TEST_CASE(NetworkModel_test_reaction_rule)
     BOOST_CHECK(model.has_reaction_rule(rr1));
     BOOST_CHECK(model.has_reaction_rule(rr2));
     BOOST_CHECK(!model.has_reaction_rule(rr3));
+    const Integer revision(model.revision());
     model.add_reaction_rule(rr3);
+    BOOST_CHECK(model.revision() > revision);
     // BOOST_CHECK_THROW(model.add_reaction_rule(rr1), AlreadyExists); //XXX:
     model.remove_reaction_rule(rr1);
+    const Integer removed(model.revision());
+    BOOST_CHECK(removed > revision + 1);
     BOOST_CHECK_THROW(model.remove_reaction_rule(rr1), NotFound);
+    BOOST_CHECK_EQUAL(model.revision(), removed);
     model.remove_reaction_rule(rr3);
     model.remove_reaction_rule(rr2);
 }
@@ -139,3 +145,42 @@ BOOST_AUTO_TEST_CASE(NetworkModel_test_query_reaction_rules2)
     BOOST_CHECK_EQUAL(model.query_reaction_rules(sp1, sp2).size(), 1);
     BOOST_CHECK_EQUAL(model.query_reaction_rules(sp2, sp1).size(), 1);
 }
+
+BOOST_AUTO_TEST_CASE(NetworkModel_test_compiled)
+{
+    Species sp1("A"), sp2("B"), sp3("C"), sp4("D");
+
+    ReactionRule rr1, rr2, rr3, rr4;
+    rr1.add_reactant(sp1);
+    rr1.add_reactant(sp2);
+    rr1.add_product(sp3);
+    rr2.add_reactant(sp3);
+    rr2.add_product(sp1);
+    rr2.add_product(sp2);
+    rr3.add_reactant(sp1);
+    rr3.add_product(sp2);
+    rr4.add_reactant(sp1);
+    rr4.add_product(sp3);
+
+    NetworkModel model;
+    model.add_reaction_rule(rr1);
+    model.add_reaction_rule(rr2);
+    model.add_reaction_rule(rr3);
+    model.add_reaction_rule(rr4);
+
+    const CompiledNetworkModel compiled(model);
+    BOOST_CHECK_EQUAL(compiled.num_first_order_reaction_rules(), 3);
+    BOOST_CHECK_EQUAL(compiled.num_second_order_reaction_rules(), 1);
+
+    const ReactionRuleRange rules1(compiled.query_reaction_rules(sp1));
+    BOOST_CHECK_EQUAL(rules1.size(), 2);
+    BOOST_CHECK(rules1[0] == rr3);
+    BOOST_CHECK(rules1[1] == rr4);
+    BOOST_CHECK_EQUAL(compiled.query_reaction_rules(sp3).size(), 1);
+    BOOST_CHECK(compiled.query_reaction_rules(sp2).empty());
+    BOOST_CHECK(compiled.query_reaction_rules(sp4).empty());
+
+    BOOST_CHECK_EQUAL(compiled.query_reaction_rules(sp1, sp2).size(), 1);
+    BOOST_CHECK(*(compiled.query_reaction_rules(sp2, sp1).begin()) == rr1);
+    BOOST_CHECK(compiled.query_reaction_rules(sp1, sp1).empty());
+}
@@ -0,0 +1,119 @@
+#define BOOST_TEST_MODULE "PackedCellList_test"
+
+#ifdef UNITTEST_FRAMEWORK_LIBRARY_EXIST
+#   include <boost/test/unit_test.hpp>
+#else
+#   define BOOST_TEST_NO_LIB
+#   include <boost/test/included/unit_test.hpp>
+#endif
+
+#include <vector>
+#include <algorithm>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+
+#include <ecell4/core/PackedCellList.hpp>
+
+using namespace ecell4;
+
+BOOST_AUTO_TEST_CASE(PackedCellList_test_constructor)
+{
+    PackedCellList cells(27);
+    BOOST_CHECK_EQUAL(cells.num_cells(), 27);
+    BOOST_CHECK_EQUAL(cells.size(), 0);
+    BOOST_CHECK(cells.cell(0).empty());
+    BOOST_CHECK(cells.check());
+}
+
+BOOST_AUTO_TEST_CASE(PackedCellList_test_push_move_erase)
+{
+    PackedCellList cells(4);
+    cells.push_back(1);
+    cells.push_back(1);
+    cells.push_back(3);
+    BOOST_CHECK_EQUAL(cells.size(), 3);
+    BOOST_CHECK_EQUAL(cells.cell(1).size(), 2);
+    BOOST_CHECK_EQUAL(cells.cell(3).size(), 1);
+    BOOST_CHECK_EQUAL(cells.cell(3)[0], 2);
+
+    cells.move(0, 3);
+    BOOST_CHECK_EQUAL(cells.cell_of(0), 3);
+    BOOST_CHECK_EQUAL(cells.cell(1).size(), 1);
+    BOOST_CHECK_EQUAL(cells.cell(1)[0], 1);
+    BOOST_CHECK_EQUAL(cells.cell(3).size(), 2);
+    BOOST_CHECK(cells.check());
+
+    // the last value, 2, is renamed to 0
+    cells.erase(0);
+    BOOST_CHECK_EQUAL(cells.size(), 2);
+    BOOST_CHECK_EQUAL(cells.cell(3).size(), 1);
+    BOOST_CHECK_EQUAL(cells.cell(3)[0], 0);
+    BOOST_CHECK_EQUAL(cells.cell_of(0), 3);
+    BOOST_CHECK_EQUAL(cells.cell_of(1), 1);
+    BOOST_CHECK(cells.check());
+
+    BOOST_CHECK_THROW(cells.erase(2), IllegalState);
+
+    cells.clear();
+    BOOST_CHECK_EQUAL(cells.size(), 0);
+    BOOST_CHECK(cells.cell(3).empty());
+    BOOST_CHECK(cells.check());
+}
+
+BOOST_AUTO_TEST_CASE(PackedCellList_test_random)
+{
+    const std::size_t num_cells(64);
+    PackedCellList cells(num_cells);
+    std::vector<std::size_t> expected;  // the cell of each value
+
+    boost::random::mt19937 rng(0);
+    boost::random::uniform_int_distribution<std::size_t> cell_dist(0, num_cells - 1);
+    boost::random::uniform_int_distribution<int> op_dist(0, 9);
+
+    for (std::size_t i(0); i < 20000; ++i)
+    {
+        const int op(expected.empty() ? 0 : op_dist(rng));
+        if (op < 3)
+        {
+            const std::size_t c(cell_dist(rng));
+            cells.push_back(c);
+            expected.push_back(c);
+        }
+        else
+        {
+            boost::random::uniform_int_distribution<std::size_t>
+                value_dist(0, expected.size() - 1);
+            const std::size_t value(value_dist(rng));
+            if (op < 5)
+            {
+                cells.erase(value);
+                expected[value] = expected.back();
+                expected.pop_back();
+            }
+            else
+            {
+                const std::size_t c(cell_dist(rng));
+                cells.move(value, c);
+                expected[value] = c;
+            }
+        }
+    }
+
+    BOOST_CHECK(cells.check());
+    BOOST_CHECK_EQUAL(cells.size(), expected.size());
+    for (std::size_t value(0); value < expected.size(); ++value)
+    {
+        BOOST_CHECK_EQUAL(cells.cell_of(value), expected[value]);
+    }
+    BOOST_CHECK(cells.num_rebuilds() > 0);
+
+    // a rebuild sorts the values in each cell
+    cells.rebuild();
+    for (std::size_t c(0); c < num_cells; ++c)
+    {
+        const PackedCellList::cell_type values(cells.cell(c));
+        BOOST_CHECK(std::is_sorted(values.begin(), values.end()));
+        BOOST_CHECK_EQUAL(values.size(),
+            static_cast<std::size_t>(std::count(expected.begin(), expected.end(), c)));
+    }
+}
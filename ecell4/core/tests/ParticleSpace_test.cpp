@@ -147,4 +147,41 @@ BOOST_AUTO_TEST_CASE(ParticleSpaceCellListImpl_test_constructor)
     BOOST_CHECK_EQUAL((*space).matrix_sizes(), matrix_sizes);
 }
 
+BOOST_AUTO_TEST_CASE(ParticleSpaceCellListImpl_test_columns)
+{
+    ParticleSpaceCellListImpl space(edge_lengths, matrix_sizes);
+    SerialIDGenerator<ParticleID> pidgen;
+
+    const ParticleID pid1 = pidgen();
+    const ParticleID pid2 = pidgen();
+    const ParticleID pid3 = pidgen();
+    const Species sp1 = Species("A");
+    const Species sp2 = Species("B");
+
+    space.update_particle(pid1, Particle(sp1, Real3(0.1, 0.2, 0.3), radius, 1.0));
+    space.update_particle(pid2, Particle(sp2, Real3(0.4, 0.5, 0.6), radius * 2, 2.0));
+    space.update_particle(pid3, Particle(sp1, Real3(0.7, 0.8, 0.9), radius, 1.0));
+    space.diagnosis();
+    BOOST_CHECK_EQUAL(space.radii().size(), 3);
+    BOOST_CHECK_EQUAL(space.coordinates(1)[1], 0.5);
+    BOOST_CHECK_EQUAL(space.Ds()[1], 2.0);
+    BOOST_CHECK_EQUAL(space.species_at(space.species_indices()[1]), sp2);
+    BOOST_CHECK_EQUAL(space.species_indices()[0], space.species_indices()[2]);
+
+    // moving and changing a species keep columns in sync
+    space.update_particle(pid1, Particle(sp2, Real3(0.15, 0.25, 0.35), radius * 2, 2.0));
+    space.diagnosis();
+    BOOST_CHECK_EQUAL(space.species_at(space.species_indices()[0]), sp2);
+
+    // the last particle is moved into the hole
+    space.remove_particle(pid1);
+    space.diagnosis();
+    BOOST_CHECK_EQUAL(space.radii().size(), 2);
+    BOOST_CHECK_EQUAL(space.coordinates(0)[0], 0.7);
+    BOOST_CHECK_EQUAL(space.species_at(space.species_indices()[0]), sp1);
+
+    BOOST_CHECK_EQUAL(space.list_particles_within_radius(Real3(0.7, 0.8, 0.9), radius).size(), 1);
+    BOOST_CHECK_EQUAL(space.list_particles_within_radius(Real3(0.7, 0.8, 0.9), radius, pid3).size(), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,193 @@
+#define BOOST_TEST_MODULE "PhiloxRandomNumberGenerator_test"
+
+#ifdef UNITTEST_FRAMEWORK_LIBRARY_EXIST
+#   include <boost/test/unit_test.hpp>
+#else
+#   define BOOST_TEST_NO_LIB
+#   include <boost/test/included/unit_test.hpp>
+#endif
+
+#include <set>
+
+#include <ecell4/core/RandomNumberGenerator.hpp>
+
+using namespace ecell4;
+
+
+BOOST_AUTO_TEST_CASE(PhiloxRandomNumberGenerator_test_known_answer)
+{
+    // Random123 known-answer tests for philox4x32_10
+    {
+        const uint32_t key[2] = {0, 0};
+        const uint32_t counter[4] = {0, 0, 0, 0};
+        uint32_t out[4];
+        PhiloxRandomNumberGenerator::generate(key, counter, out);
+        BOOST_CHECK_EQUAL(out[0], 0x6627e8d5u);
+        BOOST_CHECK_EQUAL(out[1], 0xe169c58du);
+        BOOST_CHECK_EQUAL(out[2], 0xbc57ac4cu);
+        BOOST_CHECK_EQUAL(out[3], 0x9b00dbd8u);
+    }
+    {
+        const uint32_t key[2] = {0xa4093822, 0x299f31d0};
+        const uint32_t counter[4] = {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344};
+        uint32_t out[4];
+        PhiloxRandomNumberGenerator::generate(key, counter, out);
+        BOOST_CHECK_EQUAL(out[0], 0xd16cfe09u);
+        BOOST_CHECK_EQUAL(out[1], 0x94fdccebu);
+        BOOST_CHECK_EQUAL(out[2], 0x5001e420u);
+        BOOST_CHECK_EQUAL(out[3], 0x24126ea1u);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(PhiloxRandomNumberGenerator_test_streams)
+{
+    PhiloxRandomNumberGenerator rng1(12345), rng2(12345), rng3(12345, 1);
+    BOOST_CHECK_EQUAL(rng3.stream(), 1);
+
+    for (unsigned int i(0); i < 100; ++i)
+    {
+        BOOST_CHECK_EQUAL(rng1.next(), rng2.next());
+    }
+
+    const PhiloxRandomNumberGenerator rng4(rng1.substream(1));
+    BOOST_CHECK_EQUAL(rng4.stream(), 1);
+    BOOST_CHECK_EQUAL(rng4.state().index, rng3.state().index);
+
+    PhiloxRandomNumberGenerator rng5(rng4);
+    unsigned int num_equals(0);
+    for (unsigned int i(0); i < 100; ++i)
+    {
+        const uint32_t val(rng3.next());
+        BOOST_CHECK_EQUAL(val, rng5.next());
+        if (val == rng1.next())
+        {
+            ++num_equals;
+        }
+    }
+    BOOST_CHECK(num_equals < 5);
+
+    rng1.seed(12345);
+    rng2.seed(12345);
+    BOOST_CHECK_EQUAL(rng1.uniform_int(0, 9), rng2.uniform_int(0, 9));
+}
+
+BOOST_AUTO_TEST_CASE(PhiloxRandomNumberGenerator_test_draw_key)
+{
+    GSLRandomNumberGenerator rng(0);
+
+    // both halves of the key are drawn
+    bool high(false), low(false);
+    std::set<Integer> keys;
+    for (unsigned int i(0); i < 1000; ++i)
+    {
+        const uint64_t key(
+            static_cast<uint64_t>(PhiloxRandomNumberGenerator::draw_key(rng)));
+        high = high || (key >> 32) > 0x7fffffff;
+        low = low || (key & 0xffffffff) > 0x7fffffff;
+        keys.insert(static_cast<Integer>(key));
+    }
+    BOOST_CHECK(high);
+    BOOST_CHECK(low);
+    BOOST_CHECK_EQUAL(keys.size(), 1000);
+}
+
+BOOST_AUTO_TEST_CASE(PhiloxRandomNumberGenerator_test_distributions)
+{
+    PhiloxRandomNumberGenerator rng(0);
+
+    const std::size_t N(100000);
+    std::vector<Real> data(N);
+
+    rng.fill_uniform(&data[0], N, 1.0, 3.0);
+    Real sum(0.0);
+    for (std::size_t i(0); i < N; ++i)
+    {
+        BOOST_CHECK(1.0 <= data[i] && data[i] < 3.0);
+        sum += data[i];
+    }
+    BOOST_CHECK_CLOSE(sum / N, 2.0, 1.0);
+
+    rng.fill_gaussian(&data[0], N - 1, 2.0, 1.0);
+    sum = 0.0;
+    Real sum2(0.0);
+    for (std::size_t i(0); i < N - 1; ++i)
+    {
+        sum += data[i];
+        sum2 += (data[i] - 1.0) * (data[i] - 1.0);
+    }
+    BOOST_CHECK_CLOSE(sum / (N - 1), 1.0, 3.0);
+    BOOST_CHECK_CLOSE(sum2 / (N - 1), 4.0, 3.0);
+
+    for (std::size_t i(0); i < 1000; ++i)
+    {
+        const Integer k(rng.uniform_int(-3, 3));
+        BOOST_CHECK(-3 <= k && k <= 3);
+        BOOST_CHECK_CLOSE(length(rng.direction3d(2.0)), 2.0, 1e-8);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(PhiloxRandomNumberGenerator_test_base_poisson_moments)
+{
+    PhiloxRandomNumberGenerator rng(0);
+
+    // the default implementation of the base class, with a small and a large mean
+    const Real means[] = {3.0, 50.0};
+    const std::size_t N(100000);
+    for (std::size_t j(0); j < 2; ++j)
+    {
+        Real sum(0.0), sum2(0.0);
+        for (std::size_t i(0); i < N; ++i)
+        {
+            const Integer k(rng.RandomNumberGenerator::poisson(means[j]));
+            BOOST_CHECK(k >= 0);
+            sum += k;
+            sum2 += (k - means[j]) * (k - means[j]);
+        }
+        BOOST_CHECK_CLOSE(sum / N, means[j], 1.0);
+        BOOST_CHECK_CLOSE(sum2 / N, means[j], 3.0);
+    }
+    BOOST_CHECK_EQUAL(rng.RandomNumberGenerator::poisson(0.0), 0);
+}
+
+BOOST_AUTO_TEST_CASE(PhiloxRandomNumberGenerator_test_binomial)
+{
+    PhiloxRandomNumberGenerator rng(0);
+
+    // the inversion, BTRD and the reflection for p > 0.5
+    const Real ps[] = {0.05, 0.3, 0.9};
+    const Integer ns[] = {100, 1000, 1000};
+    const std::size_t N(100000);
+    for (std::size_t j(0); j < 3; ++j)
+    {
+        const Real mean(ns[j] * ps[j]), var(mean * (1.0 - ps[j]));
+        Real sum(0.0), sum2(0.0);
+        for (std::size_t i(0); i < N; ++i)
+        {
+            const Integer k(rng.binomial(ps[j], ns[j]));
+            BOOST_CHECK(0 <= k && k <= ns[j]);
+            sum += k;
+            sum2 += (k - mean) * (k - mean);
+        }
+        BOOST_CHECK_CLOSE(sum / N, mean, 1.0);
+        BOOST_CHECK_CLOSE(sum2 / N, var, 3.0);
+    }
+    BOOST_CHECK_EQUAL(rng.binomial(0.0, 10), 0);
+    BOOST_CHECK_EQUAL(rng.binomial(1.0, 10), 10);
+}
+
+#ifdef WITH_HDF5
+BOOST_AUTO_TEST_CASE(PhiloxRandomNumberGenerator_test_save_and_load)
+{
+    PhiloxRandomNumberGenerator rng1(7, 3);
+    rng1.next();
+
+    rng1.save("philox.h5");
+    PhiloxRandomNumberGenerator rng2("philox.h5");
+
+    BOOST_CHECK_EQUAL(rng2.stream(), 3);
+    for (unsigned int i(0); i < 10; ++i)
+    {
+        BOOST_CHECK_EQUAL(rng1.next(), rng2.next());
+    }
+}
+#endif
@@ -11,6 +11,7 @@
 
 #include <ecell4/core/Species.hpp>
 #include <ecell4/core/Context.hpp>
+#include <ecell4/core/SpeciesIDMap.hpp>
 
 using namespace ecell4;
 
@@ -158,3 +159,68 @@ BOOST_AUTO_TEST_CASE(Species_test_match3)
     // BOOST_CHECK_EQUAL(
     //     SpeciesExpressionMatcher((Species("_1._2")).count(Species("A.B.C"), globals), 2);
 }
+
+BOOST_AUTO_TEST_CASE(Species_test_intern)
+{
+    const Species sp1("A"), sp2("B"), sp3("A");
+    BOOST_CHECK_EQUAL(Species().id(), 0);
+
+    // only interning assigns an id
+    const Species::id_type num_interned(Species::num_interned());
+    const Species sp0("_test_intern_W");
+    BOOST_CHECK_EQUAL(sp0.id(), Species::uninterned);
+    BOOST_CHECK_EQUAL(Species::num_interned(), num_interned);
+
+    sp1.intern();
+    const Species::id_type id2(Species::intern("B"));
+    BOOST_CHECK_EQUAL(sp2.id(), id2);
+    BOOST_CHECK_EQUAL(sp1.id(), sp3.id());
+    BOOST_CHECK(sp1.id() != sp2.id());
+    BOOST_CHECK_EQUAL(Species::find_interned("A"), sp1.id());
+    BOOST_CHECK_EQUAL(Species::interned_serial(sp2.id()), "B");
+    BOOST_CHECK(sp2.id() < Species::num_interned());
+    BOOST_CHECK_THROW(Species::interned_serial(Species::num_interned()), NotFound);
+
+    Species sp4;
+    sp4.add_unit(UnitSpecies("A"));
+    BOOST_CHECK_EQUAL(sp4.id(), sp1.id());
+    BOOST_CHECK_EQUAL(sp4, sp1);
+
+    // neither building serials by add_unit nor hashing interns them
+    const Species::id_type num_interned2(Species::num_interned());
+    Species sp6;
+    sp6.add_unit(UnitSpecies("_test_intern_X"));
+    sp6.add_unit(UnitSpecies("_test_intern_Y"));
+    BOOST_CHECK(sp6 != sp1);
+    BOOST_CHECK_EQUAL(sp6, Species("_test_intern_X._test_intern_Y"));
+    const Species sp7("_test_intern_Z");
+    BOOST_CHECK_EQUAL(
+        std::hash<Species>()(sp7),
+        std::hash<Species>()(Species("_test_intern_Z")));
+    BOOST_CHECK_EQUAL(sp6.id(), Species::uninterned);
+    BOOST_CHECK_EQUAL(Species::num_interned(), num_interned2);
+
+    BOOST_CHECK_EQUAL(Species::interned_serial(sp6.intern()), sp6.serial());
+    BOOST_CHECK_EQUAL(Species::num_interned(), num_interned2 + 1);
+    BOOST_CHECK_EQUAL(Species("_test_intern_X._test_intern_Y").id(), sp6.id());
+
+    Species sp5(sp2);
+    BOOST_CHECK_EQUAL(sp5.id(), sp2.id());
+    sp5 = sp1;
+    BOOST_CHECK_EQUAL(sp5.id(), sp1.id());
+
+    // a key is interned when inserted, and found by its id
+    SpeciesIDMap<Integer> table;
+    table[sp1] = 1;
+    table[sp2] = 2;
+    table[sp3] += 10;
+    table[Species("_test_intern_V")] = 3;
+    BOOST_CHECK_EQUAL(table.size(), 3);
+    BOOST_CHECK_EQUAL(table[sp1], 11);
+    BOOST_CHECK(Species("_test_intern_V").id() != Species::uninterned);
+    BOOST_CHECK_EQUAL((*table.find(Species("_test_intern_V"))).second, 3);
+    BOOST_CHECK(table.find(Species("_test_intern_U")) == table.end());
+    BOOST_CHECK_EQUAL(table.count(Species("_test_intern_U")), 0);
+    BOOST_CHECK_EQUAL((*table.find(sp2)).second, 2);
+    BOOST_CHECK(!table.insert(std::make_pair(sp3, 0)).second);
+}
@@ -0,0 +1,77 @@
+#define BOOST_TEST_MODULE "ThreadPool_test"
+
+#ifdef UNITTEST_FRAMEWORK_LIBRARY_EXIST
+#   include <boost/test/unit_test.hpp>
+#else
+#   define BOOST_TEST_NO_LIB
+#   include <boost/test/included/unit_test.hpp>
+#endif
+
+#include <vector>
+#include <stdexcept>
+#include <ecell4/core/parallel_for.hpp>
+
+using namespace ecell4;
+
+
+BOOST_AUTO_TEST_CASE(ThreadPool_test_constructor)
+{
+    ThreadPool pool1(1);
+    BOOST_CHECK_EQUAL(pool1.num_threads(), 1);
+    ThreadPool pool4(4);
+    BOOST_CHECK_EQUAL(pool4.num_threads(), 4);
+    ThreadPool pool0;
+    BOOST_CHECK(pool0.num_threads() >= 1);
+}
+
+BOOST_AUTO_TEST_CASE(ThreadPool_test_parallel_for)
+{
+    ThreadPool pool(4);
+
+    // the same threads serve many loops one after another
+    const std::size_t n(100);
+    std::vector<int> counts(n, 0);
+    for (std::size_t loop(0); loop < 1000; ++loop)
+    {
+        pool.parallel_for(loop % (n + 1),
+            [&](const std::size_t i) { ++counts[i]; });
+    }
+
+    for (std::size_t i(0); i < n; ++i)
+    {
+        // the loop of size m visits i < m once
+        int expected(0);
+        for (std::size_t loop(0); loop < 1000; ++loop)
+        {
+            if (i < loop % (n + 1))
+            {
+                ++expected;
+            }
+        }
+        BOOST_CHECK_EQUAL(counts[i], expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ThreadPool_test_exception)
+{
+    ThreadPool pool(4);
+
+    BOOST_CHECK_THROW(
+        pool.parallel_for(100,
+            [](const std::size_t i)
+            {
+                if (i == 42)
+                {
+                    throw std::runtime_error("42");
+                }
+            }),
+        std::runtime_error);
+
+    // the pool is still available after an exception
+    std::vector<int> counts(100, 0);
+    pool.parallel_for(counts.size(), [&](const std::size_t i) { ++counts[i]; });
+    for (std::size_t i(0); i < counts.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(counts[i], 1);
+    }
+}
@@ -0,0 +1,174 @@
+#define BOOST_TEST_MODULE "TrajectoryHDF5Writer_test"
+
+#ifdef UNITTEST_FRAMEWORK_LIBRARY_EXIST
+#   include <boost/test/unit_test.hpp>
+#else
+#   define BOOST_TEST_NO_LIB
+#   include <boost/test/included/unit_test.hpp>
+#endif
+
+#include <ecell4/core/TrajectoryHDF5Writer.hpp>
+
+using namespace ecell4;
+
+#ifdef WITH_HDF5
+
+namespace
+{
+
+TrajectoryHDF5Writer::particle_container_type create_frame(const Integer n, const Real t)
+{
+    const Species sp1("A"), sp2("B");
+    TrajectoryHDF5Writer::particle_container_type particles;
+    for (Integer i(0); i < n; ++i)
+    {
+        particles.push_back(std::make_pair(
+            ParticleID(std::make_pair(0, i + 1)),
+            Particle(i % 3 == 0 ? sp2 : sp1, Real3(t, i, 2 * i), 1e-9, 1e-12)));
+    }
+    return particles;
+}
+
+std::vector<uint64_t> read_uint64(const H5::H5File& file, const std::string& name)
+{
+    H5::DataSet dataset(file.openDataSet(name));
+    hsize_t dims[] = {0, 0};
+    const int rank(dataset.getSpace().getSimpleExtentDims(dims));
+    std::vector<uint64_t> retval(rank == 1 ? dims[0] : dims[0] * dims[1]);
+    if (!retval.empty())
+    {
+        dataset.read(&retval[0], H5::PredType::NATIVE_UINT64);
+    }
+    return retval;
+}
+
+} // anonymous
+
+BOOST_AUTO_TEST_CASE(TrajectoryHDF5Writer_test_write)
+{
+    const std::string filename("trajectory_test.h5");
+
+    {
+        TrajectoryHDF5Writer writer(filename, false, 16, 1, true);
+        writer.write(0.0, create_frame(10, 0.0));
+        writer.write(0.5, create_frame(0, 0.5));
+        BOOST_CHECK_EQUAL(writer.num_frames(), 2);
+        BOOST_CHECK_EQUAL(writer.num_species(), 2);
+    }
+
+    {
+        // a new species appears in the appended frame
+        TrajectoryHDF5Writer writer(filename, true, 16, 1, true);
+        BOOST_CHECK_EQUAL(writer.num_frames(), 2);
+
+        TrajectoryHDF5Writer::particle_container_type particles(create_frame(20, 1.0));
+        particles.push_back(std::make_pair(
+            ParticleID(std::make_pair(0, 100)),
+            Particle(Species("C"), Real3(), 1e-9, 1e-12)));
+        writer.write(1.0, particles);
+        BOOST_CHECK_EQUAL(writer.num_frames(), 3);
+        BOOST_CHECK_EQUAL(writer.num_species(), 3);
+    }
+
+    H5::H5File file(filename.c_str(), H5F_ACC_RDONLY);
+
+    const std::vector<uint64_t> offsets(read_uint64(file, "frames/offset"));
+    const std::vector<uint64_t> sizes(read_uint64(file, "frames/size"));
+    BOOST_CHECK_EQUAL(offsets.size(), 3);
+    BOOST_CHECK_EQUAL(offsets[0], 0);
+    BOOST_CHECK_EQUAL(offsets[1], 10);
+    BOOST_CHECK_EQUAL(offsets[2], 10);
+    BOOST_CHECK_EQUAL(sizes[0], 10);
+    BOOST_CHECK_EQUAL(sizes[1], 0);
+    BOOST_CHECK_EQUAL(sizes[2], 21);
+
+    // frames x species, filled with 0 for species not appeared yet
+    const std::vector<uint64_t> counts(read_uint64(file, "frames/counts"));
+    BOOST_CHECK_EQUAL(counts.size(), 9);
+    BOOST_CHECK_EQUAL(counts[0], 4);  // B
+    BOOST_CHECK_EQUAL(counts[1], 6);  // A
+    BOOST_CHECK_EQUAL(counts[2], 0);
+    BOOST_CHECK_EQUAL(counts[3] + counts[4] + counts[5], 0);
+    BOOST_CHECK_EQUAL(counts[6], 7);
+    BOOST_CHECK_EQUAL(counts[7], 13);
+    BOOST_CHECK_EQUAL(counts[8], 1);
+
+    H5::DataSet dataset(file.openDataSet("particles"));
+    hsize_t dims[] = {0};
+    dataset.getSpace().getSimpleExtentDims(dims);
+    BOOST_CHECK_EQUAL(dims[0], 31);
+
+    std::vector<TrajectoryHDF5Writer::h5_particle_struct> particles(dims[0]);
+    dataset.read(&particles[0], TrajectoryHDF5Writer::traits_type::get_particle_comp_type());
+    BOOST_CHECK_EQUAL(particles[3].serial, 4);
+    BOOST_CHECK_EQUAL(particles[3].posy, 3.0);
+    BOOST_CHECK_EQUAL(particles[10].posx, 1.0);
+    BOOST_CHECK_EQUAL(particles[30].sid, 3);
+}
+
+BOOST_AUTO_TEST_CASE(TrajectoryHDF5Writer_test_long_serial)
+{
+    const std::string filename("trajectory_test_long_serial.h5");
+    const std::string serial1("A(b^1,s=phosphorylated).B(a^1,c^2).C(b^2,loc=cytoplasm)");
+    const std::string serial2(serial1 + ".D");
+    BOOST_CHECK(serial1.size() > 32);
+
+    {
+        TrajectoryHDF5Writer::particle_container_type particles;
+        particles.push_back(std::make_pair(
+            ParticleID(std::make_pair(0, 1)),
+            Particle(Species(serial1), Real3(), 1e-9, 1e-12)));
+        TrajectoryHDF5Writer writer(filename);
+        writer.write(0.0, particles);
+    }
+
+    {
+        // serials sharing a long prefix must not be merged when appending
+        TrajectoryHDF5Writer::particle_container_type particles;
+        particles.push_back(std::make_pair(
+            ParticleID(std::make_pair(0, 1)),
+            Particle(Species(serial1), Real3(), 1e-9, 1e-12)));
+        particles.push_back(std::make_pair(
+            ParticleID(std::make_pair(0, 2)),
+            Particle(Species(serial2), Real3(), 1e-9, 1e-12)));
+        TrajectoryHDF5Writer writer(filename, true);
+        BOOST_CHECK_EQUAL(writer.num_species(), 1);
+        writer.write(1.0, particles);
+        BOOST_CHECK_EQUAL(writer.num_species(), 2);
+    }
+
+    H5::H5File file(filename.c_str(), H5F_ACC_RDONLY);
+    H5::DataSet dataset(file.openDataSet("species"));
+    hsize_t dims[] = {0};
+    dataset.getSpace().getSimpleExtentDims(dims);
+    BOOST_CHECK_EQUAL(dims[0], 2);
+
+    const H5::CompType type(TrajectoryHDF5Writer::get_species_comp_type());
+    std::vector<TrajectoryHDF5Writer::h5_species_struct> species(dims[0]);
+    dataset.read(&species[0], type);
+    BOOST_CHECK_EQUAL(species[0].id, 1);
+    BOOST_CHECK_EQUAL(std::string(species[0].serial), serial1);
+    BOOST_CHECK_EQUAL(species[1].id, 2);
+    BOOST_CHECK_EQUAL(std::string(species[1].serial), serial2);
+    H5::DataSet::vlenReclaim(
+        type, H5::DataSpace(1, dims), H5::DSetMemXferPropList::DEFAULT, &species[0]);
+}
+
+BOOST_AUTO_TEST_CASE(TrajectoryHDF5Writer_test_append_to_another)
+{
+    const std::string filename("trajectory_test_another.h5");
+    {
+        H5::H5File file(filename.c_str(), H5F_ACC_TRUNC);
+    }
+    BOOST_CHECK_THROW(TrajectoryHDF5Writer(filename, true), IllegalState);
+    BOOST_CHECK_THROW(TrajectoryHDF5Writer(filename, false, 0), IllegalArgument);
+}
+
+#else
+
+BOOST_AUTO_TEST_CASE(TrajectoryHDF5Writer_test_without_hdf5)
+{
+    ;
+}
+
+#endif
@@ -0,0 +1,260 @@
+#define BOOST_TEST_MODULE "ensemble_test"
+
+#ifdef UNITTEST_FRAMEWORK_LIBRARY_EXIST
+#   include <boost/test/unit_test.hpp>
+#else
+#   define BOOST_TEST_NO_LIB
+#   include <boost/test/included/unit_test.hpp>
+#endif
+
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <cmath>
+
+#include <ecell4/core/RandomNumberGenerator.hpp>
+#include <ecell4/core/NetworkModel.hpp>
+#include <ecell4/core/SimulatorFactory.hpp>
+#include <ecell4/core/ensemble.hpp>
+
+using namespace ecell4;
+
+#ifdef WITH_HDF5
+
+namespace
+{
+
+/**
+ * a world with a number of A decaying at the rate 1, saved as (t, A).
+ */
+class DecayWorld
+{
+public:
+
+    DecayWorld(const Real3& edge_lengths)
+        : edge_lengths_(edge_lengths), t_(0.0), num_(0),
+          rng_(new GSLRandomNumberGenerator())
+    {
+        ;
+    }
+
+    DecayWorld(const Real3& edge_lengths, const boost::shared_ptr<RandomNumberGenerator>& rng)
+        : edge_lengths_(edge_lengths), t_(0.0), num_(0), rng_(rng)
+    {
+        ;
+    }
+
+    const Real3& edge_lengths() const
+    {
+        return edge_lengths_;
+    }
+
+    Real t() const
+    {
+        return t_;
+    }
+
+    void set_t(const Real t)
+    {
+        t_ = t;
+    }
+
+    Integer num() const
+    {
+        return num_;
+    }
+
+    void set_num(const Integer num)
+    {
+        num_ = num;
+    }
+
+    Real get_value(const Species& sp) const
+    {
+        return (sp == Species("A") ? num_ : 0);
+    }
+
+    boost::shared_ptr<RandomNumberGenerator>& rng()
+    {
+        return rng_;
+    }
+
+    void bind_to(const boost::shared_ptr<Model>& /* model */)
+    {
+        ;
+    }
+
+    void save(const std::string& filename) const
+    {
+        H5::H5File file(filename.c_str(), H5F_ACC_TRUNC);
+        const hsize_t dims[] = {2};
+        const Real state[] = {t_, static_cast<Real>(num_)};
+        file.createDataSet("state", H5::PredType::NATIVE_DOUBLE, H5::DataSpace(1, dims))
+            .write(state, H5::PredType::NATIVE_DOUBLE);
+    }
+
+    void load(const std::string& filename)
+    {
+        H5::H5File file(filename.c_str(), H5F_ACC_RDONLY);
+        Real state[2];
+        file.openDataSet("state").read(state, H5::PredType::NATIVE_DOUBLE);
+        t_ = state[0];
+        num_ = static_cast<Integer>(state[1]);
+    }
+
+protected:
+
+    const Real3 edge_lengths_;
+    Real t_;
+    Integer num_;
+    boost::shared_ptr<RandomNumberGenerator> rng_;
+};
+
+class DecaySimulator
+{
+public:
+
+    DecaySimulator(const boost::shared_ptr<DecayWorld>& world, const boost::shared_ptr<Model>& /* model */)
+        : world_(world)
+    {
+        ;
+    }
+
+    bool step(const Real upto)
+    {
+        const Real dt(world_->num() > 0 ?
+            -std::log(world_->rng()->uniform(0.0, 1.0)) / world_->num() : inf);
+        if (world_->t() + dt > upto)
+        {
+            world_->set_t(upto);
+            return false;
+        }
+        world_->set_t(world_->t() + dt);
+        world_->set_num(world_->num() - 1);
+        return true;
+    }
+
+protected:
+
+    boost::shared_ptr<DecayWorld> world_;
+};
+
+class DecayFactory
+    : public SimulatorFactory<DecayWorld, DecaySimulator>
+{
+public:
+
+    DecayFactory()
+        : rng_()
+    {
+        ;
+    }
+
+    DecayFactory& rng(const boost::shared_ptr<RandomNumberGenerator>& rng)
+    {
+        rng_ = rng;
+        return (*this);
+    }
+
+    bool has_rng() const
+    {
+        return static_cast<bool>(rng_);
+    }
+
+protected:
+
+    DecayWorld* create_world(const Real3& edge_lengths) const
+    {
+        return (rng_ ? new DecayWorld(edge_lengths, rng_) : new DecayWorld(edge_lengths));
+    }
+
+    boost::shared_ptr<RandomNumberGenerator> rng_;
+};
+
+} // anonymous
+
+BOOST_AUTO_TEST_CASE(ensemble_test_num_ensemble_times)
+{
+    BOOST_CHECK_EQUAL(num_ensemble_times(1.0, 0.1), 11);
+    BOOST_CHECK_EQUAL(num_ensemble_times(1.0, 0.3), 5);
+    BOOST_CHECK_EQUAL(num_ensemble_times(0.0, 0.1), 1);
+    BOOST_CHECK_THROW(num_ensemble_times(1.0, 0.0), IllegalArgument);
+}
+
+BOOST_AUTO_TEST_CASE(ensemble_test_run_ensemble)
+{
+    boost::shared_ptr<Model> model(new NetworkModel());
+    DecayFactory factory;
+    boost::shared_ptr<DecayWorld> world(factory.world(ones()));
+    world->set_t(0.5);
+    world->set_num(100);
+
+    std::vector<Integer> seeds;
+    seeds.push_back(1);
+    seeds.push_back(2);
+    seeds.push_back(1);
+    seeds.push_back(3);
+    seeds.push_back(4);
+    std::vector<std::string> species;
+    species.push_back("A");
+    species.push_back("B");
+
+    const Real duration(1.0), dt(0.1);
+    const std::size_t num_times(num_ensemble_times(duration, dt));
+    std::vector<Real> data1(seeds.size() * num_times * 3), data2(data1.size());
+    run_ensemble(factory, model, world, seeds, duration, dt, species, &data1[0], 1);
+    run_ensemble(factory, model, world, seeds, duration, dt, species, &data2[0], 3);
+
+    // the replicates do not depend on the number of threads, but on the seeds
+    BOOST_CHECK(data1 == data2);
+    for (std::size_t i(0); i < seeds.size(); ++i)
+    {
+        const Real* row(&data1[i * num_times * 3]);
+        BOOST_CHECK_EQUAL(row[0], 0.5);
+        BOOST_CHECK_EQUAL(row[1], 100);
+        BOOST_CHECK_CLOSE(row[(num_times - 1) * 3], 0.5 + duration, 1e-10);
+        for (std::size_t k(0); k + 1 < num_times; ++k)
+        {
+            BOOST_CHECK(row[(k + 1) * 3 + 1] <= row[k * 3 + 1]);
+            BOOST_CHECK_EQUAL(row[k * 3 + 2], 0);
+        }
+    }
+    BOOST_CHECK(std::equal(
+        data1.begin(), data1.begin() + num_times * 3, data1.begin() + 2 * num_times * 3));
+    BOOST_CHECK(!std::equal(
+        data1.begin(), data1.begin() + num_times * 3, data1.begin() + num_times * 3));
+
+    // the given world is left as it is
+    BOOST_CHECK_EQUAL(world->t(), 0.5);
+    BOOST_CHECK_EQUAL(world->num(), 100);
+}
+
+BOOST_AUTO_TEST_CASE(ensemble_test_shared_rng)
+{
+    boost::shared_ptr<Model> model(new NetworkModel());
+    boost::shared_ptr<RandomNumberGenerator> rng(new GSLRandomNumberGenerator());
+    DecayFactory factory;
+    factory.rng(rng);
+    boost::shared_ptr<DecayWorld> world(factory.world(ones()));
+    world->set_num(100);
+
+    std::vector<Integer> seeds(4, 1);
+    std::vector<std::string> species(1, "A");
+    const Real duration(1.0), dt(0.5);
+    std::vector<Real> data(seeds.size() * num_ensemble_times(duration, dt) * 2);
+
+    // the replicates would race on the shared generator
+    BOOST_CHECK_THROW(
+        run_ensemble(factory, model, world, seeds, duration, dt, species, &data[0], 2),
+        IllegalArgument);
+    run_ensemble(factory, model, world, seeds, duration, dt, species, &data[0], 1);
+    BOOST_CHECK_EQUAL(data[1], 100);
+}
+
+#else
+
+BOOST_AUTO_TEST_CASE(ensemble_test_without_hdf5)
+{
+    BOOST_CHECK_EQUAL(num_ensemble_times(1.0, 0.1), 11);
+}
+
+#endif
@@ -0,0 +1,37 @@
+#define BOOST_TEST_MODULE "functions_test"
+
+#ifdef UNITTEST_FRAMEWORK_LIBRARY_EXIST
+#   include <boost/test/unit_test.hpp>
+#else
+#   define BOOST_TEST_NO_LIB
+#   include <boost/test/included/unit_test.hpp>
+#endif
+
+#include <algorithm>
+
+#include <ecell4/core/functions.hpp>
+
+using namespace ecell4;
+
+
+BOOST_AUTO_TEST_CASE(functions_test_modulo)
+{
+  BOOST_CHECK_EQUAL(modulo(3.5, 2.0), 1.5);
+  BOOST_CHECK_EQUAL(modulo(-0.5, 2.0), 1.5);
+  BOOST_CHECK_EQUAL(modulo(-2.0, 2.0), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(functions_test_fold_periodic)
+{
+  // values further than one period from [0, L) are folded as well
+  const Real L(2.0);
+  const Real values[] = {-4.5, -2.5, -0.5, 0.0, 1.5, 2.0, 3.5, 7.0};
+  Real x[8];
+  std::copy(values, values + 8, x);
+  fold_periodic(x, 8, L);
+  for (unsigned int i(0); i < 8; ++i)
+  {
+    BOOST_CHECK(0.0 <= x[i] && x[i] < L);
+    BOOST_CHECK_EQUAL(x[i], modulo(values[i], L));
+  }
+}
@@ -0,0 +1,179 @@
+#define BOOST_TEST_MODULE "observers_test"
+
+#ifdef UNITTEST_FRAMEWORK_LIBRARY_EXIST
+#   include <boost/test/unit_test.hpp>
+#else
+#   define BOOST_TEST_NO_LIB
+#   include <boost/test/included/unit_test.hpp>
+#endif
+
+#include <cstdio>
+#include <fstream>
+
+#include <ecell4/core/NetworkModel.hpp>
+#include <ecell4/core/WorldInterface.hpp>
+#include <ecell4/core/observers.hpp>
+
+#ifdef WITH_HDF5
+#include <ecell4/core/TrajectoryHDF5Writer.hpp>
+#endif
+
+using namespace ecell4;
+
+namespace
+{
+
+/**
+ * a world which only holds a list of particles for observers.
+ * the time is always zero, see WorldInterface::t().
+ */
+class ParticleListWorld
+    : public WorldInterface
+{
+public:
+
+    typedef std::vector<std::pair<ParticleID, Particle> > particle_container_type;
+
+public:
+
+    ParticleListWorld()
+        : edge_lengths_(1e-6, 1e-6, 1e-6), particles_()
+    {
+        ;
+    }
+
+    void set_t(const Real& /* t */)
+    {
+        throw NotSupported("set_t(const Real&) is not supported.");
+    }
+
+    void save(const std::string& /* filename */) const
+    {
+        throw NotSupported("save(const std::string&) is not supported.");
+    }
+
+    const Real3& edge_lengths() const
+    {
+        return edge_lengths_;
+    }
+
+    particle_container_type list_particles() const
+    {
+        return particles_;
+    }
+
+    particle_container_type& particles()
+    {
+        return particles_;
+    }
+
+protected:
+
+    Real3 edge_lengths_;
+    particle_container_type particles_;
+};
+
+} // anonymous
+
+BOOST_AUTO_TEST_CASE(observers_test_async_csv_format)
+{
+    boost::shared_ptr<NetworkModel> model(new NetworkModel());
+    boost::shared_ptr<ParticleListWorld> world(new ParticleListWorld());
+    world->particles().push_back(std::make_pair(
+        ParticleID(std::make_pair(0, 1)),
+        Particle(Species("A"), Real3(1e-7, 2e-7, 3e-7), 2.5e-9, 1e-12)));
+
+    // the format is read by the writer thread while it runs
+    FixedIntervalCSVObserver observer(1.0, "async_test_%03d.csv");
+    observer.set_async(1);
+    observer.initialize(world, model);
+    BOOST_CHECK_THROW(observer.set_header("x,y,z"), IllegalState);
+    BOOST_CHECK_THROW(observer.set_formatter("%2%,%3%,%4%"), IllegalState);
+    observer.fire(NULL, world);
+    observer.finalize(world);
+    observer.set_header("x,y,z");
+
+    BOOST_CHECK(std::ifstream("async_test_000.csv").good());
+    std::remove("async_test_000.csv");
+}
+
+#ifdef WITH_HDF5
+BOOST_AUTO_TEST_CASE(observers_test_async_hdf5)
+{
+    boost::shared_ptr<NetworkModel> model(new NetworkModel());
+    boost::shared_ptr<ParticleListWorld> world(new ParticleListWorld());
+    for (Integer i(0); i < 100; ++i)
+    {
+        world->particles().push_back(std::make_pair(
+            ParticleID(std::make_pair(0, i + 1)),
+            Particle(Species("A"), Real3(0.0, 1e-8 * i, 0.0), 2.5e-9, 1e-12)));
+    }
+
+    // two observers write on their own threads, and one synchronously
+    const Real dt(1e-3);
+    const std::string filenames[] = {
+        "async_test1.h5", "async_test2.h5", "async_test3.h5"};
+    std::vector<boost::shared_ptr<FixedIntervalHDF5TrajectoryObserver> > observers;
+    for (unsigned int i(0); i < 3; ++i)
+    {
+        observers.push_back(boost::shared_ptr<FixedIntervalHDF5TrajectoryObserver>(
+            new FixedIntervalHDF5TrajectoryObserver(dt, filenames[i])));
+    }
+    observers[0]->set_async(2);
+    observers[1]->set_async(1);
+
+    for (unsigned int i(0); i < 3; ++i)
+    {
+        observers[i]->initialize(world, model);
+    }
+    for (Integer k(0); k <= 50; ++k)
+    {
+        for (ParticleListWorld::particle_container_type::iterator
+            j(world->particles().begin()); j != world->particles().end(); ++j)
+        {
+            (*j).second.position()[0] = 1e-9 * k;
+        }
+        for (unsigned int i(0); i < 3; ++i)
+        {
+            observers[i]->fire(NULL, world);
+        }
+    }
+    for (unsigned int i(0); i < 3; ++i)
+    {
+        observers[i]->finalize(world);
+    }
+
+    // all files have the same frames in the same order
+    std::vector<uint64_t> sizes[3];
+    std::vector<Real> xs[3];
+    for (unsigned int i(0); i < 3; ++i)
+    {
+        {
+            H5::H5File file(filenames[i], H5F_ACC_RDONLY);
+            H5::DataSet size(file.openDataSet("frames/size")), particles(file.openDataSet("particles"));
+            hsize_t dims[] = {0};
+            size.getSpace().getSimpleExtentDims(dims);
+            sizes[i].resize(dims[0]);
+            size.read(&sizes[i][0], H5::PredType::NATIVE_UINT64);
+
+            particles.getSpace().getSimpleExtentDims(dims);
+            std::vector<TrajectoryHDF5Writer::h5_particle_struct> data(dims[0]);
+            particles.read(&data[0], TrajectoryHDF5Writer::traits_type::get_particle_comp_type());
+            for (std::size_t j(0); j < data.size(); ++j)
+            {
+                xs[i].push_back(data[j].posx);
+            }
+        }
+        std::remove(filenames[i].c_str());
+    }
+    BOOST_CHECK_EQUAL(sizes[2].size(), 51);
+    BOOST_CHECK_EQUAL(sizes[2].back(), 100);
+    BOOST_CHECK_EQUAL(xs[2].size(), 5100);
+    BOOST_CHECK_EQUAL(xs[2].back(), 1e-9 * 50);
+    for (unsigned int i(0); i < 2; ++i)
+    {
+        BOOST_CHECK(sizes[i] == sizes[2]);
+        BOOST_CHECK(xs[i] == xs[2]);
+    }
+}
+#endif
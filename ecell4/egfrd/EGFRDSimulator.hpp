@@ -9,6 +9,7 @@
 #include <boost/lexical_cast.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/intrusive_ptr.hpp>
 #include <boost/fusion/container/map.hpp>
 #include <boost/fusion/algorithm/iteration/for_each.hpp>
 #include <boost/fusion/sequence/intrinsic/at_key.hpp>
@@ -19,9 +20,12 @@
 
 #include <gsl/gsl_sf_log.h>
 
+#include <ecell4/core/config.h>
 #include <ecell4/core/get_mapper_mf.hpp>
 #include <ecell4/core/Model.hpp>
 #include <ecell4/core/EventScheduler.hpp>
+#include <ecell4/core/RandomNumberGenerator.hpp>
+#include <ecell4/core/parallel_for.hpp>
 #include <ecell4/core/SerialIDGenerator.hpp>
 
 #include "utils/array_helper.hpp"
@@ -38,9 +42,11 @@
 //#include "EventScheduler.hpp"
 #include "ParticleSimulator.hpp"
 #include "MatrixSpace.hpp"
+#include "sorted_list.hpp"
 #include "AnalyticalSingle.hpp"
 #include "AnalyticalPair.hpp"
 #include "Multi.hpp"
+#include "GreensFunction3DAbsSymTable.hpp"
 
 #include <greens_functions/PairGreensFunction.hpp>
 #include <greens_functions/GreensFunction3DRadAbs.hpp>
@@ -63,7 +69,11 @@ struct EGFRDSimulatorTraitsBase: public ParticleSimulatorTraitsBase<Tworld_>
     typedef ecell4::SerialIDGenerator<domain_id_type> domain_id_generator;
     typedef Domain<EGFRDSimulatorTraitsBase> domain_type;
     typedef std::pair<const domain_id_type, boost::shared_ptr<domain_type> > domain_id_pair;
-    typedef ecell4::EventScheduler event_scheduler_type; // base_type::time_type == ecell4::Real
+#ifdef WITH_CALENDAR_QUEUE
+    typedef ecell4::IntrusiveCalendarEventScheduler event_scheduler_type;
+#else
+    typedef ecell4::IntrusiveEventScheduler event_scheduler_type; // base_type::time_type == ecell4::Real
+#endif
     // typedef EventScheduler<typename base_type::time_type> event_scheduler_type;
 
     typedef typename event_scheduler_type::identifier_type event_id_type;
@@ -696,11 +706,13 @@ protected:
             // return multiply(normalize(old_iv), r);
         }
 
-        draw_on_com_escape(rng_type& rng, world_type const& world)
-            : rng_(rng), world_(world) {}
+        draw_on_com_escape(rng_type& rng, world_type const& world,
+                GreensFunction3DAbsSymTable const* table)
+            : rng_(rng), world_(world), table_(table) {}
 
         rng_type& rng_;
         world_type const& world_;
+        GreensFunction3DAbsSymTable const* table_;
     };
 
     // struct draw_on_single_reaction
@@ -782,7 +794,7 @@ protected:
                         rng_.uniform(-1., 1.)),
                     draw_r(
                         rng_,
-                        greens_functions::GreensFunction3DAbsSym(domain.D_R(), domain.a_R()),
+                        TabulatedGreensFunction3DAbsSym(domain.D_R(), domain.a_R(), table_),
                         dt, domain.a_R())));
         }
 
@@ -830,11 +842,13 @@ protected:
             // return multiply(normalize(old_iv), domain.a_r());
         }
 
-        draw_on_iv_escape(rng_type& rng, world_type const& world)
-            : rng_(rng), world_(world) {}
+        draw_on_iv_escape(rng_type& rng, world_type const& world,
+                GreensFunction3DAbsSymTable const* table)
+            : rng_(rng), world_(world), table_(table) {}
 
         rng_type& rng_;
         world_type const& world_;
+        GreensFunction3DAbsSymTable const* table_;
     };
 
     struct draw_on_iv_reaction
@@ -851,7 +865,7 @@ protected:
                         rng_.uniform(-1., 1.)),
                     draw_r(
                         rng_,
-                        greens_functions::GreensFunction3DAbsSym(domain.D_R(), domain.a_R()),
+                        TabulatedGreensFunction3DAbsSym(domain.D_R(), domain.a_R(), table_),
                         dt, domain.a_R())));
         }
 
@@ -898,11 +912,13 @@ protected:
             // return multiply(domain.sigma(), normalize(old_iv));
         }
 
-        draw_on_iv_reaction(rng_type& rng, world_type const& world)
-            : rng_(rng), world_(world) {}
+        draw_on_iv_reaction(rng_type& rng, world_type const& world,
+                GreensFunction3DAbsSymTable const* table)
+            : rng_(rng), world_(world), table_(table) {}
 
         rng_type& rng_;
         world_type const& world_;
+        GreensFunction3DAbsSymTable const* table_;
     };
 
     struct draw_on_burst
@@ -919,7 +935,7 @@ protected:
                         rng_.uniform(-1., 1.)),
                     draw_r(
                         rng_,
-                        greens_functions::GreensFunction3DAbsSym(domain.D_R(), domain.a_R()),
+                        TabulatedGreensFunction3DAbsSym(domain.D_R(), domain.a_R(), table_),
                         dt, domain.a_R())));
         }
 
@@ -976,11 +992,13 @@ protected:
             // return multiply(normalize(old_iv), r);
         }
 
-        draw_on_burst(rng_type& rng, world_type const& world)
-            : rng_(rng), world_(world) {}
+        draw_on_burst(rng_type& rng, world_type const& world,
+                GreensFunction3DAbsSymTable const* table)
+            : rng_(rng), world_(world), table_(table) {}
 
         rng_type& rng_;
         world_type const& world_;
+        GreensFunction3DAbsSymTable const* table_;
     };
 public:
     typedef abstract_limited_generator<domain_id_pair> domain_id_pair_generator;
@@ -1010,7 +1028,10 @@ public:
                                      cylindrical_shell_matrix_type*>(csmat_.get())),
           single_shell_factor_(.1),
           multi_shell_factor_(.05),
-          rejected_moves_(0), zero_step_count_(0), dirty_(true)
+          rejected_moves_(0), zero_step_count_(0), dirty_(true),
+          tabulate_greens_functions_(false),
+          parallel_(false), num_threads_(0), batch_size_(16),
+          num_batched_events_(0)
     {
         std::fill(domain_count_per_type_.begin(), domain_count_per_type_.end(), 0);
         std::fill(single_step_count_.begin(), single_step_count_.end(), 0);
@@ -1034,7 +1055,10 @@ public:
                                      cylindrical_shell_matrix_type*>(csmat_.get())),
           single_shell_factor_(.1),
           multi_shell_factor_(.05),
-          rejected_moves_(0), zero_step_count_(0), dirty_(true)
+          rejected_moves_(0), zero_step_count_(0), dirty_(true),
+          tabulate_greens_functions_(false),
+          parallel_(false), num_threads_(0), batch_size_(16),
+          num_batched_events_(0)
     {
         std::fill(domain_count_per_type_.begin(), domain_count_per_type_.end(), 0);
         std::fill(single_step_count_.begin(), single_step_count_.end(), 0);
@@ -1137,6 +1161,91 @@ public:
         return multi_step_count_[kind];
     }
 
+    /**
+     * draw escape times and displacements of singles, and those of the
+     * center of mass of pairs, from GreensFunction3DAbsSymTable::instance()
+     * instead of solving them exactly, when the table is accurate enough.
+     */
+    void set_tabulate_greens_functions(const bool val)
+    {
+        tabulate_greens_functions_ = val;
+    }
+
+    bool tabulate_greens_functions() const
+    {
+        return tabulate_greens_functions_;
+    }
+
+    /**
+     * the cost of neighbor queries to the shell matrices, i.e. the number
+     * of queries, and the numbers of cells and shells visited by them.
+     */
+    std::size_t num_shell_queries() const
+    {
+        return (*ssmat_).num_queries() + (*csmat_).num_queries();
+    }
+
+    std::size_t num_shell_cells_visited() const
+    {
+        return (*ssmat_).num_cells_visited() + (*csmat_).num_cells_visited();
+    }
+
+    std::size_t num_shell_candidates() const
+    {
+        return (*ssmat_).num_candidates() + (*csmat_).num_candidates();
+    }
+
+    /**
+     * fire escapes of spherical singles far apart from each other at the
+     * head of the queue in batches, drawing their next events on
+     * num_threads threads (0 means the number of hardware threads).
+     * See fire_batch. The trajectory depends on the seed and the batch
+     * size, but not on num_threads. It differs from the serial one with
+     * the same seed. The threads are started here, and kept until the
+     * simulator is destroyed or switched back.
+     */
+    void set_parallel(const bool parallel, const std::size_t num_threads = 0)
+    {
+        parallel_ = parallel;
+        num_threads_ = num_threads;
+        pool_.reset(parallel ? new ecell4::ThreadPool(num_threads) : NULL);
+    }
+
+    bool is_parallel() const
+    {
+        return parallel_;
+    }
+
+    std::size_t num_threads() const
+    {
+        return num_threads_;
+    }
+
+    /**
+     * the maximum number of events in a batch (16 by default).
+     */
+    void set_batch_size(const std::size_t size)
+    {
+        if (size == 0)
+        {
+            throw ecell4::IllegalArgument("The batch size must be positive.");
+        }
+        batch_size_ = size;
+    }
+
+    std::size_t batch_size() const
+    {
+        return batch_size_;
+    }
+
+    /**
+     * the number of events fired in batches of two or more.
+     */
+    std::size_t num_batched_events() const
+    {
+        return num_batched_events_;
+    }
+
     std::vector<domain_id_type>*
     get_neighbor_domains(particle_shape_type const& p)
     {
@@ -1281,7 +1390,7 @@ public:
         // if (upto >= scheduler_.top().second->time())
         if (upto >= scheduler_.next_time())
         {
-            _step();
+            _step(upto);
             return true;
         }
 
@@ -1590,8 +1699,9 @@ protected:
         if (base_type::paranoiac_)
             BOOST_ASSERT(domains_.find(domain.id()) != domains_.end());
 
-        boost::shared_ptr<event_type> new_event(
-            new single_event(this->t() + domain.dt(), domain, kind));
+        const boost::intrusive_ptr<event_type> new_event(
+            base_type::event_pool_.template create<single_event>(
+                this->t() + domain.dt(), domain, kind));
         domain.event() = std::make_pair(scheduler_.add(new_event), new_event);
         LOG_DEBUG(("add_event: #%d - %s", domain.event().first, boost::lexical_cast<std::string>(domain).c_str()));
     }
@@ -1601,8 +1711,9 @@ protected:
         if (base_type::paranoiac_)
             BOOST_ASSERT(domains_.find(domain.id()) != domains_.end());
 
-        boost::shared_ptr<event_type> new_event(
-            new pair_event(this->t() + domain.dt(), domain, kind));
+        const boost::intrusive_ptr<event_type> new_event(
+            base_type::event_pool_.template create<pair_event>(
+                this->t() + domain.dt(), domain, kind));
         domain.event() = std::make_pair(scheduler_.add(new_event), new_event);
         LOG_DEBUG(("add_event: #%d - %s", domain.event().first, boost::lexical_cast<std::string>(domain).c_str()));
     }
@@ -1612,8 +1723,9 @@ protected:
         if (base_type::paranoiac_)
             BOOST_ASSERT(domains_.find(domain.id()) != domains_.end());
 
-        boost::shared_ptr<event_type> new_event(
-            new multi_event(this->t() + domain.dt(), domain));
+        const boost::intrusive_ptr<event_type> new_event(
+            base_type::event_pool_.template create<multi_event>(
+                this->t() + domain.dt(), domain));
         domain.event() = std::make_pair(scheduler_.add(new_event), new_event);
         LOG_DEBUG(("add_event: #%d - %s", domain.event().first, boost::lexical_cast<std::string>(domain).c_str()));
     }
@@ -1625,7 +1737,8 @@ protected:
     {
         const double rnd(this->rng().uniform(0, 1));
         const double dt(gsl_sf_log(1.0 / rnd) / double(rr.k() * (*base_type::world_).volume()));
-        boost::shared_ptr<event_type> new_event(new birth_event(this->t() + dt, rr));
+        const boost::intrusive_ptr<event_type> new_event(
+            base_type::event_pool_.template create<birth_event>(this->t() + dt, rr));
         scheduler_.add(new_event);
     }
 
@@ -1835,6 +1948,18 @@ protected:
     }
     // }}}
 
+    // greens_functions {{{
+    GreensFunction3DAbsSymTable const* greens_function_table() const
+    {
+        return tabulate_greens_functions_ ? &GreensFunction3DAbsSymTable::instance() : NULL;
+    }
+
+    TabulatedGreensFunction3DAbsSym abs_sym_greens_function(D_type D, length_type a) const
+    {
+        return TabulatedGreensFunction3DAbsSym(D, a, greens_function_table());
+    }
+    // }}}
+
     // draw_r {{{
     template<typename Tgf>
     static length_type draw_r(rng_type& rng,
@@ -1928,13 +2053,10 @@ protected:
             AnalyticalSingle<traits_type, Tshell> const& domain,
             time_type dt)
     {
-        typedef Tshell shell_type;
-        typedef typename shell_type::shape_type shape_type;
-        typedef typename detail::get_greens_function<shape_type>::type greens_function;
         length_type const r(
             draw_r(
                 this->rng(),
-                greens_function(
+                abs_sym_greens_function(
                     domain.particle().second.D(),
                     domain.mobility_radius()),
                 dt,
@@ -2018,7 +2140,7 @@ protected:
     boost::array<position_type, 2> draw_new_positions(
         AnalyticalPair<traits_type, T> const& domain, time_type dt)
     {
-        Tdraw d(this->rng(), *base_type::world_);
+        Tdraw d(this->rng(), *base_type::world_, greens_function_table());
         position_type const new_com(d.draw_com(domain, dt));
         position_type const new_iv(d.draw_iv(domain, dt, domain.iv()));
         D_type const D0(domain.particles()[0].second.D());
@@ -2451,6 +2573,11 @@ protected:
     // }}}
 
     time_type draw_single_reaction_time(species_id_type const& sid)
+    {
+        return draw_single_reaction_time(sid, this->rng());
+    }
+
+    time_type draw_single_reaction_time(species_id_type const& sid, rng_type& rng)
     {
         reaction_rules const& rules(
             (*base_type::network_rules_).query_reaction_rule(sid));
@@ -2465,7 +2592,7 @@ protected:
         }
         else
         {
-            const double rnd(this->rng().uniform(0., 1.));
+            const double rnd(rng.uniform(0., 1.));
             if(rnd <= 0.)
             {
                 return std::numeric_limits<time_type>::infinity();
@@ -2486,10 +2613,7 @@ protected:
         }
         else
         {
-            typedef Tshell shell_type;
-            typedef typename shell_type::shape_type shape_type;
-            typedef typename detail::get_greens_function<shape_type>::type greens_function;
-            return greens_function(domain.particle().second.D(),
+            return abs_sym_greens_function(domain.particle().second.D(),
                             domain.mobility_radius())
                 .drawTime(this->rng().uniform(0., 1.));
         }
@@ -2501,12 +2625,10 @@ protected:
     {
         typedef Tshell shell_type;
         typedef typename shell_type::shape_type shape_type;
-        typedef typename detail::get_pair_greens_function<shape_type> pair_greens_functions;
-        typedef typename pair_greens_functions::iv_type iv_greens_function;
-        typedef typename pair_greens_functions::com_type com_greens_function;
+        typedef typename detail::get_pair_greens_function<shape_type>::iv_type iv_greens_function;
 //         BOOST_ASSERT(::size(domain.reactions()) == 1);
         time_type const dt_com(
-            com_greens_function(domain.D_R(), domain.a_R()).drawTime(this->rng().uniform(0., 1.)));
+            abs_sym_greens_function(domain.D_R(), domain.a_R()).drawTime(this->rng().uniform(0., 1.)));
 
         Real k_tot = 0;
         BOOST_FOREACH(reaction_rule_type const& rule, domain.reactions())
@@ -2667,11 +2789,14 @@ protected:
         restore_domain(domain, closest);
     }
 
+    /**
+     * the size of the shell of a single restored at pos.
+     */
     template<typename T>
-    void restore_domain(AnalyticalSingle<traits_type, T>& domain,
-                        std::pair<domain_id_type, length_type> const& closest)
+    length_type restored_shell_size(AnalyticalSingle<traits_type, T> const& domain,
+                                    position_type const& pos,
+                                    std::pair<domain_id_type, length_type> const& closest) const
     {
-        // typedef typename AnalyticalSingle<traits_type, T>::shell_type shell_type;
         domain_type const* closest_domain(
             closest.second == std::numeric_limits<length_type>::infinity() ?
                 (domain_type const*)0: get_domain(closest.first).get());
@@ -2685,7 +2810,7 @@ protected:
             {
                 length_type const distance_to_closest(
                     (*base_type::world_).distance(
-                        domain.position(), _closest_domain->position()));
+                        pos, _closest_domain->position()));
                 new_shell_size = calculate_single_shell_size(
                         domain, *_closest_domain,
                         distance_to_closest,
@@ -2700,13 +2825,21 @@ protected:
         {
             new_shell_size = max_shell_size();
         }
+        return new_shell_size;
+    }
+
+    template<typename T>
+    void restore_domain(AnalyticalSingle<traits_type, T>& domain,
+                        std::pair<domain_id_type, length_type> const& closest)
+    {
+        // typedef typename AnalyticalSingle<traits_type, T>::shell_type shell_type;
+        length_type const new_shell_size(
+            restored_shell_size(domain, domain.position(), closest));
         LOG_DEBUG(("restore domain: %s (shell_size=%.16g, dt=%.16g) closest=%s (distance=%.16g)",
             boost::lexical_cast<std::string>(domain).c_str(),
             new_shell_size,
             domain.dt(),
-            closest_domain ?
-                boost::lexical_cast<std::string>(*closest_domain).c_str():
-                "(none)",
+            boost::lexical_cast<std::string>(closest.first).c_str(),
             closest.second));
         if (base_type::paranoiac_)
         {
@@ -3323,60 +3456,69 @@ protected:
                 // Heads up: shell matrix will be updated later in restore_domain().
                 // propagate(domain, draw_new_position(domain, domain.dt()), false);
                 propagate(domain, draw_escape_position(domain), false);
-            length_type const min_shell_radius(domain.particle().second.radius() * (1. + single_shell_factor_));
-            {
-                std::vector<domain_id_type>* intruders;
-                std::pair<domain_id_type, length_type> closest;
+            escape_single(domain);
+        }
+    }
 
-                // boost::tie(intruders, closest) = get_intruders(
-                //     particle_shape_type(
-                //         domain.position(), min_shell_radius), domain.id());
-                {
-                    std::pair<std::vector<domain_id_type>*, 
-                        std::pair<domain_id_type, length_type> > 
-                        res(get_intruders(particle_shape_type(
-                                              domain.position(), 
-                                              min_shell_radius), 
-                                          domain.id()));
-                    intruders = res.first;
-                    closest = res.second;
-                }
+    /**
+     * make a new shell for a single escaped to the surface of its shell,
+     * or a pair or multi with the domains intruding into it.
+     */
+    void escape_single(single_type& domain)
+    {
+        length_type const min_shell_radius(domain.particle().second.radius() * (1. + single_shell_factor_));
+        {
+            std::vector<domain_id_type>* intruders;
+            std::pair<domain_id_type, length_type> closest;
 
-                boost::scoped_ptr<std::vector<domain_id_type> > _(intruders);
+            // boost::tie(intruders, closest) = get_intruders(
+            //     particle_shape_type(
+            //         domain.position(), min_shell_radius), domain.id());
+            {
+                std::pair<std::vector<domain_id_type>*, 
+                    std::pair<domain_id_type, length_type> > 
+                    res(get_intruders(particle_shape_type(
+                                          domain.position(), 
+                                          min_shell_radius), 
+                                      domain.id()));
+                intruders = res.first;
+                closest = res.second;
+            }
+
+            boost::scoped_ptr<std::vector<domain_id_type> > _(intruders);
 
-                LOG_DEBUG(("intruders: %s, closest: %s (dist=%.16g)",
-                    intruders ?
-                        stringize_and_join(*intruders, ", ").c_str():
-                        "(none)",
-                    boost::lexical_cast<std::string>(closest.first).c_str(),
-                    closest.second));
-                if (intruders)
+            LOG_DEBUG(("intruders: %s, closest: %s (dist=%.16g)",
+                intruders ?
+                    stringize_and_join(*intruders, ", ").c_str():
+                    "(none)",
+                boost::lexical_cast<std::string>(closest.first).c_str(),
+                closest.second));
+            if (intruders)
+            {
+                std::vector<boost::shared_ptr<domain_type> > bursted;
+                burst_non_multis(*intruders, bursted);
+                if (form_pair_or_multi(domain, bursted))
+                    return;
+                // if nothing was formed, recheck closest and restore shells.
+                restore_domain(domain);
+                BOOST_FOREACH (boost::shared_ptr<domain_type> _single, bursted)
                 {
-                    std::vector<boost::shared_ptr<domain_type> > bursted;
-                    burst_non_multis(*intruders, bursted);
-                    if (form_pair_or_multi(domain, bursted))
-                        return;
-                    // if nothing was formed, recheck closest and restore shells.
-                    restore_domain(domain);
-                    BOOST_FOREACH (boost::shared_ptr<domain_type> _single, bursted)
-                    {
-                        boost::shared_ptr<single_type> single(
-                            boost::dynamic_pointer_cast<single_type>(_single));
-                        if (!single)
-                            continue;
-                        restore_domain(*single);
-                        // reschedule events for the restored domains
-                        remove_event(*single);
-                        determine_next_event(*single);
-                    }
-                } else {
-                    restore_domain(domain, closest);
+                    boost::shared_ptr<single_type> single(
+                        boost::dynamic_pointer_cast<single_type>(_single));
+                    if (!single)
+                        continue;
+                    restore_domain(*single);
+                    // reschedule events for the restored domains
+                    remove_event(*single);
+                    determine_next_event(*single);
                 }
-                determine_next_event(domain);
-                LOG_DEBUG(("%s (dt=%.16g)",
-                    boost::lexical_cast<std::string>(domain).c_str(),
-                    domain.dt()));
+            } else {
+                restore_domain(domain, closest);
             }
+            determine_next_event(domain);
+            LOG_DEBUG(("%s (dt=%.16g)",
+                boost::lexical_cast<std::string>(domain).c_str(),
+                domain.dt()));
         }
     }
 
@@ -3546,7 +3688,8 @@ protected:
                             (*base_type::world_).apply_boundary(
                                 draw_on_iv_reaction(
                                     this->rng(),
-                                    *base_type::world_).draw_com(
+                                    *base_type::world_,
+                                    greens_function_table()).draw_com(
                                         domain, domain.dt())));
                    
                         BOOST_ASSERT(
@@ -3724,7 +3867,250 @@ protected:
         throw not_implemented(std::string("unsupported domain type"));
     }
 
-    void _step()
+    // fire_batch {{{
+    struct batched_escape
+    {
+        event_id_pair_type ev;
+        spherical_single_type* domain;
+        typename spherical_shell_matrix_type::cell_index_type cell;
+        position_type new_pos;
+        std::pair<domain_id_type, length_type> closest;
+        bool intruded;
+        length_type shell_size;
+        time_type dt_reaction;
+        time_type dt;
+        single_event_kind kind;
+    };
+
+    /**
+     * return the spherical single escaping with the event, if any.
+     */
+    spherical_single_type* batchable_domain(event_type const& event) const
+    {
+        single_event const* _event(dynamic_cast<single_event const*>(&event));
+        if (!_event || _event->kind() != SINGLE_EVENT_ESCAPE)
+            return NULL;
+        spherical_single_type* domain(
+            dynamic_cast<spherical_single_type*>(&_event->domain()));
+        if (!domain || domain->D() == 0. || domain->dt() == 0.)
+            return NULL;
+        return domain;
+    }
+
+    /**
+     * whether the cells are far enough apart for the shells in and around
+     * them not to be seen from each other. A shell is never larger than a
+     * half of a cell, and thus a single escaping from the cell i leaves
+     * its shell, and looks for its neighbors, within two cells from i.
+     */
+    bool are_far_apart(
+        typename spherical_shell_matrix_type::cell_index_type const& i,
+        typename spherical_shell_matrix_type::cell_index_type const& j) const
+    {
+        const typename spherical_shell_matrix_type::matrix_sizes_type
+            sizes((*ssmat_).matrix_sizes());
+        for (std::size_t k(0); k < 3; ++k)
+        {
+            const std::size_t d(i[k] > j[k] ? i[k] - j[k] : j[k] - i[k]);
+            if (std::min<std::size_t>(d, static_cast<std::size_t>(sizes[k]) - d) > 4)
+                return true;
+        }
+        return false;
+    }
+
+    /**
+     * put the events of batch[first:last] back into the queue as they were.
+     */
+    void put_back(std::vector<batched_escape> const& batch,
+                  std::size_t const first, std::size_t const last)
+    {
+        for (std::size_t i(first); i < last; ++i)
+        {
+            event_id_pair_type const& ev(batch[i].ev);
+            batch[i].domain->event() = std::make_pair(scheduler_.add(ev.second), ev.second);
+        }
+    }
+
+    /**
+     * fire the escapes of spherical singles at the head of the queue, up
+     * to the time upto, together as long as each of them is far apart
+     * from all the others. Nothing but the queue is changed while their
+     * new positions, shells and reaction times are drawn in the order of
+     * time, and their escape times, the bulk of the work, on the threads
+     * of pool_. The events are then committed one by one in the order of
+     * time until one of the new events would come first. The rest are
+     * put back as they were. A single finding others in the way is the
+     * last one drawn, and bursts them and forms a pair or multi as usual
+     * when committed.
+     *
+     * Each event draws random numbers from its own stream keyed with 64
+     * bits from rng() once per batch, and whether an event is put back
+     * depends only on the draws for the events before it. Thus, the
+     * singles move as they would one at a time, and the trajectory does
+     * not depend on the number of threads.
+     *
+     * return false if no event can be fired in this way.
+     */
+    bool fire_batch(time_type const& upto)
+    {
+        typedef typename spherical_shell_matrix_type::cell_index_type
+            cell_index_type;
+
+        std::vector<batched_escape> batch;
+        while (batch.size() < batch_size_ && scheduler_.size() > 0
+               && scheduler_.top().second->time() <= upto)
+        {
+            spherical_single_type* const domain(
+                batchable_domain(*scheduler_.top().second));
+            if (!domain)
+                break;
+
+            const cell_index_type cell((*ssmat_).index(domain->position()));
+            bool far_apart(true);
+            for (typename std::vector<batched_escape>::const_iterator
+                i(batch.begin()); i != batch.end() && far_apart; ++i)
+            {
+                far_apart = are_far_apart((*i).cell, cell);
+            }
+            if (!far_apart)
+                break;
+
+            batched_escape entry;
+            entry.ev = scheduler_.pop();
+            entry.domain = domain;
+            entry.cell = cell;
+            batch.push_back(entry);
+        }
+
+        if (batch.empty())
+        {
+            return false;
+        }
+        else if (batch.size() == 1)
+        {
+            this->set_t(batch[0].ev.second->time());
+            fire_event(*batch[0].ev.second);
+            return true;
+        }
+
+        const Integer key(ecell4::PhiloxRandomNumberGenerator::draw_key(this->rng()));
+        std::vector<ecell4::PhiloxRandomNumberGenerator> rngs;
+        for (std::size_t i(0); i < batch.size(); ++i)
+        {
+            rngs.push_back(ecell4::PhiloxRandomNumberGenerator(key, i));
+        }
+
+        // new positions and shells
+        std::size_t num_drawn(batch.size());
+        for (std::size_t i(0); i < batch.size(); ++i)
+        {
+            batched_escape& entry(batch[i]);
+            spherical_single_type const& domain(*entry.domain);
+            entry.new_pos = (*base_type::world_).apply_boundary(
+                add(domain.particle().second.position(),
+                    normalize(rngs[i].direction3d(1), domain.mobility_radius())));
+
+            std::pair<std::vector<domain_id_type>*,
+                std::pair<domain_id_type, length_type> >
+                res(get_intruders(particle_shape_type(
+                                      entry.new_pos,
+                                      domain.particle().second.radius() * (1. + single_shell_factor_)),
+                                  domain.id()));
+            boost::scoped_ptr<std::vector<domain_id_type> > _(res.first);
+            entry.closest = res.second;
+            entry.intruded = (res.first != NULL);
+            if (entry.intruded)
+            {
+                num_drawn = i + 1;
+                break;
+            }
+
+            entry.shell_size = restored_shell_size(domain, entry.new_pos, entry.closest);
+            entry.dt_reaction = draw_single_reaction_time(
+                domain.particle().second.species(), rngs[i]);
+        }
+
+        // next events; each thread touches its own entries and streams only
+        (*pool_).parallel_for(num_drawn,
+            [&](const std::size_t i)
+            {
+                batched_escape& entry(batch[i]);
+                if (entry.intruded)
+                    return;
+                const time_type dt_escape(
+                    abs_sym_greens_function(
+                        entry.domain->particle().second.D(),
+                        entry.shell_size - entry.domain->particle().second.radius())
+                    .drawTime(rngs[i].uniform(0., 1.)));
+                if (entry.dt_reaction < dt_escape)
+                {
+                    entry.dt = entry.dt_reaction;
+                    entry.kind = SINGLE_EVENT_REACTION;
+                }
+                else
+                {
+                    entry.dt = dt_escape;
+                    entry.kind = SINGLE_EVENT_ESCAPE;
+                }
+            });
+
+        // those not drawn go back first, for bursting may reach them
+        put_back(batch, num_drawn, batch.size());
+
+        time_type horizon(std::numeric_limits<time_type>::infinity());
+        std::size_t num_fired(0);
+        for (; num_fired < num_drawn; ++num_fired)
+        {
+            batched_escape& entry(batch[num_fired]);
+            if (entry.ev.second->time() > horizon)
+                break;
+
+            this->set_t(entry.ev.second->time());
+            spherical_single_type& domain(*entry.domain);
+            LOG_DEBUG(("fire_batch: single escape (%s)", boost::lexical_cast<std::string>(domain).c_str()));
+            ++single_step_count_[SINGLE_EVENT_ESCAPE];
+            propagate(domain, entry.new_pos, false);
+
+            if (entry.intruded)
+            {
+                // the last one drawn; nothing else is out of the queue.
+                escape_single(domain);
+                ++num_fired;
+                break;
+            }
+
+            if (base_type::paranoiac_)
+            {
+                BOOST_ASSERT(check_overlap(
+                    particle_shape_type(domain.position(), entry.shell_size),
+                    domain.particle().first));
+            }
+            domain.size() = entry.shell_size;
+            update_shell_matrix(domain);
+            domain.dt() = entry.dt;
+            domain.last_time() = this->t();
+            add_event(domain, entry.kind);
+            horizon = std::min(horizon, this->t() + entry.dt);
+        }
+
+        put_back(batch, num_fired, num_drawn);
+
+        if (num_fired > 1)
+        {
+            num_batched_events_ += num_fired;
+        }
+        LOG_INFO(("%d: t=%.16g fired %d of %d singles in a batch",
+                  base_type::num_steps_, this->t(),
+                  static_cast<int>(num_fired), static_cast<int>(batch.size())));
+        return true;
+    }
+    // }}}
+
+    /**
+     * fire the next event, or a batch of events not later than upto if
+     * parallel.
+     */
+    void _step(time_type const& upto = std::numeric_limits<time_type>::infinity())
     {
         if (base_type::paranoiac_)
             BOOST_ASSERT(check());
@@ -3740,15 +4126,18 @@ protected:
             return;
         }
 
-        event_id_pair_type ev(scheduler_.pop());
-        this->set_t(ev.second->time());
+        if (!(parallel_ && fire_batch(upto)))
+        {
+            event_id_pair_type ev(scheduler_.pop());
+            this->set_t(ev.second->time());
 
-        LOG_INFO(("%d: t=%.16g dt=%.16g domain=%s rejectedmoves=%d",
-                  base_type::num_steps_, this->t(), base_type::dt_,
-                  boost::lexical_cast<std::string>(dynamic_cast<domain_event_base const*>(ev.second.get())->domain()).c_str(),
-                  rejected_moves_));
+            LOG_INFO(("%d: t=%.16g dt=%.16g domain=%s rejectedmoves=%d",
+                      base_type::num_steps_, this->t(), base_type::dt_,
+                      boost::lexical_cast<std::string>(dynamic_cast<domain_event_base const*>(ev.second.get())->domain()).c_str(),
+                      rejected_moves_));
 
-        fire_event(*ev.second);
+            fire_event(*ev.second);
+        }
 
         time_type const next_time(scheduler_.top().second->time());
         base_type::dt_ = next_time - this->t();
@@ -4252,6 +4641,12 @@ protected:
     unsigned int rejected_moves_;
     unsigned int zero_step_count_;
     bool dirty_;
+    bool tabulate_greens_functions_;
+    bool parallel_;
+    std::size_t num_threads_;
+    boost::scoped_ptr<ecell4::ThreadPool> pool_;  // valid only if parallel_
+    std::size_t batch_size_;
+    std::size_t num_batched_events_;
     static Logger& log_;
 };
 #undef CHECK
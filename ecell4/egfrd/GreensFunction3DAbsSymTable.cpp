@@ -0,0 +1,191 @@
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <boost/array.hpp>
+
+#include "GreensFunction3DAbsSymTable.hpp"
+
+namespace
+{
+
+// draws closer to 0 or 1 than this are left to the exact function
+const Real RND_MARGIN(1e-4);
+
+Real relative_error(const Real approx, const Real exact)
+{
+    return std::abs(approx - exact) / std::max(std::abs(exact), 1e-300);
+}
+
+Real slope(const Real* y, const std::size_t k, const std::size_t n)
+{
+    if (k == 0)
+    {
+        return 0.5 * (-3 * y[0] + 4 * y[1] - y[2]);
+    }
+    else if (k + 1 == n)
+    {
+        return 0.5 * (3 * y[k] - 4 * y[k - 1] + y[k - 2]);
+    }
+    return 0.5 * (y[k + 1] - y[k - 1]);
+}
+
+/**
+ * cubic Hermite interpolation between y[i] and y[i + 1] on a uniform grid
+ * with the slopes of finite differences (Catmull-Rom).
+ */
+Real interpolate(const Real* y, const std::size_t i, const Real frac, const std::size_t n)
+{
+    const Real m0(slope(y, i, n)), m1(slope(y, i + 1, n));
+    const Real frac2(frac * frac), frac3(frac2 * frac);
+    return (2 * frac3 - 3 * frac2 + 1) * y[i] + (frac3 - 2 * frac2 + frac) * m0
+        + (-2 * frac3 + 3 * frac2) * y[i + 1] + (frac3 - frac2) * m1;
+}
+
+} // anonymous
+
+GreensFunction3DAbsSymTable::GreensFunction3DAbsSymTable(
+    const std::size_t num_rnds, const std::size_t num_taus,
+    const Real tau_min, const Real tau_max, const Real tolerance)
+    : num_rnds_(num_rnds), num_taus_(num_taus),
+      log_tau_min_(std::log(tau_min)), log_tau_max_(std::log(tau_max)),
+      max_error_(0.0), valid_(false)
+{
+    if (num_rnds_ < 3 || num_taus_ < 3 || !(tau_min > 0.0 && tau_min < tau_max))
+    {
+        throw std::invalid_argument("invalid grid for GreensFunction3DAbsSymTable");
+    }
+
+    build(tolerance);
+}
+
+const GreensFunction3DAbsSymTable& GreensFunction3DAbsSymTable::instance()
+{
+    static const GreensFunction3DAbsSymTable table;
+    return table;
+}
+
+/**
+ * map s in [0, 1] to rnd, denser at both ends where the inverse CDFs are
+ * steep.
+ */
+Real GreensFunction3DAbsSymTable::rnd_at(const Real s) const
+{
+    return RND_MARGIN + (1.0 - 2 * RND_MARGIN) * 0.5 * (1.0 - std::cos(M_PI * s));
+}
+
+bool GreensFunction3DAbsSymTable::locate(
+    const Real rnd, std::size_t& i, Real& frac) const
+{
+    if (!valid_ || !(rnd >= RND_MARGIN && rnd <= 1.0 - RND_MARGIN))
+    {
+        return false;
+    }
+
+    const Real x(1.0 - 2 * (rnd - RND_MARGIN) / (1.0 - 2 * RND_MARGIN));
+    const Real s(std::acos(std::max(-1.0, std::min(1.0, x))) / M_PI);
+    const Real v(s * (num_rnds_ - 1));
+    i = std::min(static_cast<std::size_t>(v), num_rnds_ - 2);
+    frac = v - i;
+    return true;
+}
+
+bool GreensFunction3DAbsSymTable::draw_time(const Real rnd, Real& tau) const
+{
+    std::size_t i;
+    Real frac;
+    if (!locate(rnd, i, frac))
+    {
+        return false;
+    }
+
+    tau = std::max(interpolate(&times_[0], i, frac, num_rnds_), 0.0);
+    return true;
+}
+
+bool GreensFunction3DAbsSymTable::draw_r(const Real rnd, const Real tau, Real& rho) const
+{
+    std::size_t i;
+    Real frac;
+    if (!(tau > 0.0) || !locate(rnd, i, frac))
+    {
+        return false;
+    }
+
+    const Real log_tau(std::log(tau));
+    if (!(log_tau >= log_tau_min_ && log_tau <= log_tau_max_))
+    {
+        return false;
+    }
+
+    const Real v((log_tau - log_tau_min_) / (log_tau_max_ - log_tau_min_) * (num_taus_ - 1));
+    const std::size_t j(std::min(static_cast<std::size_t>(v), num_taus_ - 2));
+    const Real w(v - j);
+
+    // interpolate the rows around j along rnd, and then them along log(tau)
+    const std::size_t first(j > 0 ? j - 1 : 0), last(std::min(j + 2, num_taus_ - 1));
+    boost::array<Real, 4> g = {{0.0, 0.0, 0.0, 0.0}};
+    for (std::size_t k(first); k <= last; ++k)
+    {
+        g[k - first] = interpolate(&rs_[k * num_rnds_], i, frac, num_rnds_);
+    }
+    const Real g3(std::max(interpolate(&g[0], j - first, w, last - first + 1), 0.0));
+    rho = std::min(std::cbrt(g3) * std::sqrt(tau), 1.0);
+    return true;
+}
+
+void GreensFunction3DAbsSymTable::build(const Real tolerance)
+{
+    const greens_functions::GreensFunction3DAbsSym gf(1.0, 1.0);
+    const Real ds(1.0 / (num_rnds_ - 1));
+    const Real dlog_tau((log_tau_max_ - log_tau_min_) / (num_taus_ - 1));
+
+    try
+    {
+        times_.resize(num_rnds_);
+        for (std::size_t i(0); i < num_rnds_; ++i)
+        {
+            times_[i] = gf.drawTime(rnd_at(i * ds));
+        }
+
+        rs_.resize(num_rnds_ * num_taus_);
+        for (std::size_t j(0); j < num_taus_; ++j)
+        {
+            const Real tau(std::exp(log_tau_min_ + j * dlog_tau));
+            const Real sqrt_tau(std::sqrt(tau));
+            for (std::size_t i(0); i < num_rnds_; ++i)
+            {
+                const Real g(gf.drawR(rnd_at(i * ds), tau) / sqrt_tau);
+                rs_[j * num_rnds_ + i] = g * g * g;
+            }
+        }
+
+        // the interpolation error is the largest around the midpoints
+        valid_ = true;
+        Real value;
+        for (std::size_t i(0); i + 1 < num_rnds_; ++i)
+        {
+            const Real rnd(rnd_at((i + 0.5) * ds));
+            draw_time(rnd, value);
+            max_error_ = std::max(max_error_, relative_error(value, gf.drawTime(rnd)));
+        }
+
+        const std::size_t stride(std::max<std::size_t>(1, num_rnds_ / 64));
+        for (std::size_t j(0); j + 1 < num_taus_; ++j)
+        {
+            const Real tau(std::exp(log_tau_min_ + (j + 0.5) * dlog_tau));
+            for (std::size_t i(0); i + 1 < num_rnds_; i += stride)
+            {
+                const Real rnd(rnd_at((i + 0.5) * ds));
+                draw_r(rnd, tau, value);
+                max_error_ = std::max(max_error_, relative_error(value, gf.drawR(rnd, tau)));
+            }
+        }
+    }
+    catch (std::exception const& e)
+    {
+        valid_ = false;
+        return;
+    }
+
+    valid_ = (max_error_ <= tolerance);
+}
@@ -0,0 +1,138 @@
+#ifndef GREENS_FUNCTION_3D_ABS_SYM_TABLE_HPP
+#define GREENS_FUNCTION_3D_ABS_SYM_TABLE_HPP
+
+#include <vector>
+#include <string>
+#include <boost/shared_ptr.hpp>
+
+#include <greens_functions/GreensFunction3DAbsSym.hpp>
+
+#include "Defs.hpp"
+
+/**
+ * Inverse CDFs of greens_functions::GreensFunction3DAbsSym tabulated in a
+ * dimensionless form. The time and the distance scale as a^2/D and a, i.e.
+ * drawTime(rnd) of (D, a) is a^2/D * T(rnd) and drawR(rnd, t) is
+ * a * R(rnd, t D/a^2), where T and R are those of (D, a) = (1, 1).
+ *
+ * T is tabulated on a grid of rnd, dense at both ends, and R on the same
+ * grid times a logarithmic grid of tau = t D/a^2, and both interpolated
+ * with cubic Hermite splines along each axis. R is stored
+ * as (R / sqrt(tau))^3, which is close to linear in rnd at small tau. The
+ * tables are checked against exact draws at the midpoints of
+ * the grid when built, and never used when the relative error exceeds the
+ * tolerance. Draws out of the grid are left to the exact function as well.
+ */
+class GreensFunction3DAbsSymTable
+{
+public:
+
+    GreensFunction3DAbsSymTable(
+        const std::size_t num_rnds = 1024, const std::size_t num_taus = 48,
+        const Real tau_min = 1e-4, const Real tau_max = 1.0,
+        const Real tolerance = 1e-4);
+
+    /**
+     * tables with the default grid shared by all simulators, built at the
+     * first call.
+     */
+    static const GreensFunction3DAbsSymTable& instance();
+
+    /**
+     * @return false if rnd is out of the grid, or the table is not valid.
+     */
+    bool draw_time(const Real rnd, Real& tau) const;
+    bool draw_r(const Real rnd, const Real tau, Real& rho) const;
+
+    bool is_valid() const
+    {
+        return valid_;
+    }
+
+    Real max_error() const
+    {
+        return max_error_;
+    }
+
+protected:
+
+    Real rnd_at(const Real s) const;
+    bool locate(const Real rnd, std::size_t& i, Real& frac) const;
+    void build(const Real tolerance);
+
+protected:
+
+    const std::size_t num_rnds_, num_taus_;
+    const Real log_tau_min_, log_tau_max_;
+
+    std::vector<Real> times_;
+    std::vector<Real> rs_;  // (R(rnd, tau) / sqrt(tau))^3 in rows of tau
+    Real max_error_;
+    bool valid_;
+};
+
+/**
+ * greens_functions::GreensFunction3DAbsSym drawing from the tables when
+ * given, or the exact function otherwise. Only drawTime and drawR are
+ * tabulated. The exact function is constructed only when first needed.
+ */
+class TabulatedGreensFunction3DAbsSym
+{
+public:
+
+    TabulatedGreensFunction3DAbsSym(
+        const Real D, const Real a, const GreensFunction3DAbsSymTable* table = NULL)
+        : gf_(), D_(D), a_(a), table_(table)
+    {
+        ;
+    }
+
+    Real drawTime(const Real rnd) const
+    {
+        Real tau;
+        if (table_ != NULL && table_->draw_time(rnd, tau))
+        {
+            return tau * (a_ * a_ / D_);
+        }
+        return exact().drawTime(rnd);
+    }
+
+    Real drawR(const Real rnd, const Real t) const
+    {
+        Real rho;
+        if (table_ != NULL && table_->draw_r(rnd, t * D_ / (a_ * a_), rho))
+        {
+            return rho * a_;
+        }
+        return exact().drawR(rnd, t);
+    }
+
+    std::string getName() const
+    {
+        return exact().getName();
+    }
+
+    std::string dump() const
+    {
+        return exact().dump();
+    }
+
+protected:
+
+    const greens_functions::GreensFunction3DAbsSym& exact() const
+    {
+        if (!gf_)
+        {
+            gf_.reset(new greens_functions::GreensFunction3DAbsSym(D_, a_));
+        }
+        return *gf_;
+    }
+
+protected:
+
+    mutable boost::shared_ptr<const greens_functions::GreensFunction3DAbsSym> gf_;
+    const Real D_, a_;
+    const GreensFunction3DAbsSymTable* table_;
+};
+
+#endif /* GREENS_FUNCTION_3D_ABS_SYM_TABLE_HPP */
@@ -5,13 +5,12 @@
 #include <cstddef>
 #include <algorithm>
 #include <iterator>
-#include <boost/multi_array.hpp>
+#include <boost/array.hpp>
 #include <boost/mpl/if.hpp>
 #include <boost/range/size.hpp>
 #include <boost/range/difference_type.hpp>
 // #include "Vector3.hpp"
 #include "Real3Type.hpp"
-#include "sorted_list.hpp"
 #include "utils/array_helper.hpp"
 #include "utils/get_default_impl.hpp"
 #include "utils/range.hpp"
@@ -19,8 +18,16 @@
 #include "utils/get_default_impl.hpp"
 
 #include <ecell4/core/Integer3.hpp>
+#include <ecell4/core/PackedCellList.hpp>
 
 
+/**
+ * Objects with positions sorted into cells of a regular grid. The indices
+ * of the objects in each cell are packed into a single array by
+ * ecell4::PackedCellList, and the objects themselves are kept in a vector.
+ * The number of cells and objects visited by neighbor queries is counted
+ * to measure their cost.
+ */
 template<typename Tobj_, typename Tkey_,
         template<typename, typename> class MFget_mapper_ =
             get_default_impl::std::template map>
@@ -38,13 +45,10 @@ public:
     typedef std::pair<key_type, mapped_type> value_type;
     typedef std::vector<value_type> all_values_type;
 
-    typedef sorted_list<std::vector<typename all_values_type::size_type> > cell_type;
-    typedef boost::multi_array<cell_type, 3> matrix_type;
+    typedef ecell4::PackedCellList::cell_type cell_type;
     typedef typename cell_type::size_type size_type;
-    typedef boost::array<typename matrix_type::size_type, 3>
-            cell_index_type;
-    typedef boost::array<typename matrix_type::difference_type, 3>
-            cell_offset_type;
+    typedef boost::array<std::size_t, 3> cell_index_type;
+    typedef boost::array<std::ptrdiff_t, 3> cell_offset_type;
     typedef typename MFget_mapper_<key_type, typename all_values_type::size_type>::type
             key_to_value_mapper_type;
 
@@ -67,8 +71,10 @@ public:
             edge_lengths[0] / matrix_sizes[0],
             edge_lengths[1] / matrix_sizes[1],
             edge_lengths[2] / matrix_sizes[2]),
-          matrix_(
-            boost::extents[matrix_sizes[0]][matrix_sizes[1]][matrix_sizes[2]])
+          matrix_sizes_(array_gen<std::size_t>(
+            matrix_sizes[0], matrix_sizes[1], matrix_sizes[2])),
+          cells_(matrix_sizes[0] * matrix_sizes[1] * matrix_sizes[2]),
+          num_queries_(0), num_cells_visited_(0), num_candidates_(0)
     {
         ;
     }
@@ -81,13 +87,10 @@ public:
     inline cell_index_type index(const position_type& pos,
             double t = 1e-10) const
     {
-        return array_gen<typename matrix_type::size_type>(
-            static_cast<typename matrix_type::size_type>(
-                pos[0] / cell_sizes_[0]) % matrix_.shape()[0],
-            static_cast<typename matrix_type::size_type>(
-                pos[1] / cell_sizes_[1]) % matrix_.shape()[1],
-            static_cast<typename matrix_type::size_type>(
-                pos[2] / cell_sizes_[2]) % matrix_.shape()[2]);
+        return array_gen<std::size_t>(
+            static_cast<std::size_t>(pos[0] / cell_sizes_[0]) % matrix_sizes_[0],
+            static_cast<std::size_t>(pos[1] / cell_sizes_[1]) % matrix_sizes_[1],
+            static_cast<std::size_t>(pos[2] / cell_sizes_[2]) % matrix_sizes_[2]);
     }
 
     inline bool offset_index(
@@ -95,11 +98,11 @@ public:
             const cell_offset_type& o) const
     {
         if ((o[0] < 0 && static_cast<size_type>(-o[0]) > i[0])
-                || (matrix_.shape()[0] - o[0] <= i[0])
+                || (matrix_sizes_[0] - o[0] <= i[0])
                 || (o[1] < 0 && static_cast<size_type>(-o[1]) > i[1])
-                || (matrix_.shape()[1] - o[1] <= i[1])
+                || (matrix_sizes_[1] - o[1] <= i[1])
                 || (o[2] < 0 && static_cast<size_type>(-o[2]) > i[2])
-                || (matrix_.shape()[2] - o[2] <= i[2]))
+                || (matrix_sizes_[2] - o[2] <= i[2]))
         {
             return false;
         }
@@ -115,24 +118,24 @@ public:
         position_type retval;
 
         if (o[0] < 0 &&
-            static_cast<typename matrix_type::size_type>(-o[0]) > i[0])
+            static_cast<std::size_t>(-o[0]) > i[0])
         {
-            typename matrix_type::size_type t(
-                (i[0] + matrix_.shape()[0] - (-o[0] % matrix_.shape()[0])) %
-                matrix_.shape()[0]);
+            std::size_t t(
+                (i[0] + matrix_sizes_[0] - (-o[0] % matrix_sizes_[0])) %
+                matrix_sizes_[0]);
             retval[0] 
                 = (o[0] - 
-                   static_cast<typename matrix_type::difference_type>
+                   static_cast<std::ptrdiff_t>
                    (t - i[0])) * cell_sizes_[0];
             i[0] = t;
         }
-        else if (matrix_.shape()[0] - o[0] <= i[0])
+        else if (matrix_sizes_[0] - o[0] <= i[0])
         {
-            typename matrix_type::size_type t(
-                    (i[0] + (o[0] % matrix_.shape()[0])) % matrix_.shape()[0]);
+            std::size_t t(
+                    (i[0] + (o[0] % matrix_sizes_[0])) % matrix_sizes_[0]);
             retval[0] 
                 = (o[0] - 
-                   static_cast<typename matrix_type::difference_type>
+                   static_cast<std::ptrdiff_t>
                    (t - i[0])) * cell_sizes_[0];
             i[0] = t;
         }
@@ -142,19 +145,19 @@ public:
         }
 
         if (o[1] < 0 &&
-                static_cast<typename matrix_type::size_type>(-o[1]) > i[1])
+                static_cast<std::size_t>(-o[1]) > i[1])
         {
-            typename matrix_type::size_type t(
-                    (i[1] + matrix_.shape()[1] - (-o[1] % matrix_.shape()[1])) %
-                        matrix_.shape()[1]);
-            retval[1] = (o[1] - static_cast<typename matrix_type::difference_type>(t - i[1])) * cell_sizes_[1];
+            std::size_t t(
+                    (i[1] + matrix_sizes_[1] - (-o[1] % matrix_sizes_[1])) %
+                        matrix_sizes_[1]);
+            retval[1] = (o[1] - static_cast<std::ptrdiff_t>(t - i[1])) * cell_sizes_[1];
             i[1] = t;
         }
-        else if (matrix_.shape()[1] - o[1] <= i[1])
+        else if (matrix_sizes_[1] - o[1] <= i[1])
         {
-            typename matrix_type::size_type t(
-                    (i[1] + (o[1] % matrix_.shape()[1])) % matrix_.shape()[1]);
-            retval[1] = (o[1] - static_cast<typename matrix_type::difference_type>(t - i[1])) * cell_sizes_[1];
+            std::size_t t(
+                    (i[1] + (o[1] % matrix_sizes_[1])) % matrix_sizes_[1]);
+            retval[1] = (o[1] - static_cast<std::ptrdiff_t>(t - i[1])) * cell_sizes_[1];
             i[1] = t;
         }
         else
@@ -163,19 +166,19 @@ public:
         }
 
         if (o[2] < 0 &&
-                static_cast<typename matrix_type::size_type>(-o[2]) > i[2])
+                static_cast<std::size_t>(-o[2]) > i[2])
         {
-            typename matrix_type::size_type t(
-                    (i[2] + matrix_.shape()[2] - (-o[2] % matrix_.shape()[2])) %
-                        matrix_.shape()[2]);
-            retval[2] = (o[2] - static_cast<typename matrix_type::difference_type>(t - i[2])) * cell_sizes_[2];
+            std::size_t t(
+                    (i[2] + matrix_sizes_[2] - (-o[2] % matrix_sizes_[2])) %
+                        matrix_sizes_[2]);
+            retval[2] = (o[2] - static_cast<std::ptrdiff_t>(t - i[2])) * cell_sizes_[2];
             i[2] = t;
         }
-        else if (matrix_.shape()[2] - o[2] <= i[2])
+        else if (matrix_sizes_[2] - o[2] <= i[2])
         {
-            typename matrix_type::size_type t(
-                    (i[2] + (o[2] % matrix_.shape()[2])) % matrix_.shape()[2]);
-            retval[2] = (o[2] - static_cast<typename matrix_type::difference_type>(t - i[2])) * cell_sizes_[2];
+            std::size_t t(
+                    (i[2] + (o[2] % matrix_sizes_[2])) % matrix_sizes_[2]);
+            retval[2] = (o[2] - static_cast<std::ptrdiff_t>(t - i[2])) * cell_sizes_[2];
             i[2] = t;
         }
         else
@@ -186,14 +189,9 @@ public:
         return retval;
     }
 
-    inline const cell_type& cell(const cell_index_type& i) const
+    inline cell_type cell(const cell_index_type& i) const
     {
-        return matrix_[i[0]][i[1]][i[2]];
-    }
-
-    inline cell_type& cell(const cell_index_type& i)
-    {
-        return matrix_[i[0]][i[1]][i[2]];
+        return cells_.cell(cell_id(i));
     }
 
     inline const position_type& edge_lengths() const
@@ -208,9 +206,7 @@ public:
 
     inline const matrix_sizes_type matrix_sizes() const
     {
-        typedef typename matrix_type::size_type matrix_size_type;
-        const matrix_size_type* sizes(matrix_.shape());
-        return matrix_sizes_type(sizes[0], sizes[1], sizes[2]);
+        return matrix_sizes_type(matrix_sizes_[0], matrix_sizes_[1], matrix_sizes_[2]);
     }
 
     inline size_type size() const
@@ -220,86 +216,29 @@ public:
 
     inline iterator update(iterator const& old_value, const value_type& v)
     {
-        cell_type* new_cell(&cell(index(v.second.position())));
-        cell_type* old_cell(0);
-
-        if (old_value != values_.end())
-            old_cell = &cell(index((*old_value).second.position()));
-
-        if (new_cell == old_cell)
+        if (old_value == values_.end())
         {
-            reinterpret_cast<nonconst_value_type&>(*old_value) = v;
-            return old_value;
+            return update(v).first;
         }
-        else
-        {
-            typename all_values_type::size_type index(0);
-
-            if (old_cell)
-            {
-                reinterpret_cast<nonconst_value_type&>(*old_value) = v;
 
-                typename cell_type::iterator i(
-                        old_cell->find(old_value - values_.begin()));
-                index = *i;
-                old_cell->erase(i);
-                new_cell->push(index);
-            }
-            else
-            {
-                index = values_.size();
-                values_.push_back(v);
-                new_cell->push(index);
-                rmap_[v.first] = index;
-            }
-            return values_.begin() + index;
-        }
+        reinterpret_cast<nonconst_value_type&>(*old_value) = v;
+        cells_.move(old_value - values_.begin(), cell_id(index(v.second.position())));
+        return old_value;
     }
 
     inline std::pair<iterator, bool> update(const value_type& v)
     {
-        cell_type* new_cell(&cell(index(v.second.position())));
-        typename all_values_type::iterator old_value(values_.end());
-        cell_type* old_cell(0);
-
+        typename key_to_value_mapper_type::const_iterator i(rmap_.find(v.first));
+        if (i != rmap_.end())
         {
-            typename key_to_value_mapper_type::const_iterator i(rmap_.find(v.first));
-            if (i != rmap_.end())
-            {
-                old_value = values_.begin() + (*i).second;
-                old_cell = &cell(index(old_value->second.position()));
-            }
+            return std::pair<iterator, bool>(update(values_.begin() + (*i).second, v), false);
         }
 
-        if (new_cell == old_cell)
-        {
-            reinterpret_cast<nonconst_value_type&>(*old_value) = v;
-            return std::pair<iterator, bool>(old_value, false);
-        }
-        else
-        {
-            typename all_values_type::size_type index(0);
-
-            if (old_cell)
-            {
-                reinterpret_cast<nonconst_value_type&>(*old_value) = v;
-
-                typename cell_type::iterator i(
-                        old_cell->find(old_value - values_.begin()));
-                index = *i;
-                old_cell->erase(i);
-                new_cell->push(index);
-                return std::pair<iterator, bool>(values_.begin() + index, false);
-            }
-            else
-            {
-                index = values_.size();
-                values_.push_back(v);
-                new_cell->push(index);
-                rmap_[v.first] = index;
-                return std::pair<iterator, bool>(values_.begin() + index, true);
-            }
-        }
+        typename all_values_type::size_type const index(values_.size());
+        values_.push_back(v);
+        cells_.push_back(cell_id(this->index(v.second.position())));
+        rmap_[v.first] = index;
+        return std::pair<iterator, bool>(values_.begin() + index, true);
     }
 
     inline bool erase(iterator const& i)
@@ -310,10 +249,7 @@ public:
         }
 
         typename all_values_type::size_type const old_index(i - values_.begin());
-
-        bool is_succeeded(cell(index((*i).second.position())).erase(old_index));
-        BOOST_ASSERT(is_succeeded);
-        // BOOST_ASSERT(cell(index((*i).second.position())).erase(old_index));
+        cells_.erase(old_index);  // the last index is renamed to old_index
         rmap_.erase((*i).first);
 
         typename all_values_type::size_type const last_index(values_.size() - 1);
@@ -321,11 +257,6 @@ public:
         if (old_index < last_index)
         {
             value_type const& last(values_[last_index]);
-            cell_type& old_c(cell(index(last.second.position())));
-            is_succeeded = old_c.erase(last_index);
-            BOOST_ASSERT(is_succeeded);
-            // BOOST_ASSERT(old_c.erase(last_index));
-            old_c.push(old_index);
             rmap_[last.first] = old_index;
             reinterpret_cast<nonconst_value_type&>(*i) = last; 
         }
@@ -345,14 +276,9 @@ public:
 
     inline void clear()
     {
-        for (typename matrix_type::element *p(matrix_.data()),
-                                           *e(matrix_.data()
-                                              + matrix_.num_elements());
-             p != e; ++p)
-        {
-            (*p).clear();
-        }
+        cells_.clear();
         rmap_.clear();
+        values_.clear();
     }
 
     inline iterator begin()
@@ -395,6 +321,32 @@ public:
         return values_.begin() + (*p).second;
     }
 
+    /**
+     * the number of neighbor queries, and the numbers of cells and objects
+     * visited by them, since the last reset_statistics().
+     */
+    inline std::size_t num_queries() const
+    {
+        return num_queries_;
+    }
+
+    inline std::size_t num_cells_visited() const
+    {
+        return num_cells_visited_;
+    }
+
+    inline std::size_t num_candidates() const
+    {
+        return num_candidates_;
+    }
+
+    inline void reset_statistics()
+    {
+        num_queries_ = 0;
+        num_cells_visited_ = 0;
+        num_candidates_ = 0;
+    }
+
     template<typename Tcollect_>
     inline void each_neighbor(const cell_index_type& idx, Tcollect_& collector)
     {
@@ -480,16 +432,9 @@ public:
     }
 
 private:
-    std::pair<cell_type*, cell_type*> cell_range()
+    inline std::size_t cell_id(const cell_index_type& i) const
     {
-        return std::make_pair(
-            matrix_.origin(), matrix_.origin() + matrix_.num_elements());
-    }
-
-    std::pair<cell_type const*, cell_type const*> cell_range() const
-    {
-        return std::make_pair(
-            matrix_.origin(), matrix_.origin() + matrix_.num_elements());
+        return (i[0] * matrix_sizes_[1] + i[1]) * matrix_sizes_[2] + i[2];
     }
 
     template<typename Tcollect_>
@@ -497,6 +442,7 @@ private:
                                     Tcollect_& collector) const
     {
         cell_offset_type off;
+        ++num_queries_;
 
         for (off[2] = -1; off[2] <= 1; ++off[2])
         {
@@ -508,7 +454,9 @@ private:
                     if (!offset_index(_idx, off)) {
                         continue;
                     }
-                    cell_type const& c(cell(_idx));
+                    cell_type const c(cell(_idx));
+                    ++num_cells_visited_;
+                    num_candidates_ += c.size();
                     for (typename cell_type::const_iterator i(c.begin()); i != c.end(); ++i) 
                     {
                         collector(values_.begin() + *i, position_type());
@@ -523,6 +471,7 @@ private:
                                     Tcollect_& collector)
     {
         cell_offset_type off;
+        ++num_queries_;
 
         for (off[2] = -1; off[2] <= 1; ++off[2])
         {
@@ -534,7 +483,9 @@ private:
                     if (!offset_index(_idx, off)) {
                         continue;
                     }
-                    cell_type const& c(cell(_idx));
+                    cell_type const c(cell(_idx));
+                    ++num_cells_visited_;
+                    num_candidates_ += c.size();
                     for (typename cell_type::const_iterator i(c.begin()); i != c.end(); ++i) 
                     {
                         collector(values_.begin() + *i, position_type());
@@ -549,6 +500,7 @@ private:
                                            Tcollect_& collector) const
     {
         cell_offset_type off;
+        ++num_queries_;
 
         for (off[2] = -1; off[2] <= 1; ++off[2])
         {
@@ -558,7 +510,9 @@ private:
                 {
                     cell_index_type _idx(idx);
                     const position_type pos_off(offset_index_cyclic(_idx, off));
-                    cell_type const& c(cell(_idx));
+                    cell_type const c(cell(_idx));
+                    ++num_cells_visited_;
+                    num_candidates_ += c.size();
                     for (typename cell_type::const_iterator i(c.begin()); i != c.end(); ++i) 
                     {
                         collector(values_.begin() + *i, pos_off);
@@ -573,6 +527,7 @@ private:
                                            Tcollect_& collector)
     {
         cell_offset_type off;
+        ++num_queries_;
 
         for (off[2] = -1; off[2] <= 1; ++off[2])
         {
@@ -582,7 +537,9 @@ private:
                 {
                     cell_index_type _idx(idx);
                     const position_type pos_off(offset_index_cyclic(_idx, off));
-                    cell_type const& c(cell(_idx));
+                    cell_type const c(cell(_idx));
+                    ++num_cells_visited_;
+                    num_candidates_ += c.size();
                     for (typename cell_type::const_iterator i(c.begin()); i != c.end(); ++i) 
                     {
                         collector(values_.begin() + *i, pos_off);
@@ -595,9 +552,12 @@ private:
 private:
     const position_type edge_lengths_;
     const position_type cell_sizes_;
-    matrix_type matrix_;
+    const cell_index_type matrix_sizes_;
+    ecell4::PackedCellList cells_;
     key_to_value_mapper_type rmap_;
     all_values_type values_;
+
+    mutable std::size_t num_queries_, num_cells_visited_, num_candidates_;
 };
 
 template<typename T_, typename Tkey_,
@@ -86,6 +86,11 @@ public:
         return &(this->rng(rng));  //XXX: == this
     }
 
+    bool has_rng() const override
+    {
+        return static_cast<bool>(rng_);
+    }
+
 protected:
 
     virtual world_type* create_world(const Real3& edge_lengths) const override
@@ -203,6 +208,11 @@ public:
         return &(this->rng(rng));  //XXX: == this
     }
 
+    bool has_rng() const override
+    {
+        return static_cast<bool>(rng_);
+    }
+
 protected:
 
     virtual world_type* create_world(const Real3& edge_lengths) const
@@ -0,0 +1,78 @@
+// Draws per second of the single Green's functions used by EGFRDSimulator,
+// drawn exactly or from the table in GreensFunction3DAbsSymTable.hpp.
+//
+// usage: greens_function_benchmark [num_draws]
+
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <boost/format.hpp>
+
+#include <ecell4/core/RandomNumberGenerator.hpp>
+#include <ecell4/egfrd/GreensFunction3DAbsSymTable.hpp>
+
+#include <greens_functions/GreensFunction3DAbsSym.hpp>
+
+
+template <typename Tfunc_>
+void benchmark(const std::string& name, const int num_draws, Tfunc_ func)
+{
+    const std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+    double sum(0.0);  // not to be optimized away
+    for (int i(0); i < num_draws; ++i)
+    {
+        sum += func(i);
+    }
+    const double elapsed(std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count());
+    std::cout << boost::format("%-32s %12.0f draws/sec (mean %.6g)")
+        % name % (num_draws / elapsed) % (sum / num_draws) << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    const int num_draws(argc > 1 ? std::atoi(argv[1]) : 100000);
+
+    // a few species and shell sizes shared by many singles
+    const Real Ds[] = {1e-12, 2.5e-12, 5e-12};
+    const Real as[] = {5e-9, 1e-8, 2e-8, 5e-8};
+
+    ecell4::GSLRandomNumberGenerator rng;
+    rng.seed(0);
+
+    std::cout << "single: drawTime" << std::endl;
+    benchmark("exact", num_draws, [&](const int i)
+        {
+            return greens_functions::GreensFunction3DAbsSym(Ds[i % 3], as[i % 4])
+                .drawTime(rng.uniform(0, 1));
+        });
+    {
+        const std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+        const GreensFunction3DAbsSymTable& table(GreensFunction3DAbsSymTable::instance());
+        std::cout << boost::format("(table built in %.3g sec, valid=%d, max error=%.3g)")
+            % std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()
+            % table.is_valid() % table.max_error() << std::endl;
+    }
+    benchmark("tabulated", num_draws, [&](const int i)
+        {
+            return TabulatedGreensFunction3DAbsSym(
+                Ds[i % 3], as[i % 4], &GreensFunction3DAbsSymTable::instance())
+                .drawTime(rng.uniform(0, 1));
+        });
+
+    std::cout << "single: drawR" << std::endl;
+    benchmark("exact", num_draws, [&](const int i)
+        {
+            const Real a(as[i % 4]), D(Ds[i % 3]);
+            return greens_functions::GreensFunction3DAbsSym(D, a)
+                .drawR(rng.uniform(0, 1), rng.uniform(0.01, 0.5) * a * a / D);
+        });
+    benchmark("tabulated", num_draws, [&](const int i)
+        {
+            const Real a(as[i % 4]), D(Ds[i % 3]);
+            return TabulatedGreensFunction3DAbsSym(D, a, &GreensFunction3DAbsSymTable::instance())
+                .drawR(rng.uniform(0, 1), rng.uniform(0.01, 0.5) * a * a / D);
+        });
+
+    return 0;
+}
@@ -0,0 +1,40 @@
+// Steps per second of the event schedulers used by EGFRDSimulator, backed by
+// the binary heap (DynamicPriorityQueue) or by the calendar queue.
+//
+// Each scheduler runs the classic hold model in ecell4/core/hold_model.hpp,
+// which the tests of the schedulers run as well.
+//
+// usage: scheduler_benchmark [num_events] [num_steps]
+
+#include <iostream>
+#include <cstdlib>
+#include <boost/format.hpp>
+
+#include <ecell4/core/EventScheduler.hpp>
+#include <ecell4/core/hold_model.hpp>
+
+using namespace ecell4;
+
+
+template <typename Tscheduler_>
+void benchmark(const std::string& name, const std::size_t num_events, const std::size_t num_steps)
+{
+    Tscheduler_ scheduler;
+    double elapsed;
+    const Real sum(hold(scheduler, num_events, num_steps, &elapsed));  // not to be optimized away
+    std::cout << boost::format("%-32s %12.0f steps/sec (%.3f sec, mean %.6g)")
+        % name % (num_steps / elapsed) % elapsed % (sum / num_steps) << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t num_events(argc > 1 ? std::atoi(argv[1]) : 100000);
+    const std::size_t num_steps(argc > 2 ? std::atoi(argv[2]) : 1000000);
+
+    std::cout << boost::format("hold: %d events, %d steps") % num_events % num_steps
+        << std::endl;
+    benchmark<EventScheduler>("heap", num_events, num_steps);
+    benchmark<CalendarEventScheduler>("calendar", num_events, num_steps);
+
+    return 0;
+}
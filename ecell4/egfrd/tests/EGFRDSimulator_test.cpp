@@ -0,0 +1,120 @@
+#define BOOST_TEST_MODULE "EGFRDSimulator_test"
+
+#ifdef UNITTEST_FRAMEWORK_LIBRARY_EXIST
+#   include <boost/test/unit_test.hpp>
+#else
+#   define BOOST_TEST_NO_LIB
+#   include <boost/test/included/unit_test.hpp>
+#endif
+
+#include <ecell4/core/NetworkModel.hpp>
+#include <ecell4/core/RandomNumberGenerator.hpp>
+#include <ecell4/egfrd/egfrd.hpp>
+
+using namespace ecell4;
+
+typedef ecell4::egfrd::EGFRDWorld world_type;
+typedef ecell4::egfrd::EGFRDSimulator simulator_type;
+typedef std::vector<std::pair<ParticleID, Particle> > particle_container_type;
+
+namespace
+{
+
+boost::shared_ptr<world_type> new_world(const boost::shared_ptr<NetworkModel>& model)
+{
+    const Real L(1e-5);
+    const Integer3 matrix_sizes(12, 12, 12);
+
+    boost::shared_ptr<RandomNumberGenerator> rng(new GSLRandomNumberGenerator(0));
+    boost::shared_ptr<world_type>
+        world(new world_type(Real3(L, L, L), matrix_sizes, rng));
+    world->bind_to(model);
+    world->add_molecules(Species("A"), 100);
+    return world;
+}
+
+particle_container_type run_parallel(
+    const std::size_t num_threads, std::size_t& num_batched_events)
+{
+    boost::shared_ptr<NetworkModel> model(new NetworkModel());
+    model->add_species_attribute(Species("A", 2.5e-9, 1e-12));
+    boost::shared_ptr<world_type> world(new_world(model));
+
+    simulator_type sim(world, model);
+    sim.set_parallel(true, num_threads);
+    sim.set_batch_size(8);
+    sim.initialize();
+    for (unsigned int i(0); i < 3000; ++i)
+    {
+        sim.step();
+    }
+
+    num_batched_events = sim.num_batched_events();
+    return world->list_particles();
+}
+
+particle_container_type run_until(
+    const bool parallel, const std::size_t batch_size, const Real upto)
+{
+    boost::shared_ptr<NetworkModel> model(new NetworkModel());
+    model->add_species_attribute(Species("A", 2.5e-9, 1e-12));
+    boost::shared_ptr<world_type> world(new_world(model));
+
+    simulator_type sim(world, model);
+    sim.set_parallel(parallel, 2);
+    sim.set_batch_size(batch_size);
+    sim.initialize();
+    while (sim.step(upto))
+    {
+        BOOST_CHECK(sim.t() <= upto);
+    }
+
+    BOOST_CHECK_EQUAL(sim.num_batched_events(), 0);
+    return world->list_particles();
+}
+
+} // anonymous
+
+BOOST_AUTO_TEST_CASE(EGFRDSimulator_test_parallel)
+{
+    std::size_t num_batched1, num_batched4;
+    const particle_container_type particles1(run_parallel(1, num_batched1));
+    const particle_container_type particles4(run_parallel(4, num_batched4));
+
+    // the trajectory does not depend on the number of threads
+    BOOST_CHECK(num_batched1 > 0);
+    BOOST_CHECK_EQUAL(num_batched1, num_batched4);
+    BOOST_CHECK_EQUAL(particles1.size(), 100);
+    BOOST_REQUIRE_EQUAL(particles1.size(), particles4.size());
+    for (std::size_t i(0); i < particles1.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(particles1[i].first, particles4[i].first);
+        BOOST_CHECK_EQUAL(particles1[i].second.position(), particles4[i].second.position());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(EGFRDSimulator_test_serial)
+{
+    // a batch of one event is fired as it would be without batching
+    const particle_container_type serial(run_until(false, 16, 1e-3));
+    const particle_container_type parallel(run_until(true, 1, 1e-3));
+    BOOST_REQUIRE_EQUAL(serial.size(), parallel.size());
+    for (std::size_t i(0); i < serial.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(serial[i].first, parallel[i].first);
+        BOOST_CHECK_EQUAL(serial[i].second.position(), parallel[i].second.position());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(EGFRDSimulator_test_batch_size)
+{
+    boost::shared_ptr<NetworkModel> model(new NetworkModel());
+    boost::shared_ptr<world_type> world(new world_type(Real3(1e-6, 1e-6, 1e-6)));
+    simulator_type sim(world, model);
+
+    BOOST_CHECK(!sim.is_parallel());
+    BOOST_CHECK_EQUAL(sim.batch_size(), 16);
+    BOOST_CHECK_THROW(sim.set_batch_size(0), IllegalArgument);
+    sim.set_batch_size(4);
+    BOOST_CHECK_EQUAL(sim.batch_size(), 4);
+}
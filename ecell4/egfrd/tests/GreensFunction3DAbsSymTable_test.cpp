@@ -0,0 +1,75 @@
+#define BOOST_TEST_MODULE "GreensFunction3DAbsSymTable_test"
+
+#ifdef UNITTEST_FRAMEWORK_LIBRARY_EXIST
+#   include <boost/test/unit_test.hpp>
+#else
+#   define BOOST_TEST_NO_LIB
+#   include <boost/test/included/unit_test.hpp>
+#endif
+
+#include <boost/test/floating_point_comparison.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real.hpp>
+
+#include "../GreensFunction3DAbsSymTable.hpp"
+
+using greens_functions::GreensFunction3DAbsSym;
+
+
+BOOST_AUTO_TEST_CASE(GreensFunction3DAbsSymTable_test_draw)
+{
+    const Real tolerance(1e-4);
+    const GreensFunction3DAbsSymTable table(1024, 48, 1e-4, 1.0, tolerance);
+    BOOST_REQUIRE(table.is_valid());
+    BOOST_CHECK(table.max_error() <= tolerance);
+
+    const Real Ds[] = {1e-12, 5e-12};
+    const Real as[] = {1e-8, 3e-7};
+    boost::mt19937 rng(0);
+    boost::uniform_real<Real> uniform(0.01, 0.99), log_tau(std::log(1e-4), 0.0);
+
+    for (unsigned int k(0); k < 4; ++k)
+    {
+        const Real D(Ds[k % 2]), a(as[k / 2]);
+        const TabulatedGreensFunction3DAbsSym tabulated(D, a, &table);
+        const GreensFunction3DAbsSym exact(D, a);
+
+        for (unsigned int i(0); i < 100; ++i)
+        {
+            const Real rnd(uniform(rng));
+            BOOST_CHECK_CLOSE_FRACTION(tabulated.drawTime(rnd), exact.drawTime(rnd), tolerance);
+
+            const Real t(std::exp(log_tau(rng)) * a * a / D);
+            BOOST_CHECK_CLOSE_FRACTION(tabulated.drawR(rnd, t), exact.drawR(rnd, t), tolerance);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(GreensFunction3DAbsSymTable_test_out_of_grid)
+{
+    const GreensFunction3DAbsSymTable table(64, 8, 1e-2, 1.0, 1.0);
+    BOOST_REQUIRE(table.is_valid());
+
+    // out of the grid, the tables draw nothing and the exact function is used
+    Real value;
+    BOOST_CHECK(!table.draw_time(1e-6, value));
+    BOOST_CHECK(!table.draw_r(0.5, 1e-3, value));
+    BOOST_CHECK(!table.draw_r(0.5, 2.0, value));
+
+    const Real D(1e-12), a(1e-8);
+    const TabulatedGreensFunction3DAbsSym tabulated(D, a, &table);
+    const GreensFunction3DAbsSym exact(D, a);
+    BOOST_CHECK_EQUAL(tabulated.drawTime(1e-6), exact.drawTime(1e-6));
+    BOOST_CHECK_EQUAL(tabulated.drawR(0.5, 2.0 * a * a / D), exact.drawR(0.5, 2.0 * a * a / D));
+
+    // without tables, all draws are exact
+    const TabulatedGreensFunction3DAbsSym untabulated(D, a);
+    BOOST_CHECK_EQUAL(untabulated.drawTime(0.5), exact.drawTime(0.5));
+    BOOST_CHECK_EQUAL(untabulated.drawR(0.5, 1e-5), exact.drawR(0.5, 1e-5));
+}
+
+BOOST_AUTO_TEST_CASE(GreensFunction3DAbsSymTable_test_invalid_grid)
+{
+    BOOST_CHECK_THROW(GreensFunction3DAbsSymTable(2, 8), std::invalid_argument);
+    BOOST_CHECK_THROW(GreensFunction3DAbsSymTable(64, 8, 1.0, 1e-2), std::invalid_argument);
+}
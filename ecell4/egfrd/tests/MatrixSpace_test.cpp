@@ -0,0 +1,141 @@
+#define BOOST_TEST_MODULE "MatrixSpace_test"
+
+#ifdef UNITTEST_FRAMEWORK_LIBRARY_EXIST
+#   include <boost/test/unit_test.hpp>
+#else
+#   define BOOST_TEST_NO_LIB
+#   include <boost/test/included/unit_test.hpp>
+#endif
+
+#include <set>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real.hpp>
+
+#include "../MatrixSpace.hpp"
+
+using namespace ecell4;
+
+namespace
+{
+
+struct Point
+{
+    typedef Real length_type;
+
+    Point(const Real3& position)
+        : position_(position)
+    {
+        ;
+    }
+
+    const Real3& position() const
+    {
+        return position_;
+    }
+
+    Real3 position_;
+};
+
+typedef MatrixSpace<Point, int> matrix_space_type;
+
+struct collector
+{
+    collector(std::set<int>& keys)
+        : keys(keys)
+    {
+        ;
+    }
+
+    void operator()(matrix_space_type::iterator i, const Real3&) const
+    {
+        keys.insert((*i).first);
+    }
+
+    std::set<int>& keys;
+};
+
+std::set<int> neighbors(matrix_space_type& space, const Real3& pos)
+{
+    std::set<int> keys;
+    space.each_neighbor_cyclic(space.index(pos), collector(keys));
+    return keys;
+}
+
+} // anonymous
+
+BOOST_AUTO_TEST_CASE(MatrixSpace_test_clear)
+{
+    matrix_space_type space(Real3(1.0, 1.0, 1.0), Integer3(4, 4, 4));
+    for (int i(0); i < 10; ++i)
+    {
+        space.update(std::make_pair(i, Point(Real3(0.1 * i, 0.1, 0.1))));
+    }
+    BOOST_CHECK_EQUAL(space.size(), 10);
+
+    // the values are dropped together with the cells and the keys
+    space.clear();
+    BOOST_CHECK_EQUAL(space.size(), 0);
+    BOOST_CHECK(space.begin() == space.end());
+    BOOST_CHECK(space.find(3) == space.end());
+
+    space.update(std::make_pair(100, Point(Real3(0.1, 0.1, 0.1))));
+    space.update(std::make_pair(101, Point(Real3(0.9, 0.9, 0.9))));
+    BOOST_CHECK_EQUAL(space.size(), 2);
+    BOOST_CHECK_EQUAL((*space.find(100)).first, 100);
+    BOOST_CHECK_EQUAL((*space.find(101)).first, 101);
+
+    const std::set<int> keys(neighbors(space, Real3(0.1, 0.1, 0.1)));
+    BOOST_CHECK_EQUAL(keys.size(), 2);  // 101 is a neighbor across the boundary
+    BOOST_CHECK(keys.count(100) == 1 && keys.count(101) == 1);
+}
+
+BOOST_AUTO_TEST_CASE(MatrixSpace_test_neighbors)
+{
+    // neighbors are visited in no particular order within a cell, so
+    // compare the sets with the cells computed from the positions
+    const Integer3 sizes(5, 5, 5);
+    matrix_space_type space(Real3(1.0, 1.0, 1.0), sizes);
+    boost::mt19937 rng(0);
+    boost::uniform_real<Real> uniform(0.0, 1.0);
+
+    std::vector<Real3> positions;
+    for (int i(0); i < 200; ++i)
+    {
+        positions.push_back(Real3(uniform(rng), uniform(rng), uniform(rng)));
+        space.update(std::make_pair(i, Point(positions.back())));
+    }
+    for (int k(0); k < 1000; ++k)
+    {
+        const int i(rng() % positions.size());
+        const Real3 pos(uniform(rng), uniform(rng), uniform(rng));
+        std::copy(pos.begin(), pos.end(), positions[i].begin());
+        space.update(std::make_pair(i, Point(pos)));
+    }
+    for (int i(0); i < 50; ++i)
+    {
+        space.erase(i);
+    }
+
+    for (int k(0); k < 20; ++k)
+    {
+        const Real3 pos(uniform(rng), uniform(rng), uniform(rng));
+        const matrix_space_type::cell_index_type idx(space.index(pos));
+
+        std::set<int> expected;
+        for (int i(50); i < static_cast<int>(positions.size()); ++i)
+        {
+            const matrix_space_type::cell_index_type j(space.index(positions[i]));
+            bool adjacent(true);
+            for (int d(0); d < 3; ++d)
+            {
+                const int diff((static_cast<int>(j[d]) - static_cast<int>(idx[d]) + sizes[d]) % sizes[d]);
+                adjacent = adjacent && (diff <= 1 || diff == sizes[d] - 1);
+            }
+            if (adjacent)
+            {
+                expected.insert(i);
+            }
+        }
+        BOOST_CHECK(neighbors(space, pos) == expected);
+    }
+}
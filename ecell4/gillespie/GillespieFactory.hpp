@@ -27,8 +27,8 @@ public:
 
 public:
 
-    GillespieFactory()
-        : base_type(), rng_()
+    GillespieFactory(const GillespieSelectionMethod selection_method = default_selection_method())
+        : base_type(), rng_(), selection_method_(selection_method)
     {
         ; // do nothing
     }
@@ -38,6 +38,11 @@ public:
         ; // do nothing
     }
 
+    static inline GillespieSelectionMethod default_selection_method()
+    {
+        return LINEAR_SEARCH;
+    }
+
     this_type& rng(const boost::shared_ptr<RandomNumberGenerator>& rng)
     {
         rng_ = rng;
@@ -49,6 +54,11 @@ public:
         return &(this->rng(rng));  //XXX: == this
     }
 
+    bool has_rng() const
+    {
+        return static_cast<bool>(rng_);
+    }
+
 protected:
 
     virtual world_type* create_world(const Real3& edge_lengths) const
@@ -63,9 +73,16 @@ protected:
         }
     }
 
+    virtual simulator_type* create_simulator(
+        const boost::shared_ptr<world_type>& w, const boost::shared_ptr<Model>& m) const
+    {
+        return new simulator_type(w, m, selection_method_);
+    }
+
 protected:
 
     boost::shared_ptr<RandomNumberGenerator> rng_;
+    GillespieSelectionMethod selection_method_;
 };
 
 } // gillespie
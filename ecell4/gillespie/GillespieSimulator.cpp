@@ -21,10 +21,12 @@ void GillespieSimulator::increment_molecules(const Species& sp)
 {
     world_->add_molecules(sp, 1);
 
-    for (boost::ptr_vector<ReactionRuleEvent>::iterator i(events_.begin());
-        i != events_.end(); ++i)
+    const std::vector<std::size_t>& dependents(get_dependent_events(sp));
+    for (std::vector<std::size_t>::const_iterator i(dependents.begin());
+        i != dependents.end(); ++i)
     {
-        (*i).inc(sp);
+        events_[*i].inc(sp);
+        update_propensity(*i);
     }
 }
 
@@ -33,23 +35,93 @@ void GillespieSimulator::decrement_molecules(const Species& sp)
 {
     world_->remove_molecules(sp, 1);
 
-    for (boost::ptr_vector<ReactionRuleEvent>::iterator i(events_.begin());
-        i != events_.end(); ++i)
+    const std::vector<std::size_t>& dependents(get_dependent_events(sp));
+    for (std::vector<std::size_t>::const_iterator i(dependents.begin());
+        i != dependents.end(); ++i)
     {
-        (*i).dec(sp);
+        events_[*i].dec(sp);
+        update_propensity(*i);
     }
 }
 
-bool GillespieSimulator::__draw_next_reaction(void)
+void GillespieSimulator::change_molecules(const Species& sp, const Integer num)
+{
+    if (num > 0)
+    {
+        world_->add_molecules(sp, num);
+    }
+    else if (num < 0)
+    {
+        world_->remove_molecules(sp, -num);
+    }
+    else
+    {
+        return;
+    }
+
+    const std::vector<std::size_t>& dependents(get_dependent_events(sp));
+    for (std::vector<std::size_t>::const_iterator i(dependents.begin());
+        i != dependents.end(); ++i)
+    {
+        events_[*i].inc(sp, num);
+        update_propensity(*i);
+    }
+}
+
+const std::vector<std::size_t>&
+GillespieSimulator::get_dependent_events(const Species& sp)
 {
-    std::vector<double> a(events_.size());
-    for (unsigned int i(0); i < events_.size(); ++i)
+    utils::get_mapper_mf<Species::serial_type, std::vector<std::size_t> >::type::iterator
+        it(dependent_events_.find(sp.serial()));
+    if (it != dependent_events_.end())
     {
-        // events_[i].initialize(world_.get());
-        a[i] = events_[i].propensity();
+        return (*it).second;
     }
 
-    const double atot(std::accumulate(a.begin(), a.end(), double(0.0)));
+    // A species generated after initialize() is registered here.
+    std::vector<std::size_t> dependents;
+    for (std::size_t i(0); i < events_.size(); ++i)
+    {
+        if (events_[i].inc(sp, 0))
+        {
+            dependents.push_back(i);
+        }
+    }
+    return (*dependent_events_.insert(std::make_pair(sp.serial(), dependents)).first).second;
+}
+
+void GillespieSimulator::update_propensity(const std::size_t idx)
+{
+    if (selection_method_ == PARTIAL_SUM_TREE)
+    {
+        propensities_.update(idx, events_[idx].propensity());
+    }
+}
+
+bool GillespieSimulator::__draw_next_reaction(void)
+{
+    std::vector<double> a;
+    double atot(0.0);
+
+    if (selection_method_ == PARTIAL_SUM_TREE)
+    {
+        for (std::vector<std::size_t>::const_iterator i(descriptor_events_.begin());
+            i != descriptor_events_.end(); ++i)
+        {
+            update_propensity(*i);
+        }
+        atot = propensities_.total();
+    }
+    else
+    {
+        a.resize(events_.size());
+        for (unsigned int i(0); i < events_.size(); ++i)
+        {
+            // events_[i].initialize(world_.get());
+            a[i] = events_[i].propensity();
+        }
+        atot = std::accumulate(a.begin(), a.end(), double(0.0));
+    }
 
     if (atot == 0.0)
     {
@@ -64,11 +136,19 @@ bool GillespieSimulator::__draw_next_reaction(void)
     if (atot == std::numeric_limits<double>::infinity())
     {
         std::vector<unsigned int> selected;
-        for (unsigned int i(0); i < a.size(); ++i)
+        if (selection_method_ == PARTIAL_SUM_TREE)
+        {
+            selected.assign(
+                propensities_.infinite().begin(), propensities_.infinite().end());
+        }
+        else
         {
-            if (a[i] == std::numeric_limits<double>::infinity())
+            for (unsigned int i(0); i < a.size(); ++i)
             {
-                selected.push_back(i);
+                if (a[i] == std::numeric_limits<double>::infinity())
+                {
+                    selected.push_back(i);
+                }
             }
         }
 
@@ -82,14 +162,21 @@ bool GillespieSimulator::__draw_next_reaction(void)
 
         dt = gsl_sf_log(1.0 / rnd1) / double(atot);
 
-        double acc(0.0);
-
-        for (idx = 0; idx < a.size(); ++idx)
+        if (selection_method_ == PARTIAL_SUM_TREE)
+        {
+            idx = propensities_.find(rnd2);
+        }
+        else
         {
-            acc += a[idx];
-            if (acc >= rnd2)
+            double acc(0.0);
+
+            for (idx = 0; idx < a.size(); ++idx)
             {
-                break;
+                acc += a[idx];
+                if (acc >= rnd2)
+                {
+                    break;
+                }
             }
         }
     }
@@ -275,6 +362,12 @@ void GillespieSimulator::check_model()
 }
 
 void GillespieSimulator::initialize(void)
+{
+    initialize_events();
+    this->draw_next_reaction();
+}
+
+void GillespieSimulator::initialize_events(void)
 {
     const Model::reaction_rule_container_type&
         reaction_rules(model_->reaction_rules());
@@ -282,6 +375,7 @@ void GillespieSimulator::initialize(void)
     check_model();
 
     events_.clear();
+    descriptor_events_.clear();
     for (Model::reaction_rule_container_type::const_iterator
         i(reaction_rules.begin()); i != reaction_rules.end(); ++i)
     {
@@ -289,6 +383,7 @@ void GillespieSimulator::initialize(void)
 
         if (rr.has_descriptor())
         {
+            descriptor_events_.push_back(events_.size());
             events_.push_back(new DescriptorReactionRuleEvent(this, rr));
         }
         else if (rr.reactants().size() == 0)
@@ -311,7 +406,22 @@ void GillespieSimulator::initialize(void)
         events_.back().initialize();
     }
 
-    this->draw_next_reaction();
+    dependent_events_.clear();
+    const std::vector<Species> species(world_->list_species());
+    for (std::vector<Species>::const_iterator i(species.begin());
+        i != species.end(); ++i)
+    {
+        get_dependent_events(*i);
+    }
+
+    if (selection_method_ == PARTIAL_SUM_TREE)
+    {
+        propensities_.reset(events_.size());
+        for (std::size_t i(0); i < events_.size(); ++i)
+        {
+            update_propensity(i);
+        }
+    }
 }
 
 Real GillespieSimulator::dt(void) const
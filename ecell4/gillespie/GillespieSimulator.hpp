@@ -11,8 +11,10 @@
 #include <ecell4/core/Model.hpp>
 #include <ecell4/core/NetworkModel.hpp>
 #include <ecell4/core/SimulatorBase.hpp>
+#include <ecell4/core/get_mapper_mf.hpp>
 
 #include "GillespieWorld.hpp"
+#include "PropensityTree.hpp"
 
 
 namespace ecell4
@@ -21,6 +23,17 @@ namespace ecell4
 namespace gillespie
 {
 
+/**
+ * How to select the next reaction from the propensities.
+ * LINEAR_SEARCH recomputes all the propensities and scans them at every step.
+ * PARTIAL_SUM_TREE keeps them in a binary tree and only updates the ones
+ * changed by the last reaction, which costs O(log R) per step.
+ */
+enum GillespieSelectionMethod {
+    LINEAR_SEARCH,
+    PARTIAL_SUM_TREE
+};
+
 class ReactionInfo
 {
 public:
@@ -120,12 +133,16 @@ protected:
         }
 
         virtual void initialize() = 0;
-        virtual void inc(const Species& sp, const Integer val = +1) = 0;
+        /**
+         * return true if the propensity may be changed by the given species.
+         * with val = 0, this only checks the dependency.
+         */
+        virtual bool inc(const Species& sp, const Integer val = +1) = 0;
         virtual const Real propensity() const = 0;
 
-        inline void dec(const Species& sp)
+        inline bool dec(const Species& sp)
         {
-            inc(sp, -1);
+            return inc(sp, -1);
         }
 
         boost::optional<ReactionRule> draw()
@@ -204,9 +221,9 @@ protected:
             ;
         }
 
-        void inc(const Species& sp, const Integer val = +1)
+        bool inc(const Species& /* sp */, const Integer /* val */ = +1)
         {
-            ; // do nothing
+            return false; // do nothing
         }
 
         void initialize()
@@ -244,14 +261,16 @@ protected:
             ;
         }
 
-        void inc(const Species& sp, const Integer val = +1)
+        bool inc(const Species& sp, const Integer val = +1)
         {
             const ReactionRule::reactant_container_type& reactants(rr_.reactants());
             const Integer coef(get_coef(reactants[0], sp));
             if (coef > 0)
             {
                 num_tot1_ += coef * val;
+                return true;
             }
+            return false;
         }
 
         void initialize()
@@ -326,7 +345,7 @@ protected:
             ;
         }
 
-        void inc(const Species& sp, const Integer val = +1)
+        bool inc(const Species& sp, const Integer val = +1)
         {
             const ReactionRule::reactant_container_type& reactants(rr_.reactants());
             const Integer coef1(get_coef(reactants[0], sp));
@@ -337,7 +356,9 @@ protected:
                 num_tot1_ += tmp;
                 num_tot2_ += coef2 * val;
                 num_tot12_ += coef2 * tmp;
+                return true;
             }
+            return false;
         }
 
         void initialize()
@@ -443,8 +464,10 @@ protected:
             ;
         }
 
-        void inc(const Species& sp, const Integer val = +1)
+        bool inc(const Species& sp, const Integer val = +1)
         {
+            bool changed(false);
+
             const ReactionRule::reactant_container_type& reactants(rr_.reactants());
             for (std::size_t i = 0; i < reactants.size(); ++i)
             {
@@ -452,6 +475,7 @@ protected:
                 if (coef > 0)
                 {
                     num_reactants_[i] += coef * val;
+                    changed = true;
                 }
             }
 
@@ -462,8 +486,10 @@ protected:
                 if (coef > 0)
                 {
                     num_products_[i] += coef * val;
+                    changed = true;
                 }
             }
+            return changed;
         }
 
         void initialize()
@@ -554,18 +580,55 @@ public:
 
     GillespieSimulator(
         boost::shared_ptr<GillespieWorld> world,
-        boost::shared_ptr<Model> model)
-        : base_type(world, model)
+        boost::shared_ptr<Model> model,
+        const GillespieSelectionMethod selection_method = LINEAR_SEARCH)
+        : base_type(world, model), selection_method_(selection_method)
     {
         initialize();
     }
 
-    GillespieSimulator(boost::shared_ptr<GillespieWorld> world)
-        : base_type(world)
+    GillespieSimulator(
+        boost::shared_ptr<GillespieWorld> world,
+        const GillespieSelectionMethod selection_method = LINEAR_SEARCH)
+        : base_type(world), selection_method_(selection_method)
     {
         initialize();
     }
 
+protected:
+
+    /**
+     * for a derived class, which sets itself up in its own initialize().
+     * initialize() is not called here, so that no random number is drawn
+     * before the derived class is ready.
+     */
+    GillespieSimulator(
+        boost::shared_ptr<GillespieWorld> world,
+        boost::shared_ptr<Model> model,
+        const GillespieSelectionMethod selection_method,
+        const bool initialize_now)
+        : base_type(world, model), selection_method_(selection_method)
+    {
+        if (initialize_now)
+        {
+            initialize();
+        }
+    }
+
+    GillespieSimulator(
+        boost::shared_ptr<GillespieWorld> world,
+        const GillespieSelectionMethod selection_method,
+        const bool initialize_now)
+        : base_type(world), selection_method_(selection_method)
+    {
+        if (initialize_now)
+        {
+            initialize();
+        }
+    }
+
+public:
+
     // SimulatorTraits
     Real dt(void) const;
 
@@ -594,12 +657,21 @@ public:
         return (*world_).rng();
     }
 
+    GillespieSelectionMethod selection_method() const
+    {
+        return selection_method_;
+    }
+
 protected:
 
+    void initialize_events(void);
     bool __draw_next_reaction(void);
+    void update_propensity(const std::size_t idx);
+    const std::vector<std::size_t>& get_dependent_events(const Species& sp);
     void draw_next_reaction(void);
     void increment_molecules(const Species& sp);
     void decrement_molecules(const Species& sp);
+    void change_molecules(const Species& sp, const Integer num);
     void check_model(void);
 
 protected:
@@ -609,6 +681,12 @@ protected:
     std::vector<std::pair<ReactionRule, reaction_info_type> > last_reactions_;
 
     boost::ptr_vector<ReactionRuleEvent> events_;
+
+    GillespieSelectionMethod selection_method_;
+    PropensityTree propensities_;
+    std::vector<std::size_t> descriptor_events_;  // propensities may depend on time
+    utils::get_mapper_mf<Species::serial_type, std::vector<std::size_t> >::type
+        dependent_events_;
 };
 
 }
@@ -0,0 +1,168 @@
+#ifndef ECELL4_GILLESPIE_PROPENSITY_TREE_HPP
+#define ECELL4_GILLESPIE_PROPENSITY_TREE_HPP
+
+#include <vector>
+#include <set>
+#include <limits>
+#include <stdexcept>
+
+#include <ecell4/core/types.hpp>
+
+
+namespace ecell4
+{
+
+namespace gillespie
+{
+
+/**
+ * A complete binary tree of partial sums over non-negative propensities.
+ * Leaves are stored in [capacity, 2 * capacity) of a flat array and each
+ * internal node holds the sum of its two children. Both an update of
+ * a single leaf and the search for the leaf which a cumulative value falls
+ * into cost O(log N). Each internal node is recomputed from its children,
+ * not by adding a difference, so no rounding error accumulates through
+ * a long run.
+ * Infinite propensities are not stored in the tree, but kept aside.
+ */
+class PropensityTree
+{
+public:
+
+    typedef std::vector<Real> container_type;
+    typedef container_type::size_type size_type;
+
+public:
+
+    PropensityTree()
+        : size_(0), capacity_(0), nodes_(), infinite_()
+    {
+        ;
+    }
+
+    PropensityTree(const size_type size)
+    {
+        reset(size);
+    }
+
+    void reset(const size_type size)
+    {
+        size_ = size;
+        capacity_ = 1;
+        while (capacity_ < size_)
+        {
+            capacity_ <<= 1;
+        }
+        nodes_.assign(2 * capacity_, 0.0);
+        infinite_.clear();
+    }
+
+    size_type size() const
+    {
+        return size_;
+    }
+
+    Real operator[](const size_type i) const
+    {
+        if (infinite_.count(i) > 0)
+        {
+            return std::numeric_limits<Real>::infinity();
+        }
+        return nodes_[capacity_ + i];
+    }
+
+    void update(const size_type i, const Real value)
+    {
+        if (i >= size_)
+        {
+            throw std::out_of_range("The index is out of range.");
+        }
+
+        size_type node(capacity_ + i);
+        if (value == std::numeric_limits<Real>::infinity())
+        {
+            infinite_.insert(i);
+            if (nodes_[node] == 0.0)
+            {
+                return;
+            }
+            nodes_[node] = 0.0;
+        }
+        else
+        {
+            infinite_.erase(i);
+            if (nodes_[node] == value)
+            {
+                return;
+            }
+            nodes_[node] = value;
+        }
+
+        while (node > 1)
+        {
+            node >>= 1;
+            nodes_[node] = nodes_[2 * node] + nodes_[2 * node + 1];
+        }
+    }
+
+    Real total() const
+    {
+        if (infinite_.size() > 0)
+        {
+            return std::numeric_limits<Real>::infinity();
+        }
+        return nodes_[1];
+    }
+
+    /**
+     * return a list of indices whose propensity is infinite.
+     */
+    const std::set<size_type>& infinite() const
+    {
+        return infinite_;
+    }
+
+    /**
+     * find the first leaf whose cumulative sum is not less than the given value.
+     * the value must be in [0, total()], and total() must be positive.
+     * a leaf with zero propensity is never selected.
+     */
+    size_type find(Real value) const
+    {
+        if (size_ == 0)
+        {
+            throw std::out_of_range("The tree is empty.");
+        }
+
+        size_type node(1);
+        while (node < capacity_)
+        {
+            const size_type left(2 * node);
+            if (nodes_[left] > 0.0
+                && (value <= nodes_[left] || nodes_[left + 1] == 0.0))
+            {
+                node = left;
+            }
+            else
+            {
+                value -= nodes_[left];
+                node = left + 1;
+            }
+        }
+
+        const size_type i(node - capacity_);
+        return (i < size_ ? i : size_ - 1);
+    }
+
+protected:
+
+    size_type size_, capacity_;
+    container_type nodes_;
+    std::set<size_type> infinite_;
+};
+
+} // gillespie
+
+} // ecell4
+
+#endif /* ECELL4_GILLESPIE_PROPENSITY_TREE_HPP */
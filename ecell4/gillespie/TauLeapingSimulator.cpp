@@ -0,0 +1,418 @@
+#include "TauLeapingSimulator.hpp"
+
+#include <cmath>
+#include <algorithm>
+#include <gsl/gsl_sf_log.h>
+
+
+namespace ecell4
+{
+
+namespace gillespie
+{
+
+/**
+ * fall back to SSA when the leap is shorter than this factor times 1/a0.
+ */
+static const Real SSA_THRESHOLD_FACTOR(10.0);
+
+/**
+ * the number of exact steps in a row once falling back to SSA.
+ */
+static const Integer NUM_EXACT_STEPS(100);
+
+std::size_t TauLeapingSimulator::get_species_index(const Species& sp)
+{
+    utils::get_mapper_mf<Species::serial_type, std::size_t>::type::const_iterator
+        it(species_index_.find(sp.serial()));
+    if (it != species_index_.end())
+    {
+        return (*it).second;
+    }
+
+    const std::size_t i(species_.size());
+    species_.push_back(sp);
+    orders_.push_back(std::vector<std::pair<Integer, Integer> >());
+    species_index_.insert(std::make_pair(sp.serial(), i));
+    return i;
+}
+
+Real TauLeapingSimulator::get_highest_order(const std::size_t i) const
+{
+    // g_i in Cao et al. (2006) generalized to any multiplicity:
+    //     (order / m) * (m + sum_{k=1}^{m-1} k / (x - k))
+    const Real x(static_cast<Real>(num_molecules_[i]));
+    Real g(1.0);
+    for (std::vector<std::pair<Integer, Integer> >::const_iterator
+        it(orders_[i].begin()); it != orders_[i].end(); ++it)
+    {
+        const Integer order((*it).first), m((*it).second);
+        Real val(m);
+        for (Integer k(1); k < m; ++k)
+        {
+            if (x > k)
+            {
+                val += k / (x - k);
+            }
+        }
+        g = std::max(g, val * order / m);
+    }
+    return g;
+}
+
+bool TauLeapingSimulator::is_critical(const std::size_t j) const
+{
+    for (stoichiometry_type::const_iterator it(changes_[j].begin());
+        it != changes_[j].end(); ++it)
+    {
+        if ((*it).second < 0
+            && num_molecules_[(*it).first] / (-(*it).second) < critical_threshold_)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+Real TauLeapingSimulator::select_tau(void)
+{
+    std::fill(mu_.begin(), mu_.end(), 0.0);
+    std::fill(sigma2_.begin(), sigma2_.end(), 0.0);
+
+    for (std::size_t j(0); j < events_.size(); ++j)
+    {
+        if (a_[j] == 0.0 || critical_[j])
+        {
+            continue;
+        }
+
+        for (stoichiometry_type::const_iterator it(changes_[j].begin());
+            it != changes_[j].end(); ++it)
+        {
+            const Real v((*it).second);
+            mu_[(*it).first] += v * a_[j];
+            sigma2_[(*it).first] += v * v * a_[j];
+        }
+    }
+
+    Real tau(inf);
+    for (std::size_t i(0); i < species_.size(); ++i)
+    {
+        if (sigma2_[i] == 0.0 || orders_[i].size() == 0)
+        {
+            // only reactants bound the relative change of propensities
+            continue;
+        }
+
+        const Real bound(std::max(epsilon_ * num_molecules_[i] / get_highest_order(i), 1.0));
+        if (mu_[i] != 0.0)
+        {
+            tau = std::min(tau, bound / std::abs(mu_[i]));
+        }
+        tau = std::min(tau, bound * bound / sigma2_[i]);
+    }
+    return tau;
+}
+
+void TauLeapingSimulator::select_next_step(void)
+{
+    fire_critical_ = false;
+
+    for (std::size_t i(0); i < species_.size(); ++i)
+    {
+        num_molecules_[i] = world_->num_molecules_exact(species_[i]);
+    }
+
+    Real a0(0.0);
+    a0_critical_ = 0.0;
+    for (std::size_t j(0); j < events_.size(); ++j)
+    {
+        a_[j] = events_[j].propensity();
+        critical_[j] = (a_[j] > 0.0 && is_critical(j));
+        a0 += a_[j];
+        if (critical_[j])
+        {
+            a0_critical_ += a_[j];
+        }
+    }
+
+    if (a0 == 0.0)
+    {
+        // no reaction occurs
+        num_exact_steps_ = 0;
+        dt_ = inf;
+        return;
+    }
+
+    if (a0 == inf)
+    {
+        // A reaction with an infinite propensity fires at once. Neither a
+        // leap nor the waiting time of a critical reaction is defined.
+        num_exact_steps_ = NUM_EXACT_STEPS;
+        draw_next_reaction();
+        return;
+    }
+
+    Real tau1(select_tau());
+    if (tau1 == inf)
+    {
+        // No propensity is changed by leaping. Any step is exact, but
+        // the number of firings in a leap is kept moderate.
+        tau1 = NUM_EXACT_STEPS / a0;
+    }
+    if (tau1 < SSA_THRESHOLD_FACTOR / a0)
+    {
+        num_exact_steps_ = NUM_EXACT_STEPS;
+        draw_next_reaction();
+        return;
+    }
+
+    num_exact_steps_ = 0;
+
+    Real tau2(inf);
+    if (a0_critical_ > 0.0)
+    {
+        const Real rnd(rng()->uniform(0, 1));
+        tau2 = gsl_sf_log(1.0 / rnd) / a0_critical_;
+    }
+
+    fire_critical_ = (tau2 <= tau1);
+    dt_ = (fire_critical_ ? tau2 : tau1);
+}
+
+void TauLeapingSimulator::leap(Real tau, bool fire_critical)
+{
+    while (true)
+    {
+        std::fill(delta_.begin(), delta_.end(), 0);
+        reacted_ = false;
+
+        for (std::size_t j(0); j < events_.size(); ++j)
+        {
+            if (a_[j] == 0.0 || critical_[j])
+            {
+                continue;
+            }
+
+            const Integer k(rng()->poisson(a_[j] * tau));
+            if (k == 0)
+            {
+                continue;
+            }
+
+            for (stoichiometry_type::const_iterator it(changes_[j].begin());
+                it != changes_[j].end(); ++it)
+            {
+                delta_[(*it).first] += k * (*it).second;
+            }
+            reacted_ = true;
+        }
+
+        if (fire_critical)
+        {
+            const Real rnd(rng()->uniform(0, a0_critical_));
+            Real acc(0.0);
+            std::size_t j(0), last(0);
+            for (; j < events_.size(); ++j)
+            {
+                if (!critical_[j])
+                {
+                    continue;
+                }
+
+                last = j;
+                acc += a_[j];
+                if (acc >= rnd)
+                {
+                    break;
+                }
+            }
+            j = std::min(j, last);  // against the round-off error
+
+            for (stoichiometry_type::const_iterator it(changes_[j].begin());
+                it != changes_[j].end(); ++it)
+            {
+                delta_[(*it).first] += (*it).second;
+            }
+            reacted_ = true;
+        }
+
+        bool negative(false);
+        for (std::size_t i(0); i < species_.size(); ++i)
+        {
+            if (num_molecules_[i] + delta_[i] < 0)
+            {
+                negative = true;
+                break;
+            }
+        }
+
+        if (!negative)
+        {
+            break;
+        }
+
+        // Reject the leap, and retry with the half. No critical reaction
+        // occurs within the shorter step as it fires after tau.
+        tau *= 0.5;
+        fire_critical = false;
+    }
+
+    for (std::size_t i(0); i < species_.size(); ++i)
+    {
+        change_molecules(species_[i], delta_[i]);
+    }
+
+    set_t(t() + tau);
+    num_steps_++;
+}
+
+void TauLeapingSimulator::step(void)
+{
+    last_reactions_.clear();
+    reacted_ = false;
+
+    if (this->dt_ == inf)
+    {
+        // No reaction occurs.
+        return;
+    }
+
+    if (num_exact_steps_ > 0)
+    {
+        base_type::step();
+        reacted_ = (last_reactions_.size() > 0);
+        if (--num_exact_steps_ > 0)
+        {
+            return;
+        }
+    }
+    else
+    {
+        leap(dt_, fire_critical_);
+    }
+
+    select_next_step();
+}
+
+bool TauLeapingSimulator::step(const Real& upto)
+{
+    if (upto <= t())
+    {
+        return false;
+    }
+
+    if (upto >= next_time())
+    {
+        step();
+        return true;
+    }
+    else if (num_exact_steps_ > 0)
+    {
+        // No reaction occurs.
+        reacted_ = false;
+        return base_type::step(upto);
+    }
+    else
+    {
+        // A shorter leap is still valid, but no critical reaction occurs.
+        last_reactions_.clear();
+        leap(upto - t(), false);
+        select_next_step();
+        return (t() < upto);  // the leap might be shortened
+    }
+}
+
+void TauLeapingSimulator::initialize(void)
+{
+    if (!model_->is_static())
+    {
+        throw NotSupported(
+            "TauLeapingSimulator only supports a static model. Expand the model first.");
+    }
+
+    initialize_events();
+
+    species_.clear();
+    species_index_.clear();
+    orders_.clear();
+    changes_.clear();
+    changes_.resize(events_.size());
+
+    for (std::size_t j(0); j < events_.size(); ++j)
+    {
+        const ReactionRule& rr(events_[j].reaction_rule());
+        const ReactionRule::reactant_container_type& reactants(rr.reactants());
+        const ReactionRule::product_container_type& products(rr.products());
+
+        std::vector<Integer> reactant_coefficients(reactants.size(), 1);
+        std::vector<Integer> product_coefficients(products.size(), 1);
+        if (rr.has_descriptor())
+        {
+            const boost::shared_ptr<ReactionRuleDescriptor>& desc(rr.get_descriptor());
+            for (std::size_t k(0); k < reactants.size(); ++k)
+            {
+                reactant_coefficients[k] = static_cast<Integer>(
+                    std::round(desc->reactant_coefficients()[k]));
+            }
+            for (std::size_t k(0); k < products.size(); ++k)
+            {
+                product_coefficients[k] = static_cast<Integer>(
+                    std::round(desc->product_coefficients()[k]));
+            }
+        }
+
+        utils::get_mapper_mf<std::size_t, Integer>::type multiplicities, changes;
+        Integer order(0);
+        for (std::size_t k(0); k < reactants.size(); ++k)
+        {
+            const std::size_t i(get_species_index(reactants[k]));
+            multiplicities[i] += reactant_coefficients[k];
+            changes[i] -= reactant_coefficients[k];
+            order += reactant_coefficients[k];
+        }
+        for (std::size_t k(0); k < products.size(); ++k)
+        {
+            changes[get_species_index(products[k])] += product_coefficients[k];
+        }
+
+        for (utils::get_mapper_mf<std::size_t, Integer>::type::const_iterator
+            it(multiplicities.begin()); it != multiplicities.end(); ++it)
+        {
+            if ((*it).second == 0)
+            {
+                continue;
+            }
+
+            const std::pair<Integer, Integer> key(order, (*it).second);
+            std::vector<std::pair<Integer, Integer> >& orders(orders_[(*it).first]);
+            if (std::find(orders.begin(), orders.end(), key) == orders.end())
+            {
+                orders.push_back(key);
+            }
+        }
+
+        for (utils::get_mapper_mf<std::size_t, Integer>::type::const_iterator
+            it(changes.begin()); it != changes.end(); ++it)
+        {
+            if ((*it).second != 0)
+            {
+                changes_[j].push_back(*it);
+            }
+        }
+    }
+
+    num_molecules_.resize(species_.size());
+    delta_.resize(species_.size());
+    mu_.resize(species_.size());
+    sigma2_.resize(species_.size());
+    a_.resize(events_.size());
+    critical_.resize(events_.size());
+
+    reacted_ = false;
+    select_next_step();
+}
+
+} // gillespie
+
+} // ecell4
@@ -0,0 +1,138 @@
+#ifndef ECELL4_GILLESPIE_TAU_LEAPING_SIMULATOR_HPP
+#define ECELL4_GILLESPIE_TAU_LEAPING_SIMULATOR_HPP
+
+#include <vector>
+#include <utility>
+#include <boost/shared_ptr.hpp>
+
+#include <ecell4/core/types.hpp>
+#include <ecell4/core/Model.hpp>
+#include <ecell4/core/get_mapper_mf.hpp>
+
+#include "GillespieWorld.hpp"
+#include "GillespieSimulator.hpp"
+
+
+namespace ecell4
+{
+
+namespace gillespie
+{
+
+/**
+ * An explicit tau-leaping simulator with the step size selection in
+ *     Y. Cao, D. T. Gillespie, and L. R. Petzold,
+ *     J. Chem. Phys. 124, 044109 (2006).
+ * A reaction which may exhaust one of its reactants within a few firings
+ * (critical) is not leaped, but fired at most once in a leap as in SSA.
+ * When the selected step is shorter than a few times of the mean waiting
+ * time of SSA, it falls back to the exact simulation of GillespieSimulator
+ * for a fixed number of steps.
+ *
+ * As each leap fires reactions in bulk, last_reactions() is empty after
+ * a leap. Only a static model, whose reaction rules are exact, is supported.
+ */
+class TauLeapingSimulator
+    : public GillespieSimulator
+{
+public:
+
+    typedef GillespieSimulator base_type;
+
+protected:
+
+    typedef std::vector<std::pair<std::size_t, Integer> > stoichiometry_type;
+
+public:
+
+    TauLeapingSimulator(
+        boost::shared_ptr<GillespieWorld> world,
+        boost::shared_ptr<Model> model,
+        const Real epsilon = 0.03,
+        const Integer critical_threshold = 10)
+        : base_type(world, model, LINEAR_SEARCH, false), epsilon_(epsilon),
+        critical_threshold_(critical_threshold), num_exact_steps_(0),
+        fire_critical_(false), reacted_(false), a0_critical_(0.0)
+    {
+        initialize();
+    }
+
+    TauLeapingSimulator(
+        boost::shared_ptr<GillespieWorld> world,
+        const Real epsilon = 0.03,
+        const Integer critical_threshold = 10)
+        : base_type(world, LINEAR_SEARCH, false), epsilon_(epsilon),
+        critical_threshold_(critical_threshold), num_exact_steps_(0),
+        fire_critical_(false), reacted_(false), a0_critical_(0.0)
+    {
+        initialize();
+    }
+
+    // SimulatorTraits
+    void step(void);
+    bool step(const Real& upto);
+
+    // Optional members
+
+    virtual bool check_reaction() const
+    {
+        return reacted_;
+    }
+
+    /**
+     * recalculate reaction propensities and select the next step.
+     */
+    void initialize();
+
+    /**
+     * return true if the next step is a leap, false if it is exact.
+     */
+    bool is_leaping() const
+    {
+        return (num_exact_steps_ == 0);
+    }
+
+    Real epsilon() const
+    {
+        return epsilon_;
+    }
+
+    Integer critical_threshold() const
+    {
+        return critical_threshold_;
+    }
+
+protected:
+
+    void select_next_step(void);
+    Real select_tau(void);
+    Real get_highest_order(const std::size_t i) const;
+    bool is_critical(const std::size_t j) const;
+    void leap(Real tau, bool fire_critical);
+    std::size_t get_species_index(const Species& sp);
+
+protected:
+
+    Real epsilon_;
+    Integer critical_threshold_;
+
+    Integer num_exact_steps_;  // the number of exact steps left
+    bool fire_critical_;  // a critical reaction fires at the end of the next leap
+    bool reacted_;
+
+    std::vector<Species> species_;
+    utils::get_mapper_mf<Species::serial_type, std::size_t>::type species_index_;
+    std::vector<stoichiometry_type> changes_;  // the net change of each event
+    std::vector<std::vector<std::pair<Integer, Integer> > > orders_;  // (order, multiplicity) for each species
+
+    std::vector<Integer> num_molecules_, delta_;
+    std::vector<Real> a_, mu_, sigma2_;
+    std::vector<bool> critical_;
+    Real a0_critical_;
+};
+
+} // gillespie
+
+} // ecell4
+
+#endif /* ECELL4_GILLESPIE_TAU_LEAPING_SIMULATOR_HPP */
@@ -47,3 +47,106 @@ BOOST_AUTO_TEST_CASE(GillespieSimulator_test_step)
     BOOST_CHECK(world->num_molecules(sp1) == 9);
 
 }
+
+BOOST_AUTO_TEST_CASE(GillespieSimulator_test_partial_sum_tree)
+{
+    boost::shared_ptr<NetworkModel> model(new NetworkModel());
+    Species sp1("A");
+    Species sp2("B");
+    Species sp3("C");
+    ReactionRule rr1 = create_binding_reaction_rule(sp1, sp2, sp3, 1.0);
+    ReactionRule rr2 = create_unbinding_reaction_rule(sp3, sp1, sp2, 5.0);
+    ReactionRule rr3 = create_degradation_reaction_rule(sp1, 0.0);
+    model->add_reaction_rule(rr1);
+    model->add_reaction_rule(rr2);
+    model->add_reaction_rule(rr3);
+
+    const Real L(1.0);
+    const Real3 edge_lengths(L, L, L);
+    boost::shared_ptr<RandomNumberGenerator> rng(new GSLRandomNumberGenerator());
+    boost::shared_ptr<GillespieWorld> world(new GillespieWorld(edge_lengths, rng));
+
+    world->add_molecules(sp1, 10);
+    world->add_molecules(sp2, 10);
+
+    GillespieSimulator sim(world, model, PARTIAL_SUM_TREE);
+    BOOST_CHECK_EQUAL(sim.selection_method(), PARTIAL_SUM_TREE);
+
+    for (unsigned int i(0); i < 100; ++i)
+    {
+        sim.step();
+        BOOST_CHECK_EQUAL(world->num_molecules(sp1), world->num_molecules(sp2));
+        BOOST_CHECK_EQUAL(world->num_molecules(sp1) + world->num_molecules(sp3), 10);
+    }
+    BOOST_CHECK(0 < sim.t());
+}
+
+BOOST_AUTO_TEST_CASE(GillespieSimulator_test_partial_sum_tree_trajectory)
+{
+    // only the dependent propensities are updated in PARTIAL_SUM_TREE,
+    // but the trajectory must follow the one with a full recomputation.
+    boost::shared_ptr<NetworkModel> model(new NetworkModel());
+    Species sp1("A");
+    Species sp2("B");
+    Species sp3("C");
+    Species sp4("D");
+    Species sp5("E");
+    model->add_reaction_rule(create_binding_reaction_rule(sp1, sp2, sp3, 0.5));
+    model->add_reaction_rule(create_unbinding_reaction_rule(sp3, sp1, sp2, 5.0));
+    model->add_reaction_rule(create_unimolecular_reaction_rule(sp1, sp4, 0.1));
+    model->add_reaction_rule(create_unimolecular_reaction_rule(sp4, sp1, 0.2));
+    model->add_reaction_rule(create_degradation_reaction_rule(sp5, 0.3));
+
+    const Real3 edge_lengths(1.0, 1.0, 1.0);
+    boost::shared_ptr<RandomNumberGenerator> rng1(new GSLRandomNumberGenerator(12345));
+    boost::shared_ptr<RandomNumberGenerator> rng2(new GSLRandomNumberGenerator(12345));
+    boost::shared_ptr<GillespieWorld> world1(new GillespieWorld(edge_lengths, rng1));
+    boost::shared_ptr<GillespieWorld> world2(new GillespieWorld(edge_lengths, rng2));
+
+    world1->add_molecules(sp1, 30);
+    world1->add_molecules(sp2, 20);
+    world1->add_molecules(sp5, 50);
+    world2->add_molecules(sp1, 30);
+    world2->add_molecules(sp2, 20);
+    world2->add_molecules(sp5, 50);
+
+    GillespieSimulator sim1(world1, model, LINEAR_SEARCH);
+    GillespieSimulator sim2(world2, model, PARTIAL_SUM_TREE);
+
+    for (unsigned int i(0); i < 500; ++i)
+    {
+        sim1.step();
+        sim2.step();
+        BOOST_CHECK_CLOSE(sim1.t(), sim2.t(), 1e-8);
+        BOOST_CHECK_EQUAL(world1->num_molecules(sp1), world2->num_molecules(sp1));
+        BOOST_CHECK_EQUAL(world1->num_molecules(sp3), world2->num_molecules(sp3));
+        BOOST_CHECK_EQUAL(world1->num_molecules(sp4), world2->num_molecules(sp4));
+        BOOST_CHECK_EQUAL(world1->num_molecules(sp5), world2->num_molecules(sp5));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(PropensityTree_test_find)
+{
+    PropensityTree tree(5);
+    tree.update(0, 1.0);
+    tree.update(2, 2.0);
+    tree.update(4, 3.0);
+
+    BOOST_CHECK_CLOSE(tree.total(), 6.0, 1e-12);
+    BOOST_CHECK_EQUAL(tree.find(0.0), 0);
+    BOOST_CHECK_EQUAL(tree.find(0.5), 0);
+    BOOST_CHECK_EQUAL(tree.find(1.5), 2);
+    BOOST_CHECK_EQUAL(tree.find(3.0), 2);
+    BOOST_CHECK_EQUAL(tree.find(4.5), 4);
+    BOOST_CHECK_EQUAL(tree.find(6.0), 4);
+
+    tree.update(2, 0.0);
+    BOOST_CHECK_CLOSE(tree.total(), 4.0, 1e-12);
+    BOOST_CHECK_EQUAL(tree.find(1.5), 4);
+
+    tree.update(3, std::numeric_limits<Real>::infinity());
+    BOOST_CHECK_EQUAL(tree.total(), std::numeric_limits<Real>::infinity());
+    BOOST_CHECK_EQUAL(tree.infinite().size(), 1);
+    tree.update(3, 0.0);
+    BOOST_CHECK_CLOSE(tree.total(), 4.0, 1e-12);
+}
@@ -0,0 +1,147 @@
+#define BOOST_TEST_MODULE "TauLeapingSimulator_test"
+
+#ifdef UNITTEST_FRAMEWORK_LIBRARY_EXIST
+#   include <boost/test/unit_test.hpp>
+#else
+#   define BOOST_TEST_NO_LIB
+#   include <boost/test/included/unit_test.hpp>
+#endif
+
+#include <ecell4/core/RandomNumberGenerator.hpp>
+#include <ecell4/core/Model.hpp>
+#include <ecell4/core/NetworkModel.hpp>
+
+#include <ecell4/gillespie/GillespieWorld.hpp>
+#include <ecell4/gillespie/TauLeapingSimulator.hpp>
+
+using namespace ecell4;
+using namespace ecell4::gillespie;
+
+BOOST_AUTO_TEST_CASE(TauLeapingSimulator_test_leap)
+{
+    boost::shared_ptr<NetworkModel> model(new NetworkModel());
+    Species sp1("A");
+    Species sp2("B");
+    model->add_reaction_rule(create_unimolecular_reaction_rule(sp1, sp2, 1.0));
+
+    const Real L(1.0);
+    const Real3 edge_lengths(L, L, L);
+    boost::shared_ptr<RandomNumberGenerator> rng(new GSLRandomNumberGenerator());
+    boost::shared_ptr<GillespieWorld> world(new GillespieWorld(edge_lengths, rng));
+
+    const Integer N(100000);
+    world->add_molecules(sp1, N);
+
+    TauLeapingSimulator sim(world, model);
+    BOOST_CHECK(sim.is_leaping());
+
+    sim.step();
+    BOOST_CHECK(sim.check_reaction());
+    BOOST_CHECK(sim.last_reactions().size() == 0);
+
+    while (sim.step(1.0))
+    {
+        BOOST_CHECK_EQUAL(world->num_molecules(sp1) + world->num_molecules(sp2), N);
+    }
+
+    BOOST_CHECK_CLOSE(sim.t(), 1.0, 1e-10);
+    BOOST_CHECK(sim.num_steps() < N / 10);
+    BOOST_CHECK_EQUAL(world->num_molecules(sp1) + world->num_molecules(sp2), N);
+
+    // the mean is N exp(-1) and the standard deviation is around 150
+    const Real expected(N * std::exp(-1.0));
+    BOOST_CHECK(std::abs(world->num_molecules(sp1) - expected) < 1000.0);
+}
+
+BOOST_AUTO_TEST_CASE(TauLeapingSimulator_test_critical)
+{
+    boost::shared_ptr<NetworkModel> model(new NetworkModel());
+    Species sp1("A");
+    Species sp2("B");
+    Species sp3("C");
+    model->add_reaction_rule(create_binding_reaction_rule(sp1, sp1, sp2, 1.0));
+    model->add_reaction_rule(create_degradation_reaction_rule(sp3, 1.0));
+
+    const Real L(1.0);
+    const Real3 edge_lengths(L, L, L);
+    boost::shared_ptr<RandomNumberGenerator> rng(new GSLRandomNumberGenerator());
+    boost::shared_ptr<GillespieWorld> world(new GillespieWorld(edge_lengths, rng));
+
+    world->add_molecules(sp1, 5000);
+    world->add_molecules(sp3, 3);
+
+    TauLeapingSimulator sim(world, model);
+
+    while (sim.step(10.0))
+    {
+        BOOST_CHECK(world->num_molecules(sp1) >= 0);
+        BOOST_CHECK(world->num_molecules(sp3) >= 0);
+        BOOST_CHECK_EQUAL(world->num_molecules(sp1) + 2 * world->num_molecules(sp2), 5000);
+    }
+
+    BOOST_CHECK(world->num_molecules(sp1) <= 1);
+    BOOST_CHECK_EQUAL(world->num_molecules(sp3), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TauLeapingSimulator_test_exact)
+{
+    boost::shared_ptr<NetworkModel> model(new NetworkModel());
+    Species sp1("A");
+    Species sp2("B");
+    model->add_reaction_rule(create_unimolecular_reaction_rule(sp1, sp2, 5.0));
+
+    const Real L(1.0);
+    const Real3 edge_lengths(L, L, L);
+    boost::shared_ptr<RandomNumberGenerator> rng(new GSLRandomNumberGenerator());
+    boost::shared_ptr<GillespieWorld> world(new GillespieWorld(edge_lengths, rng));
+
+    world->add_molecules(sp1, 10);
+
+    TauLeapingSimulator sim(world, model);
+    BOOST_CHECK(!sim.is_leaping());
+
+    sim.step();
+
+    BOOST_CHECK(0 < sim.t());
+    BOOST_CHECK_EQUAL(world->num_molecules(sp1), 9);
+    BOOST_CHECK_EQUAL(sim.last_reactions().size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(TauLeapingSimulator_test_infinite_rate)
+{
+    boost::shared_ptr<NetworkModel> model(new NetworkModel());
+    Species sp1("A");
+    Species sp2("B");
+    Species sp3("C");
+    model->add_reaction_rule(create_unimolecular_reaction_rule(sp1, sp2, inf));
+    model->add_reaction_rule(create_degradation_reaction_rule(sp3, 1.0));
+
+    const Real L(1.0);
+    const Real3 edge_lengths(L, L, L);
+    boost::shared_ptr<RandomNumberGenerator> rng(new GSLRandomNumberGenerator());
+    boost::shared_ptr<GillespieWorld> world(new GillespieWorld(edge_lengths, rng));
+
+    world->add_molecules(sp1, 3);
+    world->add_molecules(sp3, 3);
+
+    TauLeapingSimulator sim(world, model);
+    BOOST_CHECK(!sim.is_leaping());
+
+    for (Integer i(0); i < 3; ++i)
+    {
+        sim.step();
+        BOOST_CHECK_EQUAL(sim.t(), 0.0);
+        BOOST_CHECK_EQUAL(world->num_molecules(sp1), 2 - i);
+        BOOST_CHECK_EQUAL(world->num_molecules(sp2), i + 1);
+    }
+
+    while (sim.step(10.0))
+    {
+        BOOST_CHECK(std::isfinite(sim.t()));
+        BOOST_CHECK(world->num_molecules(sp3) >= 0);
+    }
+
+    BOOST_CHECK_CLOSE(sim.t(), 10.0, 1e-10);
+    BOOST_CHECK_EQUAL(world->num_molecules(sp1), 0);
+    BOOST_CHECK_EQUAL(world->num_molecules(sp2), 3);
+}
@@ -61,6 +61,11 @@ public:
         return &(this->rng(rng));  //XXX: == this
     }
 
+    bool has_rng() const
+    {
+        return static_cast<bool>(rng_);
+    }
+
 protected:
 
     virtual world_type* create_world(const Real3& edge_lengths) const
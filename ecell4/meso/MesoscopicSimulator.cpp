@@ -21,22 +21,31 @@ namespace meso
 void MesoscopicSimulator::increment(const boost::shared_ptr<MesoscopicWorld::PoolBase>& pool, const coordinate_type& c)
 {
     pool->add_molecules(1, c);
-
-    for (boost::ptr_vector<ReactionRuleProxyBase>::iterator i(proxies_.begin());
-        i != proxies_.end(); ++i)
-    {
-        (*i).inc(pool->species(), c);
-    }
+    inc_dependencies(pool->species(), c, +1);
 }
 
 void MesoscopicSimulator::decrement(const boost::shared_ptr<MesoscopicWorld::PoolBase>& pool, const coordinate_type& c)
 {
     pool->remove_molecules(1, c);
+    inc_dependencies(pool->species(), c, -1);
+}
+
+void MesoscopicSimulator::inc_dependencies(
+    const Species& sp, const coordinate_type& c, const Integer val)
+{
+    utils::get_mapper_mf<Species::serial_type, DiffusionProxy*>::type::const_iterator
+        it(diffusion_proxies_.find(sp.serial()));
+    if (it != diffusion_proxies_.end())
+    {
+        (*it).second->inc_dependencies(c, val);
+        return;
+    }
 
+    // No dependency is known for the species. Ask all the reactions.
     for (boost::ptr_vector<ReactionRuleProxyBase>::iterator i(proxies_.begin());
         i != proxies_.end(); ++i)
     {
-        (*i).dec(pool->species(), c);
+        (*i).inc(sp, c, val);
     }
 }
 
@@ -71,66 +80,106 @@ void MesoscopicSimulator::decrement_molecules(const Species& sp, const coordinat
     }
 }
 
-std::pair<Real, MesoscopicSimulator::ReactionRuleProxyBase*>
-MesoscopicSimulator::draw_next_reaction(const coordinate_type& c)
+Real MesoscopicSimulator::calculate_propensity(const coordinate_type& c)
 {
-    std::vector<double> a(proxies_.size());
+    buffer_.resize(proxies_.size());
     for (unsigned int idx(0); idx < proxies_.size(); ++idx)
     {
-        a[idx] = proxies_[idx].propensity(c);
+        buffer_[idx] = proxies_[idx].propensity(c);
     }
+    return std::accumulate(buffer_.begin(), buffer_.end(), double(0.0));
+}
 
-    const double atot(std::accumulate(a.begin(), a.end(), double(0.0)));
+MesoscopicSimulator::ReactionRuleProxyBase*
+MesoscopicSimulator::draw_next_reaction(const coordinate_type& c)
+{
+    const double atot(calculate_propensity(c));
     if (atot == 0.0)
     {
-        return std::make_pair(inf, (ReactionRuleProxyBase*)NULL);
+        return NULL;
     }
 
     if (atot == std::numeric_limits<Real>::infinity())
     {
         std::vector<unsigned int> selected;
-        for (unsigned int i(0); i < a.size(); ++i)
+        for (unsigned int i(0); i < buffer_.size(); ++i)
         {
-            if (a[i] == std::numeric_limits<Real>::infinity())
+            if (buffer_[i] == std::numeric_limits<Real>::infinity())
             {
                 selected.push_back(i);
             }
         }
 
         const unsigned int idx = selected[(selected.size() == 1 ? 0 : rng()->uniform_int(0, selected.size() - 1))];
-        return std::make_pair(0.0, &proxies_[idx]);
+        return &proxies_[idx];
     }
 
-    const double rnd1(rng()->uniform(0, 1));
-    const double dt(gsl_sf_log(1.0 / rnd1) / double(atot));
     const double rnd2(rng()->uniform(0, atot));
 
     int u(-1);
     double acc(0.0);
-    const int len_a(a.size());
+    const int len_a(buffer_.size());
     do
     {
         u++;
-        acc += a[u];
+        acc += buffer_[u];
     } while (acc < rnd2 && u < len_a - 1);
 
-    if (len_a == u)
+    return &proxies_[u];
+}
+
+/**
+ * Draw the next reaction time of the subvolume from scratch.
+ */
+void MesoscopicSimulator::reschedule(const coordinate_type& c)
+{
+    const Real atot(calculate_propensity(c));
+    propensities_[c] = atot;
+
+    Real tnext(inf);
+    if (atot == std::numeric_limits<Real>::infinity())
     {
-        return std::make_pair(inf, (ReactionRuleProxyBase*)NULL);
+        tnext = t();
     }
-
-    return std::make_pair(dt, &proxies_[u]);
+    else if (atot > 0.0)
+    {
+        const double rnd1(rng()->uniform(0, 1));
+        tnext = t() + gsl_sf_log(1.0 / rnd1) / double(atot);
+    }
+    queue_.replace(std::make_pair(c, tnext));
 }
 
-void MesoscopicSimulator::interrupt_all(const Real& t)
+/**
+ * Update the next reaction time of the subvolume after its propensity
+ * was changed by others. The waiting time is rescaled with the ratio of
+ * the old and new propensities without drawing a random number
+ * (Gibson and Bruck, 2000).
+ */
+void MesoscopicSimulator::update_propensity(const coordinate_type& c)
 {
-    EventScheduler::events_range events(scheduler_.events());
-    for (EventScheduler::events_range::iterator itr(events.begin());
-            itr != events.end(); ++itr)
+    const Real aold(propensities_[c]);
+    const Real told(queue_.get(c));
+
+    if (aold == 0.0 || aold == std::numeric_limits<Real>::infinity()
+        || told == inf)
+    {
+        reschedule(c);
+        return;
+    }
+
+    const Real anew(calculate_propensity(c));
+    propensities_[c] = anew;
+
+    Real tnext(inf);
+    if (anew == std::numeric_limits<Real>::infinity())
     {
-        (*itr).second->interrupt(t);
-        scheduler_.update(*itr);
+        tnext = t();
     }
+    else if (anew > 0.0)
+    {
+        tnext = t() + (aold / anew) * (told - t());
+    }
+    queue_.replace(std::make_pair(c, tnext));
 }
 
 void MesoscopicSimulator::step(void)
@@ -141,33 +190,26 @@ void MesoscopicSimulator::step(void)
         return;
     }
 
-    interrupted_ = event_ids_.size();
-    EventScheduler::value_type const& top(scheduler_.top());
-    const Real tnext(top.second->time());
-    top.second->fire(); // top.second->time_ is updated in fire()
+    last_reactions_.clear();
+    interrupted_ = propensities_.size();
+
+    const subvolume_queue_type::value_type top(queue_.top());
+    const coordinate_type c(top.first);
+    const Real tnext(top.second);
     this->set_t(tnext);
-    scheduler_.update(top);
 
-    if (interrupted_ < static_cast<coordinate_type>(event_ids_.size()))
+    ReactionRuleProxyBase* proxy(draw_next_reaction(c));
+    if (proxy != NULL)
     {
-        EventScheduler::identifier_type evid(event_ids_[interrupted_]);
-        boost::shared_ptr<Event> ev(scheduler_.get(evid));
-        ev->interrupt(t());
-        scheduler_.update(std::make_pair(evid, ev));
+        proxy->fire(tnext, c);
     }
+    reschedule(c);
 
-    // EventScheduler::value_type top(scheduler_.pop());
-    // const Real tnext(top.second->time());
-    // top.second->fire(); // top.second->time_ is updated in fire()
-    // this->set_t(tnext);
-    // // EventScheduler::events_range events(scheduler_.events());
-    // // for (EventScheduler::events_range::iterator itr(events.begin());
-    // //         itr != events.end(); ++itr)
-    // // {
-    // //     (*itr).second->interrupt(tnext);
-    // //     scheduler_.update(*itr);
-    // // }
-    // scheduler_.add(top.second);
+    if (interrupted_ < static_cast<coordinate_type>(propensities_.size())
+        && interrupted_ != c)
+    {
+        update_propensity(interrupted_);
+    }
 
     num_steps_++;
 }
@@ -206,6 +248,7 @@ MesoscopicSimulator::create_diffusion_proxy(const Species& sp)
         proxy->set_dependency(
             dynamic_cast<ReactionRuleProxy*>(&proxies_[i]));
     }
+    diffusion_proxies_[sp.serial()] = proxy;
     return proxy;
 }
 
@@ -266,6 +309,7 @@ void MesoscopicSimulator::initialize(void)
     check_model();
 
     proxies_.clear();
+    diffusion_proxies_.clear();
     for (Model::reaction_rule_container_type::const_iterator
         i(reaction_rules.begin()); i != reaction_rules.end(); ++i)
     {
@@ -320,13 +364,16 @@ void MesoscopicSimulator::initialize(void)
         proxies_.push_back(create_diffusion_proxy(*i));
     }
 
-    scheduler_.clear();
-    event_ids_.resize(world_->num_subvolumes());
-    for (Integer i(0); i < world_->num_subvolumes(); ++i)
+    const Integer num_subvolumes(world_->num_subvolumes());
+    queue_.clear();
+    propensities_.assign(num_subvolumes, 0.0);
+    for (Integer i(0); i < num_subvolumes; ++i)
+    {
+        queue_.push(inf);
+    }
+    for (Integer i(0); i < num_subvolumes; ++i)
     {
-        event_ids_[i] =
-            scheduler_.add(boost::shared_ptr<Event>(
-                new SubvolumeEvent(this, i, t())));
+        reschedule(i);
     }
 }
 
@@ -337,7 +384,7 @@ Real MesoscopicSimulator::dt(void) const
 
 Real MesoscopicSimulator::next_time(void) const
 {
-    return scheduler_.next_time();
+    return (queue_.empty() ? inf : queue_.top().second);
 }
 
 } // meso
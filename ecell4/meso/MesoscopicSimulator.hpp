@@ -6,7 +6,8 @@
 #include <ecell4/core/types.hpp>
 #include <ecell4/core/Model.hpp>
 #include <ecell4/core/SimulatorBase.hpp>
-#include <ecell4/core/EventScheduler.hpp>
+#include <ecell4/core/DynamicPriorityQueue.hpp>
+#include <ecell4/core/get_mapper_mf.hpp>
 
 #include "MesoscopicWorld.hpp"
 
@@ -987,17 +988,25 @@ protected:
                 pool_->remove_molecules(1, src);
                 pool_->add_molecules(1, dst);
 
-                for (dependency_container_type::const_iterator i(dependencies_.begin());
-                     i != dependencies_.end(); ++i)
-                {
-                    (*i).first->inc_with_coefs((*i).second, src, -1);
-                    (*i).first->inc_with_coefs((*i).second, dst, +1);
-                }
+                inc_dependencies(src, -1);
+                inc_dependencies(dst, +1);
             }
 
             sim_->interrupt(dst);
         }
 
+        /**
+         * update only the reactions depending on the species of this pool.
+         */
+        void inc_dependencies(const coordinate_type& c, const Integer val = +1)
+        {
+            for (dependency_container_type::const_iterator i(dependencies_.begin());
+                 i != dependencies_.end(); ++i)
+            {
+                (*i).first->inc_with_coefs((*i).second, c, val);
+            }
+        }
+
         void set_dependency(ReactionRuleProxy* proxy)
         {
             const std::vector<Integer> coefs = proxy->check_dependency(pool_->species());
@@ -1015,51 +1024,12 @@ protected:
         dependency_container_type dependencies_;
     };
 
-    struct SubvolumeEvent
-        : public Event
-    {
-    public:
-
-        SubvolumeEvent(MesoscopicSimulator* sim, const coordinate_type& c, const Real& t)
-            : Event(t), sim_(sim), coord_(c)
-        {
-            update();
-        }
-
-        virtual ~SubvolumeEvent()
-        {
-            ;
-        }
-
-        virtual void fire()
-        {
-            assert(proxy_ != NULL);
-            sim_->reset_last_reactions();
-            proxy_->fire(time_, coord_);
-            update();
-        }
-
-        virtual void interrupt(Real const& t)
-        {
-            time_ = t;
-            update();
-        }
-
-        void update()
-        {
-            const std::pair<Real, ReactionRuleProxyBase*>
-                retval = sim_->draw_next_reaction(coord_);
-            time_ += retval.first;
-            proxy_ = retval.second;
-        }
-
-    protected:
-
-        MesoscopicSimulator* sim_;
-        coordinate_type coord_;
-
-        ReactionRuleProxyBase* proxy_;
-    };
+    /**
+     * An indexed binary heap of the next reaction times of all subvolumes.
+     * No item is popped, and thus an identifier is equal to the coordinate.
+     */
+    typedef DynamicPriorityQueue<Real, std::less_equal<Real>, volatile_id_policy<> >
+        subvolume_queue_type;
 
 public:
 
@@ -1124,14 +1094,16 @@ protected:
 
     DiffusionProxy* create_diffusion_proxy(const Species& sp);
 
-    void interrupt_all(const Real& t);
-    std::pair<Real, ReactionRuleProxyBase*>
-        draw_next_reaction(const coordinate_type& c);
+    Real calculate_propensity(const coordinate_type& c);
+    ReactionRuleProxyBase* draw_next_reaction(const coordinate_type& c);
+    void reschedule(const coordinate_type& c);
+    void update_propensity(const coordinate_type& c);
 
     void increment_molecules(const Species& sp, const coordinate_type& c);
     void decrement_molecules(const Species& sp, const coordinate_type& c);
     void increment(const boost::shared_ptr<MesoscopicWorld::PoolBase>& pool, const coordinate_type& c);
     void decrement(const boost::shared_ptr<MesoscopicWorld::PoolBase>& pool, const coordinate_type& c);
+    void inc_dependencies(const Species& sp, const coordinate_type& c, const Integer val);
     void check_model(void);
 
 protected:
@@ -1140,9 +1112,11 @@ protected:
 
     boost::ptr_vector<ReactionRuleProxyBase> proxies_;
     boost::ptr_vector<ReactionRuleProxyBase>::size_type diffusion_proxy_offset_;
+    utils::get_mapper_mf<Species::serial_type, DiffusionProxy*>::type diffusion_proxies_;
 
-    EventScheduler scheduler_;
-    std::vector<EventScheduler::identifier_type> event_ids_;
+    subvolume_queue_type queue_;
+    std::vector<Real> propensities_;  // the total propensity of each subvolume
+    std::vector<Real> buffer_;  // the propensity of each proxy in a subvolume
     coordinate_type interrupted_;
 };
 
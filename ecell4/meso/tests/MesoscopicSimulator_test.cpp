@@ -49,3 +49,148 @@ BOOST_AUTO_TEST_CASE(MesoscopicSimulator_test_step)
     BOOST_CHECK(world->num_molecules(sp1, 0) == 9);
     BOOST_CHECK(world->num_molecules(sp2, 0) == 1);
 }
+
+BOOST_AUTO_TEST_CASE(MesoscopicSimulator_test_dependencies)
+{
+    boost::shared_ptr<NetworkModel> model(new NetworkModel());
+    Species sp1("A", 0.0025, 1.0);
+    Species sp2("B", 0.0025, 1.0);
+    Species sp3("C", 0.0025, 1.0);
+    model->add_species_attribute(sp1);
+    model->add_species_attribute(sp2);
+    model->add_species_attribute(sp3);
+    model->add_reaction_rule(create_unimolecular_reaction_rule(sp1, sp2, 1.0));
+    model->add_reaction_rule(create_binding_reaction_rule(sp1, sp2, sp3, 1.0));
+
+    const Real L(1.0);
+    const Real3 edge_lengths(L, L, L);
+    boost::shared_ptr<RandomNumberGenerator> rng(new GSLRandomNumberGenerator());
+    boost::shared_ptr<MesoscopicWorld> world(
+        new MesoscopicWorld(edge_lengths, Integer3(2, 2, 2), rng));
+    world->bind_to(model);
+
+    world->add_molecules(sp1, 100, 0);
+
+    MesoscopicSimulator sim(world, model);
+
+    while (sim.t() < 1.0 && sim.dt() < inf)
+    {
+        sim.step();
+        BOOST_CHECK_EQUAL(
+            world->num_molecules_exact(sp1) + world->num_molecules_exact(sp2)
+                + 2 * world->num_molecules_exact(sp3), 100);
+    }
+    BOOST_CHECK(world->num_molecules_exact(sp1) < 100);
+}
+
+namespace
+{
+
+/**
+ * expose the next reaction time and the propensity of each subvolume,
+ * and the subvolume interrupted by the last step.
+ */
+class InspectedMesoscopicSimulator
+    : public MesoscopicSimulator
+{
+public:
+
+    InspectedMesoscopicSimulator(
+        boost::shared_ptr<MesoscopicWorld> world, boost::shared_ptr<Model> model)
+        : MesoscopicSimulator(world, model)
+    {
+        ;
+    }
+
+    Real queue_time(const coordinate_type& c) const
+    {
+        return queue_.get(c);
+    }
+
+    Real propensity(const coordinate_type& c) const
+    {
+        return propensities_[c];
+    }
+
+    coordinate_type interrupted() const
+    {
+        return interrupted_;
+    }
+};
+
+} // anonymous
+
+BOOST_AUTO_TEST_CASE(MesoscopicSimulator_test_update_propensity)
+{
+    boost::shared_ptr<NetworkModel> model(new NetworkModel());
+    Species sp1("A", 0.0025, 1.0);
+    Species sp2("B", 0.0025, 0.0);
+    model->add_species_attribute(sp1);
+    model->add_species_attribute(sp2);
+    model->add_reaction_rule(create_unimolecular_reaction_rule(sp1, sp2, 0.1));
+
+    const Real L(1.0);
+    const Real3 edge_lengths(L, L, L);
+    boost::shared_ptr<RandomNumberGenerator> rng(new GSLRandomNumberGenerator());
+    boost::shared_ptr<MesoscopicWorld> world(
+        new MesoscopicWorld(edge_lengths, Integer3(4, 1, 1), rng));
+    world->bind_to(model);
+    world->add_molecules(sp1, 20, 0);
+
+    InspectedMesoscopicSimulator sim(world, model);
+    const Integer num_subvolumes(world->num_subvolumes());
+
+    std::size_t num_rescaled(0), num_rescheduled(0);
+    std::vector<Real> told(num_subvolumes), aold(num_subvolumes);
+    for (std::size_t i(0); i < 200 && sim.dt() < inf; ++i)
+    {
+        for (Integer c(0); c < num_subvolumes; ++c)
+        {
+            told[c] = sim.queue_time(c);
+            aold[c] = sim.propensity(c);
+        }
+
+        const Real t(sim.next_time());
+        sim.step();
+        BOOST_CHECK_EQUAL(sim.t(), t);
+        BOOST_CHECK_EQUAL(
+            world->num_molecules_exact(sp1) + world->num_molecules_exact(sp2), 20);
+
+        // the subvolume which fired has the earliest time
+        Integer fired(0);
+        while (fired < num_subvolumes && told[fired] != t)
+        {
+            ++fired;
+        }
+        BOOST_REQUIRE(fired < num_subvolumes);
+
+        const Integer interrupted(sim.interrupted());
+        for (Integer c(0); c < num_subvolumes; ++c)
+        {
+            if (c == fired)
+            {
+                continue;
+            }
+            else if (c != interrupted)
+            {
+                BOOST_CHECK_EQUAL(sim.queue_time(c), told[c]);
+            }
+            else if (told[c] == inf)
+            {
+                // an idle subvolume draws its first time
+                BOOST_CHECK(sim.propensity(c) > 0.0);
+                BOOST_CHECK(t <= sim.queue_time(c) && sim.queue_time(c) < inf);
+                ++num_rescheduled;
+            }
+            else
+            {
+                // the time left is rescaled without a new draw
+                BOOST_CHECK_CLOSE(sim.queue_time(c),
+                    t + (aold[c] / sim.propensity(c)) * (told[c] - t), 1e-12);
+                ++num_rescaled;
+            }
+        }
+    }
+    BOOST_CHECK(num_rescaled > 0);
+    BOOST_CHECK(num_rescheduled > 0);
+}
@@ -78,10 +78,158 @@ ODESimulator::reaction_container_type ODESimulator::convert_reactions() const
     return reactions;
 }
 
+boost::shared_ptr<const ODESimulator::compiled_reaction_container_type>
+ODESimulator::compile_reactions() const
+{
+    const reaction_container_type reactions(convert_reactions());
+
+    boost::shared_ptr<compiled_reaction_container_type>
+        retval(new compiled_reaction_container_type());
+    compiled_reaction_container_type& compiled(*retval);
+
+    compiled.num_species = world_->list_species().size();
+    compiled.max_num_participants = 0;
+    compiled.offsets.reserve(reactions.size() + 1);
+    compiled.offsets.push_back(0);
+    compiled.num_reactants.reserve(reactions.size());
+    compiled.k.reserve(reactions.size());
+    compiled.ratelaws.reserve(reactions.size());
+
+    for (reaction_container_type::const_iterator i(reactions.begin());
+        i != reactions.end(); ++i)
+    {
+        boost::shared_ptr<ReactionRuleDescriptor> ratelaw((*i).ratelaw.lock());
+        Real k((*i).k);
+        if (ReactionRuleDescriptorMassAction* massaction
+            = dynamic_cast<ReactionRuleDescriptorMassAction*>(ratelaw.get()))
+        {
+            k = massaction->k();
+            ratelaw.reset();
+        }
+        assert(!ratelaw || ratelaw->is_available());
+
+        compiled.indices.insert(compiled.indices.end(), (*i).reactants.begin(), (*i).reactants.end());
+        compiled.coefficients.insert(compiled.coefficients.end(),
+            (*i).reactant_coefficients.begin(), (*i).reactant_coefficients.end());
+        compiled.indices.insert(compiled.indices.end(), (*i).products.begin(), (*i).products.end());
+        compiled.coefficients.insert(compiled.coefficients.end(),
+            (*i).product_coefficients.begin(), (*i).product_coefficients.end());
+
+        compiled.offsets.push_back(compiled.indices.size());
+        compiled.num_reactants.push_back((*i).reactants.size());
+        compiled.k.push_back(k);
+        compiled.ratelaws.push_back(ratelaw);
+        compiled.max_num_participants = std::max(
+            compiled.max_num_participants, (*i).reactants.size() + (*i).products.size());
+    }
+
+    // The sparsity pattern of the jacobian
+    std::vector<std::vector<std::size_t> > pattern(compiled.num_species);
+    for (std::size_t row(0); row < compiled.num_species; ++row)
+    {
+        pattern[row].push_back(row);
+    }
+    for (std::size_t i(0); i < compiled.k.size(); ++i)
+    {
+        const std::size_t first(compiled.offsets[i]), last(compiled.offsets[i + 1]);
+        const std::size_t cols_last(
+            compiled.ratelaws[i] ? last : first + compiled.num_reactants[i]);
+        for (std::size_t row(first); row < last; ++row)
+        {
+            for (std::size_t col(first); col < cols_last; ++col)
+            {
+                pattern[compiled.indices[row]].push_back(compiled.indices[col]);
+            }
+        }
+    }
+
+    compiled.row_offsets.reserve(compiled.num_species + 1);
+    compiled.row_offsets.push_back(0);
+    for (std::size_t row(0); row < compiled.num_species; ++row)
+    {
+        std::vector<std::size_t>& cols(pattern[row]);
+        std::sort(cols.begin(), cols.end());
+        cols.erase(std::unique(cols.begin(), cols.end()), cols.end());
+        compiled.columns.insert(compiled.columns.end(), cols.begin(), cols.end());
+        compiled.row_offsets.push_back(compiled.columns.size());
+    }
+
+    const SparseMatrix matrix(compiled.num_species, compiled.row_offsets, compiled.columns);
+    compiled.position_offsets.reserve(compiled.k.size());
+    for (std::size_t i(0); i < compiled.k.size(); ++i)
+    {
+        compiled.position_offsets.push_back(compiled.positions.size());
+
+        const std::size_t first(compiled.offsets[i]), last(compiled.offsets[i + 1]);
+        const std::size_t cols_last(
+            compiled.ratelaws[i] ? last : first + compiled.num_reactants[i]);
+        for (std::size_t row(first); row < last; ++row)
+        {
+            for (std::size_t col(first); col < cols_last; ++col)
+            {
+                compiled.positions.push_back(
+                    matrix.position(compiled.indices[row], compiled.indices[col]));
+            }
+        }
+    }
+
+    return retval;
+}
+
+void ODESimulator::compile()
+{
+    compiled_reactions_ = compile_reactions();
+    compiled_revision_ = model_->revision();
+    compiled_world_revision_ = world_->revision();
+
+    compiled_descriptor_revisions_.clear();
+    const Model::reaction_rule_container_type& reaction_rules(model_->reaction_rules());
+    for (std::size_t i(0); i < reaction_rules.size(); ++i)
+    {
+        if (reaction_rules[i].has_descriptor())
+        {
+            compiled_descriptor_revisions_.push_back(std::make_pair(
+                i, reaction_rules[i].get_descriptor()->revision()));
+        }
+    }
+}
+
+bool ODESimulator::is_compiled() const
+{
+    if (model_->revision() != compiled_revision_
+        || world_->revision() != compiled_world_revision_)
+    {
+        return false;
+    }
+
+    // the descriptor of a rule in the model may be changed in place
+    const Model::reaction_rule_container_type& reaction_rules(model_->reaction_rules());
+    for (std::vector<std::pair<std::size_t, Integer> >::const_iterator
+        i(compiled_descriptor_revisions_.begin());
+        i != compiled_descriptor_revisions_.end(); ++i)
+    {
+        if (reaction_rules[(*i).first].get_descriptor()->revision() != (*i).second)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 std::pair<ODESimulator::deriv_func, ODESimulator::jacobi_func>
 ODESimulator::generate_system() const
 {
-    const reaction_container_type reactions(convert_reactions());
+    if (is_compiled())
+    {
+        return generate_system(compiled_reactions_);
+    }
+    return generate_system(compile_reactions());
+}
+
+std::pair<ODESimulator::deriv_func, ODESimulator::jacobi_func>
+ODESimulator::generate_system(
+    const boost::shared_ptr<const compiled_reaction_container_type>& reactions) const
+{
     return std::make_pair(
             deriv_func(reactions, world_->volume()),
             jacobi_func(reactions, world_->volume(), abs_tol_, rel_tol_));
@@ -108,7 +256,11 @@ bool ODESimulator::step(const Real &upto)
         x[i] = static_cast<double>(world_->get_value_exact(*it));
         i++;
     }
-    std::pair<deriv_func, jacobi_func> system(generate_system());
+    if (!is_compiled())
+    {
+        compile();
+    }
+    std::pair<deriv_func, jacobi_func> system(generate_system(compiled_reactions_));
     StateAndTimeBackInserter::state_container_type x_vec;
     StateAndTimeBackInserter::time_container_type times;
 
@@ -144,6 +296,15 @@ bool ODESimulator::step(const Real &upto)
                         StateAndTimeBackInserter(x_vec, times)));
             }
             break;
+        case ecell4::ode::ROSENBROCK2_SPARSE:
+            {
+                /* This solver doesn't keep intermediate states */
+                SparseRosenbrock2<state_type> stepper(abs_tol_, rel_tol_);
+                stepper.integrate(system, x, t(), ntime, dt);
+                x_vec.push_back(x);
+                steps = 0;
+            }
+            break;
         default:
             throw IllegalState("Solver is not specified\n");
     };
@@ -20,6 +20,7 @@
 #include <ecell4/core/SimulatorBase.hpp>
 
 #include "ODEWorld.hpp"
+#include "SparseRosenbrock.hpp"
 
 namespace ecell4
 {
@@ -30,6 +31,7 @@ enum ODESolverType {
     RUNGE_KUTTA_CASH_KARP54 = 0,
     ROSENBROCK4_CONTROLLER = 1,
     EULER = 2,
+    ROSENBROCK2_SPARSE = 3,
 };
 
 class ODESimulator
@@ -59,283 +61,287 @@ public:
     };
     typedef std::vector<reaction_type> reaction_container_type;
 
+    static inline Real power(const Real x, const Real coef)
+    {
+        return (coef == 1.0 ? x : (coef == 2.0 ? x * x : std::pow(x, coef)));
+    }
+
+    template <typename Treactions_>
+    static inline void fill_states(
+        const Treactions_& reactions, const std::size_t i, const state_type& x,
+        ReactionRuleDescriptor::state_container_type& reactants_states,
+        ReactionRuleDescriptor::state_container_type& products_states)
+    {
+        const std::size_t first(reactions.offsets[i]);
+        const std::size_t last(reactions.offsets[i + 1]);
+        const std::size_t middle(first + reactions.num_reactants[i]);
+
+        reactants_states.resize(middle - first);
+        for (std::size_t j(first); j < middle; ++j)
+        {
+            reactants_states[j - first] = x[reactions.indices[j]];
+        }
+        products_states.resize(last - middle);
+        for (std::size_t j(middle); j < last; ++j)
+        {
+            products_states[j - middle] = x[reactions.indices[j]];
+        }
+    }
+
+    /**
+     * A flat representation of reactions compiled from reaction_container_type.
+     * The participants of the i-th reaction are stored in
+     * [offsets[i], offsets[i + 1]) of indices and coefficients, the first
+     * num_reactants[i] of which are reactants and the rest are products.
+     * A reaction without ratelaw obeys the mass action with the rate k[i].
+     *
+     * The sparsity pattern of the Jacobian, including all diagonal elements,
+     * is stored in the CSR format (row_offsets and columns). For the i-th
+     * reaction, positions[position_offsets[i] + n_cols * row + col] gives where
+     * the derivative of the row-th participant by the col-th participant is
+     * accumulated. Only reactants are columns for the mass action.
+     */
+    struct compiled_reaction_container_type
+    {
+        typedef std::vector<std::size_t> offset_container_type;
+
+        std::size_t num_species;
+        offset_container_type offsets;
+        offset_container_type num_reactants;
+        index_container_type indices;
+        coefficient_container_type coefficients;
+        std::vector<Real> k;
+        std::vector<boost::shared_ptr<ReactionRuleDescriptor> > ratelaws;
+
+        offset_container_type row_offsets, columns;
+        offset_container_type position_offsets, positions;
+
+        std::size_t max_num_participants;
+    };
+
     class deriv_func
     {
     public:
-        deriv_func(const reaction_container_type &reactions, const Real &volume)
-            : reactions_(reactions), volume_(volume), vinv_(1.0 / volume)
+        deriv_func(
+            const boost::shared_ptr<const compiled_reaction_container_type>& reactions,
+            const Real &volume)
+            : reactions_(reactions), volume_(volume), vinv_(1.0 / volume),
+              reactants_states_(), products_states_()
         {
             ;
         }
 
         void operator()(const state_type &x, state_type &dxdt, const double &t)
         {
+            const compiled_reaction_container_type& reactions(*reactions_);
+
             std::fill(dxdt.begin(), dxdt.end(), 0.0);
-            for(reaction_container_type::const_iterator i(reactions_.begin());
-                i != reactions_.end(); i++)
+            for (std::size_t i(0); i < reactions.k.size(); ++i)
             {
-                ReactionRuleDescriptor::state_container_type reactants_states(i->reactants.size());
-                ReactionRuleDescriptor::state_container_type products_states(i->products.size());
-                ReactionRuleDescriptor::state_container_type::size_type cnt(0);
+                const std::size_t first(reactions.offsets[i]);
+                const std::size_t last(reactions.offsets[i + 1]);
+                const std::size_t middle(first + reactions.num_reactants[i]);
 
-                for(index_container_type::const_iterator j(i->reactants.begin());
-                    j != i->reactants.end(); j++, cnt++)
-                {
-                    reactants_states[cnt] = x[*j];
-                }
-                cnt = 0;
-                for(index_container_type::const_iterator j(i->products.begin());
-                    j != i->products.end(); j++, cnt++)
-                {
-                    products_states[cnt] = x[*j];
-                }
                 double flux;
-                // Calculation! XXX
-                if (i->ratelaw.expired())
+                if (!reactions.ratelaws[i])
                 {
-                    boost::scoped_ptr<ReactionRuleDescriptor> temporary_ratelaw_obj(new ReactionRuleDescriptorMassAction(i->k, i->reactant_coefficients, i->product_coefficients));
-                    flux = temporary_ratelaw_obj->propensity(reactants_states, products_states, volume_, t);
+                    flux = reactions.k[i] * volume_;
+                    for (std::size_t j(first); j < middle; ++j)
+                    {
+                        flux *= power(x[reactions.indices[j]] * vinv_, reactions.coefficients[j]);
+                    }
                 }
                 else
                 {
-                    boost::shared_ptr<ReactionRuleDescriptor> ratelaw = i->ratelaw.lock();
-                    assert(ratelaw->is_available());
-                    flux = ratelaw->propensity(reactants_states, products_states, volume_, t);
+                    fill_states(reactions, i, x, reactants_states_, products_states_);
+                    flux = reactions.ratelaws[i]->propensity(
+                        reactants_states_, products_states_, volume_, t);
                 }
+
                 // Merge each reaction's flux into whole dxdt
-                std::size_t nth = 0;
-                for(index_container_type::const_iterator j(i->reactants.begin());
-                    j != i->reactants.end(); j++)
+                for (std::size_t j(first); j < middle; ++j)
                 {
-                    dxdt[*j] -= (flux * (double)i->reactant_coefficients[nth]);
-                    nth++;
+                    dxdt[reactions.indices[j]] -= flux * reactions.coefficients[j];
                 }
-                nth = 0;
-                for(index_container_type::const_iterator j(i->products.begin()); 
-                    j != i->products.end(); j++)
+                for (std::size_t j(middle); j < last; ++j)
                 {
-                    dxdt[*j] += (flux * (double)i->product_coefficients[nth]);
-                    nth++;
+                    dxdt[reactions.indices[j]] += flux * reactions.coefficients[j];
                 }
             }
             return;
         }
+
     protected:
-        const reaction_container_type reactions_;
+        const boost::shared_ptr<const compiled_reaction_container_type> reactions_;
         const Real volume_;
         const Real vinv_;
+
+        ReactionRuleDescriptor::state_container_type reactants_states_, products_states_;
     };
 
     class jacobi_func
     {
     public:
         jacobi_func(
-            const reaction_container_type &reactions, const Real& volume,
-            const Real& abs_tol, const Real& rel_tol)
-            : reactions_(reactions), volume_(volume), vinv_(1.0 / volume), abs_tol_(abs_tol), rel_tol_(rel_tol)
+            const boost::shared_ptr<const compiled_reaction_container_type>& reactions,
+            const Real& volume, const Real& abs_tol, const Real& rel_tol)
+            : reactions_(reactions), volume_(volume), vinv_(1.0 / volume),
+              abs_tol_(abs_tol), rel_tol_(rel_tol), values_(),
+              reactants_states_(), products_states_(), shifted_states_()
         {
             ;
         }
+
+        /**
+         * return an empty matrix with the sparsity pattern of the Jacobian.
+         */
+        SparseMatrix create_sparse_matrix() const
+        {
+            return SparseMatrix(
+                reactions_->num_species, reactions_->row_offsets, reactions_->columns);
+        }
+
+        void operator()(
+                const state_type& x, SparseMatrix& jacobi, const double &t, state_type &dfdt) const
+        {
+            evaluate(x, jacobi.values(), t, dfdt);
+        }
+
         void operator()(
                 const state_type& x, matrix_type& jacobi, const double &t, state_type &dfdt) const
         {
+            const compiled_reaction_container_type& reactions(*reactions_);
+
+            values_.resize(reactions.columns.size());
+            evaluate(x, values_, t, dfdt);
+
+            std::fill(jacobi.data().begin(), jacobi.data().end(), 0.0);
+            for (std::size_t row(0); row < reactions.num_species; ++row)
+            {
+                for (std::size_t p(reactions.row_offsets[row]);
+                    p < reactions.row_offsets[row + 1]; ++p)
+                {
+                    jacobi(row, reactions.columns[p]) = values_[p];
+                }
+            }
+        }
+
+    protected:
+
+        void evaluate(
+            const state_type& x, SparseMatrix::value_container_type& values,
+            const double &t, state_type &dfdt) const
+        {
+            const compiled_reaction_container_type& reactions(*reactions_);
+
             //fill 0 into jacobi and dfdt
             std::fill(dfdt.begin(), dfdt.end(), 0.0);
-            std::fill(jacobi.data().begin(), jacobi.data().end(), 0.0);
+            std::fill(values.begin(), values.end(), 0.0);
 
             // const Real ETA(2.2204460492503131e-16);
             const Real SQRTETA(1.4901161193847656e-08);
             const Real r0(1.0);
-            // Real fac(0.0);
-            // for (std::size_t k(0); k < dfdt.size(); ++k)
-            // {
-            //     const Real ewtk(atol + rtol * x[k]);
-            //     fac = std::max(fac, dfdt[k] * ewtk);
-            // }
-            // const Real r0(1000.0 * h * ETA * dfdt.size() * fac);  //XXX: h means the step interval
-            // {
-            //     const Real ewtj(atol + rtol * x[j]);
-            //     const Real dyj(std::max(SQRTETA * abs(x[j]), r0 * ewtj));
-            // }
-
-            // const Real h(1.0e-8);
-            // const Real ht(1.0e-10);
             const Real ht(1.0e-10);
 
+            derivs_.resize(reactions.max_num_participants);
+
             // calculate jacobian for each reaction and merge it.
-            for(reaction_container_type::const_iterator i(reactions_.begin());
-                i != reactions_.end(); i++)
+            for (std::size_t i(0); i < reactions.k.size(); ++i)
             {
-                // Calculate one reactions's jabobian
-                //  Prepare the state_array to pass ReactionRuleDescriptor.
-                index_container_type::size_type reactants_size(i->reactants.size());
-                index_container_type::size_type products_size(i->products.size());
-                ReactionRuleDescriptor::state_container_type reactants_states(reactants_size);
-                ReactionRuleDescriptor::state_container_type products_states(products_size);
-                ReactionRuleDescriptor::state_container_type::size_type cnt(0);
-                for(index_container_type::const_iterator j(i->reactants.begin());
-                    j != i->reactants.end(); j++, cnt++)
-                {
-                    reactants_states[cnt] = x[*j];
-                }
-                cnt = 0;
-                for(index_container_type::const_iterator j(i->products.begin());
-                    j != i->products.end(); j++, cnt++)
-                {
-                    products_states[cnt] = x[*j];
-                }
-                // Call the ReactionRuleDescriptor object
+                const std::size_t first(reactions.offsets[i]);
+                const std::size_t last(reactions.offsets[i + 1]);
+                const std::size_t middle(first + reactions.num_reactants[i]);
 
-                if (i->ratelaw.expired())
+                std::size_t num_cols;
+                if (!reactions.ratelaws[i])
                 {
-                    boost::scoped_ptr<ReactionRuleDescriptor> temporary_ratelaw_obj(new ReactionRuleDescriptorMassAction(i->k, i->reactant_coefficients, i->product_coefficients));
-                    Real flux_0 = temporary_ratelaw_obj->propensity(reactants_states, products_states, volume_, t);
-                    // Differentiate by time
+                    // The exact derivatives of the mass action by each reactant
+                    num_cols = middle - first;
+                    for (std::size_t j(first); j < middle; ++j)
                     {
-                        Real flux = temporary_ratelaw_obj->propensity(reactants_states, products_states, volume_, t + ht);
-                        Real flux_deriv = (flux - flux_0) / ht;
-                        if (flux_deriv != 0.0)
+                        const Real coef(reactions.coefficients[j]);
+                        Real deriv(reactions.k[i] * volume_ * coef * vinv_
+                            * power(x[reactions.indices[j]] * vinv_, coef - 1.0));
+                        for (std::size_t l(first); l < middle; ++l)
                         {
-                            for(std::size_t k(0); k < i->reactants.size(); k++)
+                            if (l != j)
                             {
-                                matrix_type::size_type row = i->reactants[k];
-                                Real coeff = i->reactant_coefficients[k];
-                                dfdt[row] -= coeff * flux_deriv;
-                            }
-                            for(std::size_t k(0); k < i->products.size(); k++)
-                            {
-                                matrix_type::size_type row = i->products[k];
-                                Real coeff = i->product_coefficients[k];
-                                dfdt[row] += coeff * flux_deriv;
+                                deriv *= power(x[reactions.indices[l]] * vinv_, reactions.coefficients[l]);
                             }
                         }
-                    }
-                    // Differentiate by each Reactants
-                    for(std::size_t j(0); j < reactants_states.size(); j++)
-                    {
-                        const Real ewt = abs_tol_ + rel_tol_ * abs(reactants_states[j]);
-                        const Real h = std::max(SQRTETA * abs(reactants_states[j]), r0 * ewt);
-                        ReactionRuleDescriptor::state_container_type h_shift(reactants_states);
-                        h_shift[j] += h;
-                        Real flux = temporary_ratelaw_obj->propensity(h_shift, products_states, volume_, t);
-                        Real flux_deriv = (flux - flux_0) / h;
-                        matrix_type::size_type col = i->reactants[j];
-                        for(std::size_t k(0); k < i->reactants.size(); k++)
-                        {
-                            matrix_type::size_type row = i->reactants[k];
-                            Real coeff = i->reactant_coefficients[k];
-                            jacobi(row, col) -= coeff * flux_deriv;
-                        }
-                        for(std::size_t k(0); k < i->products.size(); k++)
-                        {
-                            matrix_type::size_type row = i->products[k];
-                            Real coeff = i->product_coefficients[k];
-                            jacobi(row, col) += coeff * flux_deriv;
-                        }
-                    }
-                    // Differentiate by Products
-                    for(std::size_t j(0); j < products_states.size(); j++)
-                    {
-                        const Real ewt = abs_tol_ + rel_tol_ * abs(products_states[j]);
-                        const Real h = std::max(SQRTETA * abs(products_states[j]), r0 * ewt);
-                        ReactionRuleDescriptor::state_container_type h_shift(products_states);
-                        h_shift[j] += h;
-                        Real flux = temporary_ratelaw_obj->propensity(reactants_states, h_shift, volume_, t);
-                        Real flux_deriv = (flux - flux_0) / h;
-                        matrix_type::size_type col = i->products[j];
-                        for(std::size_t k(0); k < i->reactants.size(); k++)
-                        {
-                            matrix_type::size_type row = i->reactants[k];
-                            Real coeff = i->reactant_coefficients[k];
-                            jacobi(row, col) -= coeff * flux_deriv;
-                        }
-                        for(std::size_t k(0); k < i->products.size(); k++)
-                        {
-                            matrix_type::size_type row = i->products[k];
-                            Real coeff = i->product_coefficients[k];
-                            jacobi(row, col) += coeff * flux_deriv;
-                        }
+                        derivs_[j - first] = deriv;
                     }
                 }
                 else
                 {
-                    boost::shared_ptr<ReactionRuleDescriptor> ratelaw = i->ratelaw.lock();
-                    assert(ratelaw->is_available());
-                    Real flux_0 = ratelaw->propensity(reactants_states, products_states, volume_, t);
+                    // The finite differences by time and each participant
+                    num_cols = last - first;
+                    const ReactionRuleDescriptor& ratelaw(*reactions.ratelaws[i]);
+                    fill_states(reactions, i, x, reactants_states_, products_states_);
+                    const Real flux_0 = ratelaw.propensity(reactants_states_, products_states_, volume_, t);
+
                     // Differentiate by time
                     {
-                        Real flux = ratelaw->propensity(reactants_states, products_states, volume_, t + ht);
-                        Real flux_deriv = (flux - flux_0) / ht;
+                        const Real flux = ratelaw.propensity(reactants_states_, products_states_, volume_, t + ht);
+                        const Real flux_deriv = (flux - flux_0) / ht;
                         if (flux_deriv != 0.0)
                         {
-                            for(std::size_t k(0); k < i->reactants.size(); k++)
+                            for (std::size_t k(first); k < middle; ++k)
                             {
-                                matrix_type::size_type row = i->reactants[k];
-                                Real coeff = i->reactant_coefficients[k];
-                                dfdt[row] -= coeff * flux_deriv;
+                                dfdt[reactions.indices[k]] -= reactions.coefficients[k] * flux_deriv;
                             }
-                            for(std::size_t k(0); k < i->products.size(); k++)
+                            for (std::size_t k(middle); k < last; ++k)
                             {
-                                matrix_type::size_type row = i->products[k];
-                                Real coeff = i->product_coefficients[k];
-                                dfdt[row] += coeff * flux_deriv;
+                                dfdt[reactions.indices[k]] += reactions.coefficients[k] * flux_deriv;
                             }
                         }
                     }
-                    // Differentiate by each Reactants
-                    for(std::size_t j(0); j < reactants_states.size(); j++)
+                    // Differentiate by each reactant
+                    for (std::size_t j(0); j < reactants_states_.size(); j++)
                     {
-                        const Real ewt = abs_tol_ + rel_tol_ * abs(reactants_states[j]);
-                        const Real h = std::max(SQRTETA * abs(reactants_states[j]), r0 * ewt);
-                        ReactionRuleDescriptor::state_container_type h_shift(reactants_states);
-                        h_shift[j] += h;
-                        Real flux = ratelaw->propensity(h_shift, products_states, volume_, t);
-                        Real flux_deriv = (flux - flux_0) / h;
-                        matrix_type::size_type col = i->reactants[j];
-                        for(std::size_t k(0); k < i->reactants.size(); k++)
-                        {
-                            matrix_type::size_type row = i->reactants[k];
-                            Real coeff = i->reactant_coefficients[k];
-                            jacobi(row, col) -= coeff * flux_deriv;
-                        }
-                        for(std::size_t k(0); k < i->products.size(); k++)
-                        {
-                            matrix_type::size_type row = i->products[k];
-                            Real coeff = i->product_coefficients[k];
-                            jacobi(row, col) += coeff * flux_deriv;
-                        }
+                        const Real ewt = abs_tol_ + rel_tol_ * std::abs(reactants_states_[j]);
+                        const Real h = std::max(SQRTETA * std::abs(reactants_states_[j]), r0 * ewt);
+                        shifted_states_ = reactants_states_;
+                        shifted_states_[j] += h;
+                        const Real flux = ratelaw.propensity(shifted_states_, products_states_, volume_, t);
+                        derivs_[j] = (flux - flux_0) / h;
                     }
-                    // Differentiate by Products
-                    for(std::size_t j(0); j < products_states.size(); j++)
+                    // Differentiate by each product
+                    for (std::size_t j(0); j < products_states_.size(); j++)
                     {
-                        const Real ewt = abs_tol_ + rel_tol_ * abs(products_states[j]);
-                        const Real h = std::max(SQRTETA * abs(products_states[j]), r0 * ewt);
-                        ReactionRuleDescriptor::state_container_type h_shift(products_states);
-                        h_shift[j] += h;
-                        Real flux = ratelaw->propensity(reactants_states, h_shift, volume_, t);
-                        Real flux_deriv = (flux - flux_0) / h;
-                        matrix_type::size_type col = i->products[j];
-                        for(std::size_t k(0); k < i->reactants.size(); k++)
-                        {
-                            matrix_type::size_type row = i->reactants[k];
-                            Real coeff = i->reactant_coefficients[k];
-                            jacobi(row, col) -= coeff * flux_deriv;
-                        }
-                        for(std::size_t k(0); k < i->products.size(); k++)
-                        {
-                            matrix_type::size_type row = i->products[k];
-                            Real coeff = i->product_coefficients[k];
-                            jacobi(row, col) += coeff * flux_deriv;
-                        }
+                        const Real ewt = abs_tol_ + rel_tol_ * std::abs(products_states_[j]);
+                        const Real h = std::max(SQRTETA * std::abs(products_states_[j]), r0 * ewt);
+                        shifted_states_ = products_states_;
+                        shifted_states_[j] += h;
+                        const Real flux = ratelaw.propensity(reactants_states_, shifted_states_, volume_, t);
+                        derivs_[reactants_states_.size() + j] = (flux - flux_0) / h;
+                    }
+                }
+
+                // Merge the derivatives into the jacobian
+                const std::size_t* positions(&reactions.positions[reactions.position_offsets[i]]);
+                for (std::size_t row(first); row < last; ++row)
+                {
+                    const Real coeff(row < middle ?
+                        -reactions.coefficients[row] : reactions.coefficients[row]);
+                    for (std::size_t col(0); col < num_cols; ++col, ++positions)
+                    {
+                        values[*positions] += coeff * derivs_[col];
                     }
                 }
             }
         }
+
     protected:
-        const reaction_container_type reactions_;
+        const boost::shared_ptr<const compiled_reaction_container_type> reactions_;
         const Real volume_;
         const Real vinv_;
         const Real abs_tol_, rel_tol_;
+
+        mutable SparseMatrix::value_container_type values_;
+        mutable std::vector<Real> derivs_;
+        mutable ReactionRuleDescriptor::state_container_type
+            reactants_states_, products_states_, shifted_states_;
     };
 
     class elasticity_func
@@ -525,6 +531,7 @@ public:
         }
 
         // ode_reaction_rules_ = convert_ode_reaction_rules(model_);
+        compile();
     }
 
     void step(void)
@@ -707,7 +714,12 @@ public:
 protected:
 
     reaction_container_type convert_reactions() const;
+    boost::shared_ptr<const compiled_reaction_container_type> compile_reactions() const;
+    void compile();
+    bool is_compiled() const;
     std::pair<deriv_func, jacobi_func> generate_system() const;
+    std::pair<deriv_func, jacobi_func> generate_system(
+        const boost::shared_ptr<const compiled_reaction_container_type>& reactions) const;
 
 protected:
 
@@ -718,6 +730,17 @@ protected:
     Real abs_tol_, rel_tol_;
     ODESolverType solver_type_;
 
+    /**
+     * The reactions compiled by initialize(), with the revisions of the
+     * model, the world and the descriptors they were compiled from. They are
+     * compiled again when any of them has changed, including the rate
+     * constant or the coefficients of a descriptor changed in place.
+     */
+    boost::shared_ptr<const compiled_reaction_container_type> compiled_reactions_;
+    Integer compiled_revision_;
+    Integer compiled_world_revision_;
+    std::vector<std::pair<std::size_t, Integer> > compiled_descriptor_revisions_;  // (rule, revision)
+
     // ODENetworkModel::ode_reaction_rule_container_type ode_reaction_rules_;
 };
 
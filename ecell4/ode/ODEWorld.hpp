@@ -59,13 +59,13 @@ protected:
 public:
 
     ODEWorld(const Real3& edge_lengths = Real3(1, 1, 1))
-        : t_(0.0)
+        : t_(0.0), revision_(0)
     {
         reset(edge_lengths);
     }
 
     ODEWorld(const std::string& filename)
-        : t_(0.0)
+        : t_(0.0), revision_(0)
     {
         reset(Real3(1, 1, 1));
         this->load(filename);
@@ -98,6 +98,7 @@ public:
         index_map_.clear();
         num_molecules_.clear();
         species_.clear();
+        ++revision_;
 
         for (Real3::size_type dim(0); dim < 3; ++dim)
         {
@@ -143,6 +144,15 @@ public:
         return species_;
     }
 
+    /**
+     * return the number of changes made to the list of species so far,
+     * including its order.
+     */
+    Integer revision() const
+    {
+        return revision_;
+    }
+
     void add_molecules(const Species& sp, const Real& num)
     {
         species_map_type::const_iterator i(index_map_.find(sp));
@@ -228,6 +238,7 @@ public:
         index_map_.insert(std::make_pair(sp, num_molecules_.size()));
         species_.push_back(sp);
         num_molecules_.push_back(0);
+        ++revision_;
     }
 
     void release_species(const Species& sp)
@@ -255,6 +266,7 @@ public:
         species_.pop_back();
         num_molecules_.pop_back();
         index_map_.erase(sp);
+        ++revision_;
     }
 
     void bind_to(boost::shared_ptr<Model> model);
@@ -355,6 +367,7 @@ protected:
     num_molecules_container_type num_molecules_;
     species_container_type species_;
     species_map_type index_map_;
+    Integer revision_;  // see revision()
 
     boost::weak_ptr<Model> model_;
 };
@@ -0,0 +1,391 @@
+#ifndef ECELL4_ODE_SPARSE_ROSENBROCK_HPP
+#define ECELL4_ODE_SPARSE_ROSENBROCK_HPP
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <limits>
+
+#include <ecell4/core/types.hpp>
+#include <ecell4/core/exceptions.hpp>
+
+
+namespace ecell4
+{
+
+namespace ode
+{
+
+/**
+ * A square sparse matrix in the compressed sparse row (CSR) format.
+ * The sparsity pattern is fixed at construction and only values change.
+ */
+class SparseMatrix
+{
+public:
+
+    typedef std::vector<std::size_t> index_container_type;
+    typedef std::vector<Real> value_container_type;
+
+public:
+
+    SparseMatrix()
+        : size_(0), row_offsets_(1, 0), columns_(), values_()
+    {
+        ;
+    }
+
+    SparseMatrix(
+        const std::size_t size, const index_container_type& row_offsets,
+        const index_container_type& columns)
+        : size_(size), row_offsets_(row_offsets), columns_(columns),
+          values_(columns.size(), 0.0)
+    {
+        ;
+    }
+
+    std::size_t size() const
+    {
+        return size_;
+    }
+
+    std::size_t num_nonzeros() const
+    {
+        return columns_.size();
+    }
+
+    const index_container_type& row_offsets() const
+    {
+        return row_offsets_;
+    }
+
+    const index_container_type& columns() const
+    {
+        return columns_;
+    }
+
+    const value_container_type& values() const
+    {
+        return values_;
+    }
+
+    value_container_type& values()
+    {
+        return values_;
+    }
+
+    void clear()
+    {
+        std::fill(values_.begin(), values_.end(), 0.0);
+    }
+
+    /**
+     * return the position of (row, col) in values().
+     * the element must be a part of the sparsity pattern.
+     */
+    std::size_t position(const std::size_t row, const std::size_t col) const
+    {
+        const index_container_type::const_iterator
+            first(columns_.begin() + row_offsets_[row]),
+            last(columns_.begin() + row_offsets_[row + 1]);
+        const index_container_type::const_iterator it(std::lower_bound(first, last, col));
+        if (it == last || *it != col)
+        {
+            throw NotFound("The element is not in the sparsity pattern.");
+        }
+        return static_cast<std::size_t>(it - columns_.begin());
+    }
+
+    Real operator()(const std::size_t row, const std::size_t col) const
+    {
+        return values_[position(row, col)];
+    }
+
+    /**
+     * y = A x
+     */
+    template <typename Tvector_>
+    void multiply(const Tvector_& x, Tvector_& y) const
+    {
+        for (std::size_t i(0); i < size_; ++i)
+        {
+            Real sum(0.0);
+            for (std::size_t p(row_offsets_[i]); p < row_offsets_[i + 1]; ++p)
+            {
+                sum += values_[p] * x[columns_[p]];
+            }
+            y[i] = sum;
+        }
+    }
+
+protected:
+
+    std::size_t size_;
+    index_container_type row_offsets_, columns_;
+    value_container_type values_;
+};
+
+/**
+ * A linearly implicit, L-stable Rosenbrock method of order two (ROS2) with
+ * an embedded first order solution for the step size control:
+ *     J. G. Verwer, E. J. Spee, J. G. Blom, and W. Hundsdorfer,
+ *     SIAM J. Sci. Comput. 20, 1456-1480 (1999).
+ * The Jacobian is kept in a SparseMatrix, and the linear systems are solved
+ * with BiCGSTAB preconditioned by the diagonal. Thus, neither memory nor
+ * work scale with the square of the number of species.
+ *
+ * A system is a pair of functors given as in boost::numeric::odeint:
+ *     system.first(x, dxdt, t) and system.second(x, jacobian, t, dfdt).
+ * The second must accept a SparseMatrix which is created by
+ * system.second.create_sparse_matrix(), whose pattern has all the diagonal
+ * elements.
+ */
+template <typename Tstate_>
+class SparseRosenbrock2
+{
+public:
+
+    typedef Tstate_ state_type;
+
+public:
+
+    SparseRosenbrock2(const Real abs_tol, const Real rel_tol)
+        : abs_tol_(abs_tol), rel_tol_(rel_tol)
+    {
+        ;
+    }
+
+    /**
+     * integrate x from t to tend with the initial step size dt.
+     * return the number of accepted steps.
+     */
+    template <typename Tsystem_>
+    std::size_t integrate(Tsystem_& system, state_type& x, Real t, const Real tend, Real dt)
+    {
+        const std::size_t n(x.size());
+        const Real gamma(1.0 + 1.0 / std::sqrt(2.0));
+
+        SparseMatrix jacobian(system.second.create_sparse_matrix());
+        SparseMatrix w(jacobian);
+        std::vector<std::size_t> diagonal(n);
+        for (std::size_t i(0); i < n; ++i)
+        {
+            diagonal[i] = w.position(i, i);
+        }
+
+        state_type f(n), dfdt(n), k1(n), k2(n), xtmp(n), rhs(n);
+
+        std::size_t steps(0);
+        bool jacobian_is_fresh(false);
+        while (t < tend)
+        {
+            const Real h(std::min(dt, tend - t));
+            if (!(h > 0.0) || t + h == t)
+            {
+                throw IllegalState("The step size is too small.");
+            }
+
+            if (!jacobian_is_fresh)
+            {
+                system.first(x, f, t);
+                system.second(x, jacobian, t, dfdt);
+                jacobian_is_fresh = true;
+            }
+
+            // W = I - gamma * h * J
+            const Real gh(gamma * h);
+            for (std::size_t p(0); p < jacobian.num_nonzeros(); ++p)
+            {
+                w.values()[p] = -gh * jacobian.values()[p];
+            }
+            for (std::size_t i(0); i < n; ++i)
+            {
+                w.values()[diagonal[i]] += 1.0;
+            }
+
+            // W k1 = f(t, x) + gamma h df/dt
+            for (std::size_t i(0); i < n; ++i)
+            {
+                rhs[i] = f[i] + gh * dfdt[i];
+            }
+            bool succeeded(solve(w, diagonal, rhs, k1));
+
+            if (succeeded)
+            {
+                // W k2 = f(t + h, x + h k1) - 2 k1 - gamma h df/dt
+                for (std::size_t i(0); i < n; ++i)
+                {
+                    xtmp[i] = x[i] + h * k1[i];
+                }
+                system.first(xtmp, rhs, t + h);
+                for (std::size_t i(0); i < n; ++i)
+                {
+                    rhs[i] -= 2.0 * k1[i] + gh * dfdt[i];
+                }
+                succeeded = solve(w, diagonal, rhs, k2);
+            }
+
+            Real err(0.0);
+            if (succeeded)
+            {
+                for (std::size_t i(0); i < n; ++i)
+                {
+                    xtmp[i] = x[i] + h * (1.5 * k1[i] + 0.5 * k2[i]);
+                    const Real scale(abs_tol_ + rel_tol_
+                        * std::max(std::abs(x[i]), std::abs(xtmp[i])));
+                    const Real e(0.5 * h * (k1[i] + k2[i]));
+                    if (scale > 0.0)
+                    {
+                        err = std::max(err, std::abs(e) / scale);
+                    }
+                    else if (e != 0.0)
+                    {
+                        err = std::numeric_limits<Real>::infinity();
+                    }
+                }
+                succeeded = (err <= 1.0);
+            }
+
+            if (!succeeded)
+            {
+                dt = h * (err > 0.0 && std::isfinite(err) ?
+                    std::max(0.2, 0.8 / std::sqrt(err)) : 0.25);
+                continue;
+            }
+
+            std::swap(x, xtmp);
+            t += h;
+            ++steps;
+            jacobian_is_fresh = false;
+            dt = h * (err > 0.0 ? std::min(5.0, std::max(0.2, 0.8 / std::sqrt(err))) : 5.0);
+        }
+        return steps;
+    }
+
+protected:
+
+    /**
+     * solve A x = b with BiCGSTAB preconditioned by the diagonal of A.
+     */
+    bool solve(
+        const SparseMatrix& a, const std::vector<std::size_t>& diagonal,
+        const state_type& b, state_type& x)
+    {
+        const std::size_t n(b.size());
+
+        std::fill(x.begin(), x.end(), 0.0);
+        const Real bnorm(norm(b));
+        if (bnorm == 0.0)
+        {
+            return true;
+        }
+        const Real tol(1e-12 * bnorm);
+
+        dinv_.resize(n);
+        for (std::size_t i(0); i < n; ++i)
+        {
+            const Real d(a.values()[diagonal[i]]);
+            dinv_[i] = (d != 0.0 ? 1.0 / d : 1.0);
+        }
+
+        r_.assign(b.begin(), b.end());
+        rhat_ = r_;
+        p_.assign(n, 0.0);
+        v_.assign(n, 0.0);
+        y_.resize(n);
+        s_.resize(n);
+        z_.resize(n);
+        tv_.resize(n);
+
+        Real rho(1.0), alpha(1.0), omega(1.0);
+        const std::size_t max_iterations(std::max<std::size_t>(100, 2 * n));
+        for (std::size_t iteration(0); iteration < max_iterations; ++iteration)
+        {
+            const Real rho_new(dot(rhat_, r_));
+            if (rho_new == 0.0 || omega == 0.0)
+            {
+                return false;
+            }
+
+            const Real beta((rho_new / rho) * (alpha / omega));
+            for (std::size_t i(0); i < n; ++i)
+            {
+                p_[i] = r_[i] + beta * (p_[i] - omega * v_[i]);
+                y_[i] = dinv_[i] * p_[i];
+            }
+            a.multiply(y_, v_);
+
+            const Real rv(dot(rhat_, v_));
+            if (rv == 0.0)
+            {
+                return false;
+            }
+            alpha = rho_new / rv;
+
+            for (std::size_t i(0); i < n; ++i)
+            {
+                s_[i] = r_[i] - alpha * v_[i];
+            }
+            if (norm(s_) <= tol)
+            {
+                for (std::size_t i(0); i < n; ++i)
+                {
+                    x[i] += alpha * y_[i];
+                }
+                return true;
+            }
+
+            for (std::size_t i(0); i < n; ++i)
+            {
+                z_[i] = dinv_[i] * s_[i];
+            }
+            a.multiply(z_, tv_);
+
+            const Real tt(dot(tv_, tv_));
+            omega = (tt > 0.0 ? dot(tv_, s_) / tt : 0.0);
+
+            for (std::size_t i(0); i < n; ++i)
+            {
+                x[i] += alpha * y_[i] + omega * z_[i];
+                r_[i] = s_[i] - omega * tv_[i];
+            }
+            if (norm(r_) <= tol)
+            {
+                return true;
+            }
+
+            rho = rho_new;
+        }
+        return false;
+    }
+
+    template <typename T1_, typename T2_>
+    static Real dot(const T1_& a, const T2_& b)
+    {
+        Real ret(0.0);
+        for (std::size_t i(0); i < a.size(); ++i)
+        {
+            ret += a[i] * b[i];
+        }
+        return ret;
+    }
+
+    template <typename T_>
+    static Real norm(const T_& a)
+    {
+        return std::sqrt(dot(a, a));
+    }
+
+protected:
+
+    Real abs_tol_, rel_tol_;
+
+    std::vector<Real> dinv_, r_, rhat_, p_, v_, y_, s_, z_, tv_;
+};
+
+} // ode
+
+} // ecell4
+
+#endif /* ECELL4_ODE_SPARSE_ROSENBROCK_HPP */
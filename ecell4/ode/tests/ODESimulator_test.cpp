@@ -7,8 +7,11 @@
 #   include <boost/test/included/unit_test.hpp>
 #endif
 
+#include <cmath>
+
 #include <ecell4/core/Species.hpp>
 #include <ecell4/core/ReactionRule.hpp>
+#include <ecell4/core/ReactionRuleDescriptor.hpp>
 #include <ecell4/core/NetworkModel.hpp>
 #include "../ODESimulator.hpp"
 
@@ -71,3 +74,148 @@ BOOST_AUTO_TEST_CASE(ODESimulator_test_step2)
 
     // BOOST_ASSERT(false);
 }
+
+BOOST_AUTO_TEST_CASE(ODESimulator_test_jacobian)
+{
+    const Real3 edge_lengths(1.0, 1.0, 1.0);
+
+    Species sp1("A"), sp2("B"), sp3("C");
+    boost::shared_ptr<NetworkModel> model(new NetworkModel());
+    model->add_reaction_rule(create_binding_reaction_rule(sp1, sp2, sp3, 2.0));
+
+    boost::shared_ptr<ODEWorld> world(new ODEWorld(edge_lengths));
+    world->set_value(sp1, 3.0);
+    world->set_value(sp2, 5.0);
+    world->set_value(sp3, 0.0);
+
+    ODESimulator target(world, model);
+
+    const std::vector<Species> species(world->list_species());
+    BOOST_REQUIRE_EQUAL(species.size(), 3);
+    BOOST_REQUIRE(species[0] == sp1 && species[1] == sp2 && species[2] == sp3);
+
+    const std::vector<std::vector<Real> > jacobian(target.jacobian());
+    BOOST_CHECK_CLOSE(jacobian[0][0], -10.0, 1e-12);
+    BOOST_CHECK_CLOSE(jacobian[0][1], -6.0, 1e-12);
+    BOOST_CHECK_EQUAL(jacobian[0][2], 0.0);
+    BOOST_CHECK_CLOSE(jacobian[1][0], -10.0, 1e-12);
+    BOOST_CHECK_CLOSE(jacobian[1][1], -6.0, 1e-12);
+    BOOST_CHECK_CLOSE(jacobian[2][0], 10.0, 1e-12);
+    BOOST_CHECK_CLOSE(jacobian[2][1], 6.0, 1e-12);
+    BOOST_CHECK_EQUAL(jacobian[2][2], 0.0);
+
+    const std::vector<Real> derivatives(target.derivatives());
+    BOOST_CHECK_CLOSE(derivatives[0], -30.0, 1e-12);
+    BOOST_CHECK_CLOSE(derivatives[2], 30.0, 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE(ODESimulator_test_sparse_solver)
+{
+    const Real3 edge_lengths(1.0, 1.0, 1.0);
+
+    Species sp1("A"), sp2("B"), sp3("C");
+    boost::shared_ptr<NetworkModel> model(new NetworkModel());
+    model->add_reaction_rule(create_binding_reaction_rule(sp1, sp2, sp3, 1.0));
+    model->add_reaction_rule(create_unbinding_reaction_rule(sp3, sp1, sp2, 100.0));
+
+    boost::shared_ptr<ODEWorld> world1(new ODEWorld(edge_lengths));
+    world1->set_value(sp1, 60.0);
+    world1->set_value(sp2, 40.0);
+    world1->set_value(sp3, 0.0);
+    boost::shared_ptr<ODEWorld> world2(new ODEWorld(edge_lengths));
+    world2->set_value(sp1, 60.0);
+    world2->set_value(sp2, 40.0);
+    world2->set_value(sp3, 0.0);
+
+    ODESimulator target1(world1, model, ROSENBROCK4_CONTROLLER);
+    ODESimulator target2(world2, model, ROSENBROCK2_SPARSE);
+    target1.set_dt(0.1);
+    target2.set_dt(0.1);
+
+    while (target1.step(1.0));
+    while (target2.step(1.0));
+
+    BOOST_CHECK_CLOSE(target1.t(), target2.t(), 1e-12);
+    BOOST_CHECK_CLOSE(world1->get_value(sp1), world2->get_value(sp1), 1e-3);
+    BOOST_CHECK_CLOSE(world1->get_value(sp3), world2->get_value(sp3), 1e-3);
+    BOOST_CHECK_CLOSE(
+        world2->get_value(sp1) + world2->get_value(sp3), 60.0, 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE(ODESimulator_test_recompile)
+{
+    const Real3 edge_lengths(1.0, 1.0, 1.0);
+
+    Species sp1("A"), sp2("B"), sp3("C");
+    boost::shared_ptr<NetworkModel> model(new NetworkModel());
+    model->add_reaction_rule(create_unimolecular_reaction_rule(sp1, sp2, 1.0));
+
+    boost::shared_ptr<ODEWorld> world(new ODEWorld(edge_lengths));
+    world->set_value(sp1, 60.0);
+    world->set_value(sp2, 0.0);
+
+    ODESimulator target(world, model);
+    target.set_dt(0.1);
+    target.step(0.1);
+
+    // A species new to the world is taken into account at the next step.
+    world->set_value(sp3, 40.0);
+    target.step(0.2);
+    BOOST_CHECK_CLOSE(
+        world->get_value(sp1) + world->get_value(sp2), 60.0, 1e-6);
+    BOOST_CHECK_CLOSE(world->get_value(sp3), 40.0, 1e-12);
+
+    // So is a reaction rule added to the model.
+    model->add_reaction_rule(create_unimolecular_reaction_rule(sp3, sp1, 1.0));
+    const std::vector<Real> derivatives(target.derivatives());
+    BOOST_REQUIRE_EQUAL(derivatives.size(), 3);
+    BOOST_CHECK_CLOSE(derivatives[2], -40.0, 1e-12);
+    target.step(0.3);
+    BOOST_CHECK_CLOSE(
+        world->get_value(sp1) + world->get_value(sp2) + world->get_value(sp3),
+        100.0, 1e-6);
+    BOOST_CHECK(world->get_value(sp3) < 40.0);
+}
+
+BOOST_AUTO_TEST_CASE(ODESimulator_test_recompile_descriptor)
+{
+    const Real3 edge_lengths(1.0, 1.0, 1.0);
+
+    Species sp1("A"), sp2("B");
+    ReactionRule rr(create_unimolecular_reaction_rule(sp1, sp2, 1.0));
+    const std::vector<Real> coefficients(1, 1.0);
+    rr.set_descriptor(boost::shared_ptr<ReactionRuleDescriptor>(
+        new ReactionRuleDescriptorMassAction(1.0, coefficients, coefficients)));
+    boost::shared_ptr<NetworkModel> model(new NetworkModel());
+    model->add_reaction_rule(rr);
+
+    // the model keeps a copy of the descriptor
+    ReactionRuleDescriptorMassAction* const descriptor(
+        dynamic_cast<ReactionRuleDescriptorMassAction*>(
+            model->reaction_rules()[0].get_descriptor().get()));
+    BOOST_REQUIRE(descriptor != NULL);
+
+    boost::shared_ptr<ODEWorld> world(new ODEWorld(edge_lengths));
+    world->set_value(sp1, 60.0);
+    world->set_value(sp2, 0.0);
+
+    ODESimulator target(world, model);
+    target.set_dt(0.1);
+    BOOST_CHECK_CLOSE(target.derivatives()[0], -60.0, 1e-12);
+    target.step(0.1);
+    const Real x1(world->get_value(sp1));
+
+    // The rate constant of a descriptor changed in place applies at the next step.
+    descriptor->set_k(2.0);
+    BOOST_CHECK_CLOSE(target.derivatives()[0], -2.0 * x1, 1e-12);
+    target.step(0.2);
+    BOOST_CHECK_CLOSE(world->get_value(sp1), x1 * std::exp(-0.2), 1e-3);
+
+    // So do its coefficients.
+    const Real x2(world->get_value(sp1)), y2(world->get_value(sp2));
+    descriptor->set_product_coefficient(0, 3.0);
+    BOOST_CHECK_CLOSE(target.derivatives()[1], 3.0 * 2.0 * x2, 1e-12);
+    target.step(0.3);
+    BOOST_CHECK_CLOSE(
+        3.0 * world->get_value(sp1) + world->get_value(sp2), 3.0 * x2 + y2, 1e-6);
+}
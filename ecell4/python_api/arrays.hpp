@@ -0,0 +1,102 @@
+#ifndef ECELL4_PYTHON_API_ARRAYS_HPP
+#define ECELL4_PYTHON_API_ARRAYS_HPP
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+#include <ecell4/core/Particle.hpp>
+#include <ecell4/core/observers.hpp>
+#include <ecell4/core/get_mapper_mf.hpp>
+
+namespace py = pybind11;
+
+namespace ecell4
+{
+
+namespace python_api
+{
+
+/**
+ * Convert particles into a dict of NumPy arrays, "lot", "serial" (N),
+ * "position" (N x 3), "radius", "D" (N) and "species_index" (N), the
+ * index of each particle's species in "species_serials" (not a species id),
+ * in a single pass without building a Python object per particle.
+ */
+static inline
+py::dict as_arrays(const std::vector<std::pair<ParticleID, Particle>>& particles)
+{
+    typedef utils::get_mapper_mf<Species::serial_type, int32_t>::type index_map_type;
+
+    const std::size_t num_particles(particles.size());
+    py::array_t<int32_t> lots(num_particles), species_indices(num_particles);
+    py::array_t<uint64_t> serials(num_particles);
+    py::array_t<Real> positions(std::vector<std::size_t>({num_particles, 3}));
+    py::array_t<Real> radii(num_particles), Ds(num_particles);
+
+    int32_t* lot_ptr(lots.mutable_data());
+    uint64_t* serial_ptr(serials.mutable_data());
+    Real* position_ptr(positions.mutable_data());
+    Real* radius_ptr(radii.mutable_data());
+    Real* D_ptr(Ds.mutable_data());
+    int32_t* species_index_ptr(species_indices.mutable_data());
+
+    std::vector<Species::serial_type> species_serials;
+    {
+        py::gil_scoped_release release;
+
+        index_map_type indices;
+        for (std::size_t i(0); i < num_particles; ++i)
+        {
+            const ParticleID& pid(particles[i].first);
+            const Particle& p(particles[i].second);
+            lot_ptr[i] = pid.lot();
+            serial_ptr[i] = pid.serial();
+            position_ptr[3 * i] = p.position()[0];
+            position_ptr[3 * i + 1] = p.position()[1];
+            position_ptr[3 * i + 2] = p.position()[2];
+            radius_ptr[i] = p.radius();
+            D_ptr[i] = p.D();
+
+            std::pair<index_map_type::iterator, bool> retval(
+                indices.insert(std::make_pair(p.species_serial(), species_serials.size())));
+            if (retval.second)
+            {
+                species_serials.push_back(p.species_serial());
+            }
+            species_index_ptr[i] = (*retval.first).second;
+        }
+    }
+
+    py::dict retval;
+    retval["lot"] = lots;
+    retval["serial"] = serials;
+    retval["position"] = positions;
+    retval["radius"] = radii;
+    retval["D"] = Ds;
+    retval["species_index"] = species_indices;
+    retval["species_serials"] = species_serials;
+    return retval;
+}
+
+/**
+ * Copy the table of a NumberLogger into a 2D NumPy array, the time in the
+ * first column and the values of targets in the rest, row by row.
+ */
+static inline
+py::array_t<Real> as_array(const NumberLogger& logger)
+{
+    py::array_t<Real> data(
+        std::vector<std::size_t>({logger.data.size(), logger.num_columns()}));
+    Real* ptr(data.mutable_data());
+    {
+        py::gil_scoped_release release;
+        logger.copy_data(ptr);
+    }
+    return data;
+}
+
+}
+
+}
+
+#endif /* ECELL4_PYTHON_API_ARRAYS_HPP */
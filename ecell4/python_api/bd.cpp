@@ -25,8 +25,11 @@ void define_bd_factory(py::module& m)
         .def(py::init<const Integer3&, Real>(),
                 py::arg("matrix_sizes") = BDFactory::default_matrix_sizes(),
                 py::arg("bd_dt_factor") = BDFactory::default_bd_dt_factor())
-        .def("rng", &BDFactory::rng);
+        .def("rng", &BDFactory::rng)
+        .def("parallel", &BDFactory::parallel, py::arg("num_threads") = 0)
+        .def("neighbor_list", &BDFactory::neighbor_list, py::arg("skin"));
     define_factory_functions(factory);
+    define_ensemble_functions(factory);
 
     m.attr("Factory") = factory;
 }
@@ -42,7 +45,10 @@ void define_bd_simulator(py::module& m)
         .def(py::init<boost::shared_ptr<BDWorld>, boost::shared_ptr<Model>, Real>(),
                 py::arg("w"), py::arg("m"), py::arg("bd_dt_factor") = 1e-5)
         .def("last_reactions", &BDSimulator::last_reactions)
-        .def("set_t", &BDSimulator::set_t);
+        .def("set_t", &BDSimulator::set_t)
+        .def("set_parallel", &BDSimulator::set_parallel,
+                py::arg("parallel"), py::arg("num_threads") = 0)
+        .def("is_parallel", &BDSimulator::is_parallel);
     define_simulator_functions(simulator);
 
     m.attr("Simulator") = simulator;
@@ -91,7 +97,9 @@ void define_bd_world(py::module& m)
             (void (BDWorld::*)(const Species&, const Integer&, const boost::shared_ptr<Shape>)) &BDWorld::add_molecules)
         .def("remove_molecules", &BDWorld::remove_molecules)
         .def("bind_to", &BDWorld::bind_to)
-        .def("rng", &BDWorld::rng);
+        .def("rng", &BDWorld::rng)
+        .def("set_neighbor_list_skin", &BDWorld::set_neighbor_list_skin, py::arg("skin"))
+        .def("neighbor_list_skin", &BDWorld::neighbor_list_skin);
 
     m.attr("World") = world;
 }
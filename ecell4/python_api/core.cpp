@@ -1,5 +1,7 @@
 #include "python_api.hpp"
 
+#include <pybind11/numpy.h>
+
 #include <ecell4/core/BDMLWriter.hpp>
 #include <ecell4/core/Context.hpp>
 #include <ecell4/core/extras.hpp>
@@ -9,6 +11,7 @@
 #include <ecell4/core/Barycentric.hpp>
 #include <ecell4/core/types.hpp>
 
+#include "arrays.hpp"
 #include "model.hpp"
 #include "observers.hpp"
 #include "random_number_generator.hpp"
@@ -231,6 +234,7 @@ void define_species(py::module& m)
                 py::arg("location") = "",
                 py::arg("dimension") = 0)
         .def("serial", &Species::serial)
+        .def("id", &Species::id)
         .def("get_attribute", &Species::get_attribute)
         .def("set_attribute", &Species::set_attribute<std::string>)
         .def("set_attribute", &Species::set_attribute<const char*>)
@@ -343,6 +347,21 @@ void define_rng(py::module& m)
         .def("gaussian", &RandomNumberGenerator::gaussian,
             py::arg("sigma"), py::arg("mean") = 0.0)
         .def("binomial", &RandomNumberGenerator::binomial)
+        .def("poisson", &RandomNumberGenerator::poisson)
+        .def("fill_uniform",
+            [](RandomNumberGenerator& self, py::array_t<Real, py::array::c_style> data,
+               const Real min, const Real max)
+            {
+                self.fill_uniform(data.mutable_data(), data.size(), min, max);
+            },
+            py::arg("data"), py::arg("min") = 0.0, py::arg("max") = 1.0)
+        .def("fill_gaussian",
+            [](RandomNumberGenerator& self, py::array_t<Real, py::array::c_style> data,
+               const Real sigma, const Real mean)
+            {
+                self.fill_gaussian(data.mutable_data(), data.size(), sigma, mean);
+            },
+            py::arg("data"), py::arg("sigma") = 1.0, py::arg("mean") = 0.0)
         .def("seed", (void (RandomNumberGenerator::*)()) &RandomNumberGenerator::seed)
         .def("seed", (void (RandomNumberGenerator::*)(Integer)) &RandomNumberGenerator::seed)
         .def("save", (void (RandomNumberGenerator::*)(const std::string&) const) &RandomNumberGenerator::save)
@@ -354,6 +373,21 @@ void define_rng(py::module& m)
         .def(py::init<>())
         .def(py::init<const Integer>(), py::arg("seed"))
         .def(py::init<const std::string&>(), py::arg("filename"));
+
+    py::class_<PhiloxRandomNumberGenerator, RandomNumberGenerator,
+        PyRandomNumberGeneratorImpl<PhiloxRandomNumberGenerator>,
+        boost::shared_ptr<PhiloxRandomNumberGenerator>>(m, "PhiloxRandomNumberGenerator")
+        .def(py::init<>())
+        .def(py::init<const Integer, const Integer>(), py::arg("seed"), py::arg("stream") = 0)
+        .def(py::init<const std::string&>(), py::arg("filename"))
+        .def("stream", &PhiloxRandomNumberGenerator::stream)
+        .def("substream",
+            [](const PhiloxRandomNumberGenerator& self, const Integer stream)
+            {
+                return boost::shared_ptr<PhiloxRandomNumberGenerator>(
+                    new PhiloxRandomNumberGenerator(self.substream(stream)));
+            },
+            py::arg("stream"));
 }
 
 static inline
@@ -440,7 +474,9 @@ void define_model(py::module& m)
         .def("species_attributes", &Model::species_attributes)
         .def("num_reaction_rules", &Model::num_reaction_rules)
         .def("expand", (boost::shared_ptr<Model> (Model::*)(
-                const std::vector<Species>&, const Integer, const std::map<Species, Integer>&) const) &Model::expand)
+                const std::vector<Species>&, const Integer, const std::map<Species, Integer>&,
+                const std::size_t) const) &Model::expand,
+            py::arg("sp"), py::arg("max_itr"), py::arg("max_stoich"), py::arg("num_threads") = 0)
         .def("expand", (boost::shared_ptr<Model> (Model::*)(const std::vector<Species>&, const Integer) const) &Model::expand)
         .def("expand", (boost::shared_ptr<Model> (Model::*)(const std::vector<Species>&) const) &Model::expand)
         .def("list_species", &Model::list_species)
@@ -518,6 +554,21 @@ void define_world_interface(py::module& m)
             (std::vector<std::pair<ParticleID, Particle>> (WorldInterface::*)(const Species&) const)
             &WorldInterface::list_particles)
         .def("list_particles_exact", &WorldInterface::list_particles_exact)
+        .def("list_particles_as_arrays",
+            [](const WorldInterface& self)
+            {
+                return as_arrays(self.list_particles());
+            })
+        .def("list_particles_as_arrays",
+            [](const WorldInterface& self, const Species& sp)
+            {
+                return as_arrays(self.list_particles(sp));
+            })
+        .def("list_particles_exact_as_arrays",
+            [](const WorldInterface& self, const Species& sp)
+            {
+                return as_arrays(self.list_particles_exact(sp));
+            })
         ;
 }
 
@@ -605,6 +656,8 @@ void define_observers(py::module& m)
         .def(py::init<const Real&, const std::vector<std::string>&>(),
                 py::arg("dt"), py::arg("species"))
         .def("data", &FixedIntervalNumberObserver::data)
+        .def("data_as_array",
+            [](const FixedIntervalNumberObserver& self) { return as_array(self.logger()); })
         .def("targets", &FixedIntervalNumberObserver::targets)
         .def("save", &FixedIntervalNumberObserver::save);
 
@@ -613,6 +666,8 @@ void define_observers(py::module& m)
         .def(py::init<>())
         .def(py::init<const std::vector<std::string>&>(), py::arg("species"))
         .def("data", &NumberObserver::data)
+        .def("data_as_array",
+            [](const NumberObserver& self) { return as_array(self.logger()); })
         .def("targets", &NumberObserver::targets)
         .def("save", &NumberObserver::save);
 
@@ -622,6 +677,8 @@ void define_observers(py::module& m)
         .def(py::init<const std::vector<Real>&, const std::vector<std::string>&>(),
                 py::arg("t"), py::arg("species"))
         .def("data", &TimingNumberObserver::data)
+        .def("data_as_array",
+            [](const TimingNumberObserver& self) { return as_array(self.logger()); })
         .def("targets", &TimingNumberObserver::targets)
         .def("save", &TimingNumberObserver::save);
 
@@ -633,6 +690,21 @@ void define_observers(py::module& m)
         .def("filename", (const std::string (FixedIntervalHDF5Observer::*)() const) &FixedIntervalHDF5Observer::filename)
         .def("filename", (const std::string (FixedIntervalHDF5Observer::*)(const Integer) const) &FixedIntervalHDF5Observer::filename);
 
+    py::class_<FixedIntervalHDF5TrajectoryObserver, Observer, PyObserver<FixedIntervalHDF5TrajectoryObserver>,
+        boost::shared_ptr<FixedIntervalHDF5TrajectoryObserver>>(m, "FixedIntervalHDF5TrajectoryObserver")
+        .def(py::init<const Real&, const std::string&>(),
+                py::arg("dt"), py::arg("filename"))
+        .def(py::init<const Real&, const std::string&, std::vector<std::string>&>(),
+                py::arg("dt"), py::arg("filename"), py::arg("species"))
+        .def("log", &FixedIntervalHDF5TrajectoryObserver::log)
+        .def("filename", &FixedIntervalHDF5TrajectoryObserver::filename)
+        .def("set_append", &FixedIntervalHDF5TrajectoryObserver::set_append)
+        .def("set_chunk_size", &FixedIntervalHDF5TrajectoryObserver::set_chunk_size)
+        .def("set_compression", &FixedIntervalHDF5TrajectoryObserver::set_compression)
+        .def("set_shuffle", &FixedIntervalHDF5TrajectoryObserver::set_shuffle)
+        .def("set_flush_interval", &FixedIntervalHDF5TrajectoryObserver::set_flush_interval)
+        .def("set_async", &FixedIntervalHDF5TrajectoryObserver::set_async);
+
     py::class_<FixedIntervalCSVObserver, Observer, PyObserver<FixedIntervalCSVObserver>,
         boost::shared_ptr<FixedIntervalCSVObserver>>(m, "FixedIntervalCSVObserver")
         .def(py::init<const Real&, const std::string&>(),
@@ -642,7 +714,8 @@ void define_observers(py::module& m)
         .def("log", &FixedIntervalCSVObserver::log)
         .def("filename", &FixedIntervalCSVObserver::filename)
         .def("set_header", &FixedIntervalCSVObserver::set_header)
-        .def("set_formatter", &FixedIntervalCSVObserver::set_formatter);
+        .def("set_formatter", &FixedIntervalCSVObserver::set_formatter)
+        .def("set_async", &FixedIntervalCSVObserver::set_async);
 
     py::class_<CSVObserver, Observer, PyObserver<CSVObserver>, boost::shared_ptr<CSVObserver>>(m, "CSVObserver")
         .def(py::init<const std::string&>(), py::arg("filename"))
@@ -651,7 +724,8 @@ void define_observers(py::module& m)
         .def("log", &CSVObserver::log)
         .def("filename", &CSVObserver::filename)
         .def("set_header", &CSVObserver::set_header)
-        .def("set_formatter", &CSVObserver::set_formatter);
+        .def("set_formatter", &CSVObserver::set_formatter)
+        .def("set_async", &CSVObserver::set_async);
 
     py::class_<FixedIntervalTrajectoryObserver, Observer, PyObserver<FixedIntervalTrajectoryObserver>,
         boost::shared_ptr<FixedIntervalTrajectoryObserver>>(m, "FixedIntervalTrajectoryObserver")
@@ -1064,13 +1138,16 @@ static inline
 void define_simulator(py::module& m)
 {
     py::class_<Simulator, PySimulator<>, boost::shared_ptr<Simulator>>(m, "Simulator")
-        .def("initialize", &Simulator::initialize)
+        .def("initialize", &Simulator::initialize,
+            py::call_guard<py::gil_scoped_release>())
         .def("t", &Simulator::t)
         .def("dt", &Simulator::dt)
         .def("set_dt", &Simulator::set_dt)
         .def("num_steps", &Simulator::num_steps)
-        .def("step", (void (Simulator::*)()) &Simulator::step)
-        .def("step", (bool (Simulator::*)(const Real&)) &Simulator::step)
+        .def("step", (void (Simulator::*)()) &Simulator::step,
+            py::call_guard<py::gil_scoped_release>())
+        .def("step", (bool (Simulator::*)(const Real&)) &Simulator::step,
+            py::call_guard<py::gil_scoped_release>())
         .def("check_reaction", &Simulator::check_reaction)
         .def("next_time", &Simulator::next_time);
 }
@@ -105,7 +105,24 @@ void define_egfrd_simulator(py::module& m)
                 py::arg("user_max_shell_size") = std::numeric_limits<length_type>::infinity())
         .def("last_reactions", &::ecell4::egfrd::EGFRDSimulator::last_reactions)
         .def("set_t", &::ecell4::egfrd::EGFRDSimulator::set_t)
-        .def("set_paranoiac", &::ecell4::egfrd::EGFRDSimulator::set_paranoiac);
+        .def("set_paranoiac", &::ecell4::egfrd::EGFRDSimulator::set_paranoiac)
+        .def("set_tabulate_greens_functions",
+            &::ecell4::egfrd::EGFRDSimulator::set_tabulate_greens_functions)
+        .def("tabulate_greens_functions",
+            &::ecell4::egfrd::EGFRDSimulator::tabulate_greens_functions)
+        .def("num_shell_queries",
+            &::ecell4::egfrd::EGFRDSimulator::num_shell_queries)
+        .def("num_shell_cells_visited",
+            &::ecell4::egfrd::EGFRDSimulator::num_shell_cells_visited)
+        .def("num_shell_candidates",
+            &::ecell4::egfrd::EGFRDSimulator::num_shell_candidates)
+        .def("set_parallel", &::ecell4::egfrd::EGFRDSimulator::set_parallel,
+                py::arg("parallel"), py::arg("num_threads") = 0)
+        .def("is_parallel", &::ecell4::egfrd::EGFRDSimulator::is_parallel)
+        .def("set_batch_size", &::ecell4::egfrd::EGFRDSimulator::set_batch_size)
+        .def("batch_size", &::ecell4::egfrd::EGFRDSimulator::batch_size)
+        .def("num_batched_events",
+            &::ecell4::egfrd::EGFRDSimulator::num_batched_events);
     define_simulator_functions(simulator);
 
     m.attr("Simulator") = simulator;
@@ -3,6 +3,8 @@
 #include <ecell4/gillespie/GillespieFactory.hpp>
 #include <ecell4/gillespie/GillespieSimulator.hpp>
 #include <ecell4/gillespie/GillespieWorld.hpp>
+#include <ecell4/gillespie/TauLeapingFactory.hpp>
+#include <ecell4/gillespie/TauLeapingSimulator.hpp>
 
 #include "simulator.hpp"
 #include "simulator_factory.hpp"
@@ -22,9 +24,11 @@ void define_gillespie_factory(py::module& m)
 {
     py::class_<GillespieFactory> factory(m, "GillespieFactory");
     factory
-        .def(py::init<>())
+        .def(py::init<const GillespieSelectionMethod>(),
+            py::arg("selection_method") = GillespieFactory::default_selection_method())
         .def("rng", &GillespieFactory::rng);
     define_factory_functions(factory);
+    define_ensemble_functions(factory);
 
     m.attr("Factory") = factory;
 }
@@ -35,9 +39,12 @@ void define_gillespie_simulator(py::module& m)
     py::class_<GillespieSimulator, Simulator, PySimulator<GillespieSimulator>,
         boost::shared_ptr<GillespieSimulator>> simulator(m, "GillespieSimulator");
     simulator
-        .def(py::init<boost::shared_ptr<GillespieWorld>>(), py::arg("w"))
-        .def(py::init<boost::shared_ptr<GillespieWorld>, boost::shared_ptr<Model>>(),
-                py::arg("w"), py::arg("m"))
+        .def(py::init<boost::shared_ptr<GillespieWorld>, const GillespieSelectionMethod>(),
+                py::arg("w"), py::arg("selection_method") = GillespieSelectionMethod::LINEAR_SEARCH)
+        .def(py::init<boost::shared_ptr<GillespieWorld>, boost::shared_ptr<Model>, const GillespieSelectionMethod>(),
+                py::arg("w"), py::arg("m"),
+                py::arg("selection_method") = GillespieSelectionMethod::LINEAR_SEARCH)
+        .def("selection_method", &GillespieSimulator::selection_method)
         .def("last_reactions", &GillespieSimulator::last_reactions)
         .def("set_t", &GillespieSimulator::set_t);
     define_simulator_functions(simulator);
@@ -45,6 +52,41 @@ void define_gillespie_simulator(py::module& m)
     m.attr("Simulator") = simulator;
 }
 
+static inline
+void define_tau_leaping_factory(py::module& m)
+{
+    py::class_<TauLeapingFactory> factory(m, "TauLeapingFactory");
+    factory
+        .def(py::init<const Real, const Integer>(),
+            py::arg("epsilon") = TauLeapingFactory::default_epsilon(),
+            py::arg("critical_threshold") = TauLeapingFactory::default_critical_threshold())
+        .def("rng", &TauLeapingFactory::rng);
+    define_factory_functions(factory);
+    define_ensemble_functions(factory);
+}
+
+static inline
+void define_tau_leaping_simulator(py::module& m)
+{
+    py::class_<TauLeapingSimulator, Simulator, PySimulator<TauLeapingSimulator>,
+        boost::shared_ptr<TauLeapingSimulator>> simulator(m, "TauLeapingSimulator");
+    simulator
+        .def(py::init<boost::shared_ptr<GillespieWorld>, const Real, const Integer>(),
+                py::arg("w"),
+                py::arg("epsilon") = TauLeapingFactory::default_epsilon(),
+                py::arg("critical_threshold") = TauLeapingFactory::default_critical_threshold())
+        .def(py::init<boost::shared_ptr<GillespieWorld>, boost::shared_ptr<Model>, const Real, const Integer>(),
+                py::arg("w"), py::arg("m"),
+                py::arg("epsilon") = TauLeapingFactory::default_epsilon(),
+                py::arg("critical_threshold") = TauLeapingFactory::default_critical_threshold())
+        .def("epsilon", &TauLeapingSimulator::epsilon)
+        .def("critical_threshold", &TauLeapingSimulator::critical_threshold)
+        .def("is_leaping", &TauLeapingSimulator::is_leaping)
+        .def("last_reactions", &TauLeapingSimulator::last_reactions)
+        .def("set_t", &TauLeapingSimulator::set_t);
+    define_simulator_functions(simulator);
+}
+
 static inline
 void define_gillespie_world(py::module& m)
 {
@@ -106,9 +148,16 @@ void define_reaction_info(py::module& m)
 
 void setup_gillespie_module(py::module& m)
 {
+    py::enum_<GillespieSelectionMethod>(m, "GillespieSelectionMethod")
+        .value("LINEAR_SEARCH", GillespieSelectionMethod::LINEAR_SEARCH)
+        .value("PARTIAL_SUM_TREE", GillespieSelectionMethod::PARTIAL_SUM_TREE)
+        .export_values();
+
     define_gillespie_factory(m);
     define_gillespie_simulator(m);
     define_gillespie_world(m);
+    define_tau_leaping_factory(m);
+    define_tau_leaping_simulator(m);
     define_reaction_info(m);
 }
 
@@ -82,9 +82,10 @@ namespace python_api
 
         boost::shared_ptr<Model> expand(
             const std::vector<Species>& sp, const Integer max_itr,
-            const std::map<Species, Integer>& max_stoich) const override
+            const std::map<Species, Integer>& max_stoich,
+            const std::size_t num_threads = 0) const override
         {
-            PYBIND11_OVERLOAD_PURE(boost::shared_ptr<Model>, Base, expand, sp, max_itr, max_stoich);
+            PYBIND11_OVERLOAD_PURE(boost::shared_ptr<Model>, Base, expand, sp, max_itr, max_stoich, num_threads);
         }
 
         boost::shared_ptr<Model> expand(
@@ -127,9 +128,10 @@ namespace python_api
 
         boost::shared_ptr<Model> expand(
             const std::vector<Species>& sp, const Integer max_itr,
-            const std::map<Species, Integer>& max_stoich) const override
+            const std::map<Species, Integer>& max_stoich,
+            const std::size_t num_threads = 0) const override
         {
-            PYBIND11_OVERLOAD(boost::shared_ptr<Model>, Base, expand, sp, max_itr, max_stoich);
+            PYBIND11_OVERLOAD(boost::shared_ptr<Model>, Base, expand, sp, max_itr, max_stoich, num_threads);
         }
 
         boost::shared_ptr<Model> expand(
@@ -44,7 +44,13 @@ namespace python_api
 
         bool fire(const Simulator* sim, const boost::shared_ptr<WorldInterface>& world) override
         {
-            return callback_(world, sim->check_reaction()) && base_type::fire(sim, world);
+            const bool is_dirty(sim->check_reaction());
+            bool retval;
+            {
+                py::gil_scoped_acquire acquire;  // released in Simulator::run
+                retval = callback_(world, is_dirty);
+            }
+            return retval && base_type::fire(sim, world);
         }
 
     protected:
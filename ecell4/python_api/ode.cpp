@@ -102,6 +102,7 @@ void setup_ode_module(py::module& m)
         .value("RUNGE_KUTTA_CASH_KARP54", ODESolverType::RUNGE_KUTTA_CASH_KARP54)
         .value("ROSENBROCK4_CONTROLLER", ODESolverType::ROSENBROCK4_CONTROLLER)
         .value("EULER", ODESolverType::EULER)
+        .value("ROSENBROCK2_SPARSE", ODESolverType::ROSENBROCK2_SPARSE)
         .export_values();
 
     define_ode_factory(m);
@@ -40,6 +40,11 @@ namespace python_api
             PYBIND11_OVERLOAD_PURE(Integer, Base, binomial, p, n);
         }
 
+        Integer poisson(Real mean)
+        {
+            PYBIND11_OVERLOAD(Integer, Base, poisson, mean);
+        }
+
         Real3 direction3d(Real length = 1.0)
         {
             PYBIND11_OVERLOAD_PURE(Real3, Base, direction3d, length);
@@ -119,6 +124,11 @@ namespace python_api
             PYBIND11_OVERLOAD(Integer, Base, binomial, p, n);
         }
 
+        Integer poisson(Real mean)
+        {
+            PYBIND11_OVERLOAD(Integer, Base, poisson, mean);
+        }
+
         Real3 direction3d(Real length = 1.0)
         {
             PYBIND11_OVERLOAD(Real3, Base, direction3d, length);
@@ -45,8 +45,31 @@ namespace python_api
         {
         }
 
+        // A simulator may clone and release the descriptor without the GIL.
+        ~ReactionRuleDescriptorPyfunc()
+        {
+            if (!callback_)
+            {
+                return;
+            }
+            if (!Py_IsInitialized())
+            {
+                // The interpreter is already finalized. Nothing can be decref'd.
+                callback_.release();
+                return;
+            }
+            if (PyGILState_Check())
+            {
+                callback_ = py::object();
+                return;
+            }
+            py::gil_scoped_acquire acquire;
+            callback_ = py::object();
+        }
+
         Real propensity(const state_container_type& reactants, const state_container_type& products, Real volume, Real t) const override
         {
+            py::gil_scoped_acquire acquire;
             return callback_(reactants, products, volume, t, reactant_coefficients(), product_coefficients()).cast<Real>();
         }
 
@@ -67,6 +90,7 @@ namespace python_api
 
         ReactionRuleDescriptor* clone() const
         {
+            py::gil_scoped_acquire acquire;
             return new ReactionRuleDescriptorPyfunc(callback_, name_,
                     reactant_coefficients(), product_coefficients());
         }
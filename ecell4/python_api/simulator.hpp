@@ -102,6 +102,12 @@ public:
     }
 };
 
+/**
+ * run releases the GIL, so that simulators in different Python threads run
+ * in parallel. Python callbacks, i.e. FixedIntervalPythonHooker, descriptors
+ * with a Python function and methods overridden in Python, acquire it again
+ * only while they are called.
+ */
 template<class S, class... Others>
 static inline
 void define_simulator_functions(py::class_<S, Others...>& simulator)
@@ -111,13 +117,16 @@ void define_simulator_functions(py::class_<S, Others...>& simulator)
         .def("world", &S::world)
         .def("run",
             (void (S::*)(const Real&, const bool)) &S::run,
-            py::arg("duration"), py::arg("is_dirty") = true)
+            py::arg("duration"), py::arg("is_dirty") = true,
+            py::call_guard<py::gil_scoped_release>())
         .def("run",
             (void (S::*)(const Real&, const boost::shared_ptr<Observer>&, const bool)) &S::run,
-            py::arg("duration"), py::arg("observer"), py::arg("is_dirty") = true)
+            py::arg("duration"), py::arg("observer"), py::arg("is_dirty") = true,
+            py::call_guard<py::gil_scoped_release>())
         .def("run",
             (void (S::*)(const Real&, std::vector<boost::shared_ptr<Observer>>, const bool)) &S::run,
-            py::arg("duration"), py::arg("observers"), py::arg("is_dirty") = true)
+            py::arg("duration"), py::arg("observers"), py::arg("is_dirty") = true,
+            py::call_guard<py::gil_scoped_release>())
         ;
 }
 
@@ -2,6 +2,8 @@
 #define ECELL4_PYTHON_API_SIMULATOR_FACTORY_HPP
 
 #include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <ecell4/core/ensemble.hpp>
 
 namespace py = pybind11;
 
@@ -57,6 +59,35 @@ void define_factory_functions(py::class_<Factory>& factory)
             py::arg("world"), py::arg("model"));
 }
 
+template<class Factory>
+static inline
+void define_ensemble_functions(py::class_<Factory>& factory)
+{
+    using world_type = typename Factory::world_type;
+
+    factory
+        .def("run_ensemble",
+            [](const Factory& self, const boost::shared_ptr<Model>& model,
+               const boost::shared_ptr<world_type>& world, const std::vector<Integer>& seeds,
+               const Real duration, const Real dt, const std::vector<std::string>& species,
+               const std::size_t num_threads)
+            {
+                std::vector<std::size_t> shape(3);
+                shape[0] = seeds.size();
+                shape[1] = num_ensemble_times(duration, dt);
+                shape[2] = species.size() + 1;
+                py::array_t<Real> data(shape);
+                Real* ptr(data.mutable_data());
+                {
+                    py::gil_scoped_release release;
+                    run_ensemble(self, model, world, seeds, duration, dt, species, ptr, num_threads);
+                }
+                return data;
+            },
+            py::arg("model"), py::arg("world"), py::arg("seeds"), py::arg("duration"),
+            py::arg("dt"), py::arg("species"), py::arg("num_threads") = 0);
+}
+
 }
 
 }
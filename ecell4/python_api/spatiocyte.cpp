@@ -59,8 +59,11 @@ void define_spatiocyte_factory(py::module& m)
     factory
         .def(py::init<const Real>(),
                 py::arg("voxel_radius") = SpatiocyteFactory::default_voxel_radius())
-        .def("rng", &SpatiocyteFactory::rng);
+        .def("rng", &SpatiocyteFactory::rng)
+        .def("parallel", &SpatiocyteFactory::parallel, py::arg("num_threads") = 0)
+        .def("compact", &SpatiocyteFactory::compact, py::arg("compact") = true);
     define_factory_functions(factory);
+    define_ensemble_functions(factory);
 
     m.attr("Factory") = factory;
 }
@@ -75,7 +78,10 @@ void define_spatiocyte_simulator(py::module& m)
         .def(py::init<boost::shared_ptr<SpatiocyteWorld>, boost::shared_ptr<Model>>(),
                 py::arg("w"), py::arg("m"))
         .def("last_reactions", &SpatiocyteSimulator::last_reactions)
-        .def("set_t", &SpatiocyteSimulator::set_t);
+        .def("set_t", &SpatiocyteSimulator::set_t)
+        .def("set_parallel", &SpatiocyteSimulator::set_parallel,
+                py::arg("parallel"), py::arg("num_threads") = 0)
+        .def("is_parallel", &SpatiocyteSimulator::is_parallel);
     define_simulator_functions(simulator);
 
     m.attr("Simulator") = simulator;
@@ -152,6 +158,7 @@ void define_spatiocyte_world(py::module& m)
 
     m.def("create_spatiocyte_world_cell_list_impl", &create_spatiocyte_world_cell_list_impl_alias);
     m.def("create_spatiocyte_world_vector_impl", &create_spatiocyte_world_vector_impl_alias);
+    m.def("create_spatiocyte_world_compact_impl", &create_spatiocyte_world_compact_impl_alias);
     m.def("create_spatiocyte_world_square_offlattice_impl", &allocate_spatiocyte_world_square_offlattice_impl);
 
     m.attr("World") = world;
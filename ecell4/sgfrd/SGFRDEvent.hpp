@@ -14,7 +14,11 @@ namespace ecell4
 namespace sgfrd
 {
 
+/**
+ * an Event, held by boost::intrusive_ptr in SGFRDEventScheduler.
+ */
 struct SGFRDEvent
+    : public ecell4::Event
 {
 public:
     typedef boost::variant<Single, Pair, Multi, Birth> domain_type;
@@ -33,10 +37,9 @@ public:
 
     template<typename domainT>
     SGFRDEvent(Real const& time, const domainT& dom)
-        : time_(time), domain_(dom)
+        : ecell4::Event(time), domain_(dom)
     {}
 
-    Real const&        time()   const {return time_;}
     domain_type const& domain() const {return domain_;}
     domain_type &      domain()       {return domain_;}
 
@@ -47,11 +50,10 @@ public:
 
 private:
 
-    Real time_;
     domain_type domain_;
 };
 
-typedef ecell4::EventSchedulerBase<SGFRDEvent> SGFRDEventScheduler;
+typedef ecell4::IntrusiveEventSchedulerBase<SGFRDEvent> SGFRDEventScheduler;
 typedef SGFRDEventScheduler::identifier_type EventID;
 typedef EventID DomainID; // XXX!
 
@@ -60,6 +60,11 @@ class SGFRDFactory :
         return std::addressof(this->rng(rng));
     }
 
+    bool has_rng() const
+    {
+        return static_cast<bool>(rng_);
+    }
+
     this_type& polygon(const std::string& fname, const STLFormat fmt)
     {
         this->polygon_ = std::make_pair(fname, fmt);
@@ -549,7 +549,7 @@ bool SGFRDSimulator::burst_and_shrink_overlaps(
             assert(false);
         }
 
-        boost::shared_ptr<event_type> ev_(get_event(did_));
+        boost::intrusive_ptr<event_type> ev_(get_event(did_));
 
         if(ev_->which_domain() == SGFRDEvent::multi_domain)
         {
@@ -583,7 +583,7 @@ SGFRDSimulator::form_pair(
     SGFRD_SCOPE(us, form_pair, tracer_);
 
     // the first (nearest) domain in the intruders is the partner to form pair.
-    const boost::shared_ptr<event_type> nearest =
+    const boost::intrusive_ptr<event_type> nearest =
         this->get_event(intruders.front().first);
     if(nearest->which_domain() != event_type::single_domain)
     {
@@ -649,7 +649,7 @@ SGFRDSimulator::form_pair(
     for(std::vector<std::pair<DomainID, Real> >::const_iterator
         iter(intruders.begin()+1), iend(intruders.end()); iter != iend; ++iter)
     {
-        const boost::shared_ptr<event_type> intruder_ev =
+        const boost::intrusive_ptr<event_type> intruder_ev =
             this->get_event(iter->first);
         if(intruder_ev->which_domain() != event_type::single_domain)
         {
@@ -811,7 +811,8 @@ DomainID SGFRDSimulator::form_multi(
     // when the multi domain is assigned, it had a negative delta t.
     // we need to update the data after determining delta_t and reaction_length.
     this->scheduler_.update(std::make_pair(formed_multi_id,
-        boost::make_shared<event_type>(this->time() + formed_multi.dt(), formed_multi)));
+        this->event_pool_.create<event_type>(
+            this->time() + formed_multi.dt(), formed_multi)));
 
     return formed_multi_id;
 }
@@ -1106,7 +1107,7 @@ SGFRDSimulator::form_single_circular_event(
                 "%1% does not intersect with minimum circle", iter->first));
 
             // calculate modest distance if this one is a single domain.
-            boost::shared_ptr<event_type> ev(this->get_event(iter->first));
+            boost::intrusive_ptr<event_type> ev(this->get_event(iter->first));
             if(ev->which_domain() == event_type::single_domain)
             {
                 SGFRD_TRACE(tracer_.write("calculating modest r."))
@@ -1403,7 +1404,7 @@ bool SGFRDSimulator::diagnosis() const
     // 3.
     std::map<ParticleID, EventID> pid2evid;
     std::map<ShellID,    EventID> sid2evid;
-    EventID evid; boost::shared_ptr<event_type> ev_ptr;
+    EventID evid; boost::intrusive_ptr<event_type> ev_ptr;
     for(const auto& evidptr : this->scheduler_.events())
     {
         std::tie(evid, ev_ptr) = evidptr;
@@ -345,7 +345,7 @@ class SGFRDSimulator :
         SGFRD_TRACE(tracer_.write("  checking event %1% exists or not", id));
         try
         {
-            boost::shared_ptr<event_type> ev = scheduler_.get(id);
+            boost::intrusive_ptr<event_type> ev = scheduler_.get(id);
             return static_cast<bool>(ev);
         }
         catch(std::out_of_range const& oor)
@@ -354,7 +354,7 @@ class SGFRDSimulator :
         }
     }
 
-    boost::shared_ptr<event_type> get_event(const event_id_type& id)
+    boost::intrusive_ptr<event_type> get_event(const event_id_type& id)
     {
         SGFRD_TRACE(tracer_.write("  getting event %1%", id));
         return scheduler_.get(id);
@@ -1799,7 +1799,8 @@ class SGFRDSimulator :
         SGFRD_TRACE(tracer_.write("the domain has dt = %1%, begin_time = %2%",
                     dom.dt(), dom.begin_time()))
 
-        auto ev = boost::make_shared<event_type>(dom.begin_time() + dom.dt(), dom);
+        auto ev = this->event_pool_.create<event_type>(
+                dom.begin_time() + dom.dt(), dom);
         const DomainID did = scheduler_.add(ev);
 
         SGFRD_TRACE(tracer_.write("event_time = %1%, domain ID = %2%", ev->time(), did))
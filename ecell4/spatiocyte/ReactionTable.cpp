@@ -0,0 +1,118 @@
+#include <iostream>
+#include <limits>
+
+#include "ReactionTable.hpp"
+#include "utils.hpp"
+
+namespace ecell4
+{
+
+namespace spatiocyte
+{
+
+void ReactionTable::update()
+{
+    const std::vector<Species> species(world_->list_species());
+    for (std::vector<Species>::const_iterator itr(species.begin());
+        itr != species.end(); ++itr)
+    {
+        index_of(world_->find_voxel_pool(*itr));
+    }
+}
+
+void ReactionTable::refresh()
+{
+    if (model_->revision() == revision_)
+    {
+        return;
+    }
+
+    revision_ = model_->revision();
+    for (index_type i(0); i < pools_.size(); ++i)
+    {
+        for (index_type j(0); j < pools_.size(); ++j)
+        {
+            table_[i][j] = generate(pools_[i], pools_[j]);
+        }
+    }
+}
+
+void ReactionTable::warn_acceptance(
+    const index_type i, const index_type j, const Real& alpha)
+{
+    entry_type& entry(table_[i][j]);
+    for (std::size_t k(0); k < entry.rules.size(); ++k)
+    {
+        const Real accp(entry.accps[k] * alpha);
+        if (accp > 1 && entry.rules[k].k() != std::numeric_limits<Real>::infinity())
+        {
+            if (!entry.warned[k])
+            {
+                std::cerr << "The total acceptance probability [" << accp
+                    << "] exceeds 1 for '" << pools_[i]->species().serial()
+                    << "' and '" << pools_[j]->species().serial() << "'." << std::endl;
+                entry.warned[k] = true;
+            }
+            break;
+        }
+    }
+}
+
+ReactionTable::index_type
+ReactionTable::index_of(const boost::shared_ptr<const VoxelPool>& vp)
+{
+    index_map_type::const_iterator itr(indices_.find(vp.get()));
+    if (itr != indices_.end())
+    {
+        return (*itr).second;
+    }
+
+    const index_type index(pools_.size());
+    pools_.push_back(vp);
+    indices_.insert(index_map_type::value_type(vp.get(), index));
+
+    for (index_type i(0); i < index; ++i)
+    {
+        table_[i].push_back(generate(pools_[i], vp));
+    }
+
+    table_.push_back(std::vector<entry_type>());
+    table_.back().reserve(index + 1);
+    for (index_type j(0); j <= index; ++j)
+    {
+        table_.back().push_back(generate(vp, pools_[j]));
+    }
+    return index;
+}
+
+ReactionTable::entry_type ReactionTable::generate(
+    const boost::shared_ptr<const VoxelPool>& vp0,
+    const boost::shared_ptr<const VoxelPool>& vp1) const
+{
+    entry_type entry;
+    if (vp0->is_vacant() || vp1->is_vacant())
+    {
+        return entry;
+    }
+
+    entry.rules = model_->query_reaction_rules(vp0->species(), vp1->species());
+    if (entry.rules.empty())
+    {
+        return entry;
+    }
+
+    const Real factor(calculate_dimensional_factor(vp0, vp1, world_));
+    Real accp(0.0);
+    for (std::vector<ReactionRule>::const_iterator itr(entry.rules.begin());
+        itr != entry.rules.end(); ++itr)
+    {
+        accp += (*itr).k() * factor;
+        entry.accps.push_back(accp);
+    }
+    entry.warned.resize(entry.rules.size(), false);
+    return entry;
+}
+
+} // spatiocyte
+
+} // ecell4
@@ -0,0 +1,129 @@
+#ifndef ECELL4_SPATIOCYTE_REACTION_TABLE_HPP
+#define ECELL4_SPATIOCYTE_REACTION_TABLE_HPP
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <ecell4/core/Model.hpp>
+#include <ecell4/core/ReactionRule.hpp>
+#include <ecell4/core/VoxelPool.hpp>
+#include <ecell4/core/get_mapper_mf.hpp>
+#include "SpatiocyteWorld.hpp"
+
+namespace ecell4
+{
+
+namespace spatiocyte
+{
+
+/**
+ * A dense table of second order reaction rules between pools, which replaces
+ * Model::query_reaction_rules and calculate_dimensional_factor at every
+ * collision with a lookup.
+ *
+ * Each pool is given an index when registered. The entry at (i, j) holds the
+ * rules between the i-th and j-th pools, and the cumulative acceptance
+ * probabilities of them without alpha, i.e. the sum of k * factor up to each
+ * rule. Pools are held by the table, so that an address is never reused by
+ * another pool while registered. The entries are regenerated by refresh()
+ * when the revision of the model has changed, keeping the indices.
+ */
+class ReactionTable
+{
+public:
+
+    typedef std::size_t index_type;
+
+    struct entry_type
+    {
+        std::vector<ReactionRule> rules;
+        std::vector<Real> accps;  // cumulative k * factor
+        std::vector<bool> warned;  // see warn_acceptance
+    };
+
+protected:
+
+    typedef utils::get_mapper_mf<const VoxelPool*, index_type>::type index_map_type;
+
+public:
+
+    ReactionTable(boost::shared_ptr<Model> model, boost::shared_ptr<SpatiocyteWorld> world)
+        : model_(model), world_(world), revision_(model->revision())
+    {
+        ;
+    }
+
+    /**
+     * register all pools in the world, which are not registered yet.
+     */
+    void update();
+
+    /**
+     * regenerate all the entries if the model has been changed since they
+     * were generated. It compares only Model::revision, and is cheap enough
+     * to call at every step.
+     */
+    void refresh();
+
+    /**
+     * print a warning to std::cerr if the total acceptance probability in the
+     * entry at (i, j) exceeds 1 with alpha. It is printed once for each rule.
+     */
+    void warn_acceptance(const index_type i, const index_type j, const Real& alpha);
+
+    /**
+     * return the index of the pool, which is registered if not yet.
+     */
+    index_type index_of(const boost::shared_ptr<const VoxelPool>& vp);
+
+    /**
+     * return if the pool is registered, and if so, set its index.
+     * This never modifies the table, and is safe to call concurrently.
+     */
+    bool find(const VoxelPool* vp, index_type& index) const
+    {
+        index_map_type::const_iterator itr(indices_.find(vp));
+        if (itr == indices_.end())
+        {
+            return false;
+        }
+        index = (*itr).second;
+        return true;
+    }
+
+    const entry_type& get(const index_type i, const index_type j) const
+    {
+        return table_[i][j];
+    }
+
+    const boost::shared_ptr<const VoxelPool>& pool(const index_type i) const
+    {
+        return pools_[i];
+    }
+
+    std::size_t size() const
+    {
+        return pools_.size();
+    }
+
+protected:
+
+    entry_type generate(
+        const boost::shared_ptr<const VoxelPool>& vp0,
+        const boost::shared_ptr<const VoxelPool>& vp1) const;
+
+protected:
+
+    boost::shared_ptr<Model> model_;
+    boost::shared_ptr<SpatiocyteWorld> world_;
+    Integer revision_;  // of the model when generated
+
+    std::vector<boost::shared_ptr<const VoxelPool> > pools_;
+    index_map_type indices_;
+    std::vector<std::vector<entry_type> > table_;
+};
+
+} // spatiocyte
+
+} // ecell4
+
+#endif /* ECELL4_SPATIOCYTE_REACTION_TABLE_HPP */
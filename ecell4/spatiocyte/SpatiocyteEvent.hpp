@@ -4,8 +4,10 @@
 #include <ecell4/core/ReactionRule.hpp>
 #include <ecell4/core/EventScheduler.hpp>
 #include <ecell4/core/Model.hpp>
+#include <ecell4/core/parallel_for.hpp>
 #include "SpatiocyteReactions.hpp"
 #include "SpatiocyteWorld.hpp"
+#include "ReactionTable.hpp"
 
 namespace ecell4
 {
@@ -45,11 +47,16 @@ protected:
 
 struct StepEvent : SpatiocyteEvent
 {
+    /**
+     * table is shared among events to look up reactions at collisions.
+     * A table of its own is created if not given.
+     */
     StepEvent(boost::shared_ptr<Model> model,
               boost::shared_ptr<SpatiocyteWorld> world,
               const Species& species,
               const Real& t,
-              const Real alpha=1.0);
+              const Real alpha=1.0,
+              boost::shared_ptr<ReactionTable> table=boost::shared_ptr<ReactionTable>());
     virtual ~StepEvent() {}
 
     Species const& species() const
@@ -77,11 +84,19 @@ protected:
         const Voxel& dst,
         const Real& alpha);
 
+    /**
+     * register new pools in the table, and warn if the acceptance
+     * probability with any of them exceeds 1.
+     */
+    void update_table(const Real& alpha);
+
 protected:
 
     boost::shared_ptr<Model> model_;
     boost::shared_ptr<SpatiocyteWorld> world_;
     boost::shared_ptr<MoleculePool> mpool_;
+    boost::shared_ptr<ReactionTable> table_;
+    ReactionTable::index_type row_;  // the index of mpool_ in table_
 
     const Real alpha_;
 };
@@ -92,9 +107,60 @@ struct StepEvent3D : StepEvent
                 boost::shared_ptr<SpatiocyteWorld> world,
                 const Species& species,
                 const Real& t,
-                const Real alpha=1.0);
+                const Real alpha=1.0,
+                boost::shared_ptr<ReactionTable> table=boost::shared_ptr<ReactionTable>());
 
     void walk(const Real& alpha);
+
+    /**
+     * let walk() move molecules block by block on threads of the pool, or
+     * serially if NULL. See walk_in_parallel. The pool is shared with the
+     * simulator, which replaces it in set_parallel and destroys its own
+     * reference before the scheduler holding this event.
+     */
+    void set_parallel(const boost::shared_ptr<ThreadPool>& pool)
+    {
+        pool_ = pool;
+    }
+
+    bool is_parallel() const
+    {
+        return static_cast<bool>(pool_);
+    }
+
+protected:
+
+    /**
+     * return if the lattice allows walk_in_parallel, i.e. the world consists
+     * only of a LatticeSpaceVectorImpl, and the location of the species does
+     * not track its voxels (vacant or a structure). Otherwise, walk() falls
+     * back to the serial walk.
+     */
+    bool can_walk_in_parallel() const;
+
+    /**
+     * move molecules block by block on multiple threads.
+     *
+     * The lattice is divided into blocks at least 8 voxels wide, which are
+     * coloured like a checkerboard, so that no two blocks in the same colour
+     * are adjacent even across the periodic boundary (2 colours along an
+     * axis with an even number of blocks, and 3 with an odd number). Blocks
+     * in a colour are walked concurrently, and colours one after another.
+     * As a molecule only moves to or collides with its nearest neighbors,
+     * voxels touched by walkers in different blocks of a colour never meet.
+     *
+     * Reactions are selected in the parallel phase, and both reactants are
+     * reserved within the block. They are fired in the serial pass after
+     * each colour, in the order of blocks. Each block draws random numbers
+     * from its own stream of PhiloxRandomNumberGenerator seeded with the
+     * world RNG once per walk. Thus, the result does not depend on the
+     * number of threads, but differs from the serial walk with the same seed.
+     */
+    void walk_in_parallel(const Real& alpha);
+
+protected:
+
+    boost::shared_ptr<ThreadPool> pool_;
 };
 
 struct StepEvent2D : StepEvent
@@ -103,7 +169,8 @@ struct StepEvent2D : StepEvent
                 boost::shared_ptr<SpatiocyteWorld> world,
                 const Species& species,
                 const Real& t,
-                const Real alpha=1.0);
+                const Real alpha=1.0,
+                boost::shared_ptr<ReactionTable> table=boost::shared_ptr<ReactionTable>());
 
     void walk(const Real& alpha);
 
@@ -28,7 +28,8 @@ public:
 public:
 
     SpatiocyteFactory(const Real voxel_radius = default_voxel_radius())
-        : base_type(), rng_(), voxel_radius_(voxel_radius)
+        : base_type(), rng_(), voxel_radius_(voxel_radius), parallel_(false), num_threads_(0),
+          compact_(false)
     {
         ; // do nothing
     }
@@ -54,11 +55,65 @@ public:
         return &(this->rng(rng));  //XXX: == this
     }
 
+    bool has_rng() const
+    {
+        return static_cast<bool>(rng_);
+    }
+
+    /**
+     * let simulators walk molecules on num_threads threads.
+     * See SpatiocyteSimulator::set_parallel.
+     */
+    this_type& parallel(const Integer num_threads = 0)
+    {
+        if (num_threads < 0)
+        {
+            throw IllegalArgument("The number of threads must not be negative.");
+        }
+        parallel_ = true;
+        num_threads_ = num_threads;
+        return (*this);
+    }
+
+    inline this_type* parallel_ptr(const Integer num_threads = 0)
+    {
+        return &(this->parallel(num_threads));  //XXX: == this
+    }
+
+    /**
+     * let worlds store voxels in LatticeSpaceCompactImpl instead of
+     * LatticeSpaceVectorImpl. See create_spatiocyte_world_compact_impl.
+     */
+    this_type& compact(const bool compact = true)
+    {
+        compact_ = compact;
+        return (*this);
+    }
+
+    inline this_type* compact_ptr(const bool compact = true)
+    {
+        return &(this->compact(compact));  //XXX: == this
+    }
+
 protected:
 
     virtual world_type* create_world(const Real3& edge_lengths) const
     {
-        if (rng_)
+        if (compact_)
+        {
+            boost::shared_ptr<RandomNumberGenerator> rng(rng_);
+            if (!rng)
+            {
+                rng = boost::shared_ptr<RandomNumberGenerator>(
+                    new GSLRandomNumberGenerator());
+                (*rng).seed();
+            }
+            // the same defaults as the constructors of SpatiocyteWorld
+            return create_spatiocyte_world_compact_impl(
+                edge_lengths, (voxel_radius_ > 0 ? voxel_radius_ : edge_lengths[0] / 100),
+                rng);
+        }
+        else if (rng_)
         {
             return new world_type(edge_lengths, voxel_radius_, rng_);
         }
@@ -72,10 +127,26 @@ protected:
         }
     }
 
+protected:
+
+    virtual simulator_type* create_simulator(
+        const boost::shared_ptr<world_type>& w, const boost::shared_ptr<Model>& m) const
+    {
+        simulator_type* sim(new simulator_type(w, m));
+        if (parallel_)
+        {
+            sim->set_parallel(true, num_threads_);
+        }
+        return sim;
+    }
+
 protected:
 
     boost::shared_ptr<RandomNumberGenerator> rng_;
     Real voxel_radius_;
+    bool parallel_;
+    Integer num_threads_;
+    bool compact_;
 };
 
 } // spatiocyte
@@ -19,6 +19,10 @@ void SpatiocyteSimulator::initialize()
 
     scheduler_.clear();
     update_alpha_map();
+
+    reaction_table_.reset(new ReactionTable(model_, world_));
+    reaction_table_->update();
+
     const std::vector<Species> species(world_->list_species());
     for (std::vector<Species>::const_iterator itr(species.begin());
         itr != species.end(); ++itr)
@@ -35,7 +39,7 @@ void SpatiocyteSimulator::initialize()
         {
             continue;
         }
-        const boost::shared_ptr<SpatiocyteEvent>
+        const boost::intrusive_ptr<SpatiocyteEvent>
             zeroth_order_reaction_event(
                 create_zeroth_order_reaction_event(rr, world_->t()));
         scheduler_.add(zeroth_order_reaction_event);
@@ -79,7 +83,7 @@ void SpatiocyteSimulator::register_events(const Species& sp)
         //TODO: Call steps only if sp is assigned not to StructureType.
         alpha_map_type::const_iterator itr(alpha_map_.find(sp));
         const Real alpha(itr != alpha_map_.end() ? itr->second : 1.0);
-        const boost::shared_ptr<SpatiocyteEvent> step_event(
+        const boost::intrusive_ptr<SpatiocyteEvent> step_event(
                 create_step_event(sp, world_->t(), alpha));
         scheduler_.add(step_event);
     }
@@ -89,14 +93,14 @@ void SpatiocyteSimulator::register_events(const Species& sp)
         i != reaction_rules.end(); ++i)
     {
         const ReactionRule& rr(*i);
-        const boost::shared_ptr<SpatiocyteEvent>
+        const boost::intrusive_ptr<SpatiocyteEvent>
             first_order_reaction_event(
                 create_first_order_reaction_event(rr, world_->t()));
         scheduler_.add(first_order_reaction_event);
     }
 }
 
-boost::shared_ptr<SpatiocyteEvent> SpatiocyteSimulator::create_step_event(
+boost::intrusive_ptr<SpatiocyteEvent> SpatiocyteSimulator::create_step_event(
         const Species& species, const Real& t, const Real& alpha)
 {
     boost::shared_ptr<MoleculePool> mpool(world_->find_molecule_pool(species));
@@ -104,13 +108,15 @@ boost::shared_ptr<SpatiocyteEvent> SpatiocyteSimulator::create_step_event(
 
     if (dimension == Shape::THREE)
     {
-        return boost::shared_ptr<SpatiocyteEvent>(
-                new StepEvent3D(model_, world_, species, t, alpha));
+        const boost::intrusive_ptr<StepEvent3D> step_event(event_pool_.create<StepEvent3D>(
+                model_, world_, species, t, alpha, reaction_table_));
+        step_event->set_parallel(pool_);
+        return step_event;
     }
     else if (dimension == Shape::TWO)
     {
-        return boost::shared_ptr<SpatiocyteEvent>(
-                new StepEvent2D(model_, world_, species, t, alpha));
+        return event_pool_.create<StepEvent2D>(
+                model_, world_, species, t, alpha, reaction_table_);
     }
     else
     {
@@ -118,22 +124,18 @@ boost::shared_ptr<SpatiocyteEvent> SpatiocyteSimulator::create_step_event(
     }
 }
 
-boost::shared_ptr<SpatiocyteEvent>
+boost::intrusive_ptr<SpatiocyteEvent>
 SpatiocyteSimulator::create_zeroth_order_reaction_event(
     const ReactionRule& reaction_rule, const Real& t)
 {
-    boost::shared_ptr<SpatiocyteEvent> event(
-            new ZerothOrderReactionEvent(world_, reaction_rule, t));
-    return event;
+    return event_pool_.create<ZerothOrderReactionEvent>(world_, reaction_rule, t);
 }
 
-boost::shared_ptr<SpatiocyteEvent>
+boost::intrusive_ptr<SpatiocyteEvent>
 SpatiocyteSimulator::create_first_order_reaction_event(
     const ReactionRule& reaction_rule, const Real& t)
 {
-    boost::shared_ptr<SpatiocyteEvent> event(new FirstOrderReactionEvent(
-                world_, reaction_rule, t));
-    return event;
+    return event_pool_.create<FirstOrderReactionEvent>(world_, reaction_rule, t);
 }
 
 void SpatiocyteSimulator::finalize()
@@ -155,6 +157,24 @@ void SpatiocyteSimulator::finalize()
     initialize();
 }
 
+void SpatiocyteSimulator::set_parallel(const bool parallel, const std::size_t num_threads)
+{
+    parallel_ = parallel;
+    num_threads_ = num_threads;
+    pool_.reset(parallel ? new ThreadPool(num_threads) : NULL);
+
+    scheduler_type::events_range events(scheduler_.events());
+    for (scheduler_type::events_range::iterator itr(events.begin());
+            itr != events.end(); ++itr)
+    {
+        StepEvent3D* step_event(dynamic_cast<StepEvent3D*>((*itr).second.get()));
+        if (step_event != NULL)
+        {
+            step_event->set_parallel(pool_);
+        }
+    }
+}
+
 void SpatiocyteSimulator::step()
 {
     step_();
@@ -188,7 +208,7 @@ void SpatiocyteSimulator::step_()
     const Real time(top.second->time());
     world_->set_t(time);
     top.second->fire(); // top.second->time_ is updated in fire()
-    set_last_event_(boost::const_pointer_cast<const SpatiocyteEvent>(top.second));
+    set_last_event_(top.second);
 
     last_reactions_ = last_event_->reactions();
 
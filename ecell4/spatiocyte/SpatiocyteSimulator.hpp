@@ -5,6 +5,7 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/lexical_cast.hpp>
 
+#include <ecell4/core/config.h>
 #include <ecell4/core/Model.hpp>
 #include <ecell4/core/ReactionRule.hpp>
 #include <ecell4/core/VoxelPool.hpp>
@@ -12,6 +13,7 @@
 #include <ecell4/core/RandomNumberGenerator.hpp>
 #include <ecell4/core/EventScheduler.hpp>
 #include <ecell4/core/get_mapper_mf.hpp>
+#include <ecell4/core/parallel_for.hpp>
 
 #include "SpatiocyteWorld.hpp"
 #include "SpatiocyteEvent.hpp"
@@ -29,7 +31,11 @@ public:
 
     typedef SimulatorBase<SpatiocyteWorld> base_type;
     typedef SpatiocyteEvent::reaction_type reaction_type;
-    typedef EventSchedulerBase<SpatiocyteEvent> scheduler_type;
+#ifdef WITH_CALENDAR_QUEUE
+    typedef IntrusiveCalendarEventSchedulerBase<SpatiocyteEvent> scheduler_type;
+#else
+    typedef IntrusiveEventSchedulerBase<SpatiocyteEvent> scheduler_type;
+#endif
     typedef utils::get_mapper_mf<Species, Real>::type alpha_map_type;
 
 public:
@@ -37,14 +43,14 @@ public:
     SpatiocyteSimulator(
             boost::shared_ptr<SpatiocyteWorld> world,
             boost::shared_ptr<Model> model)
-        : base_type(world, model)
+        : base_type(world, model), parallel_(false), num_threads_(0)
     {
         initialize();
     }
 
     SpatiocyteSimulator(
             boost::shared_ptr<SpatiocyteWorld> world)
-        : base_type(world)
+        : base_type(world), parallel_(false), num_threads_(0)
     {
         initialize();
     }
@@ -70,34 +76,56 @@ public:
         return last_reactions_;
     }
 
+    /**
+     * let molecules in 3D walk block by block on num_threads threads
+     * (0 means the number of hardware threads). See StepEvent3D::walk_in_parallel.
+     * Its result does not depend on num_threads, but differs from the serial
+     * one with the same seed.
+     */
+    void set_parallel(const bool parallel, const std::size_t num_threads = 0);
+
+    bool is_parallel() const
+    {
+        return parallel_;
+    }
+
+    std::size_t num_threads() const
+    {
+        return num_threads_;
+    }
+
 protected:
 
-    boost::shared_ptr<SpatiocyteEvent> create_step_event(
+    boost::intrusive_ptr<SpatiocyteEvent> create_step_event(
         const Species& species, const Real& t, const Real& alpha);
-    boost::shared_ptr<SpatiocyteEvent> create_zeroth_order_reaction_event(
+    boost::intrusive_ptr<SpatiocyteEvent> create_zeroth_order_reaction_event(
         const ReactionRule& reaction_rule, const Real& t);
-    boost::shared_ptr<SpatiocyteEvent> create_first_order_reaction_event(
+    boost::intrusive_ptr<SpatiocyteEvent> create_first_order_reaction_event(
         const ReactionRule& reaction_rule, const Real& t);
 
     void step_();
     void register_events(const Species& species);
     void update_alpha_map();
 
-    void set_last_event_(boost::shared_ptr<const SpatiocyteEvent> event)
+    void set_last_event_(boost::intrusive_ptr<const SpatiocyteEvent> event)
     {
         last_event_ = event;
     }
 
 protected:
 
-    scheduler_type scheduler_; boost::shared_ptr<const SpatiocyteEvent> last_event_;
+    scheduler_type scheduler_; boost::intrusive_ptr<const SpatiocyteEvent> last_event_;
     alpha_map_type alpha_map_;
+    boost::shared_ptr<ReactionTable> reaction_table_;
 
     std::vector<reaction_type> last_reactions_;
 
     std::vector<Species> species_list_;
 
     Real dt_;
+    bool parallel_;
+    std::size_t num_threads_;
+    boost::shared_ptr<ThreadPool> pool_;  // valid only if parallel_
 };
 
 } // spatiocyte
@@ -8,6 +8,7 @@
 
 #include <ecell4/core/LatticeSpaceCellListImpl.hpp>
 #include <ecell4/core/LatticeSpaceVectorImpl.hpp>
+#include <ecell4/core/LatticeSpaceCompactImpl.hpp>
 #include <ecell4/core/OffLatticeSpace.hpp>
 #include <ecell4/core/VoxelPool.hpp>
 #include <ecell4/core/RandomNumberGenerator.hpp>
@@ -833,6 +834,19 @@ public:
         return rng_;
     }
 
+    /**
+     * return the root space if it is the only space and a LatticeSpaceVectorImpl,
+     * or a null pointer otherwise. Coordinates of the world are then those of it.
+     */
+    boost::shared_ptr<LatticeSpaceVectorImpl> get_vector_impl_root() const
+    {
+        if (spaces_.size() != 1)
+        {
+            return boost::shared_ptr<LatticeSpaceVectorImpl>();
+        }
+        return boost::dynamic_pointer_cast<LatticeSpaceVectorImpl>(get_root());
+    }
+
     void bind_to(boost::shared_ptr<Model> model)
     {
         if (boost::shared_ptr<Model> bound_model = model_.lock())
@@ -964,6 +978,17 @@ create_spatiocyte_world_vector_impl(
         new LatticeSpaceVectorImpl(edge_lengths, voxel_radius), rng);
 }
 
+inline
+SpatiocyteWorld*
+create_spatiocyte_world_compact_impl(
+        const Real3& edge_lengths,
+        const Real& voxel_radius,
+        const boost::shared_ptr<RandomNumberGenerator>& rng)
+{
+    return new SpatiocyteWorld(
+        new LatticeSpaceCompactImpl(edge_lengths, voxel_radius), rng);
+}
+
 inline
 SpatiocyteWorld*
 allocate_spatiocyte_world_square_offlattice_impl(
@@ -1033,6 +1058,13 @@ inline SpatiocyteWorld* create_spatiocyte_world_vector_impl_alias(
     return create_spatiocyte_world_vector_impl(edge_lengths, voxel_radius, rng);
 }
 
+inline SpatiocyteWorld* create_spatiocyte_world_compact_impl_alias(
+    const Real3& edge_lengths, const Real& voxel_radius,
+    const boost::shared_ptr<RandomNumberGenerator>& rng)
+{
+    return create_spatiocyte_world_compact_impl(edge_lengths, voxel_radius, rng);
+}
+
 } // spatiocyte
 
 } // ecell4
@@ -1,3 +1,8 @@
+#include <algorithm>
+
+#include <ecell4/core/get_mapper_mf.hpp>
+#include <ecell4/core/parallel_for.hpp>
+
 #include "SpatiocyteEvent.hpp"
 #include "utils.hpp"
 
@@ -7,14 +12,151 @@ namespace ecell4
 namespace spatiocyte
 {
 
+namespace
+{
+
+typedef SpatiocyteWorld::coordinate_type coordinate_type;
+
+/**
+ * blocks along an axis of the lattice for walk_in_parallel.
+ */
+struct block_axis
+{
+    static const Integer width = 8;  // the last block takes the remainder
+
+    block_axis(const Integer size)
+        : num_blocks(std::max<Integer>(1, size / width))
+    {
+        ;
+    }
+
+    Integer block(const Integer i) const
+    {
+        return std::min<Integer>(i / width, num_blocks - 1);
+    }
+
+    Integer colour(const Integer b) const
+    {
+        return (num_blocks > 1 && num_blocks % 2 != 0 && b + 1 == num_blocks ? 2 : b % 2);
+    }
+
+    Integer num_blocks;
+};
+
+struct walker_type
+{
+    coordinate_type coordinate;
+    Integer index;  // in the MoleculePool, given to move as a candidate
+};
+
+struct deferred_reaction
+{
+    coordinate_type src, dst;
+    ReactionTable::index_type partner;
+    std::size_t rule;
+};
+
+void walk_block(
+    LatticeSpaceVectorImpl& space, const VoxelPool* mpool,
+    const std::vector<walker_type>& walkers,
+    const ReactionTable& table, const ReactionTable::index_type row, const Real& alpha,
+    RandomNumberGenerator& rng, std::vector<deferred_reaction>& reactions)
+{
+    std::vector<coordinate_type> reserved;  // reactants selected in this block
+
+    for (std::vector<walker_type>::const_iterator i(walkers.begin());
+        i != walkers.end(); ++i)
+    {
+        const coordinate_type coord((*i).coordinate);
+        if (space.get_voxel_pool_ptr_at(coord) != mpool
+            || std::find(reserved.begin(), reserved.end(), coord) != reserved.end())
+        {
+            continue;
+        }
+
+        const coordinate_type neighbor(space.get_neighbor(
+            coord, rng.uniform_int(0, space.num_neighbors(coord) - 1)));
+
+        if (space.can_move(coord, neighbor))
+        {
+            if (rng.uniform(0, 1) <= alpha)
+                space.move(coord, neighbor, /*candidate=*/(*i).index);
+            continue;
+        }
+
+        const VoxelPool* target(space.get_voxel_pool_ptr_at(neighbor));
+        if (target->is_vacant()
+            || std::find(reserved.begin(), reserved.end(), neighbor) != reserved.end())
+        {
+            continue;
+        }
+
+        ReactionTable::index_type j;
+        if (!table.find(target, j) || table.get(row, j).rules.empty())
+        {
+            continue;
+        }
+
+        const ReactionTable::entry_type& entry(table.get(row, j));
+        const Real rnd(rng.uniform(0, 1));
+        for (std::size_t k(0); k < entry.rules.size(); ++k)
+        {
+            if (entry.accps[k] * alpha >= rnd)
+            {
+                const deferred_reaction reaction = {coord, neighbor, j, k};
+                reactions.push_back(reaction);
+                reserved.push_back(coord);
+                reserved.push_back(neighbor);
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * fix candidates of walkers after reactions reordered the pool.
+ */
+void reindex_walkers(
+    const MoleculePool& mpool, std::vector<walker_type>& walkers,
+    utils::get_mapper_mf<coordinate_type, Integer>::type& indices)
+{
+    for (std::vector<walker_type>::iterator i(walkers.begin()); i != walkers.end(); ++i)
+    {
+        if ((*i).index < mpool.size() && mpool[(*i).index].coordinate == (*i).coordinate)
+        {
+            continue;
+        }
+
+        if (indices.empty())
+        {
+            for (Integer idx(0); idx < mpool.size(); ++idx)
+            {
+                indices[mpool[idx].coordinate] = idx;
+            }
+        }
+
+        utils::get_mapper_mf<coordinate_type, Integer>::type::const_iterator
+            j(indices.find((*i).coordinate));
+        if (j != indices.end())
+        {
+            (*i).index = (*j).second;
+        }  // otherwise, it has reacted and is skipped
+    }
+}
+
+} // anonymous
+
 StepEvent::StepEvent(boost::shared_ptr<Model> model, boost::shared_ptr<SpatiocyteWorld> world,
-        const Species& species, const Real& t, const Real alpha)
+        const Species& species, const Real& t, const Real alpha,
+        boost::shared_ptr<ReactionTable> table)
     : SpatiocyteEvent(t),
       model_(model),
       world_(world),
       mpool_(world_->find_molecule_pool(species)),
+      table_(table ? table : boost::shared_ptr<ReactionTable>(new ReactionTable(model, world))),
       alpha_(alpha)
 {
+    row_ = table_->index_of(mpool_);
     time_ = t;
 }
 
@@ -22,8 +164,10 @@ StepEvent3D::StepEvent3D(boost::shared_ptr<Model> model,
                          boost::shared_ptr<SpatiocyteWorld> world,
                          const Species& species,
                          const Real& t,
-                         const Real alpha)
-    : StepEvent(model, world, species, t, alpha)
+                         const Real alpha,
+                         boost::shared_ptr<ReactionTable> table)
+    : StepEvent(model, world, species, t, alpha, table),
+      pool_()
 {
     const MoleculeInfo minfo(world_->get_molecule_info(species));
     const Real D(minfo.D);
@@ -44,6 +188,13 @@ void StepEvent3D::walk(const Real& alpha)
         return; // INVALID ALPHA VALUE
     }
 
+    if (pool_ && can_walk_in_parallel())
+    {
+        walk_in_parallel(alpha);
+        return;
+    }
+
+    table_->refresh();
     const boost::shared_ptr<RandomNumberGenerator>& rng(world_->rng());
     MoleculePool::container_type voxels;
     copy(mpool_->begin(), mpool_->end(), back_inserter(voxels));
@@ -79,12 +230,141 @@ void StepEvent3D::walk(const Real& alpha)
     }
 }
 
+bool StepEvent3D::can_walk_in_parallel() const
+{
+    if (!world_->get_vector_impl_root())
+    {
+        return false;
+    }
+
+    // the pool of the location would be updated by every move otherwise
+    const boost::shared_ptr<const VoxelPool> location(mpool_->location());
+    return (location && (location->is_vacant() || location->is_structure()));
+}
+
+void StepEvent3D::walk_in_parallel(const Real& alpha)
+{
+    const boost::shared_ptr<LatticeSpaceVectorImpl> root(world_->get_vector_impl_root());
+    LatticeSpaceVectorImpl& space(*root);
+    const block_axis axes[3] = {
+        block_axis(space.col_size()),
+        block_axis(space.row_size()),
+        block_axis(space.layer_size())};
+    const Integer num_blocks(
+        axes[0].num_blocks * axes[1].num_blocks * axes[2].num_blocks);
+
+    // group molecules by blocks
+    std::vector<std::vector<walker_type> > walkers(num_blocks);
+    for (Integer idx(0); idx < mpool_->size(); ++idx)
+    {
+        const walker_type walker = {(*mpool_)[idx].coordinate, idx};
+        const Integer3 global(space.coordinate2global(walker.coordinate));
+        walkers[axes[0].block(global.col) + axes[0].num_blocks * (
+            axes[1].block(global.row) + axes[1].num_blocks * axes[2].block(global.layer))
+            ].push_back(walker);
+    }
+
+    // group blocks by colours
+    std::vector<std::vector<Integer> > colours(27);
+    for (Integer k(0); k < axes[2].num_blocks; ++k)
+    {
+        for (Integer j(0); j < axes[1].num_blocks; ++j)
+        {
+            for (Integer i(0); i < axes[0].num_blocks; ++i)
+            {
+                const Integer block(
+                    i + axes[0].num_blocks * (j + axes[1].num_blocks * k));
+                if (!walkers[block].empty())
+                {
+                    colours[axes[0].colour(i)
+                        + 3 * (axes[1].colour(j) + 3 * axes[2].colour(k))
+                        ].push_back(block);
+                }
+            }
+        }
+    }
+
+    update_table(alpha);
+
+    const Integer seed(PhiloxRandomNumberGenerator::draw_key(*world_->rng()));
+    const VoxelPool* mpool(mpool_.get());
+    std::vector<std::vector<deferred_reaction> > reactions(num_blocks);
+
+    for (std::vector<std::vector<Integer> >::const_iterator
+        c(colours.begin()); c != colours.end(); ++c)
+    {
+        const std::vector<Integer>& blocks(*c);
+        pool_->parallel_for(blocks.size(),
+            [&](const std::size_t n)
+            {
+                const Integer block(blocks[n]);
+                PhiloxRandomNumberGenerator rng(seed, block);
+                walk_block(space, mpool, walkers[block], *table_, row_, alpha, rng,
+                    reactions[block]);
+            });
+
+        // fire reactions selected in this colour in the order of blocks
+        bool fired(false);
+        for (std::vector<Integer>::const_iterator i(blocks.begin());
+            i != blocks.end(); ++i)
+        {
+            for (std::vector<deferred_reaction>::const_iterator
+                j(reactions[*i].begin()); j != reactions[*i].end(); ++j)
+            {
+                const boost::shared_ptr<const VoxelPool>& partner(table_->pool((*j).partner));
+                if (space.get_voxel_pool_ptr_at((*j).src) != mpool
+                    || space.get_voxel_pool_ptr_at((*j).dst) != partner.get())
+                {
+                    continue;
+                }
+
+                const ReactionRule& rule(table_->get(row_, (*j).partner).rules[(*j).rule]);
+                ReactionInfo rinfo(apply_second_order_reaction(
+                            world_, rule,
+                            ReactionInfo::Item(mpool_->get_particle_id((*j).src),
+                                               mpool_->species(),
+                                               world_->coordinate2voxel((*j).src)),
+                            ReactionInfo::Item(partner->get_particle_id((*j).dst),
+                                               partner->species(),
+                                               world_->coordinate2voxel((*j).dst))));
+                if (rinfo.has_occurred())
+                {
+                    reaction_type reaction(std::make_pair(rule, rinfo));
+                    push_reaction(reaction);
+                }
+                fired = true;
+            }
+            reactions[*i].clear();
+        }
+
+        if (!fired)
+        {
+            continue;
+        }
+
+        // reactions may remove molecules from the pool, or yield new species
+        update_table(alpha);
+
+        utils::get_mapper_mf<coordinate_type, Integer>::type indices;
+        for (std::vector<std::vector<Integer> >::const_iterator
+            d(c + 1); d != colours.end(); ++d)
+        {
+            for (std::vector<Integer>::const_iterator i((*d).begin());
+                i != (*d).end(); ++i)
+            {
+                reindex_walkers(*mpool_, walkers[*i], indices);
+            }
+        }
+    }
+}
+
 StepEvent2D::StepEvent2D(boost::shared_ptr<Model> model,
                          boost::shared_ptr<SpatiocyteWorld> world,
                          const Species& species,
                          const Real& t,
-                         const Real alpha)
-    : StepEvent(model, world, species, t, alpha)
+                         const Real alpha,
+                         boost::shared_ptr<ReactionTable> table)
+    : StepEvent(model, world, species, t, alpha, table)
 {
     const MoleculeInfo minfo(world_->get_molecule_info(species));
     const Real D(minfo.D);
@@ -109,6 +389,7 @@ void StepEvent2D::walk(const Real& alpha)
         return; // INVALID ALPHA VALUE
     }
 
+    table_->refresh();
     const boost::shared_ptr<RandomNumberGenerator>& rng(world_->rng());
     MoleculePool::container_type voxels;
     copy(mpool_->begin(), mpool_->end(), back_inserter(voxels));
@@ -174,41 +455,31 @@ void StepEvent::attempt_reaction_(
         return;
     }
 
-    const Species& speciesA(from_mt->species());
-    const Species& speciesB(to_mt->species());
+    const ReactionTable::index_type row(from_mt == mpool_ ? row_ : table_->index_of(from_mt));
+    const ReactionTable::index_type col(table_->index_of(to_mt));
+    const ReactionTable::entry_type& entry(table_->get(row, col));
 
-    const std::vector<ReactionRule> rules(model_->query_reaction_rules(speciesA, speciesB));
-
-    if (rules.empty())
+    if (entry.rules.empty())
     {
         return;
     }
 
-    const Real factor(calculate_dimensional_factor(from_mt, to_mt, world_));
-    const Real rnd(world_->rng()->uniform(0,1));
-    Real accp(0.0);
+    table_->warn_acceptance(row, col, alpha);
 
-    for (std::vector<ReactionRule>::const_iterator itr(rules.begin()); itr != rules.end(); ++itr)
+    const Real rnd(world_->rng()->uniform(0,1));
+    for (std::size_t k(0); k < entry.rules.size(); ++k)
     {
-        const Real k((*itr).k());
-        const Real P(k * factor * alpha);
-        accp += P;
-        if (accp > 1 && k != std::numeric_limits<Real>::infinity())
-        {
-            std::cerr << "The total acceptance probability [" << accp
-                << "] exceeds 1 for '" << speciesA.serial()
-                << "' and '" << speciesB.serial() << "'." << std::endl;
-        }
-        if (accp >= rnd)
+        if (entry.accps[k] * alpha >= rnd)
         {
+            const ReactionRule& rule(entry.rules[k]);
             ReactionInfo rinfo(apply_second_order_reaction(
-                        world_, *itr,
+                        world_, rule,
                         ReactionInfo::Item(info.pid, from_mt->species(), voxel),
                         ReactionInfo::Item(to_mt->get_particle_id(dst.coordinate),
                                            to_mt->species(), dst)));
             if (rinfo.has_occurred())
             {
-                reaction_type reaction(std::make_pair(*itr, rinfo));
+                reaction_type reaction(std::make_pair(rule, rinfo));
                 push_reaction(reaction);
             }
             return;
@@ -216,6 +487,16 @@ void StepEvent::attempt_reaction_(
     }
 }
 
+void StepEvent::update_table(const Real& alpha)
+{
+    table_->refresh();
+    table_->update();
+    for (ReactionTable::index_type j(0); j < table_->size(); ++j)
+    {
+        table_->warn_acceptance(row_, j, alpha);
+    }
+}
+
 } // spatiocyte
 
 } // ecell4
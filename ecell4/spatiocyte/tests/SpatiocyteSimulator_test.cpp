@@ -9,8 +9,12 @@
 
 #include <boost/test/floating_point_comparison.hpp>
 
+#include <algorithm>
+
 #include <ecell4/core/NetworkModel.hpp>
 #include "../SpatiocyteSimulator.hpp"
+#include "../SpatiocyteFactory.hpp"
+#include "../utils.hpp"
 #include <ecell4/core/Sphere.hpp>
 
 using namespace ecell4;
@@ -262,6 +266,239 @@ BOOST_AUTO_TEST_CASE(SpatiocyteSimulator_test_binding_reaction)
     BOOST_CHECK_EQUAL(25 - world->num_molecules(sp2), num_sp3);
 }
 
+std::vector<std::pair<ParticleID, Integer> >
+run_parallel_binding(const std::size_t num_threads)
+{
+    const Real L(2e-7);
+    const Real3 edge_lengths(L, L, L);
+    const Real voxel_radius(2.5e-9);
+    const Real radius(1.25e-9);
+    const ecell4::Species sp1("A", radius, 1.0e-12),
+          sp2("B", radius, 1.1e-12),
+          sp3("C", 2.5e-9, 1.2e-12);
+
+    boost::shared_ptr<NetworkModel> model(new NetworkModel());
+    model->add_species_attribute(sp1);
+    model->add_species_attribute(sp2);
+    model->add_species_attribute(sp3);
+    model->add_reaction_rule(create_binding_reaction_rule(sp1,sp2,sp3,1e-19));
+
+    boost::shared_ptr<GSLRandomNumberGenerator>
+        rng(new GSLRandomNumberGenerator());
+    rng->seed(0);
+    boost::shared_ptr<SpatiocyteWorld> world(
+            new SpatiocyteWorld(edge_lengths, voxel_radius, rng));
+
+    SpatiocyteSimulator sim(world, model);
+    sim.set_parallel(true, num_threads);
+    BOOST_CHECK(sim.is_parallel());
+
+    BOOST_CHECK(world->add_molecules(sp1, 1000));
+    BOOST_CHECK(world->add_molecules(sp2, 1000));
+    sim.initialize();
+
+    for (Integer i(0); i < 50; ++i)
+    {
+        sim.step();
+    }
+
+    const Integer num_sp3(world->num_molecules(sp3));
+    BOOST_CHECK(num_sp3 > 0);
+    BOOST_CHECK_EQUAL(1000 - world->num_molecules(sp1), num_sp3);
+    BOOST_CHECK_EQUAL(1000 - world->num_molecules(sp2), num_sp3);
+
+    std::vector<std::pair<ParticleID, Integer> > retval;
+    const std::vector<std::pair<ParticleID, ParticleVoxel> > voxels(world->list_voxels());
+    for (std::vector<std::pair<ParticleID, ParticleVoxel> >::const_iterator
+        i(voxels.begin()); i != voxels.end(); ++i)
+    {
+        retval.push_back(std::make_pair((*i).first, (*i).second.coordinate));
+    }
+    std::sort(retval.begin(), retval.end());
+    return retval;
+}
+
+BOOST_AUTO_TEST_CASE(SpatiocyteSimulator_test_parallel)
+{
+    const std::vector<std::pair<ParticleID, Integer> >
+        serial(run_parallel_binding(1)), parallel(run_parallel_binding(4));
+    BOOST_CHECK(serial.size() > 0);
+    BOOST_CHECK(serial == parallel);
+}
+
+Integer count_bound(const bool parallel, const Integer seed)
+{
+    const Real L(2e-7);
+    const Real3 edge_lengths(L, L, L);
+    const Real voxel_radius(2.5e-9);
+    const Real radius(1.25e-9);
+    const ecell4::Species sp1("A", radius, 1.0e-12),
+          sp2("B", radius, 1.1e-12),
+          sp3("C", 2.5e-9, 1.2e-12);
+
+    boost::shared_ptr<NetworkModel> model(new NetworkModel());
+    model->add_species_attribute(sp1);
+    model->add_species_attribute(sp2);
+    model->add_species_attribute(sp3);
+    model->add_reaction_rule(create_binding_reaction_rule(sp1,sp2,sp3,1e-19));
+
+    boost::shared_ptr<GSLRandomNumberGenerator>
+        rng(new GSLRandomNumberGenerator());
+    rng->seed(seed);
+    boost::shared_ptr<SpatiocyteWorld> world(
+            new SpatiocyteWorld(edge_lengths, voxel_radius, rng));
+
+    SpatiocyteSimulator sim(world, model);
+    sim.set_parallel(parallel, 2);
+
+    world->add_molecules(sp1, 500);
+    world->add_molecules(sp2, 500);
+    sim.initialize();
+
+    for (Integer i(0); i < 30; ++i)
+    {
+        sim.step();
+    }
+    return world->num_molecules(sp3);
+}
+
+std::vector<std::pair<ParticleID, Integer> >
+run_factory_binding(const bool compact)
+{
+    const Real L(1e-7);
+    const Real3 edge_lengths(L, L, L);
+    const Real voxel_radius(2.5e-9);
+    const ecell4::Species sp1("A", voxel_radius, 1.0e-12),
+          sp2("B", voxel_radius, 1.1e-12),
+          sp3("C", voxel_radius, 1.2e-12);
+
+    boost::shared_ptr<NetworkModel> model(new NetworkModel());
+    model->add_species_attribute(sp1);
+    model->add_species_attribute(sp2);
+    model->add_species_attribute(sp3);
+    model->add_reaction_rule(create_binding_reaction_rule(sp1,sp2,sp3,1e-19));
+
+    boost::shared_ptr<GSLRandomNumberGenerator>
+        rng(new GSLRandomNumberGenerator());
+    rng->seed(0);
+    SpatiocyteFactory factory(voxel_radius);
+    factory.rng(rng).compact(compact);
+
+    boost::shared_ptr<SpatiocyteWorld> world(factory.world(edge_lengths));
+    BOOST_CHECK(world->add_molecules(sp1, 100));
+    BOOST_CHECK(world->add_molecules(sp2, 100));
+    boost::shared_ptr<SpatiocyteSimulator> sim(factory.simulator(world, model));
+    for (Integer i(0); i < 20; ++i)
+    {
+        sim->step();
+    }
+
+    std::vector<std::pair<ParticleID, Integer> > retval;
+    const std::vector<std::pair<ParticleID, ParticleVoxel> > voxels(world->list_voxels());
+    for (std::vector<std::pair<ParticleID, ParticleVoxel> >::const_iterator
+        i(voxels.begin()); i != voxels.end(); ++i)
+    {
+        retval.push_back(std::make_pair((*i).first, (*i).second.coordinate));
+    }
+    std::sort(retval.begin(), retval.end());
+    return retval;
+}
+
+BOOST_AUTO_TEST_CASE(SpatiocyteSimulator_test_compact_factory)
+{
+    // the compact lattice has the same voxels as the default one
+    const std::vector<std::pair<ParticleID, Integer> >
+        vector_impl(run_factory_binding(false)), compact_impl(run_factory_binding(true));
+    BOOST_CHECK(vector_impl.size() > 0);
+    BOOST_CHECK(vector_impl == compact_impl);
+}
+
+BOOST_AUTO_TEST_CASE(SpatiocyteSimulator_test_parallel_statistics)
+{
+    // the parallel walk draws different random numbers from the serial one,
+    // but the mean number of bound molecules must agree.
+    const Integer num_samples(16);
+    Real sum[2] = {0, 0}, sum_sq[2] = {0, 0};
+    for (Integer seed(0); seed < num_samples; ++seed)
+    {
+        for (Integer i(0); i < 2; ++i)
+        {
+            const Real x(count_bound(i == 1, seed));
+            sum[i] += x;
+            sum_sq[i] += x * x;
+        }
+    }
+
+    Real mean[2], var[2];
+    for (Integer i(0); i < 2; ++i)
+    {
+        mean[i] = sum[i] / num_samples;
+        var[i] = (sum_sq[i] - num_samples * mean[i] * mean[i]) / (num_samples - 1);
+    }
+    BOOST_CHECK(mean[0] > 0);
+    BOOST_CHECK(mean[1] > 0);
+    BOOST_CHECK_SMALL(mean[1] - mean[0],
+        4 * std::sqrt((var[0] + var[1]) / num_samples) + 1.0);
+}
+
+BOOST_AUTO_TEST_CASE(SpatiocyteSimulator_test_reaction_table)
+{
+    const Real L(2.5e-8);
+    const Real3 edge_lengths(L, L, L);
+    const Real voxel_radius(2.5e-9);
+    const ecell4::Species sp1("A", voxel_radius, 1.0e-12),
+          sp2("B", voxel_radius, 1.1e-12),
+          sp3("C", voxel_radius, 1.2e-12);
+
+    boost::shared_ptr<NetworkModel> model(new NetworkModel());
+    model->add_species_attribute(sp1);
+    model->add_species_attribute(sp2);
+    model->add_species_attribute(sp3);
+    model->add_reaction_rule(create_binding_reaction_rule(sp1,sp2,sp3,1e-20));
+    model->add_reaction_rule(create_binding_reaction_rule(sp1,sp2,sp1,2e-20));
+
+    boost::shared_ptr<GSLRandomNumberGenerator>
+        rng(new GSLRandomNumberGenerator());
+    boost::shared_ptr<SpatiocyteWorld> world(
+            new SpatiocyteWorld(edge_lengths, voxel_radius, rng));
+    BOOST_CHECK(world->add_molecules(sp1, 10));
+    BOOST_CHECK(world->add_molecules(sp2, 10));
+
+    ReactionTable table(model, world);
+    table.update();
+    BOOST_CHECK_EQUAL(table.size(), 2);
+
+    const boost::shared_ptr<const VoxelPool>
+        vp1(world->find_voxel_pool(sp1)), vp2(world->find_voxel_pool(sp2));
+    const ReactionTable::index_type i(table.index_of(vp1)), j(table.index_of(vp2));
+    BOOST_CHECK_EQUAL(table.size(), 2);
+
+    const ReactionTable::entry_type& entry(table.get(i, j));
+    BOOST_CHECK_EQUAL(entry.rules.size(), 2);
+    BOOST_CHECK_EQUAL(entry.rules.size(), table.get(j, i).rules.size());
+    BOOST_CHECK(table.get(i, i).rules.empty());
+
+    const Real factor(calculate_dimensional_factor(vp1, vp2, world));
+    BOOST_CHECK_CLOSE(entry.accps.at(0), 1e-20 * factor, 1e-6);
+    BOOST_CHECK_CLOSE(entry.accps.at(1), 3e-20 * factor, 1e-6);
+
+    // a rate changed in the model is taken at the next refresh
+    table.refresh();
+    BOOST_CHECK_CLOSE(table.get(i, j).accps.at(0), 1e-20 * factor, 1e-6);
+    model->add_reaction_rule(create_binding_reaction_rule(sp1,sp2,sp3,1e-20));
+    table.refresh();
+    BOOST_CHECK_CLOSE(table.get(i, j).accps.at(0), 2e-20 * factor, 1e-6);
+    BOOST_CHECK_CLOSE(table.get(i, j).accps.at(1), 4e-20 * factor, 1e-6);
+
+    // a pool appearing later is registered on demand
+    BOOST_CHECK(world->add_molecules(sp3, 1));
+    ReactionTable::index_type k;
+    BOOST_CHECK(!table.find(world->find_voxel_pool(sp3).get(), k));
+    k = table.index_of(world->find_voxel_pool(sp3));
+    BOOST_CHECK_EQUAL(table.size(), 3);
+    BOOST_CHECK(table.get(k, i).rules.empty());
+}
+
 BOOST_AUTO_TEST_CASE(SpatiocyteSimulator_test_unbinding_reaction)
 {
     const Real L(2.5e-8);